@@ -0,0 +1,139 @@
+/**
+ * BootSequence.cpp - Implementierung des Startablaufs
+ */
+
+#define LOG_MODULE LOG_MOD_MAIN
+
+#include "BootSequence.h"
+
+// Globale Instanz
+BootSequence bootSequence;
+
+int BootSequence::add(const char* name, std::initializer_list<int> needs, Step step) {
+  if (count >= BOOT_MAX_PHASES) {
+    LOG_E("Startphase %s: zu viele Phasen", name);
+    return -1;
+  }
+
+  Phase& phase = phases[count];
+  phase.name = name;
+  phase.step = step;
+  for (int need : needs) {
+    if (need < 0) {
+      continue;
+    }
+    uint32_t& mask = (need & AFTER_ONLY) ? phase.after : phase.needs;
+    need &= ~AFTER_ONLY;
+    if (need < count) {
+      mask |= 1UL << need;
+    }
+  }
+  finished = false;
+  return count++;
+}
+
+bool BootSequence::update() {
+  if (finished) {
+    return true;
+  }
+
+  // Phasen sind in Abhängigkeitsreihenfolge angelegt: ein Durchgang genügt,
+  // damit eine Kette synchroner Phasen vollständig abläuft
+  bool open = false;
+  for (uint8_t i = 0; i < count; i++) {
+    Phase& phase = phases[i];
+    if (phase.state != PHASE_WAITING && phase.state != PHASE_RUNNING) {
+      continue;
+    }
+
+    bool ready = true;
+    for (uint8_t need = 0; need < count; need++) {
+      if (!(phase.needs & (1UL << need))) {
+        continue;
+      }
+      if (phases[need].state == PHASE_FAILED || phases[need].state == PHASE_SKIPPED) {
+        phase.state = PHASE_SKIPPED;
+        LOG_W("Startphase %s übersprungen (%s fehlgeschlagen)", phase.name, phases[need].name);
+        ready = false;
+        break;
+      }
+      if (phases[need].state != PHASE_DONE) {
+        ready = false;
+      }
+    }
+    for (uint8_t need = 0; ready && need < count; need++) {
+      if ((phase.after & (1UL << need)) &&
+          (phases[need].state == PHASE_WAITING || phases[need].state == PHASE_RUNNING)) {
+        ready = false;
+      }
+    }
+    if (phase.state == PHASE_SKIPPED) {
+      continue;
+    }
+    if (!ready) {
+      open = true;
+      continue;
+    }
+
+    uint32_t start = micros();
+    if (phase.state == PHASE_WAITING) {
+      phase.state = PHASE_RUNNING;
+      phase.startedAt = start;
+    }
+    BootResult result = phase.step();
+    uint32_t end = micros();
+    phase.busy += end - start;
+    phase.calls++;
+
+    if (result == BOOT_PENDING) {
+      open = true;
+      continue;
+    }
+    phase.state = result == BOOT_DONE ? PHASE_DONE : PHASE_FAILED;
+    phase.finishedAt = end;
+    LOG_I("Startphase %s %s nach %lu ms", phase.name,
+          result == BOOT_DONE ? "fertig" : "fehlgeschlagen",
+          (unsigned long)((end - phase.startedAt) / 1000));
+  }
+
+  if (!open) {
+    finished = true;
+    LOG_I("Start abgeschlossen nach %lu ms", (unsigned long)(micros() / 1000));
+  }
+  return finished;
+}
+
+bool BootSequence::isDone(int phase) const {
+  return phase >= 0 && phase < count && phases[phase].state == PHASE_DONE;
+}
+
+void BootSequence::markInteractive() {
+  if (interactiveAt == 0) {
+    interactiveAt = micros();
+    LOG_I("Bedienbar nach %lu ms", (unsigned long)(interactiveAt / 1000));
+  }
+}
+
+void BootSequence::printReport(Print &out) const {
+  static const char* stateNames[] = { "wartet", "läuft", "fertig", "Fehler", "übersprungen" };
+
+  out.println("Phase        Beginn (ms)  Dauer (ms)  Eigen (ms)  Aufrufe  Status");
+  for (uint8_t i = 0; i < count; i++) {
+    const Phase& phase = phases[i];
+    uint32_t end = phase.state == PHASE_RUNNING ? micros() : phase.finishedAt;
+    bool started = phase.state != PHASE_WAITING && phase.state != PHASE_SKIPPED;
+    char line[96];
+    snprintf(line, sizeof(line), "%-12s %11lu %11lu %11lu %8u  %s", phase.name,
+             (unsigned long)(phase.startedAt / 1000),
+             (unsigned long)(started ? (end - phase.startedAt) / 1000 : 0),
+             (unsigned long)(phase.busy / 1000), (unsigned)phase.calls, stateNames[phase.state]);
+    out.println(line);
+  }
+  out.print("Bedienbar nach: ");
+  if (interactiveAt > 0) {
+    out.print(interactiveAt / 1000);
+    out.println(" ms");
+  } else {
+    out.println("-");
+  }
+}
@@ -0,0 +1,87 @@
+/**
+ * BootSequence.h - Startablauf als Abhängigkeitsgraph mit Zeitmessung
+ *
+ * Jede Startphase (Display, Dateisystem, Konfiguration, Menü, WLAN, MQTT, ...)
+ * nennt die Phasen, die vorher fertig sein müssen. update() führt alle Phasen
+ * aus, deren Vorgänger abgeschlossen sind:
+ *   - Synchrone Phasen liefern sofort BOOT_DONE und laufen in setup() in
+ *     einem Durchgang ab
+ *   - Netzwerkphasen liefern BOOT_PENDING und werden aus loop() erneut
+ *     aufgerufen, bis sie fertig sind; Menü und Touch sind bis dahin bedienbar
+ *   - Schlägt eine Phase fehl, werden ihre Nachfolger übersprungen; mit
+ *     after(phase) wartet ein Nachfolger nur auf ihr Ende und läuft auch
+ *     nach einem Fehler (z.B. Standardwerte statt Dateisystem)
+ * Für jede Phase werden Beginn, Dauer bis zum Abschluss und die in der Phase
+ * selbst verbrachte Zeit festgehalten, dazu der Zeitpunkt, ab dem das Menü
+ * bedienbar ist.
+ */
+
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <Arduino.h>
+#include <functional>
+#include <initializer_list>
+#include "config.h"
+
+enum BootResult : uint8_t {
+  BOOT_DONE,
+  BOOT_PENDING,        // Erneut aufrufen (z.B. auf WLAN warten)
+  BOOT_FAILED
+};
+
+class BootSequence {
+public:
+  typedef std::function<BootResult()> Step;
+
+private:
+  enum PhaseState : uint8_t {
+    PHASE_WAITING,
+    PHASE_RUNNING,
+    PHASE_DONE,
+    PHASE_FAILED,
+    PHASE_SKIPPED      // Ein Vorgänger ist fehlgeschlagen
+  };
+
+  struct Phase {
+    const char* name;
+    uint32_t needs = 0;           // Bit je Vorgänger
+    uint32_t after = 0;           // Bit je Vorgänger, dessen Fehler nicht stört
+    Step step;
+    PhaseState state = PHASE_WAITING;
+    uint32_t startedAt = 0;       // µs seit dem Reset
+    uint32_t finishedAt = 0;
+    uint32_t busy = 0;            // µs in step()
+    uint16_t calls = 0;
+  };
+
+  Phase phases[BOOT_MAX_PHASES];
+  uint8_t count = 0;
+  uint32_t interactiveAt = 0;
+  bool finished = false;
+
+  static const int AFTER_ONLY = 0x100;
+
+public:
+  // Phase anhängen; liefert ihre Nummer für spätere Abhängigkeiten
+  int add(const char* name, std::initializer_list<int> needs, Step step);
+
+  // Abhängigkeit nur in der Reihenfolge: warten, aber auch nach Fehler starten
+  static int after(int phase) { return phase < 0 ? phase : phase | AFTER_ONLY; }
+
+  // Alle bereiten Phasen einmal ausführen; true, wenn keine mehr offen ist
+  bool update();
+
+  bool isFinished() const { return finished; }
+  bool isDone(int phase) const;
+
+  // Menü gezeichnet und Touch aktiv
+  void markInteractive();
+  uint32_t getInteractiveTime() const { return interactiveAt; }
+
+  void printReport(Print &out) const;
+};
+
+extern BootSequence bootSequence;
+
+#endif // BOOT_SEQUENCE_H
@@ -2,11 +2,20 @@
  * ConfigManager.cpp - Implementierung der Konfigurationsfunktionen
  */
 
+#define LOG_MODULE LOG_MOD_CONFIG
+
 #include "ConfigManager.h"
 
 // Globale Instanz
 ConfigManager configManager;
 
+// Konfigurationen mit Binär-Snapshot (SPIFFS-Namen max. 31 Zeichen)
+const ConfigManager::ConfigSource ConfigManager::configSources[CONFIG_SOURCES] = {
+  { "/config.json", "/config.msgpack", &ConfigManager::isValidConfig },
+  { "/menu.json", "/menu.msgpack", &ConfigManager::isValidMenu },
+  { "/mqtt_topics.json", "/mqtt_topics.msgpack", &ConfigManager::isValidTopics }
+};
+
 ConfigManager::ConfigManager() {
   // Konstruktor
 }
@@ -29,16 +38,14 @@ bool ConfigManager::begin() {
   
   spiffsInitialized = true;
   
-  // Liste der Dateien ausgeben
-  DEBUG_PRINTLN("Dateien im SPIFFS:");
-  listFiles();
+  // Fehlende Konfigurationen werden nicht angelegt: die Standardwerte liegen
+  // als Tabellen im Flash (default_data.h)
   
-  // Standard-Konfigurationen erstellen, falls nicht vorhanden
-  createDefaultConfigs();
-  
-  // Nach dem Erstellen nochmals alle Dateien anzeigen
-  DEBUG_PRINTLN("Dateien nach dem Erstellen der Standardkonfigurationen:");
-  listFiles();
+  // Dateiliste nur bei Debug-Ausgabe, sie verlängert sonst den Start
+  if (logger.enabled(LOG_LEVEL_DEBUG, LOG_MODULE)) {
+    DEBUG_PRINTLN("Dateien im SPIFFS:");
+    listFiles();
+  }
   
   return true;
 }
@@ -49,23 +56,29 @@ bool ConfigManager::loadJsonConfig(const String &filename, JsonDocument &doc) {
     return false;
   }
   
+  // Bekannte Konfigurationen über den Binär-Snapshot, alle anderen direkt
+  for (int i = 0; i < CONFIG_SOURCES; i++) {
+    if (filename == configSources[i].path) {
+      return loadCached(i, doc);
+    }
+  }
+  return parseJsonFile(filename, doc);
+}
+
+bool ConfigManager::parseJsonFile(const String &filename, JsonDocument &doc) {
   if (!SPIFFS.exists(filename)) {
     DEBUG_PRINT("Konfigurationsdatei nicht gefunden: ");
     DEBUG_PRINTLN(filename);
     return false;
   }
   
-  DEBUG_PRINT("Öffne Datei: ");
-  DEBUG_PRINTLN(filename);
-  
   File file = SPIFFS.open(filename, "r");
   if (!file) {
     DEBUG_PRINTLN("Fehler beim Öffnen der Datei");
     return false;
   }
   
-  DEBUG_PRINT("Dateigröße: ");
-  DEBUG_PRINTLN(file.size());
+  LOG_D("Parse %s (%u Bytes)", filename.c_str(), (unsigned)file.size());
   
   // Falls die Datei leer ist, keine Verarbeitung durchführen
   if (file.size() == 0) {
@@ -87,23 +100,168 @@ bool ConfigManager::loadJsonConfig(const String &filename, JsonDocument &doc) {
   DEBUG_PRINT("Konfigurationsdatei geladen: ");
   DEBUG_PRINTLN(filename);
   return true;
+}
+
+bool ConfigManager::loadCached(int index, JsonDocument &doc) {
+  const ConfigSource &source = configSources[index];
+  ConfigLoadInfo &info = loadInfo[index];
+  unsigned long start = micros();
+  
+  uint32_t hash = 0;
+  size_t size = 0;
+  if (hashFile(source.path, hash, size)) {
+    // Quelle unverändert: Snapshot ohne JSON-Parser lesen
+    if (readSnapshot(source.snapshot, hash, size, doc)) {
+      info.origin = CONFIG_FROM_SNAPSHOT;
+    } else if (parseJsonFile(source.path, doc) && (this->*source.validate)(doc)) {
+      writeSnapshot(source.snapshot, hash, size, doc);
+      info.origin = CONFIG_FROM_JSON;
+    } else {
+      // Datei bleibt zur Korrektur erhalten
+      LOG_W("%s ist ungültig, verwende Standardwerte", source.path);
+      info.origin = CONFIG_FROM_DEFAULT;
+    }
+  } else {
+    LOG_I("%s fehlt, verwende Standardwerte", source.path);
+    info.origin = CONFIG_FROM_DEFAULT;
+    hash = 0;
+    size = 0;
+  }
+  
+  info.hash = hash;
+  info.size = size;
+  info.loadTime = micros() - start;
+  info.loads++;
+  LOG_D("%s geladen (%s) in %lu us", source.path, originName(info.origin), (unsigned long)info.loadTime);
+  if (info.origin == CONFIG_FROM_DEFAULT) {
+    doc.clear();
+    return false;
+  }
+  return true;
+}
+
+bool ConfigManager::hasChanged(const String &filename) {
+  if (!spiffsInitialized) {
+    return false;
+  }
+  for (int i = 0; i < CONFIG_SOURCES; i++) {
+    if (filename != configSources[i].path) {
+      continue;
+    }
+    const ConfigLoadInfo &info = loadInfo[i];
+    if (info.origin == CONFIG_NOT_LOADED) {
+      return false;
+    }
+    uint32_t hash = 0;
+    size_t size = 0;
+    if (!hashFile(configSources[i].path, hash, size)) {
+      hash = 0;
+      size = 0;
+    }
+    return hash != info.hash || size != info.size;
+  }
+  return false;
+}
+
+uint32_t ConfigManager::fnv1a(uint32_t hash, const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    hash ^= data[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+bool ConfigManager::hashFile(const char *path, uint32_t &hash, size_t &size) {
+  // Ein einziges Öffnen liefert Existenz, Größe und Inhalt
+  if (!SPIFFS.exists(path)) {
+    return false;
+  }
+  File file = SPIFFS.open(path, "r");
+  if (!file) {
+    return false;
+  }
+  
+  size = file.size();
+  hash = FNV_OFFSET;
+  uint8_t buffer[256];
+  size_t length;
+  while ((length = file.read(buffer, sizeof(buffer))) > 0) {
+    hash = fnv1a(hash, buffer, length);
+  }
+  file.close();
+  return size > 0;
+}
 
-    // Erweitere Validierung basierend auf dem Dateityp
-  bool isValid = true;
-  if (filename == "/menu.json") {
-    isValid = isValidMenu(doc);
-    if (!isValid) DEBUG_PRINTLN("menu.json hat keine gültige Struktur!");
+bool ConfigManager::readSnapshot(const char *path, uint32_t hash, size_t size, JsonDocument &doc) {
+  if (!SPIFFS.exists(path)) {
+    return false;
+  }
+  File file = SPIFFS.open(path, "r");
+  if (!file) {
+    return false;
   }
-  else if (filename == "/mqtt_topics.json") {
-    isValid = isValidTopics(doc);
-    if (!isValid) DEBUG_PRINTLN("mqtt_topics.json hat keine gültige Struktur!");
+  
+  SnapshotHeader header;
+  if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+      header.magic != CONFIG_SNAPSHOT_MAGIC || header.hash != hash || header.size != size) {
+    file.close();
+    return false;
   }
-  else if (filename == "/config.json") {
-    isValid = isValidConfig(doc);
-    if (!isValid) DEBUG_PRINTLN("config.json hat keine gültige Struktur!");
+  
+  DeserializationError error = deserializeMsgPack(doc, file);
+  file.close();
+  if (error) {
+    LOG_W("Snapshot %s unlesbar: %s", path, error.c_str());
+    SPIFFS.remove(path);
+    return false;
+  }
+  return true;
+}
+
+bool ConfigManager::writeSnapshot(const char *path, uint32_t hash, size_t size, const JsonDocument &doc) {
+  File file = SPIFFS.open(path, "w");
+  if (!file) {
+    LOG_W("Snapshot %s nicht schreibbar", path);
+    return false;
   }
   
-  return isValid;
+  SnapshotHeader header = { CONFIG_SNAPSHOT_MAGIC, hash, (uint32_t)size };
+  bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+            serializeMsgPack(doc, file) > 0;
+  file.close();
+  if (!ok) {
+    // Ein halber Snapshot würde beim nächsten Start als gültig gelten
+    SPIFFS.remove(path);
+    LOG_W("Snapshot %s unvollständig, verworfen", path);
+  }
+  return ok;
+}
+
+void ConfigManager::clearSnapshots() {
+  for (int i = 0; i < CONFIG_SOURCES; i++) {
+    SPIFFS.remove(configSources[i].snapshot);
+  }
+}
+
+const char* ConfigManager::originName(ConfigOrigin origin) {
+  switch (origin) {
+    case CONFIG_FROM_SNAPSHOT: return "Snapshot";
+    case CONFIG_FROM_JSON: return "JSON";
+    case CONFIG_FROM_DEFAULT: return "Standard";
+    default: return "-";
+  }
+}
+
+void ConfigManager::printStatus(Print &out) const {
+  out.println("Datei               Quelle     Bytes  Hash      Zeit (us)  Ladevorgänge");
+  for (int i = 0; i < CONFIG_SOURCES; i++) {
+    const ConfigLoadInfo &info = loadInfo[i];
+    char line[96];
+    snprintf(line, sizeof(line), "%-19s %-9s %6lu  %08lx %10lu  %lu", configSources[i].path,
+             originName(info.origin), (unsigned long)info.size, (unsigned long)info.hash,
+             (unsigned long)info.loadTime, (unsigned long)info.loads);
+    out.println(line);
+  }
 }
 
 bool ConfigManager::saveJsonConfig(const String &filename, const JsonDocument &doc) {
@@ -112,7 +270,10 @@ bool ConfigManager::saveJsonConfig(const String &filename, const JsonDocument &d
     return false;
   }
   
-  File file = SPIFFS.open(filename, "w");
+  // Erst vollständig in eine Zwischendatei schreiben, damit ein Stromausfall
+  // nicht die bisherige Datei zerstört
+  String tempName = filename + ".tmp";
+  File file = SPIFFS.open(tempName, "w");
   if (!file) {
     DEBUG_PRINTLN("Fehler beim Öffnen der Datei zum Schreiben");
     return false;
@@ -122,73 +283,21 @@ bool ConfigManager::saveJsonConfig(const String &filename, const JsonDocument &d
   if (serializeJson(doc, file) == 0) {
     DEBUG_PRINTLN("Fehler beim Schreiben der JSON-Daten");
     file.close();
+    SPIFFS.remove(tempName);
     return false;
   }
   
   file.close();
+  SPIFFS.remove(filename);
+  if (!SPIFFS.rename(tempName, filename)) {
+    DEBUG_PRINTLN("Fehler beim Umbenennen der Zwischendatei");
+    return false;
+  }
   DEBUG_PRINT("Konfigurationsdatei gespeichert: ");
   DEBUG_PRINTLN(filename);
   return true;
 }
 
-void ConfigManager::createDefaultConfigs() {
-  DEBUG_PRINTLN("Prüfe auf vorhandene Konfigurationsdateien...");
-  
-  // Prüfe/erstelle config.json
-  if (!fileExists("/config.json")) {
-    DEBUG_PRINTLN("config.json existiert nicht, erstelle Standardkonfiguration...");
-    createDefaultConfigFile();
-  } else {
-    DEBUG_PRINTLN("config.json existiert bereits");
-    
-    // Lade die Datei und prüfe, ob sie gültig ist
-    JsonDocument testDoc;
-    if (loadJsonConfig("/config.json", testDoc) && isValidConfig(testDoc)) {
-      DEBUG_PRINTLN("config.json ist gültig");
-    } else {
-      DEBUG_PRINTLN("config.json ist ungültig, erstelle neu...");
-      SPIFFS.remove("/config.json");
-      createDefaultConfigFile();
-    }
-  }
-  
-  // Prüfe/erstelle menu.json
-  if (!fileExists("/menu.json")) {
-    DEBUG_PRINTLN("menu.json existiert nicht, erstelle Standardkonfiguration...");
-    createDefaultMenuFile();
-  } else {
-    DEBUG_PRINTLN("menu.json existiert bereits");
-    
-    // Lade die Datei und prüfe, ob sie gültig ist
-    JsonDocument testDoc;
-    if (loadJsonConfig("/menu.json", testDoc) && isValidMenu(testDoc)) {
-      DEBUG_PRINTLN("menu.json ist gültig");
-    } else {
-      DEBUG_PRINTLN("menu.json ist ungültig, erstelle neu...");
-      SPIFFS.remove("/menu.json");
-      createDefaultMenuFile();
-    }
-  }
-  
-  // Prüfe/erstelle mqtt_topics.json
-  if (!fileExists("/mqtt_topics.json")) {
-    DEBUG_PRINTLN("mqtt_topics.json existiert nicht, erstelle Standardkonfiguration...");
-    createDefaultMqttTopicsFile();
-  } else {
-    DEBUG_PRINTLN("mqtt_topics.json existiert bereits");
-    
-    // Lade die Datei und prüfe, ob sie gültig ist
-    JsonDocument testDoc;
-    if (loadJsonConfig("/mqtt_topics.json", testDoc) && isValidTopics(testDoc)) {
-      DEBUG_PRINTLN("mqtt_topics.json ist gültig");
-    } else {
-      DEBUG_PRINTLN("mqtt_topics.json ist ungültig, erstelle neu...");
-      SPIFFS.remove("/mqtt_topics.json");
-      createDefaultMqttTopicsFile();
-    }
-  }
-}
-
 void ConfigManager::listFiles() {
   File root = SPIFFS.open("/");
   File file = root.openNextFile();
@@ -211,78 +320,32 @@ void ConfigManager::listFiles() {
 
 bool ConfigManager::fileExists(const String &filename) {
   if (!spiffsInitialized) {
-    DEBUG_PRINTLN("SPIFFS nicht initialisiert beim Prüfen von Datei!");
+    LOG_E("SPIFFS nicht initialisiert beim Prüfen von %s", filename.c_str());
     return false;
   }
   
   bool exists = SPIFFS.exists(filename);
-  DEBUG_PRINT("Prüfe Datei ");
-  DEBUG_PRINT(filename);
-  DEBUG_PRINT(": ");
-  DEBUG_PRINTLN(exists ? "Existiert" : "Existiert nicht");
-  
-  if (exists) {
-    // Prüfe auch, ob die Datei Inhalt hat
-    File file = SPIFFS.open(filename, "r");
-    if (!file) {
-      DEBUG_PRINTLN("  Konnte Datei nicht öffnen trotz exists=true");
-      return false;
-    }
-    
-    size_t size = file.size();
-    file.close();
-    
-    DEBUG_PRINT("  Dateigröße: ");
-    DEBUG_PRINTLN(size);
-    
-    if (size == 0) {
-      DEBUG_PRINTLN("  Datei ist leer!");
-      return false;
-    }
-  }
-  
-  return exists;
-}
-
-bool ConfigManager::createDefaultConfigFile() {
-  DEBUG_PRINTLN("Erstelle default config.json...");
-  File file = SPIFFS.open("/config.json", "w");
-  if (!file) {
-    DEBUG_PRINTLN("Konnte config.json nicht zum Schreiben öffnen");
+  if (!exists) {
+    LOG_D("Prüfe Datei %s: existiert nicht", filename.c_str());
     return false;
   }
   
-  file.print(DEFAULT_CONFIG_JSON);
-  file.close();
-  DEBUG_PRINTLN("Default config.json erstellt");
-  return true;
-}
-
-bool ConfigManager::createDefaultMenuFile() {
-  DEBUG_PRINTLN("Erstelle default menu.json...");
-  File file = SPIFFS.open("/menu.json", "w");
+  // Prüfe auch, ob die Datei Inhalt hat
+  File file = SPIFFS.open(filename, "r");
   if (!file) {
-    DEBUG_PRINTLN("Konnte menu.json nicht zum Schreiben öffnen");
+    LOG_W("Konnte %s nicht öffnen trotz exists=true", filename.c_str());
     return false;
   }
   
-  file.print(DEFAULT_MENU_JSON);
+  size_t size = file.size();
   file.close();
-  DEBUG_PRINTLN("Default menu.json erstellt");
-  return true;
-}
-
-bool ConfigManager::createDefaultMqttTopicsFile() {
-  DEBUG_PRINTLN("Erstelle default mqtt_topics.json...");
-  File file = SPIFFS.open("/mqtt_topics.json", "w");
-  if (!file) {
-    DEBUG_PRINTLN("Konnte mqtt_topics.json nicht zum Schreiben öffnen");
+  
+  LOG_D("Prüfe Datei %s: %u Bytes", filename.c_str(), (unsigned)size);
+  if (size == 0) {
+    LOG_W("Datei %s ist leer", filename.c_str());
     return false;
   }
   
-  file.print(DEFAULT_MQTT_TOPICS_JSON);
-  file.close();
-  DEBUG_PRINTLN("Default mqtt_topics.json erstellt");
   return true;
 }
 
@@ -11,30 +11,72 @@
 #include "config.h"
 #include "default_data.h"
 
+enum ConfigOrigin : uint8_t {
+  CONFIG_NOT_LOADED,
+  CONFIG_FROM_SNAPSHOT,   // Binär-Snapshot, kein JSON-Parser
+  CONFIG_FROM_JSON,       // Quelle geändert, Snapshot neu geschrieben
+  CONFIG_FROM_DEFAULT     // Quelle fehlt oder ungültig: Tabellen aus default_data
+};
+
 class ConfigManager {
 private:
   bool spiffsInitialized = false;
   
+  // config.json, menu.json und mqtt_topics.json werden einmal als JSON
+  // geparst und validiert und danach als MessagePack mit Hash und Größe der
+  // Quelle gespeichert. Solange die Quelle gleich bleibt, wird nur der
+  // Snapshot gelesen.
+  static const int CONFIG_SOURCES = 3;
+  static const uint32_t FNV_OFFSET = 2166136261UL;
+  
+  struct ConfigSource {
+    const char* path;
+    const char* snapshot;
+    bool (ConfigManager::*validate)(JsonDocument &doc);
+  };
+  static const ConfigSource configSources[CONFIG_SOURCES];
+  
+  struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t hash;          // FNV-1a über die JSON-Quelle
+    uint32_t size;
+  };
+  
+  struct ConfigLoadInfo {
+    ConfigOrigin origin = CONFIG_NOT_LOADED;
+    uint32_t hash = 0;
+    size_t size = 0;
+    uint32_t loadTime = 0;  // µs, letzter Ladevorgang
+    uint32_t loads = 0;
+  };
+  ConfigLoadInfo loadInfo[CONFIG_SOURCES];
+  
+  bool parseJsonFile(const String &filename, JsonDocument &doc);
+  bool loadCached(int index, JsonDocument &doc);
+  bool hashFile(const char *path, uint32_t &hash, size_t &size);
+  bool readSnapshot(const char *path, uint32_t hash, size_t size, JsonDocument &doc);
+  bool writeSnapshot(const char *path, uint32_t hash, size_t size, const JsonDocument &doc);
+  static uint32_t fnv1a(uint32_t hash, const uint8_t *data, size_t length);
+  
 public:
   ConfigManager();
   
   // SPIFFS initialisieren
   bool begin();
+  bool isMounted() const { return spiffsInitialized; }
   
-  // JSON-Datei laden
+  // JSON-Datei laden; bekannte Konfigurationen über den Snapshot. Fehlt eine
+  // oder ist sie ungültig, liefert die Funktion false und der Aufrufer nutzt
+  // die Standardtabellen aus default_data.h (es wird nichts geschrieben)
   bool loadJsonConfig(const String &filename, JsonDocument &doc);
   
+  // Quelle seit dem letzten loadJsonConfig() geändert, angelegt oder
+  // gelöscht (Hash und Größe); nur für config.json, menu.json, mqtt_topics.json
+  bool hasChanged(const String &filename);
+  
   // JSON-Datei speichern
   bool saveJsonConfig(const String &filename, const JsonDocument &doc);
   
-  // Standard-Konfigurationen erstellen, falls nicht vorhanden
-  void createDefaultConfigs();
-  
-  // Standard-Konfigurationsdateien erstellen
-  bool createDefaultConfigFile();
-  bool createDefaultMenuFile();
-  bool createDefaultMqttTopicsFile();
-  
   // Validierungsfunktionen
   bool isValidConfig(JsonDocument &doc);
   bool isValidMenu(JsonDocument &doc);
@@ -43,6 +85,11 @@ public:
   // Hilfsfunktionen
   void listFiles(); // Listet alle Dateien im SPIFFS
   bool fileExists(const String &filename);
+  
+  // Snapshots löschen; der nächste Ladevorgang parst wieder JSON
+  void clearSnapshots();
+  void printStatus(Print &out) const;
+  static const char* originName(ConfigOrigin origin);
 };
 
 extern ConfigManager configManager;
@@ -0,0 +1,317 @@
+/**
+ * ConfigStore.cpp - Implementierung des Einstellungsjournals
+ */
+
+#define LOG_MODULE LOG_MOD_CONFIG
+
+#include "ConfigStore.h"
+#include "JsonArena.h"
+
+// Globale Instanz
+ConfigStore configStore;
+
+bool ConfigStore::begin(fs::FS &fs) {
+  this->fs = &fs;
+  values.clear();
+  logSize = 0;
+  liveSize = 0;
+
+  // Stromausfall während der Verdichtung: ist die alte Datei schon gelöscht,
+  // ist die neue vollständig; sonst gilt weiter die alte
+  if (fs.exists(CONFIG_STORE_TEMP)) {
+    if (fs.exists(CONFIG_STORE_PATH)) {
+      fs.remove(CONFIG_STORE_TEMP);
+    } else if (!fs.rename(CONFIG_STORE_TEMP, CONFIG_STORE_PATH)) {
+      LOG_E("Einstellungsjournal konnte nicht übernommen werden");
+      return false;
+    }
+  }
+
+  if (!replay()) {
+    // Hinter einem abgerissenen Datensatz angehängte Werte wären beim
+    // nächsten Start unerreichbar: sofort sauber neu schreiben
+    LOG_W("Einstellungsjournal nach %lu Bytes beschädigt, verdichte", (unsigned long)logSize);
+    return compact();
+  }
+
+  LOG_I("%u Einstellungen aus dem Journal (%lu Bytes)", (unsigned)values.size(), (unsigned long)logSize);
+  return true;
+}
+
+bool ConfigStore::replay() {
+  if (!fs->exists(CONFIG_STORE_PATH)) {
+    return true;
+  }
+  File file = fs->open(CONFIG_STORE_PATH, "r");
+  if (!file) {
+    // Nicht verdichten, sonst wären die gespeicherten Werte verloren
+    LOG_E("Einstellungsjournal nicht lesbar");
+    return true;
+  }
+
+  size_t fileSize = file.size();
+  uint8_t buffer[RECORD_MAX];
+  RecordHeader header;
+  bool valid = true;
+
+  while (logSize < fileSize) {
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != CONFIG_STORE_MAGIC || header.keyLength == 0 ||
+        header.keyLength > CONFIG_STORE_MAX_KEY ||
+        (header.valueLength > CONFIG_STORE_MAX_VALUE && header.valueLength != VALUE_ERASED)) {
+      valid = false;
+      break;
+    }
+
+    uint16_t valueLength = header.valueLength == VALUE_ERASED ? 0 : header.valueLength;
+    size_t dataLength = header.keyLength + valueLength;
+    if (file.read(buffer, dataLength) != dataLength) {
+      valid = false;
+      break;
+    }
+
+    uint32_t crc = crc32(0, (const uint8_t*)&header.keyLength, 3);
+    if (crc32(crc, buffer, dataLength) != header.crc) {
+      valid = false;
+      break;
+    }
+
+    String key;
+    key.concat((const char*)buffer, header.keyLength);
+    if (header.valueLength == VALUE_ERASED) {
+      values.erase(key);
+    } else {
+      String value;
+      value.concat((const char*)buffer + header.keyLength, valueLength);
+      values[key] = value;
+    }
+    logSize += sizeof(header) + dataLength;
+  }
+  file.close();
+
+  liveSize = 0;
+  for (const auto &entry : values) {
+    liveSize += recordSize(entry.first, entry.second);
+  }
+  if (!valid) {
+    torn += fileSize - logSize;
+  }
+  return valid;
+}
+
+bool ConfigStore::set(const String &key, const String &value) {
+  if (key.length() == 0 || key.length() > CONFIG_STORE_MAX_KEY || value.length() > CONFIG_STORE_MAX_VALUE) {
+    LOG_W("Einstellung %s: Schlüssel oder Wert zu lang", key.c_str());
+    return false;
+  }
+  auto it = values.find(key);
+  if (it != values.end() && it->second == value) {
+    return true;
+  }
+  if (!append(key, value.c_str(), value.length())) {
+    return false;
+  }
+
+  if (it != values.end()) {
+    liveSize -= recordSize(key, it->second);
+  }
+  values[key] = value;
+  liveSize += recordSize(key, value);
+
+  // Erst ab einer Mindestgröße und wenn mehr als die Hälfte überholt ist
+  if (logSize >= CONFIG_STORE_COMPACT_SIZE && logSize > 2 * liveSize) {
+    compact();
+  }
+  return true;
+}
+
+bool ConfigStore::remove(const String &key) {
+  auto it = values.find(key);
+  if (it == values.end()) {
+    return true;
+  }
+  if (!append(key, "", VALUE_ERASED)) {
+    return false;
+  }
+  liveSize -= recordSize(key, it->second);
+  values.erase(it);
+  return true;
+}
+
+String ConfigStore::get(const String &key, const String &fallback) const {
+  auto it = values.find(key);
+  return it != values.end() ? it->second : fallback;
+}
+
+size_t ConfigStore::encode(uint8_t *buffer, const char *key, uint8_t keyLength,
+                           const char *value, uint16_t valueLength) {
+  RecordHeader header;
+  header.magic = CONFIG_STORE_MAGIC;
+  header.keyLength = keyLength;
+  header.valueLength = valueLength;
+
+  uint16_t dataLength = valueLength == VALUE_ERASED ? 0 : valueLength;
+  uint8_t *data = buffer + sizeof(header);
+  memcpy(data, key, keyLength);
+  memcpy(data + keyLength, value, dataLength);
+  header.crc = crc32(crc32(0, &header.keyLength, 3), data, keyLength + dataLength);
+  memcpy(buffer, &header, sizeof(header));
+  return sizeof(header) + keyLength + dataLength;
+}
+
+bool ConfigStore::append(const String &key, const char *value, uint16_t valueLength) {
+  if (!fs) {
+    return false;
+  }
+
+  // Ein Datensatz in einem Schreibaufruf
+  uint8_t buffer[RECORD_MAX];
+  size_t length = encode(buffer, key.c_str(), key.length(), value, valueLength);
+  File file = fs->open(CONFIG_STORE_PATH, "a");
+  if (!file) {
+    LOG_E("Einstellungsjournal nicht beschreibbar");
+    return false;
+  }
+  size_t written = file.write(buffer, length);
+  file.close();
+
+  if (written != length) {
+    // Halber Datensatz am Ende: aus dem RAM-Stand neu schreiben
+    LOG_E("Einstellung %s nicht vollständig geschrieben", key.c_str());
+    compact();
+    return false;
+  }
+  logSize += length;
+  appended += length;
+  return true;
+}
+
+bool ConfigStore::compact() {
+  if (!fs) {
+    return false;
+  }
+  File file = fs->open(CONFIG_STORE_TEMP, "w");
+  if (!file) {
+    LOG_E("Verdichtung: %s nicht beschreibbar", CONFIG_STORE_TEMP);
+    return false;
+  }
+
+  uint8_t buffer[RECORD_MAX];
+  size_t size = 0;
+  bool complete = true;
+  for (const auto &entry : values) {
+    size_t length = encode(buffer, entry.first.c_str(), entry.first.length(),
+                           entry.second.c_str(), entry.second.length());
+    if (file.write(buffer, length) != length) {
+      complete = false;
+      break;
+    }
+    size += length;
+  }
+  file.close();
+
+  if (!complete) {
+    LOG_E("Verdichtung abgebrochen, Journal unverändert");
+    fs->remove(CONFIG_STORE_TEMP);
+    return false;
+  }
+
+  // Ab dem Löschen gilt die neue Datei, auch wenn rename() nicht mehr läuft
+  fs->remove(CONFIG_STORE_PATH);
+  if (!fs->rename(CONFIG_STORE_TEMP, CONFIG_STORE_PATH)) {
+    LOG_E("Verdichtung: Umbenennen fehlgeschlagen");
+    return false;
+  }
+
+  LOG_D("Einstellungsjournal verdichtet: %lu -> %u Bytes", (unsigned long)logSize, (unsigned)size);
+  logSize = size;
+  liveSize = size;
+  compactions++;
+  return true;
+}
+
+uint32_t ConfigStore::crc32(uint32_t crc, const uint8_t *data, size_t length) {
+  // CRC-32 (IEEE), bitweise: die Datensätze sind kurz
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+// Ganze Zeichenkette als Zahl lesbar
+static bool isNumber(const char *text, bool integer) {
+  char *end = nullptr;
+  if (integer) {
+    strtol(text, &end, 10);
+  } else {
+    strtod(text, &end);
+  }
+  return end != text && *end == '\0';
+}
+
+// "a.b.c": fehlende Objekte auf dem Weg werden angelegt
+static void setPath(JsonObject node, const String &path, const String &value) {
+  int dot = path.indexOf('.');
+  if (dot > 0) {
+    String part = path.substring(0, dot);
+    JsonObject child = node[part].is<JsonObject>() ? node[part].as<JsonObject>() : node[part].to<JsonObject>();
+    setPath(child, path.substring(dot + 1), value);
+    return;
+  }
+
+  const char *text = value.c_str();
+  if (value == "true" || value == "false") {
+    node[path] = value == "true";
+  } else if (text[0] == '[' || text[0] == '{') {
+    JsonDocument parsed(&jsonArena);
+    if (deserializeJson(parsed, value)) {
+      node[path] = value;
+    } else {
+      node[path] = parsed;
+    }
+  } else if (isNumber(text, true)) {
+    node[path] = value.toInt();
+  } else if (isNumber(text, false)) {
+    node[path] = value.toFloat();
+  } else {
+    node[path] = value;
+  }
+}
+
+void ConfigStore::apply(JsonDocument &doc) const {
+  if (values.empty()) {
+    return;
+  }
+  JsonObject root = doc.is<JsonObject>() ? doc.as<JsonObject>() : doc.to<JsonObject>();
+  for (const auto &entry : values) {
+    setPath(root, entry.first, entry.second);
+  }
+}
+
+void ConfigStore::printValues(Print &out) const {
+  for (const auto &entry : values) {
+    out.print(entry.first);
+    out.print(" = ");
+    out.println(entry.second);
+  }
+}
+
+void ConfigStore::printStatus(Print &out) const {
+  out.print("Einstellungen: ");
+  out.print((unsigned)values.size());
+  out.print(", Journal: ");
+  out.print(logSize);
+  out.print(" Bytes (aktuell ");
+  out.print(liveSize);
+  out.println(" Bytes)");
+  out.print("Geschrieben seit Start: ");
+  out.print(appended);
+  out.print(" Bytes, Verdichtungen: ");
+  out.print(compactions);
+  out.print(", verworfene Reste: ");
+  out.println(torn);
+}
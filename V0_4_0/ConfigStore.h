@@ -0,0 +1,78 @@
+/**
+ * ConfigStore.h - Einzelne Einstellungen als Journal im SPIFFS
+ *
+ * Geänderte Einstellungen (z.B. "display.brightness" = "80") werden als
+ * kurzer Datensatz mit CRC an CONFIG_STORE_PATH angehängt, statt eine ganze
+ * JSON-Datei neu zu schreiben. Beim Start wird das Journal einmal gelesen;
+ * der letzte Datensatz je Schlüssel gilt.
+ *   - Ein beim Stromausfall abgerissener Datensatz fällt über Länge oder CRC
+ *     auf; alle Datensätze davor bleiben gültig
+ *   - Überschreitet das Journal CONFIG_STORE_COMPACT_SIZE und besteht zum
+ *     größten Teil aus überholten Werten, wird es verdichtet: die aktuellen
+ *     Werte kommen in CONFIG_STORE_TEMP, das danach die alte Datei ersetzt
+ *   - apply() legt die Werte über config.json bzw. die Standardwerte
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <ArduinoJson.h>
+#include <map>
+#include "config.h"
+
+class ConfigStore {
+private:
+  struct RecordHeader {
+    uint8_t magic;             // CONFIG_STORE_MAGIC
+    uint8_t keyLength;
+    uint16_t valueLength;      // VALUE_ERASED: Schlüssel gelöscht
+    uint32_t crc;              // CRC-32 über Längen, Schlüssel und Wert
+  };
+  static const uint16_t VALUE_ERASED = 0xFFFF;
+  static const size_t RECORD_MAX = sizeof(RecordHeader) + CONFIG_STORE_MAX_KEY + CONFIG_STORE_MAX_VALUE;
+
+  fs::FS *fs = nullptr;
+  std::map<String, String> values;
+  uint32_t logSize = 0;        // Bytes im Journal
+  uint32_t liveSize = 0;       // Bytes nach einer Verdichtung
+  uint32_t appended = 0;       // Seit dem Start geschriebene Bytes
+  uint32_t torn = 0;           // Beim Lesen verworfene Reste
+  uint32_t compactions = 0;
+
+  bool replay();
+  bool append(const String &key, const char *value, uint16_t valueLength);
+  static size_t encode(uint8_t *buffer, const char *key, uint8_t keyLength,
+                       const char *value, uint16_t valueLength);
+  static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t length);
+  static size_t recordSize(const String &key, const String &value) {
+    return sizeof(RecordHeader) + key.length() + value.length();
+  }
+
+public:
+  // Journal lesen; eine unterbrochene Verdichtung wird abgeschlossen
+  bool begin(fs::FS &fs);
+
+  // Wert setzen bzw. löschen; unveränderte Werte schreiben nichts
+  bool set(const String &key, const String &value);
+  bool remove(const String &key);
+
+  bool has(const String &key) const { return values.count(key) > 0; }
+  String get(const String &key, const String &fallback = "") const;
+  size_t count() const { return values.size(); }
+
+  // Nur die aktuellen Werte neu schreiben
+  bool compact();
+
+  // Werte in ein JSON-Dokument übernehmen, "a.b" wird zu doc["a"]["b"];
+  // Zahlen, true/false und [..]/{..} werden als JSON übernommen
+  void apply(JsonDocument &doc) const;
+
+  void printValues(Print &out) const;
+  void printStatus(Print &out) const;
+};
+
+extern ConfigStore configStore;
+
+#endif // CONFIG_STORE_H
@@ -2,8 +2,11 @@
  * DataManager.cpp - Implementierung der Datenmanagement-Funktionen
  */
 
+#define LOG_MODULE LOG_MOD_DATA
+
 #include "DataManager.h"
 #include "MqttManager.h"
+#include "LatencyTracer.h"
 
 // Globale Instanz
 DataManager dataManager;
@@ -13,127 +16,263 @@ DataManager::DataManager() {
 }
 
 void DataManager::updateFromMqtt(MqttManager& mqttManager) {
-  // Daten aus MQTT Topics extrahieren
-  // Zunächst als String holen und dann parsen
+  // Alle gebundenen Topics übernehmen (z.B. nach dem Laden der Konfiguration)
+  for (const auto& topic : mqttManager.getTopics()) {
+    applyTopic(topic);
+  }
+}
+
+bool DataManager::applyTopic(const MqttTopic& topic) {
+  if (topic.metric == METRIC_NONE || topic.value == "N/A") {
+    return true;  // Nichts zu übernehmen
+  }
+  
+  // Nicht numerische Payloads verwerfen statt als 0 zu übernehmen
+  char* end;
+  float value = strtof(topic.value.c_str(), &end);
+  if (end == topic.value.c_str()) {
+    return false;
+  }
+  latencyTracer.markCurrent(TRACE_FIELD_UPDATE);
   
-  String batterySOCStr = mqttManager.getValue("battery_soc");
-  if (batterySOCStr != "N/A") {
-    data.batterySOC = batterySOCStr.toFloat();
+  setMetric((SolarMetric)topic.metric, topic.unitIndex, value);
+  return true;
+}
+
+SolarMetric DataManager::metricFromName(const String &name) {
+  if (name == "pv_power") return METRIC_PV_POWER;
+  if (name == "grid_power") return METRIC_GRID_POWER;
+  if (name == "load_power") return METRIC_LOAD_POWER;
+  if (name == "daily_yield") return METRIC_DAILY_YIELD;
+  if (name == "battery_soc") return METRIC_BATTERY_SOC;
+  if (name == "battery_power") return METRIC_BATTERY_POWER;
+  if (name == "battery_voltage") return METRIC_BATTERY_VOLTAGE;
+  return METRIC_NONE;
+}
+
+uint8_t DataManager::unitFromName(const String &name, uint8_t fallback) {
+  int end = name.lastIndexOf('/');
+  for (int i = end - 1; i >= 0; i--) {
+    if (!isDigit(name[i])) {
+      continue;
+    }
+    int start = i;
+    while (start > 0 && isDigit(name[start - 1])) {
+      start--;
+    }
+    int number = atoi(name.c_str() + start);
+    return number > 0 ? number - 1 : fallback;
+  }
+  return fallback;
+}
+
+// Summe nachführen: bei nur einer Einheit direkt übernehmen, sonst Differenz addieren
+static inline void applyDelta(float &total, float &slot, float value, uint8_t count) {
+  total = (count == 1) ? value : total + (value - slot);
+  slot = value;
+}
+
+void DataManager::setMetric(SolarMetric metric, uint8_t unit, float value) {
+  if (metric <= METRIC_NONE || metric >= METRIC_COUNT) {
+    return;
   }
   
-  String pvPowerStr = mqttManager.getValue("pv_power");
-  if (pvPowerStr != "N/A") {
-    data.pvPower = pvPowerStr.toFloat();
+  bool battery = isBatteryMetric(metric);
+  if (unit >= (battery ? MAX_BATTERIES : MAX_INVERTERS)) {
+    return;
   }
+  ensureUnitCount(battery, unit);
   
-  String gridPowerStr = mqttManager.getValue("grid_power");
-  if (gridPowerStr != "N/A") {
-    data.gridPower = gridPowerStr.toFloat();
+  switch (metric) {
+    case METRIC_PV_POWER:
+      applyDelta(data.pvPower, inverters.pvPower[unit], value, inverters.count);
+      break;
+    case METRIC_GRID_POWER:
+      applyDelta(data.gridPower, inverters.gridPower[unit], value, inverters.count);
+      break;
+    case METRIC_LOAD_POWER:
+      applyDelta(data.loadPower, inverters.loadPower[unit], value, inverters.count);
+      break;
+    case METRIC_DAILY_YIELD:
+      applyDelta(data.dailyYield, inverters.dailyYield[unit], value, inverters.count);
+      break;
+    case METRIC_BATTERY_POWER:
+      applyDelta(data.batteryPower, batteries.power[unit], value, batteries.count);
+      break;
+    case METRIC_BATTERY_SOC:
+      // Nach Kapazität gewichteter Gesamt-SOC
+      socCapacitySum += (value - batteries.soc[unit]) * batteries.capacityAh[unit];
+      batteries.soc[unit] = value;
+      data.batterySOC = (batteries.count == 1) ? value : socCapacitySum / capacitySum;
+      break;
+    case METRIC_BATTERY_VOLTAGE:
+      // Mittelwert der Bankspannungen
+      voltageSum += value - batteries.voltage[unit];
+      batteries.voltage[unit] = value;
+      data.batteryVoltage = (batteries.count == 1) ? value : voltageSum / batteries.count;
+      break;
+    default:
+      break;
   }
   
-  String loadPowerStr = mqttManager.getValue("load_power");
-  if (loadPowerStr != "N/A") {
-    data.loadPower = loadPowerStr.toFloat();
+  staleMask &= ~(1 << metric);
+  dirty = true;
+  latencyTracer.markCurrent(TRACE_DIRTY);
+  
+  // Jede Differenz rundet; ohne Neuberechnung wüchse der Fehler mit der Laufzeit
+  if (++deltaUpdates >= TOTALS_RESYNC_UPDATES) {
+    recomputeTotals();
+  } else {
+    updateAutarky();
+  }
+  lastUpdate = millis();
+}
+
+void DataManager::ensureUnitCount(bool battery, uint8_t unit) {
+  if (!battery) {
+    if (unit >= inverters.count) {
+      inverters.count = unit + 1;
+    }
+    return;
   }
   
-  String batteryPowerStr = mqttManager.getValue("battery_power");
-  if (batteryPowerStr != "N/A") {
-    data.batteryPower = batteryPowerStr.toFloat();
+  if (unit < batteries.count) {
+    return;
   }
   
-  String batteryVoltageStr = mqttManager.getValue("battery_voltage");
-  if (batteryVoltageStr != "N/A") {
-    data.batteryVoltage = batteryVoltageStr.toFloat();
+  // Neu hinzugekommene Batteriebänke in die Gewichtung aufnehmen
+  for (uint8_t i = batteries.count; i <= unit; i++) {
+    capacitySum += batteries.capacityAh[i];
   }
+  batteries.count = unit + 1;
+  data.batterySOC = socCapacitySum / capacitySum;
+  data.batteryVoltage = voltageSum / batteries.count;
+}
+
+void DataManager::configureUnits(uint8_t inverterCount, uint8_t batteryCount, const float* capacitiesAh) {
+  inverters.count = constrain(inverterCount, (uint8_t)1, (uint8_t)MAX_INVERTERS);
+  batteries.count = constrain(batteryCount, (uint8_t)1, (uint8_t)MAX_BATTERIES);
   
-  String dailyYieldStr = mqttManager.getValue("daily_yield");
-  if (dailyYieldStr != "N/A") {
-    data.dailyYield = dailyYieldStr.toFloat();
+  if (capacitiesAh) {
+    for (uint8_t i = 0; i < batteries.count; i++) {
+      batteries.capacityAh[i] = capacitiesAh[i] > 0 ? capacitiesAh[i] : 1.0f;
+    }
   }
   
-  // Autarkie berechnen
+  recomputeTotals();
+  
+  DEBUG_PRINT("Anlage: ");
+  DEBUG_PRINT(inverters.count);
+  DEBUG_PRINT(" Wechselrichter, ");
+  DEBUG_PRINT(batteries.count);
+  DEBUG_PRINTLN(" Batteriebänke");
+}
+
+void DataManager::recomputeTotals() {
+  // Summen einmalig vollständig neu berechnen
+  deltaUpdates = 0;
+  data.pvPower = data.gridPower = data.loadPower = data.dailyYield = 0;
+  for (uint8_t i = 0; i < inverters.count; i++) {
+    data.pvPower += inverters.pvPower[i];
+    data.gridPower += inverters.gridPower[i];
+    data.loadPower += inverters.loadPower[i];
+    data.dailyYield += inverters.dailyYield[i];
+  }
+  
+  socCapacitySum = capacitySum = voltageSum = data.batteryPower = 0;
+  for (uint8_t i = 0; i < batteries.count; i++) {
+    socCapacitySum += batteries.soc[i] * batteries.capacityAh[i];
+    capacitySum += batteries.capacityAh[i];
+    voltageSum += batteries.voltage[i];
+    data.batteryPower += batteries.power[i];
+  }
+  data.batterySOC = socCapacitySum / capacitySum;
+  data.batteryVoltage = voltageSum / batteries.count;
+  
+  updateAutarky();
+}
+
+void DataManager::restoreUnits(const InverterArray& savedInverters, const BatteryArray& savedBatteries) {
+  // Kapazitäten stammen aus der aktuellen Konfiguration, nicht aus dem Snapshot
+  float capacities[MAX_BATTERIES];
+  memcpy(capacities, batteries.capacityAh, sizeof(capacities));
+  
+  inverters = savedInverters;
+  batteries = savedBatteries;
+  memcpy(batteries.capacityAh, capacities, sizeof(capacities));
+  inverters.count = constrain(inverters.count, (uint8_t)1, (uint8_t)MAX_INVERTERS);
+  batteries.count = constrain(batteries.count, (uint8_t)1, (uint8_t)MAX_BATTERIES);
+  
+  recomputeTotals();
+  
+  // Bis zur ersten Live-Nachricht gelten alle Werte als veraltet
+  staleMask = (1 << METRIC_COUNT) - 1;
+  dirty = false;
+}
+
+void DataManager::updateAutarky() {
   if (data.loadPower > 0) {
     float selfSupply = data.pvPower + abs(min(0.0f, data.batteryPower));
     data.autarky = min(selfSupply / data.loadPower * 100, 100.0f);
   } else {
     data.autarky = 100.0f;
   }
-  
-  lastUpdate = millis();
 }
 
 void DataManager::simulateData() {
-  // Diese Funktion ist eine Übernahme der alten Simulationsfunktion
-  // Leichte Veränderungen der Werte um Dynamik zu simulieren
-  data.pvPower += random(-100, 100);
-  if (data.pvPower < 0) data.pvPower = 0;
-  if (data.pvPower > 4000) data.pvPower = 4000;
-  
-  data.loadPower += random(-50, 50);
-  if (data.loadPower < 200) data.loadPower = 200;
-  if (data.loadPower > 3000) data.loadPower = 3000;
-  
-  // Netzwert berechnen (Überschuss geht ins Netz, negative Werte)
-  float surplus = data.pvPower - data.loadPower;
-  
-  // Batteriesimulation
-  if (surplus > 0) {
-    // Überschuss: lade Batterie oder speise ins Netz ein
-    if (data.batterySOC < 99) {
-      // Noch Platz in der Batterie
-      data.batteryPower = min(surplus, 2000.0f); // Max. 2kW Ladeleistung
-      surplus -= data.batteryPower;
-      
-      // SOC erhöhen
-      data.batterySOC += data.batteryPower / 5000.0; // Simulierte Ladegeschwindigkeit
-      if (data.batterySOC > 100) data.batterySOC = 100;
-    } else {
-      // Batterie voll
-      data.batteryPower = 0;
+  // Diese Funktion ist eine Übernahme der alten Simulationsfunktion, jetzt je
+  // Einheit: Wechselrichter und Batteriebänke werden einzeln simuliert, die
+  // Summen wie bei MQTT-Werten daraus berechnet
+  float surplus = 0;
+  for (uint8_t i = 0; i < inverters.count; i++) {
+    // Leichte Veränderungen der Werte um Dynamik zu simulieren
+    inverters.pvPower[i] = constrain(inverters.pvPower[i] + random(-100, 100), 0.0f, 4000.0f);
+    inverters.loadPower[i] = constrain(inverters.loadPower[i] + random(-50, 50), 200.0f, 3000.0f);
+    surplus += inverters.pvPower[i] - inverters.loadPower[i];
+    
+    // Leichte Anpassung des Tagesertrags
+    if (random(10) > 7) { // Nur manchmal erhöhen
+      inverters.dailyYield[i] += random(10) / 100.0;
     }
+  }
+  
+  // Batteriesimulation: Überschuss bzw. Defizit nach Kapazität auf die Bänke verteilen
+  float remaining = surplus;
+  for (uint8_t i = 0; i < batteries.count; i++) {
+    float share = surplus * batteries.capacityAh[i] / capacitySum;
+    float power = 0;
+    if (share > 0 && batteries.soc[i] < 99) {
+      power = min(share, 2000.0f);   // Max. 2kW Ladeleistung
+    } else if (share < 0 && batteries.soc[i] > 10) {
+      power = max(share, -2000.0f);  // Max. 2kW Entladeleistung, negativ
+    }
+    batteries.power[i] = power;
+    remaining -= power;
     
-    // Restlicher Überschuss ins Netz
-    data.gridPower = -surplus;
-  } else {
-    // Defizit: entlade Batterie oder beziehe vom Netz
-    if (data.batterySOC > 10) {
-      // Batterie hat noch genug Energie
-      data.batteryPower = max(-min(abs(surplus), 2000.0f), -2000.0f); // Max. 2kW Entladeleistung, negativ
-      surplus += abs(data.batteryPower);
-      
-      // SOC verringern
-      data.batterySOC += data.batteryPower / 5000.0; // Simulierte Entladegeschwindigkeit
-      if (data.batterySOC < 0) data.batterySOC = 0;
+    // SOC mit simulierter Lade- bzw. Entladegeschwindigkeit
+    float soc = constrain(batteries.soc[i] + power / 5000.0f, 0.0f, 100.0f);
+    batteries.soc[i] = soc;
+    
+    // Batteriespannung simulieren (48V System)
+    if (soc < 20) {
+      batteries.voltage[i] = 47.0 + (soc / 20.0);
+    } else if (soc > 80) {
+      batteries.voltage[i] = 48.0 + ((soc - 80) / 20.0) * 1.5;
     } else {
-      // Batterie fast leer
-      data.batteryPower = 0;
+      batteries.voltage[i] = 48.0 + ((soc - 50) / 30.0) * 0.5;
     }
-    
-    // Restliches Defizit vom Netz
-    data.gridPower = abs(surplus);
   }
   
-  // Autarkie berechnen
-  if (data.loadPower > 0) {
-    float selfSupply = data.pvPower + abs(min(0.0f, data.batteryPower));
-    data.autarky = min(selfSupply / data.loadPower * 100, 100.0f);
-  } else {
-    data.autarky = 100;
+  // Restlicher Überschuss ins Netz (negativ), Defizit vom Netz; gleichmäßig je Wechselrichter
+  for (uint8_t i = 0; i < inverters.count; i++) {
+    inverters.gridPower[i] = -remaining / inverters.count;
   }
   
-  // Batteriespannung simulieren (48V System)
-  if (data.batterySOC < 20) {
-    data.batteryVoltage = 47.0 + (data.batterySOC / 20.0);
-  } else if (data.batterySOC > 80) {
-    data.batteryVoltage = 48.0 + ((data.batterySOC - 80) / 20.0) * 1.5;
-  } else {
-    data.batteryVoltage = 48.0 + ((data.batterySOC - 50) / 30.0) * 0.5;
-  }
+  // Summen und Autarkie aus den Einheiten
+  recomputeTotals();
   
-  // Leichte Anpassung des Tagesertrags
-  if (random(10) > 7) { // Nur manchmal erhöhen
-    data.dailyYield += random(10) / 100.0;
-  }
+  // Simulierte Werte ersetzen einen wiederhergestellten Snapshot
+  staleMask = 0;
   
   // Debug-Ausgabe
   DEBUG_PRINTLN("Simulierte Daten aktualisiert:");
@@ -147,6 +286,16 @@ void DataManager::simulateData() {
   lastUpdate = millis();
 }
 
+void DataManager::setSimulationMode(bool mode) {
+  if (mode == simulationMode) {
+    return;
+  }
+  simulationMode = mode;
+  
+  // Simulierte Summen nicht in den echten Betrieb übernehmen
+  recomputeTotals();
+}
+
 void DataManager::update() {
   // Periodische Aktualisierung abhängig vom Modus
   unsigned long currentMillis = millis();
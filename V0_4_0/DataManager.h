@@ -10,6 +10,7 @@
 
 // Vorwärtsdeklaration der MQTT-Manager-Klasse
 class MqttManager;
+struct MqttTopic;
 
 // Struktur für Solardaten
 struct SolarData {
@@ -34,24 +35,113 @@ struct SolarData {
     autarky(0) {}
 };
 
+// Messgrößen, an die MQTT-Topics gebunden werden können
+enum SolarMetric : int8_t {
+  METRIC_NONE = -1,
+  // Wechselrichter
+  METRIC_PV_POWER = 0,
+  METRIC_GRID_POWER,
+  METRIC_LOAD_POWER,
+  METRIC_DAILY_YIELD,
+  // Batterien
+  METRIC_BATTERY_SOC,
+  METRIC_BATTERY_POWER,
+  METRIC_BATTERY_VOLTAGE,
+  METRIC_COUNT
+};
+
+// Werte aller Wechselrichter als Struct-of-Arrays
+struct InverterArray {
+  uint8_t count;
+  float pvPower[MAX_INVERTERS];
+  float gridPower[MAX_INVERTERS];
+  float loadPower[MAX_INVERTERS];
+  float dailyYield[MAX_INVERTERS];
+  
+  InverterArray() : count(1) {
+    memset(pvPower, 0, sizeof(pvPower));
+    memset(gridPower, 0, sizeof(gridPower));
+    memset(loadPower, 0, sizeof(loadPower));
+    memset(dailyYield, 0, sizeof(dailyYield));
+  }
+};
+
+// Werte aller Batteriebänke als Struct-of-Arrays
+struct BatteryArray {
+  uint8_t count;
+  float soc[MAX_BATTERIES];
+  float power[MAX_BATTERIES];
+  float voltage[MAX_BATTERIES];
+  float capacityAh[MAX_BATTERIES];  // Gewichtung für den Gesamt-SOC
+  
+  BatteryArray() : count(1) {
+    memset(soc, 0, sizeof(soc));
+    memset(power, 0, sizeof(power));
+    memset(voltage, 0, sizeof(voltage));
+    for (int i = 0; i < MAX_BATTERIES; i++) {
+      capacityAh[i] = 1.0f;
+    }
+  }
+};
+
 class DataManager {
 private:
-  SolarData data;
+  SolarData data;           // Summen über alle Einheiten
+  InverterArray inverters;
+  BatteryArray batteries;
   bool simulationMode = true;
   unsigned long lastUpdate = 0;
   
+  // Laufende Summen für die inkrementelle Berechnung der Gesamtwerte
+  float socCapacitySum = 0;  // Summe SOC * Kapazität
+  float capacitySum = 1.0f;  // Summe der Kapazitäten aktiver Batterien
+  float voltageSum = 0;
+  uint16_t deltaUpdates = 0; // Einzelwerte seit der letzten vollständigen Berechnung
+  
+  // Warmstart: Bit je Messgröße, deren Wert noch aus dem Snapshot stammt
+  uint8_t staleMask = 0;
+  bool dirty = false;       // Seit dem letzten Snapshot geändert
+  
+  void ensureUnitCount(bool battery, uint8_t unit);
+  void updateAutarky();
+  void recomputeTotals();
+  
 public:
   DataManager();
   
   // Daten aktualisieren
-  void updateFromMqtt(MqttManager& mqttManager);
+  void updateFromMqtt(MqttManager& mqttManager);  // Vollständiger Abgleich aller Topics
+  bool applyTopic(const MqttTopic& topic);         // Nur das geänderte Topic übernehmen, false bei ungültiger Payload
   void simulateData();  // Für Testzwecke
   
+  // Einzelnen Messwert einer Einheit setzen; Summen werden in O(1) nachgeführt
+  void setMetric(SolarMetric metric, uint8_t unit, float value);
+  
+  // Anlagenkonfiguration (Anzahl Einheiten, Batteriekapazitäten)
+  void configureUnits(uint8_t inverterCount, uint8_t batteryCount, const float* capacitiesAh);
+  
+  // Snapshot-Werte übernehmen und als veraltet markieren
+  void restoreUnits(const InverterArray& savedInverters, const BatteryArray& savedBatteries);
+  bool isStale(SolarMetric metric) const { return (staleMask >> metric) & 1; }
+  uint8_t getStaleMask() const { return staleMask; }
+  bool isDirty() const { return dirty; }
+  void clearDirty() { dirty = false; }
+  
+  // Zuordnung Topic-Name -> Messgröße (z.B. "pv_power" -> METRIC_PV_POWER)
+  static SolarMetric metricFromName(const String &name);
+  
+  // Einheit aus der letzten Zahl vor der letzten Ebene eines Namens, z.B.
+  // "inverter_2/pv_power" -> 1 (0-basiert); ohne Zahl gilt fallback
+  static uint8_t unitFromName(const String &name, uint8_t fallback);
+  static bool isBatteryMetric(SolarMetric metric) { return metric >= METRIC_BATTERY_SOC; }
+  
   // Getter
   SolarData& getData() { return data; }
+  const InverterArray& getInverters() const { return inverters; }
+  const BatteryArray& getBatteries() const { return batteries; }
   
-  // Simulationsmodus ein/ausschalten
-  void setSimulationMode(bool mode) { simulationMode = mode; }
+  // Simulationsmodus ein/ausschalten; Summen danach aus den Einheiten neu berechnen
+  void setSimulationMode(bool mode);
   bool isSimulationMode() { return simulationMode; }
   
   // Periodische Aktualisierung
@@ -0,0 +1,84 @@
+/**
+ * FixedString.h - Zeichenkette mit fester Kapazität ohne Heap
+ *
+ * Ersetzt String dort, wo Texte in langlebigen Strukturen liegen und im
+ * Betrieb ständig neu gesetzt oder gelesen werden (Topic-Werte, Menü- und
+ * Ansichtsnamen). Der Text liegt im Objekt selbst; Zuweisen kopiert in den
+ * vorhandenen Puffer, längere Texte werden gekürzt. Lesen geht über c_str()
+ * bzw. die Umwandlung in const char*, ohne Kopie.
+ *
+ * Vergleiche mit const char*, String und anderen FixedStrings vergleichen
+ * den Inhalt, nicht die Zeiger.
+ */
+
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+
+template <size_t N>
+class FixedString {
+  static_assert(N > 1 && N <= 256, "FixedString: Kapazität 1..255 Zeichen");
+
+private:
+  char text[N];
+  uint8_t size = 0;
+
+public:
+  FixedString() { text[0] = '\0'; }
+  FixedString(const char *value) { assign(value); }
+  FixedString(const String &value) { assign(value.c_str(), value.length()); }
+
+  // false, wenn der Text gekürzt werden musste
+  bool assign(const char *value, size_t length) {
+    bool complete = length < N;
+    size = complete ? length : N - 1;
+    if (value) {
+      memmove(text, value, size);   // Zuweisung aus dem eigenen Puffer erlaubt
+    } else {
+      size = 0;
+    }
+    text[size] = '\0';
+    return complete;
+  }
+  bool assign(const char *value) { return assign(value, value ? strlen(value) : 0); }
+
+  FixedString &operator=(const char *value) { assign(value); return *this; }
+  FixedString &operator=(const String &value) { assign(value.c_str(), value.length()); return *this; }
+
+  const char *c_str() const { return text; }
+  operator const char *() const { return text; }
+  size_t length() const { return size; }
+  static constexpr size_t capacity() { return N - 1; }
+
+  bool operator==(const char *other) const { return strcmp(text, other ? other : "") == 0; }
+  bool operator==(const String &other) const {
+    return size == other.length() && memcmp(text, other.c_str(), size) == 0;
+  }
+  template <size_t M>
+  bool operator==(const FixedString<M> &other) const {
+    return size == other.length() && memcmp(text, other.c_str(), size) == 0;
+  }
+  template <typename T>
+  bool operator!=(const T &other) const { return !(*this == other); }
+
+  bool equalsIgnoreCase(const char *other) const { return strcasecmp(text, other ? other : "") == 0; }
+  bool equalsIgnoreCase(const String &other) const { return equalsIgnoreCase(other.c_str()); }
+};
+
+template <size_t N>
+bool operator==(const char *a, const FixedString<N> &b) { return b == a; }
+template <size_t N>
+bool operator!=(const char *a, const FixedString<N> &b) { return !(b == a); }
+template <size_t N>
+bool operator==(const String &a, const FixedString<N> &b) { return b == a; }
+template <size_t N>
+bool operator!=(const String &a, const FixedString<N> &b) { return !(b == a); }
+
+// Ordnung für std::map mit Zeichenketten-Schlüsseln, die nicht kopiert
+// werden müssen (Literale oder Tabellen im Flash)
+struct CStringLess {
+  bool operator()(const char *a, const char *b) const { return strcmp(a, b) < 0; }
+};
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,90 @@
+/**
+ * HotReload.cpp - Implementierung des Neuladens ohne Neustart
+ */
+
+#define LOG_MODULE LOG_MOD_CONFIG
+
+#include "HotReload.h"
+#include "ConfigManager.h"
+#include "MemoryMonitor.h"
+
+// Globale Instanz
+HotReload hotReload;
+
+void HotReload::setHandler(ReloadTarget target, const char* path, Handler handler) {
+  targets[target].path = path;
+  targets[target].handler = handler;
+}
+
+bool HotReload::request(const char* name) {
+  String target = name;
+  target.trim();
+  if (target == "all") {
+    pending = (1 << RELOAD_TARGETS) - 1;
+    return true;
+  }
+  for (uint8_t i = 0; i < RELOAD_TARGETS; i++) {
+    if (target == targetName((ReloadTarget)i)) {
+      request((ReloadTarget)i);
+      return true;
+    }
+  }
+  LOG_W("Unbekanntes Ziel zum Neuladen: %s", target.c_str());
+  return false;
+}
+
+void HotReload::update() {
+  if (!active) {
+    return;
+  }
+
+  // Je Prüfung nur eine Datei hashen, damit loop() kurz bleibt
+  unsigned long now = millis();
+  if (now - lastCheck >= CONFIG_RELOAD_CHECK_INTERVAL) {
+    lastCheck = now;
+    Target &target = targets[nextCheck];
+    if (target.path && configManager.hasChanged(target.path)) {
+      LOG_I("%s geändert", target.path);
+      request((ReloadTarget)nextCheck);
+    }
+    nextCheck = (nextCheck + 1) % RELOAD_TARGETS;
+  }
+
+  for (uint8_t i = 0; i < RELOAD_TARGETS && pending; i++) {
+    Target &target = targets[i];
+    if (!(pending & (1 << i))) {
+      continue;
+    }
+    if (!target.handler) {
+      pending &= ~(1 << i);
+      continue;
+    }
+
+    unsigned long start = micros();
+    MemoryScope memoryScope(LOG_MODULE);
+    if (!target.handler()) {
+      continue;
+    }
+    target.duration = micros() - start;
+    target.reloads++;
+    pending &= ~(1 << i);
+    LOG_I("%s neu geladen in %lu us", targetName((ReloadTarget)i), (unsigned long)target.duration);
+  }
+}
+
+void HotReload::printStatus(Print &out) const {
+  out.println("Ziel      Datei               Neu geladen  Dauer (us)  Wartet");
+  for (uint8_t i = 0; i < RELOAD_TARGETS; i++) {
+    const Target &target = targets[i];
+    char line[80];
+    snprintf(line, sizeof(line), "%-9s %-19s %11lu %11lu  %s", targetName((ReloadTarget)i),
+             target.path ? target.path : "-", (unsigned long)target.reloads,
+             (unsigned long)target.duration, pending & (1 << i) ? "ja" : "nein");
+    out.println(line);
+  }
+}
+
+const char* HotReload::targetName(ReloadTarget target) {
+  static const char* names[RELOAD_TARGETS] = { "menu", "topics", "settings" };
+  return target < RELOAD_TARGETS ? names[target] : "?";
+}
@@ -0,0 +1,65 @@
+/**
+ * HotReload.h - Menü, Topics und Einstellungen ohne Neustart neu laden
+ *
+ * Auslöser sind der Konsolenbefehl "reload", eine Nachricht an
+ * CONFIG_RELOAD_TOPIC und die Dateiprüfung: alle CONFIG_RELOAD_CHECK_INTERVAL
+ * ms wird eine der Dateien über Hash und Größe mit dem zuletzt geladenen
+ * Stand verglichen. Angeforderte Ziele werden in update() aus loop()
+ * ausgeführt, nie aus dem MQTT-Empfang heraus. Die Handler vergleichen alten
+ * und neuen Stand und übernehmen nur die Unterschiede; Anzeige und
+ * MQTT-Verbindung bleiben bestehen.
+ */
+
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+#include <Arduino.h>
+#include <functional>
+#include "config.h"
+
+enum ReloadTarget : uint8_t {
+  RELOAD_MENU,
+  RELOAD_TOPICS,
+  RELOAD_SETTINGS,
+  RELOAD_TARGETS
+};
+
+class HotReload {
+public:
+  // false: jetzt nicht möglich, beim nächsten update() erneut versuchen
+  typedef std::function<bool()> Handler;
+
+private:
+  struct Target {
+    const char* path = nullptr;   // Überwachte Datei
+    Handler handler;
+    uint32_t reloads = 0;
+    uint32_t duration = 0;        // µs, letzter Durchlauf
+  };
+  Target targets[RELOAD_TARGETS];
+  uint8_t pending = 0;            // Bit je Ziel
+  bool active = false;
+  unsigned long lastCheck = 0;
+  uint8_t nextCheck = 0;
+
+public:
+  void setHandler(ReloadTarget target, const char* path, Handler handler);
+
+  // Nach dem Start aufrufen, vorher werden Anforderungen nur gesammelt
+  void begin() { active = true; }
+
+  void request(ReloadTarget target) { pending |= 1 << target; }
+
+  // "menu", "topics", "settings" oder "all"; false bei unbekanntem Namen
+  bool request(const char* name);
+
+  void update();
+
+  void printStatus(Print &out) const;
+
+  static const char* targetName(ReloadTarget target);
+};
+
+extern HotReload hotReload;
+
+#endif // HOT_RELOAD_H
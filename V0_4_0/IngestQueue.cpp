@@ -0,0 +1,240 @@
+/**
+ * IngestQueue.cpp - Implementierung der Eingangswarteschlange
+ */
+
+#include "IngestQueue.h"
+
+IngestQueue::IngestQueue() {
+  clear();
+}
+
+void IngestQueue::clear() {
+  for (auto& slot : slots) {
+    slot.topic = -1;
+    slot.large = -1;
+  }
+  memset(largeUsed, 0, sizeof(largeUsed));
+  memset(head, 0, sizeof(head));
+  memset(count, 0, sizeof(count));
+}
+
+size_t IngestQueue::size() const {
+  size_t total = 0;
+  for (uint8_t lane = 0; lane < INGEST_LANES; lane++) {
+    total += count[lane];
+  }
+  return total;
+}
+
+void IngestQueue::append(uint8_t lane, int slot) {
+  order[lane][(head[lane] + count[lane]) % INGEST_QUEUE_DEPTH] = slot;
+  count[lane]++;
+  stats[lane].peakDepth = max(stats[lane].peakDepth, count[lane]);
+}
+
+bool IngestQueue::canStore(size_t length) {
+  if (length > MQTT_PACKET_SIZE) {
+    return false;
+  }
+  if (length <= INGEST_INLINE_SIZE) {
+    return true;
+  }
+  for (uint8_t i = 0; i < INGEST_LARGE_BUFFERS; i++) {
+    if (!largeUsed[i]) {
+      return true;
+    }
+  }
+  largeMissing++;
+  return false;
+}
+
+bool IngestQueue::store(Slot &slot, const uint8_t* payload, size_t length) {
+  if (length > MQTT_PACKET_SIZE) {
+    return false;
+  }
+
+  // Kurze Payloads im Platz, längere in einem eigenen Puffer
+  char* target = slot.inlineData;
+  if (length > INGEST_INLINE_SIZE) {
+    if (slot.large < 0) {
+      uint8_t used = 0;
+      for (uint8_t i = 0; i < INGEST_LARGE_BUFFERS; i++) {
+        if (largeUsed[i]) {
+          used++;
+        } else if (slot.large < 0) {
+          slot.large = i;
+        }
+      }
+      if (slot.large < 0) {
+        largeMissing++;
+        return false;
+      }
+      largeUsed[slot.large] = true;
+      largePeak = max(largePeak, (uint8_t)(used + 1));
+    }
+    target = largeBuffers[slot.large];
+  } else {
+    release(slot);
+  }
+
+  memcpy(target, payload, length);
+  target[length] = '\0';
+  slot.length = length;
+  return true;
+}
+
+void IngestQueue::release(Slot &slot) {
+  if (slot.large >= 0) {
+    largeUsed[slot.large] = false;
+    slot.large = -1;
+  }
+}
+
+int IngestQueue::popLane(uint8_t lane) {
+  if (count[lane] == 0) {
+    return -1;
+  }
+  int slot = order[lane][head[lane]];
+  head[lane] = (head[lane] + 1) % INGEST_QUEUE_DEPTH;
+  count[lane]--;
+  return slot;
+}
+
+bool IngestQueue::push(uint16_t topic, IngestPriority priority, bool coalesce,
+                       const uint8_t* payload, size_t length, uint16_t traceId) {
+  uint8_t lane = min((uint8_t)priority, (uint8_t)(INGEST_LANES - 1));
+
+  // Wartender Wert desselben Topics wird ersetzt, die Position bleibt
+  if (coalesce) {
+    for (auto& slot : slots) {
+      if (slot.topic == topic && slot.coalesce) {
+        if (!store(slot, payload, length)) {
+          stats[slot.lane].dropped++;
+          return false;  // Der wartende Wert bleibt
+        }
+        slot.traceId = traceId;
+        stats[slot.lane].coalesced++;
+        return true;
+      }
+    }
+  }
+
+  // Vor dem Verdrängen prüfen, sonst ginge eine wartende Nachricht umsonst verloren
+  if (!canStore(length)) {
+    stats[lane].dropped++;
+    return false;
+  }
+
+  int free = -1;
+  for (int i = 0; i < INGEST_QUEUE_DEPTH; i++) {
+    if (slots[i].topic < 0) {
+      free = i;
+      break;
+    }
+  }
+
+  if (free < 0) {
+    // Voll: älteste Nachricht der niedrigsten Spur unterhalb dieser verdrängen
+    for (uint8_t victim = INGEST_LANES - 1; victim > lane && free < 0; victim--) {
+      free = popLane(victim);
+      if (free >= 0) {
+        release(slots[free]);
+        slots[free].topic = -1;
+        stats[victim].dropped++;
+      }
+    }
+    if (free < 0) {
+      stats[lane].dropped++;
+      return false;
+    }
+  }
+
+  Slot& slot = slots[free];
+  if (!store(slot, payload, length)) {
+    stats[lane].dropped++;
+    return false;
+  }
+  slot.topic = topic;
+  slot.lane = lane;
+  slot.coalesce = coalesce;
+  slot.traceId = traceId;
+  slot.receivedAt = millis();
+  append(lane, free);
+  stats[lane].queued++;
+  return true;
+}
+
+bool IngestQueue::pop(uint16_t &topic, const char* &payload, size_t &length, uint16_t *traceId) {
+  for (uint8_t lane = 0; lane < INGEST_LANES; lane++) {
+    int index = popLane(lane);
+    if (index < 0) {
+      continue;
+    }
+
+    Slot& slot = slots[index];
+    topic = slot.topic;
+    payload = slot.large >= 0 ? largeBuffers[slot.large] : slot.inlineData;
+    length = slot.length;
+    if (traceId) {
+      *traceId = slot.traceId;
+    }
+    // Der große Puffer wird erst beim nächsten push() wieder vergeben
+    slot.topic = -1;
+    release(slot);
+    stats[lane].processed++;
+    stats[lane].maxWait = max(stats[lane].maxWait, millis() - slot.receivedAt);
+    return true;
+  }
+  return false;
+}
+
+IngestPriority IngestQueue::priorityFromName(const char* name, IngestPriority fallback) {
+  if (!name) {
+    return fallback;
+  }
+  if (strcmp(name, "high") == 0) {
+    return INGEST_HIGH;
+  }
+  if (strcmp(name, "normal") == 0) {
+    return INGEST_NORMAL;
+  }
+  if (strcmp(name, "low") == 0) {
+    return INGEST_LOW;
+  }
+  return fallback;
+}
+
+void IngestQueue::printStats(Print &out) const {
+  static const char* laneNames[INGEST_LANES] = { "hoch", "normal", "niedrig" };
+
+  out.println("Spur      Wartend  Eingereiht  Ersetzt  Verworfen  Verarbeitet  Spitze  Max. Wartezeit");
+  for (uint8_t lane = 0; lane < INGEST_LANES; lane++) {
+    char line[100];
+    snprintf(line, sizeof(line), "%-8s %8u %11lu %8lu %10lu %12lu %7u %11lu ms",
+             laneNames[lane], (unsigned)count[lane], (unsigned long)stats[lane].queued,
+             (unsigned long)stats[lane].coalesced, (unsigned long)stats[lane].dropped,
+             (unsigned long)stats[lane].processed, (unsigned)stats[lane].peakDepth,
+             (unsigned long)stats[lane].maxWait);
+    out.println(line);
+  }
+  out.print("Tiefe: ");
+  out.print(INGEST_QUEUE_DEPTH);
+  out.print(", große Puffer: ");
+  out.print(largePeak);
+  out.print(" von ");
+  out.print(INGEST_LARGE_BUFFERS);
+  out.print(" belegt (Spitze), ");
+  out.print(largeMissing);
+  out.print(" mal keiner frei");
+  out.print(", Zeitbudget je Durchlauf: ");
+  out.print(INGEST_BUDGET_US);
+  out.println(" us");
+}
+
+void IngestQueue::resetStats() {
+  for (auto& laneStats : stats) {
+    laneStats = LaneStats();
+  }
+  largePeak = 0;
+  largeMissing = 0;
+}
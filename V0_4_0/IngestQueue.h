@@ -0,0 +1,93 @@
+/**
+ * IngestQueue.h - Eingangswarteschlange für MQTT-Nachrichten
+ *
+ * Der Empfang legt Nachrichten nur ab; verarbeitet werden sie in loop() mit
+ * begrenzter Zeit pro Durchlauf. Bei einer Flut (z.B. Retained-Nachrichten
+ * nach dem Verbindungsaufbau) bleiben so Touch und Anzeige bedienbar.
+ *   - Drei Spuren: hoch (Leistungen), normal, niedrig (Tageswerte)
+ *   - Zusammenfassbare Topics belegen höchstens einen Platz; eine neue
+ *     Nachricht ersetzt den wartenden Wert
+ *   - Feste Tiefe: ist sie erreicht, verdrängt eine Nachricht die älteste
+ *     einer niedrigeren Spur, sonst wird sie verworfen und gezählt
+ *   - Kein Heap: kurze Payloads liegen direkt im Platz, längere (JSON) in
+ *     einem von wenigen festen Puffern mit MQTT_PACKET_SIZE
+ */
+
+#ifndef INGEST_QUEUE_H
+#define INGEST_QUEUE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum IngestPriority : uint8_t {
+  INGEST_HIGH,
+  INGEST_NORMAL,
+  INGEST_LOW,
+  INGEST_LANES
+};
+
+class IngestQueue {
+private:
+  struct Slot {
+    int16_t topic = -1;            // -1 = frei
+    uint8_t lane = INGEST_NORMAL;
+    bool coalesce = true;
+    uint16_t traceId = 0;          // LatencyTracer
+    unsigned long receivedAt = 0;  // Erste wartende Nachricht dieses Platzes
+    int8_t large = -1;             // Index in largeBuffers oder -1 = inline
+    uint16_t length = 0;
+    char inlineData[INGEST_INLINE_SIZE + 1];
+  };
+
+  struct LaneStats {
+    uint32_t queued = 0;
+    uint32_t coalesced = 0;        // Durch einen neueren Wert ersetzt
+    uint32_t dropped = 0;          // Verworfen oder verdrängt
+    uint32_t processed = 0;
+    uint8_t peakDepth = 0;
+    unsigned long maxWait = 0;     // Längste Wartezeit in ms
+  };
+
+  Slot slots[INGEST_QUEUE_DEPTH];
+
+  // Längere Payloads; ein Puffer gehört höchstens einem Platz
+  char largeBuffers[INGEST_LARGE_BUFFERS][MQTT_PACKET_SIZE + 1];
+  bool largeUsed[INGEST_LARGE_BUFFERS];
+  uint8_t largePeak = 0;
+  uint32_t largeMissing = 0;       // Verworfen, weil kein Puffer frei war
+
+  // Je Spur ein Ring aus Platz-Indizes in Ankunftsreihenfolge
+  uint8_t order[INGEST_LANES][INGEST_QUEUE_DEPTH];
+  uint8_t head[INGEST_LANES];
+  uint8_t count[INGEST_LANES];
+
+  LaneStats stats[INGEST_LANES];
+
+  int popLane(uint8_t lane);
+  void append(uint8_t lane, int slot);
+  bool canStore(size_t length);
+  bool store(Slot &slot, const uint8_t* payload, size_t length);
+  void release(Slot &slot);
+
+public:
+  IngestQueue();
+
+  // Nachricht ablegen; false, wenn sie verworfen wurde
+  bool push(uint16_t topic, IngestPriority priority, bool coalesce,
+            const uint8_t* payload, size_t length, uint16_t traceId = 0);
+
+  // Älteste Nachricht der höchsten belegten Spur entnehmen. payload zeigt in
+  // den Platz (nullterminiert) und bleibt bis zum nächsten push() gültig
+  bool pop(uint16_t &topic, const char* &payload, size_t &length, uint16_t *traceId = nullptr);
+
+  size_t size() const;
+  void clear();
+
+  void printStats(Print &out) const;
+  void resetStats();
+
+  // "high", "normal", "low"; unbekannte Namen ergeben fallback
+  static IngestPriority priorityFromName(const char* name, IngestPriority fallback);
+};
+
+#endif // INGEST_QUEUE_H
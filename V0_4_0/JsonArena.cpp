@@ -0,0 +1,116 @@
+/**
+ * JsonArena.cpp - Implementierung des JSON-Speicherbereichs
+ */
+
+#define LOG_MODULE LOG_MOD_DATA
+
+#include "JsonArena.h"
+
+// Globale Instanz
+JsonArena jsonArena;
+
+void* JsonArena::allocate(size_t size) {
+  size_t rounded = align(size);
+  if (top + sizeof(BlockHeader) + rounded > sizeof(buffer)) {
+    // Puffer voll: Dokument funktioniert weiter, nur eben auf dem Heap
+    fallbacks++;
+    fallbackBytes += size;
+    return malloc(size);
+  }
+
+  BlockHeader *header = (BlockHeader*)(buffer + top);
+  header->size = rounded;
+  header->offset = top;
+  top += sizeof(BlockHeader) + rounded;
+  liveBlocks++;
+  allocations++;
+  if (top > highWater) {
+    highWater = top;
+  }
+  return header + 1;
+}
+
+void JsonArena::deallocate(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  if (!owns(ptr)) {
+    free(ptr);
+    return;
+  }
+
+  // Der oberste Block wird sofort zurückgenommen, alle anderen erst, wenn
+  // der Puffer ganz leer ist
+  BlockHeader *header = headerOf(ptr);
+  if (isTop(header)) {
+    top = header->offset;
+  }
+  release();
+}
+
+void* JsonArena::reallocate(void *ptr, size_t newSize) {
+  if (!ptr) {
+    return allocate(newSize);
+  }
+  if (!owns(ptr)) {
+    return realloc(ptr, newSize);
+  }
+
+  BlockHeader *header = headerOf(ptr);
+  size_t rounded = align(newSize);
+  if (rounded <= header->size) {
+    // Schrumpfen: nur der oberste Block gibt den Rest zurück
+    if (isTop(header)) {
+      header->size = rounded;
+      top = header->offset + sizeof(BlockHeader) + rounded;
+    }
+    return ptr;
+  }
+  if (isTop(header) && header->offset + sizeof(BlockHeader) + rounded <= sizeof(buffer)) {
+    header->size = rounded;
+    top = header->offset + sizeof(BlockHeader) + rounded;
+    if (top > highWater) {
+      highWater = top;
+    }
+    return ptr;
+  }
+
+  // Umziehen, der alte Block bleibt bis zum Leeren des Puffers belegt
+  size_t oldSize = header->size;
+  void *moved = allocate(newSize);
+  if (!moved) {
+    return nullptr;
+  }
+  memcpy(moved, ptr, oldSize);
+  release();
+  return moved;
+}
+
+void JsonArena::release() {
+  if (liveBlocks > 0 && --liveBlocks == 0) {
+    top = 0;
+    resets++;
+  }
+}
+
+void JsonArena::resetStats() {
+  highWater = top;
+  allocations = 0;
+  resets = 0;
+  fallbacks = 0;
+  fallbackBytes = 0;
+}
+
+void JsonArena::printStatus(Print &out) const {
+  char line[80];
+  snprintf(line, sizeof(line), "JSON-Arena: %u B, belegt %u B, Spitze %u B (%u %%)",
+           (unsigned)sizeof(buffer), (unsigned)top, (unsigned)highWater,
+           (unsigned)(highWater * 100 / sizeof(buffer)));
+  out.println(line);
+  snprintf(line, sizeof(line), "Blöcke: %lu angefordert, %lu offen, %lu x geleert",
+           (unsigned long)allocations, (unsigned long)liveBlocks, (unsigned long)resets);
+  out.println(line);
+  snprintf(line, sizeof(line), "Auf den Heap ausgewichen: %lu x, %lu B",
+           (unsigned long)fallbacks, (unsigned long)fallbackBytes);
+  out.println(line);
+}
@@ -0,0 +1,72 @@
+/**
+ * JsonArena.h - Fester Speicherbereich für kurzlebige JSON-Dokumente
+ *
+ * Dokumente, die nur während des Parsens bestehen (Konfigurationsdateien,
+ * JSON-Payloads, Batterieparameter), holen ihren Speicher nicht mehr vom
+ * Heap, sondern fortlaufend aus einem statischen Puffer:
+ *   - Anfordern schiebt nur die Obergrenze weiter; der oberste Block kann an
+ *     Ort und Stelle wachsen oder schrumpfen (Zeichenketten, shrinkToFit)
+ *   - Sind alle Blöcke zurückgegeben, beginnt der Puffer wieder von vorn
+ *   - Passt eine Anforderung nicht mehr, fällt sie auf den Heap zurück und
+ *     wird gezählt
+ * Langlebige Dokumente (bootConfig, Filter) bleiben auf dem Heap, sonst würde
+ * der Puffer nie frei. Nur aus setup() und loop() verwenden, nicht
+ * threadsicher.
+ */
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "config.h"
+
+class JsonArena : public ArduinoJson::Allocator {
+private:
+  static const size_t ALIGNMENT = 8;
+  struct BlockHeader {
+    uint32_t size;             // Nutzbare Bytes, auf ALIGNMENT gerundet
+    uint32_t offset;           // Lage des Kopfs im Puffer
+  };
+
+  alignas(ALIGNMENT) uint8_t buffer[JSON_ARENA_SIZE];
+  size_t top = 0;              // Erstes freies Byte
+  uint32_t liveBlocks = 0;
+
+  // Statistik
+  size_t highWater = 0;
+  uint32_t allocations = 0;
+  uint32_t resets = 0;
+  uint32_t fallbacks = 0;
+  uint32_t fallbackBytes = 0;
+
+  bool owns(const void *ptr) const {
+    return ptr >= buffer && ptr < buffer + sizeof(buffer);
+  }
+  BlockHeader *headerOf(void *ptr) {
+    return (BlockHeader*)((uint8_t*)ptr - sizeof(BlockHeader));
+  }
+  bool isTop(const BlockHeader *header) const {
+    return header->offset + sizeof(BlockHeader) + header->size == top;
+  }
+  static size_t align(size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+  void release();
+
+public:
+  void* allocate(size_t size) override;
+  void deallocate(void *ptr) override;
+  void* reallocate(void *ptr, size_t newSize) override;
+
+  size_t used() const { return top; }
+  size_t peak() const { return highWater; }
+  uint32_t heapFallbacks() const { return fallbacks; }
+
+  void resetStats();
+  void printStatus(Print &out) const;
+};
+
+extern JsonArena jsonArena;
+
+#endif // JSON_ARENA_H
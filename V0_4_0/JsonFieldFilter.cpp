@@ -0,0 +1,248 @@
+/**
+ * JsonFieldFilter.cpp - Implementierung der vorkompilierten JSON-Pfade
+ */
+
+#define LOG_MODULE LOG_MOD_MQTT
+
+#include "JsonFieldFilter.h"
+#include "JsonStreamParser.h"
+#include "JsonArena.h"
+
+uint32_t JsonFieldFilter::hashPath(const char* path) {
+  uint32_t hash = 2166136261UL;
+  while (*path) {
+    hash ^= (uint8_t)*path++;
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+bool JsonFieldFilter::add(const String& path, uint16_t index) {
+  Field field;
+  field.path = path;
+  field.pathHash = hashPath(path.c_str());
+  field.index = index;
+
+  // In Segmente zerlegen; rein numerische Segmente sind Array-Indizes
+  int start = 0;
+  while (start <= (int)path.length()) {
+    int end = path.indexOf('.', start);
+    if (end < 0) {
+      end = path.length();
+    }
+    if (end == start) {
+      return false;  // Leeres Segment, z.B. "ENERGY..Power"
+    }
+
+    Step step;
+    step.key = path.substring(start, end);
+    step.index = -1;
+    if (step.key.length() <= 4) {
+      bool numeric = true;
+      for (unsigned int i = 0; i < step.key.length() && numeric; i++) {
+        numeric = isDigit(step.key[i]);
+      }
+      if (numeric) {
+        step.index = step.key.toInt();
+      }
+    }
+    field.steps.push_back(step);
+    start = end + 1;
+  }
+
+  // Pfad in das Filterdokument eintragen; true übernimmt den ganzen Teilbaum
+  JsonVariant node = filter.as<JsonVariant>();
+  for (const Step& step : field.steps) {
+    if (node.is<bool>()) {
+      break;  // Ein kürzerer Pfad schließt diesen bereits ein
+    }
+    node = filterChild(node, step);
+  }
+  if (!node.is<bool>()) {
+    node.set(true);
+  }
+
+  fields.push_back(field);
+  return true;
+}
+
+JsonVariant JsonFieldFilter::filterChild(JsonVariant node, const Step& step) {
+  if (step.index >= 0) {
+    // Ein Element im Filter gilt für alle Elemente des Arrays
+    JsonArray array = node.is<JsonArray>() ? node.as<JsonArray>() : node.to<JsonArray>();
+    if (array.size() == 0) {
+      return array.add<JsonVariant>();
+    }
+    return array[0];
+  }
+
+  JsonObject object = node.is<JsonObject>() ? node.as<JsonObject>() : node.to<JsonObject>();
+  JsonVariant child = object[step.key];
+  return child.isNull() ? object[step.key].to<JsonVariant>() : child;
+}
+
+JsonVariantConst JsonFieldFilter::resolve(JsonVariantConst node, const Field& field) {
+  for (const Step& step : field.steps) {
+    if (step.index >= 0 && node.is<JsonArrayConst>()) {
+      node = node[(size_t)step.index];
+    } else {
+      node = node[step.key];
+    }
+  }
+  return node;
+}
+
+void JsonFieldFilter::emitValue(JsonVariantConst value, uint16_t index, ValueCallback callback) {
+  if (value.is<const char*>()) {
+    callback(index, value.as<const char*>());
+    return;
+  }
+
+  // Zahlen und Literale in derselben Form wie der JsonStreamParser melden
+  char text[JSON_STREAM_MAX_TOKEN];
+  serializeJson(value, text, sizeof(text));
+  callback(index, text);
+}
+
+bool JsonFieldFilter::extract(const uint8_t* payload, size_t length, ValueCallback callback) const {
+  JsonDocument doc(&jsonArena);
+  DeserializationError error = deserializeJson(doc, (const char*)payload, length,
+                                               DeserializationOption::Filter(filter));
+  if (error) {
+    DEBUG_PRINT("JSON-Payload fehlerhaft: ");
+    DEBUG_PRINTLN(error.c_str());
+    return false;
+  }
+
+  for (const Field& field : fields) {
+    JsonVariantConst value = resolve(doc.as<JsonVariantConst>(), field);
+    if (!value.isNull()) {
+      emitValue(value, field.index, callback);
+    }
+  }
+  return true;
+}
+
+bool JsonFieldFilter::match(const char* path, const char* value, ValueCallback callback) const {
+  uint32_t hash = hashPath(path);
+  bool found = false;
+  for (const Field& field : fields) {
+    if (field.pathHash == hash && field.path == path) {
+      callback(field.index, value);
+      found = true;
+    }
+  }
+  return found;
+}
+
+// Beispielnachrichten für den Vergleich
+struct BenchmarkSample {
+  const char* name;
+  const char* payload;
+  const char* paths[4];
+};
+
+static const BenchmarkSample BENCHMARK_SAMPLES[] = {
+  { "Tasmota",
+    R"({"Time":"2024-05-01T12:00:00","ENERGY":{"TotalStartTime":"2023-01-01T00:00:00",)"
+    R"("Total":1234.567,"Yesterday":3.210,"Today":1.234,"Period":5,"Power":321,)"
+    R"("ApparentPower":340,"ReactivePower":110,"Factor":0.94,"Voltage":231,"Current":1.470}})",
+    { "ENERGY.Power", "ENERGY.Today", nullptr } },
+  { "Shelly",
+    R"({"ble":{},"cloud":{"connected":true},"input:0":{"id":0,"state":false},)"
+    R"("mqtt":{"connected":true},"switch:0":{"id":0,"source":"MQTT","output":true,)"
+    R"("apower":153.2,"voltage":229.8,"current":0.708,"aenergy":{"total":12345.678,)"
+    R"("by_minute":[2553.8,2560.1,2548.3],"minute_ts":1714560000},)"
+    R"("temperature":{"tC":45.3,"tF":113.5}},"sys":{"mac":"A8032ABCDEF0",)"
+    R"("restart_required":false,"time":"12:00","unixtime":1714560000,"uptime":123456,)"
+    R"("ram_size":246680,"ram_free":150000,"fs_size":458752,"fs_free":131072,)"
+    R"("cfg_rev":10,"kvs_rev":0,"schedule_rev":0,"webhook_rev":0,"available_updates":{}},)"
+    R"("wifi":{"sta_ip":"192.168.1.50","status":"got ip","ssid":"Home","rssi":-60},)"
+    R"("ws":{"connected":false}})",
+    { "switch:0.apower", "switch:0.aenergy.total", "switch:0.aenergy.by_minute.0", "sys.ram_free" } }
+};
+
+int JsonFieldFilter::benchmarkParse(int method, const uint8_t* payload, size_t length,
+                                    uint32_t* heapUsed) const {
+  int found = 0;
+  ValueCallback count = [&found](uint16_t, const char*) {
+    found++;
+  };
+  uint32_t heapBefore = heapUsed ? ESP.getFreeHeap() : 0;
+
+  if (method == 2) {
+    // Inkrementell: fester Speicher auf dem Stack, kein Dokument
+    JsonStreamParser parser;
+    parser.begin([this, &count](const char* path, const char* value) {
+      match(path, value, count);
+    });
+    parser.feed(payload, length);
+    parser.end();
+    if (heapUsed) {
+      *heapUsed = heapBefore - ESP.getFreeHeap();
+    }
+    return found;
+  }
+
+  JsonDocument doc;
+  DeserializationError error = method == 1 ?
+    deserializeJson(doc, (const char*)payload, length, DeserializationOption::Filter(filter)) :
+    deserializeJson(doc, (const char*)payload, length);
+  if (error) {
+    return -1;
+  }
+  for (const Field& field : fields) {
+    JsonVariantConst value = resolve(doc.as<JsonVariantConst>(), field);
+    if (!value.isNull()) {
+      emitValue(value, field.index, count);
+    }
+  }
+  if (heapUsed) {
+    *heapUsed = heapBefore - ESP.getFreeHeap();  // Solange das Dokument besteht
+  }
+  return found;
+}
+
+void JsonFieldFilter::runBenchmark(Print& out, int iterations) {
+  static const char* methodNames[3] = { "komplett", "Filter", "inkrementell" };
+
+  out.print("JSON-Vergleich, ");
+  out.print(iterations);
+  out.println(" Durchläufe je Verfahren");
+  out.println("Nachricht  Bytes  Verfahren       us/Nachricht      Heap  Felder");
+
+  for (const BenchmarkSample& sample : BENCHMARK_SAMPLES) {
+    JsonFieldFilter compiled;
+    uint16_t pathCount = 0;
+    for (const char* path : sample.paths) {
+      if (path) {
+        compiled.add(path, pathCount++);
+      }
+    }
+    const uint8_t* payload = (const uint8_t*)sample.payload;
+    size_t length = strlen(sample.payload);
+
+    for (int method = 0; method < 3; method++) {
+      // Erster Durchlauf misst den Heap, die übrigen nur die Zeit
+      uint32_t heapUsed = 0;
+      int found = compiled.benchmarkParse(method, payload, length, &heapUsed);
+
+      unsigned long start = micros();
+      for (int i = 0; i < iterations; i++) {
+        compiled.benchmarkParse(method, payload, length, nullptr);
+      }
+      unsigned long elapsed = micros() - start;
+
+      char line[96];
+      snprintf(line, sizeof(line), "%-9s %6u  %-13s %10.1f %7lu B  %d/%u",
+               sample.name, (unsigned)length, methodNames[method],
+               iterations > 0 ? (float)elapsed / iterations : 0.0f,
+               (unsigned long)heapUsed, found, (unsigned)pathCount);
+      out.println(line);
+    }
+  }
+
+  out.print("Parser (Stack): ");
+  out.print((unsigned long)sizeof(JsonStreamParser));
+  out.println(" B");
+}
@@ -0,0 +1,69 @@
+/**
+ * JsonFieldFilter.h - Vorkompilierte JSON-Pfade eines Topics
+ *
+ * Die in mqtt_topics.json konfigurierten Pfade ("ENERGY.Power",
+ * "switch:0.aenergy.by_minute.0") werden beim Laden einmal zerlegt:
+ *   - in ein ArduinoJson-Filterdokument, sodass deserializeJson() nur die
+ *     benötigten Felder in den Speicher übernimmt
+ *   - in Pfad-Hashes, mit denen der JsonStreamParser große Nachrichten
+ *     ohne String-Vergleich je Wert zuordnet
+ * Numerische Segmente gelten im Filter als Array-Index; ArduinoJson filtert
+ * damit alle Elemente des Arrays.
+ */
+
+#ifndef JSON_FIELD_FILTER_H
+#define JSON_FIELD_FILTER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include <functional>
+#include "config.h"
+
+class JsonFieldFilter {
+public:
+  // index = beim Hinzufügen übergebener Index (z.B. Topic-Index)
+  typedef std::function<void(uint16_t index, const char* value)> ValueCallback;
+
+private:
+  struct Step {
+    String key;
+    int16_t index;          // Array-Index, -1 für Objektschlüssel
+  };
+
+  struct Field {
+    String path;
+    uint32_t pathHash;
+    uint16_t index;
+    std::vector<Step> steps;
+  };
+
+  JsonDocument filter;
+  std::vector<Field> fields;
+
+  static JsonVariant filterChild(JsonVariant node, const Step& step);
+  static JsonVariantConst resolve(JsonVariantConst node, const Field& field);
+  static void emitValue(JsonVariantConst value, uint16_t index, ValueCallback callback);
+
+  // method: 0 = vollständig, 1 = Filter, 2 = JsonStreamParser; Anzahl gefundener Felder
+  int benchmarkParse(int method, const uint8_t* payload, size_t length, uint32_t* heapUsed) const;
+
+public:
+  // Pfad übernehmen; false bei leerem Pfad oder leerem Segment
+  bool add(const String& path, uint16_t index);
+  size_t size() const { return fields.size(); }
+
+  // Nur die gefilterten Felder deserialisieren und melden; false bei Parse-Fehler
+  bool extract(const uint8_t* payload, size_t length, ValueCallback callback) const;
+
+  // Wert mit Pfad, wie ihn der JsonStreamParser meldet; false ohne passendes Feld
+  bool match(const char* path, const char* value, ValueCallback callback) const;
+
+  static uint32_t hashPath(const char* path);
+
+  // Vergleich von vollständiger, gefilterter und inkrementeller Verarbeitung
+  // anhand eingebauter Beispielnachrichten (Tasmota, Shelly)
+  static void runBenchmark(Print& out, int iterations);
+};
+
+#endif // JSON_FIELD_FILTER_H
@@ -0,0 +1,291 @@
+/**
+ * JsonStreamParser.cpp - Implementierung des inkrementellen JSON-Parsers
+ */
+
+#include "JsonStreamParser.h"
+
+static inline bool isJsonWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool isLiteralChar(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         c == '-' || c == '+' || c == '.';
+}
+
+JsonStreamParser::JsonStreamParser() {
+  path[0] = '\0';
+  token[0] = '\0';
+}
+
+void JsonStreamParser::begin(FieldCallback callback) {
+  this->callback = callback;
+  state = VALUE;
+  depth = 0;
+  arrayMask = 0;
+  pathLength = 0;
+  path[0] = '\0';
+  tokenLength = 0;
+  tokenTruncated = false;
+  leafValid = true;
+}
+
+void JsonStreamParser::feed(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length && state != ERROR; i++) {
+    process((char)data[i]);
+  }
+}
+
+bool JsonStreamParser::end() {
+  // Zahl oder Literal als gesamtes Dokument endet erst hier
+  if (state == LITERAL && depth == 0) {
+    endValue();
+  }
+  return state == DONE || (state == NEXT && depth == 0);
+}
+
+void JsonStreamParser::appendToken(char c) {
+  if (tokenLength < sizeof(token) - 1) {
+    token[tokenLength++] = c;
+  } else {
+    tokenTruncated = true;
+  }
+}
+
+bool JsonStreamParser::setPath(const char* segment, size_t length) {
+  // Pfad des umgebenden Containers plus neues Segment
+  if (depth > JSON_STREAM_MAX_DEPTH) {
+    leafValid = false;
+    return false;
+  }
+  uint8_t base = depth > 0 ? levels[depth - 1].pathLength : 0;
+  bool parentValid = depth == 0 || levels[depth - 1].valid;
+  size_t needed = base + (base > 0 ? 1 : 0) + length;
+
+  pathLength = base;
+  if (needed >= sizeof(path)) {
+    path[pathLength] = '\0';
+    leafValid = false;
+    return false;
+  }
+
+  if (base > 0) {
+    path[pathLength++] = '.';
+  }
+  memcpy(path + pathLength, segment, length);
+  pathLength += length;
+  path[pathLength] = '\0';
+  leafValid = parentValid;
+  return true;
+}
+
+void JsonStreamParser::push(bool array) {
+  if (depth >= 32) {
+    state = ERROR;  // Tiefer als die Typmaske
+    return;
+  }
+  if (depth < JSON_STREAM_MAX_DEPTH) {
+    levels[depth].pathLength = pathLength;
+    levels[depth].index = 0;
+    levels[depth].valid = leafValid;
+  }
+  if (array) {
+    arrayMask |= (1UL << depth);
+  } else {
+    arrayMask &= ~(1UL << depth);
+  }
+  depth++;
+  state = array ? ARRAY_START : OBJECT_START;
+}
+
+bool JsonStreamParser::pop(bool array) {
+  if (depth == 0 || inArray() != array) {
+    state = ERROR;
+    return false;
+  }
+  depth--;
+  if (depth < JSON_STREAM_MAX_DEPTH) {
+    pathLength = levels[depth].pathLength;
+    path[pathLength] = '\0';
+  }
+  state = depth == 0 ? DONE : NEXT;
+  return true;
+}
+
+void JsonStreamParser::startValue(char c) {
+  // Array-Elemente erhalten ihren Index als Pfadsegment
+  if (inArray()) {
+    if (depth <= JSON_STREAM_MAX_DEPTH) {
+      char index[6];
+      uint8_t start = sizeof(index);
+      uint16_t value = levels[depth - 1].index;
+      do {
+        index[--start] = '0' + value % 10;
+        value /= 10;
+      } while (value > 0);
+      setPath(index + start, sizeof(index) - start);
+    } else {
+      leafValid = false;
+    }
+  }
+
+  tokenLength = 0;
+  tokenTruncated = false;
+  switch (c) {
+    case '{':
+      push(false);
+      break;
+    case '[':
+      push(true);
+      break;
+    case '"':
+      keyString = false;
+      state = STRING;
+      break;
+    default:
+      if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        appendToken(c);
+        state = LITERAL;
+      } else {
+        state = ERROR;
+      }
+      break;
+  }
+}
+
+void JsonStreamParser::endValue() {
+  token[tokenLength] = '\0';
+  if (leafValid && callback) {
+    callback(path, token);
+  }
+  state = NEXT;
+}
+
+void JsonStreamParser::process(char c) {
+  switch (state) {
+    case VALUE:
+      if (!isJsonWhitespace(c)) {
+        startValue(c);
+      }
+      break;
+
+    case ARRAY_START:
+      if (isJsonWhitespace(c)) {
+        break;
+      }
+      if (c == ']') {
+        pop(true);
+      } else {
+        startValue(c);
+      }
+      break;
+
+    case OBJECT_START:
+    case KEY:
+      if (isJsonWhitespace(c)) {
+        break;
+      }
+      if (c == '}' && state == OBJECT_START) {
+        pop(false);
+      } else if (c == '"') {
+        keyString = true;
+        tokenLength = 0;
+        tokenTruncated = false;
+        state = STRING;
+      } else {
+        state = ERROR;
+      }
+      break;
+
+    case COLON:
+      if (c == ':') {
+        state = VALUE;
+      } else if (!isJsonWhitespace(c)) {
+        state = ERROR;
+      }
+      break;
+
+    case STRING:
+      if (c == '\\') {
+        state = ESCAPE;
+      } else if (c == '"') {
+        if (keyString) {
+          // Gekürzte Schlüssel würden einen falschen Pfad ergeben
+          setPath(token, tokenLength);
+          if (tokenTruncated) {
+            leafValid = false;
+          }
+          state = COLON;
+        } else {
+          endValue();
+        }
+      } else {
+        appendToken(c);
+      }
+      break;
+
+    case ESCAPE:
+      state = STRING;
+      switch (c) {
+        case 'n': appendToken('\n'); break;
+        case 't': appendToken('\t'); break;
+        case 'r': appendToken('\r'); break;
+        case 'b': appendToken('\b'); break;
+        case 'f': appendToken('\f'); break;
+        case 'u':
+          // Unicode-Zeichen werden durch '?' ersetzt
+          appendToken('?');
+          unicodeDigits = 0;
+          state = UNICODE;
+          break;
+        default: appendToken(c); break;
+      }
+      break;
+
+    case UNICODE:
+      if (++unicodeDigits == 4) {
+        state = STRING;
+      }
+      break;
+
+    case LITERAL:
+      if (isLiteralChar(c)) {
+        appendToken(c);
+      } else {
+        endValue();
+        process(c);
+      }
+      break;
+
+    case NEXT:
+      if (isJsonWhitespace(c)) {
+        break;
+      }
+      if (c == ',' && depth > 0) {
+        if (inArray()) {
+          if (depth <= JSON_STREAM_MAX_DEPTH) {
+            levels[depth - 1].index++;
+          }
+          state = VALUE;
+        } else {
+          state = KEY;
+        }
+      } else if (c == '}') {
+        pop(false);
+      } else if (c == ']') {
+        pop(true);
+      } else {
+        state = ERROR;
+      }
+      break;
+
+    case DONE:
+      if (!isJsonWhitespace(c)) {
+        state = ERROR;  // Daten nach dem Dokumentende
+      }
+      break;
+
+    case ERROR:
+      break;
+  }
+}
@@ -0,0 +1,84 @@
+/**
+ * JsonStreamParser.h - Inkrementeller JSON-Parser mit festem Speicherbedarf
+ *
+ * Nimmt ein JSON-Dokument in beliebigen Stücken entgegen (feed()) und meldet
+ * jeden skalaren Wert mit seinem Pfad, z.B. "ENERGY.Power" oder
+ * "switch:0.apower". Array-Elemente erscheinen als Index ("Channels.1").
+ * Der Speicherbedarf hängt nicht von der Nachrichtengröße ab: zu lange Pfade,
+ * zu tiefe Verschachtelung und zu lange Werte werden übersprungen bzw. gekürzt.
+ */
+
+#ifndef JSON_STREAM_PARSER_H
+#define JSON_STREAM_PARSER_H
+
+#include <Arduino.h>
+#include <functional>
+#include "config.h"
+
+class JsonStreamParser {
+public:
+  typedef std::function<void(const char* path, const char* value)> FieldCallback;
+
+private:
+  enum State : uint8_t {
+    VALUE,          // Wert erwartet
+    ARRAY_START,    // Nach '[': Wert oder ']'
+    OBJECT_START,   // Nach '{': Schlüssel oder '}'
+    KEY,            // Nach ',' im Objekt: Schlüssel erwartet
+    COLON,          // Nach dem Schlüssel
+    STRING,
+    ESCAPE,
+    UNICODE,
+    LITERAL,        // Zahl, true, false, null
+    NEXT,           // Nach einem Wert: ',', '}' oder ']'
+    DONE,
+    ERROR
+  };
+
+  struct Level {
+    uint8_t pathLength;     // Pfadlänge des Containers selbst
+    uint16_t index;         // Aktueller Array-Index
+    bool valid;             // Pfad passt vollständig in den Puffer
+  };
+
+  FieldCallback callback;
+  State state = DONE;
+  bool keyString = false;   // STRING gehört zu einem Schlüssel
+  bool tokenTruncated = false;
+  bool leafValid = true;
+  uint8_t unicodeDigits = 0;
+
+  uint8_t depth = 0;
+  uint32_t arrayMask = 0;   // Bit je Ebene: Array (1) oder Objekt (0)
+  Level levels[JSON_STREAM_MAX_DEPTH];
+
+  char path[JSON_STREAM_MAX_PATH];
+  uint8_t pathLength = 0;
+  char token[JSON_STREAM_MAX_TOKEN];
+  uint8_t tokenLength = 0;
+
+  void appendToken(char c);
+  bool setPath(const char* segment, size_t length);
+  void startValue(char c);
+  void endValue();
+  void push(bool array);
+  bool pop(bool array);
+  bool inArray() const { return depth > 0 && (arrayMask >> (depth - 1)) & 1; }
+  void process(char c);
+
+public:
+  JsonStreamParser();
+
+  // Neues Dokument beginnen
+  void begin(FieldCallback callback);
+
+  // Nächstes Stück des Dokuments verarbeiten
+  void feed(const uint8_t* data, size_t length);
+
+  // Dokumentende; true, wenn das Dokument vollständig und gültig war
+  bool end();
+
+  bool failed() const { return state == ERROR; }
+};
+
+#endif // JSON_STREAM_PARSER_H
@@ -0,0 +1,223 @@
+/**
+ * LatencyTracer.cpp - Implementierung der Latenzmessung
+ */
+
+#include "LatencyTracer.h"
+
+// Globale Instanz
+LatencyTracer latencyTracer;
+
+int LatencyHistogram::bucketFor(uint32_t micros) {
+  if (micros == 0) {
+    return 0;
+  }
+  int octave = 31 - __builtin_clz(micros);
+  int sub = octave >= 2 ? (micros >> (octave - 2)) & 3 : (micros << (2 - octave)) & 3;
+  return min(octave * 4 + sub, BUCKETS - 1);
+}
+
+uint32_t LatencyHistogram::upperBound(int bucket) {
+  int octave = bucket / 4;
+  int sub = bucket % 4;
+  return ((uint32_t)(5 + sub) << octave) >> 2;
+}
+
+void LatencyHistogram::add(uint32_t micros) {
+  counts[bucketFor(micros)]++;
+  total++;
+  maxValue = max(maxValue, micros);
+}
+
+void LatencyHistogram::reset() {
+  memset(counts, 0, sizeof(counts));
+  total = 0;
+  maxValue = 0;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t percent) const {
+  if (total == 0) {
+    return 0;
+  }
+  uint32_t rank = ((uint64_t)total * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int i = 0; i < BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return min(upperBound(i), maxValue);
+    }
+  }
+  return maxValue;
+}
+
+LatencyTracer::LatencyTracer() {
+  // Konstruktor
+}
+
+uint32_t LatencyTracer::toMicros(uint32_t cycles) const {
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  return mhz > 0 ? cycles / mhz : cycles;
+}
+
+void LatencyTracer::record(uint16_t id, TracePoint point, uint32_t cycles) {
+  Event& event = events[(eventHead + eventCount) % TRACE_BUFFER_SIZE];
+  event.cycles = cycles;
+  event.id = id;
+  event.point = point;
+  if (eventCount < TRACE_BUFFER_SIZE) {
+    eventCount++;
+  } else {
+    eventHead = (eventHead + 1) % TRACE_BUFFER_SIZE;
+  }
+}
+
+void LatencyTracer::expire(uint32_t cycles) {
+  // Alte Einträge freigeben, bevor die Differenz der Zählerstände überläuft
+  uint32_t maxAge = TRACE_MAX_AGE_MS * 1000UL * ESP.getCpuFreqMHz();
+  for (auto& slot : pending) {
+    if (slot.id != 0 && cycles - slot.cycles[TRACE_RECEIVE] > maxAge) {
+      slot.id = 0;
+      expired++;
+    }
+  }
+}
+
+uint16_t LatencyTracer::begin(uint32_t cycles) {
+  uint16_t id = nextId++;
+  if (nextId == 0) {
+    nextId = 1;
+  }
+  expire(cycles);
+
+  // Freien Eintrag suchen, sonst den nächsten im Ring überschreiben
+  int free = -1;
+  for (int i = 0; i < TRACE_PENDING && free < 0; i++) {
+    int index = (nextPending + i) % TRACE_PENDING;
+    if (pending[index].id == 0) {
+      free = index;
+    }
+  }
+  if (free < 0) {
+    free = nextPending;
+    overwritten++;
+  }
+  Pending& slot = pending[free];
+  nextPending = (free + 1) % TRACE_PENDING;
+  slot.id = id;
+  slot.seen = 1 << TRACE_RECEIVE;
+  slot.cycles[TRACE_RECEIVE] = cycles;
+
+  record(id, TRACE_RECEIVE, cycles);
+  return id;
+}
+
+void LatencyTracer::mark(uint16_t id, TracePoint point) {
+  uint32_t cycles = ESP.getCycleCount();
+  for (auto& slot : pending) {
+    if (slot.id == id) {
+      if (!(slot.seen & (1 << point))) {
+        slot.seen |= 1 << point;
+        slot.cycles[point] = cycles;
+        record(id, point, cycles);
+      }
+      return;
+    }
+  }
+}
+
+void LatencyTracer::release(uint16_t id) {
+  for (auto& slot : pending) {
+    if (slot.id == id) {
+      slot.id = 0;
+      released++;
+      return;
+    }
+  }
+}
+
+void LatencyTracer::complete() {
+  uint32_t cycles = ESP.getCycleCount();
+  expire(cycles);
+  const uint8_t required = (1 << TRACE_RECEIVE) | (1 << TRACE_DIRTY);
+
+  for (auto& slot : pending) {
+    if (slot.id == 0 || (slot.seen & required) != required) {
+      continue;
+    }
+    slot.cycles[TRACE_PIXEL] = cycles;
+    record(slot.id, TRACE_PIXEL, cycles);
+
+    // Abschnitte nur, wenn beide Messpunkte erreicht wurden
+    static const uint8_t stageFrom[TRACE_STAGES] = {
+      TRACE_RECEIVE, TRACE_DEQUEUE, TRACE_FIELD_UPDATE, TRACE_DIRTY, TRACE_RECEIVE
+    };
+    static const uint8_t stageTo[TRACE_STAGES] = {
+      TRACE_DEQUEUE, TRACE_FIELD_UPDATE, TRACE_DIRTY, TRACE_PIXEL, TRACE_PIXEL
+    };
+    slot.seen |= 1 << TRACE_PIXEL;
+    for (int stage = 0; stage < TRACE_STAGES; stage++) {
+      uint8_t from = stageFrom[stage];
+      uint8_t to = stageTo[stage];
+      if ((slot.seen & (1 << from)) && (slot.seen & (1 << to))) {
+        histograms[stage].add(toMicros(slot.cycles[to] - slot.cycles[from]));
+      }
+    }
+    slot.id = 0;
+  }
+}
+
+const char* LatencyTracer::stageName(TraceStage stage) {
+  static const char* names[TRACE_STAGES] = {
+    "Warteschlange", "Lesen", "Übernahme", "Zeichnen", "Gesamt"
+  };
+  return names[stage];
+}
+
+void LatencyTracer::printStats(Print &out) const {
+  out.println("Abschnitt        Anzahl      p50      p95      p99      Max  (us)");
+  for (int stage = 0; stage < TRACE_STAGES; stage++) {
+    const LatencyHistogram& h = histograms[stage];
+    char line[80];
+    snprintf(line, sizeof(line), "%-14s %8lu %8lu %8lu %8lu %8lu",
+             stageName((TraceStage)stage), (unsigned long)h.count(),
+             (unsigned long)h.percentile(50), (unsigned long)h.percentile(95),
+             (unsigned long)h.percentile(99), (unsigned long)h.maximum());
+    out.println(line);
+  }
+  out.print("Nicht gezeichnet: ");
+  out.print(overwritten);
+  out.print(" verdrängt, ");
+  out.print(expired);
+  out.print(" abgelaufen; in der Warteschlange verworfen: ");
+  out.println(released);
+}
+
+void LatencyTracer::dump(Print &out) const {
+  static const char* pointNames[TRACE_POINTS] = {
+    "empfangen", "entnommen", "gelesen", "geändert", "gezeichnet"
+  };
+
+  // Zeit relativ zum ältesten Ereignis im Puffer
+  uint32_t base = eventCount > 0 ? events[eventHead].cycles : 0;
+  out.println("ID     Zeit (us)  Messpunkt");
+  for (uint16_t i = 0; i < eventCount; i++) {
+    const Event& event = events[(eventHead + i) % TRACE_BUFFER_SIZE];
+    char line[48];
+    snprintf(line, sizeof(line), "%5u %10lu  %s", (unsigned)event.id,
+             (unsigned long)toMicros(event.cycles - base), pointNames[event.point]);
+    out.println(line);
+  }
+}
+
+void LatencyTracer::reset() {
+  for (auto& histogram : histograms) {
+    histogram.reset();
+  }
+  for (auto& slot : pending) {
+    slot.id = 0;
+  }
+  eventHead = 0;
+  eventCount = 0;
+  overwritten = 0;
+  expired = 0;
+  released = 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * LatencyTracer.h - Latenzmessung vom MQTT-Empfang bis zum Pixel
+ *
+ * Jede empfangene Nachricht erhält eine Trace-ID. An festen Messpunkten
+ * (Empfang, Entnahme aus der Eingangswarteschlange, Übernahme in den
+ * DataManager, Änderungsmarke, nach dem SPI-Transfer der Anzeige) wird der
+ * Zykluszähler der CPU festgehalten: als Ereignis im Ringpuffer und für die
+ * Abschnittsdauern. Die Dauern landen in logarithmischen Histogrammen
+ * (4 Klassen pro Oktave), aus denen p50/p95/p99 abgelesen werden.
+ * Verfolgt werden nur Nachrichten mit passendem Topic; nicht gezeichnete
+ * verfallen nach TRACE_MAX_AGE_MS, lange vor dem Überlauf des Zählers.
+ */
+
+#ifndef LATENCY_TRACER_H
+#define LATENCY_TRACER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum TracePoint : uint8_t {
+  TRACE_RECEIVE,       // MqttManager::handleCallback
+  TRACE_DEQUEUE,       // Entnahme aus der Eingangswarteschlange
+  TRACE_FIELD_UPDATE,  // Payload gelesen (DataManager::applyTopic)
+  TRACE_DIRTY,         // Messgröße geändert (DataManager::setMetric)
+  TRACE_PIXEL,         // Anzeige gezeichnet (ViewManager)
+  TRACE_POINTS
+};
+
+enum TraceStage : uint8_t {
+  STAGE_QUEUE,         // Empfang -> Entnahme
+  STAGE_PARSE,         // Entnahme -> Übernahme
+  STAGE_APPLY,         // Übernahme -> Änderungsmarke
+  STAGE_RENDER,        // Änderungsmarke -> Pixel
+  STAGE_TOTAL,         // Empfang -> Pixel
+  TRACE_STAGES
+};
+
+// Histogramm in µs, 4 Klassen pro Oktave bis ca. 1 s
+class LatencyHistogram {
+public:
+  static const int BUCKETS = 80;
+
+private:
+  uint32_t counts[BUCKETS];
+  uint32_t total = 0;
+  uint32_t maxValue = 0;
+
+  static int bucketFor(uint32_t micros);
+  static uint32_t upperBound(int bucket);
+
+public:
+  LatencyHistogram() { reset(); }
+
+  void add(uint32_t micros);
+  void reset();
+
+  // Obere Grenze der Klasse, in der das Perzentil liegt (µs)
+  uint32_t percentile(uint8_t percent) const;
+  uint32_t count() const { return total; }
+  uint32_t maximum() const { return maxValue; }
+};
+
+class LatencyTracer {
+private:
+  struct Event {
+    uint32_t cycles;
+    uint16_t id;
+    uint8_t point;
+  };
+
+  // Noch nicht gezeichnete Nachrichten
+  struct Pending {
+    uint16_t id = 0;               // 0 = frei
+    uint8_t seen = 0;              // Bit je TracePoint
+    uint32_t cycles[TRACE_POINTS];
+  };
+
+  Event events[TRACE_BUFFER_SIZE];
+  uint16_t eventHead = 0;
+  uint16_t eventCount = 0;
+
+  Pending pending[TRACE_PENDING];
+  uint8_t nextPending = 0;
+
+  uint16_t nextId = 1;
+  uint16_t currentId = 0;
+  uint32_t overwritten = 0;        // Vor dem Zeichnen verdrängte Traces
+  uint32_t expired = 0;            // Nach TRACE_MAX_AGE_MS nicht gezeichnet
+  uint32_t released = 0;           // In der Eingangswarteschlange verworfen
+
+  LatencyHistogram histograms[TRACE_STAGES];
+
+  void record(uint16_t id, TracePoint point, uint32_t cycles);
+  uint32_t toMicros(uint32_t cycles) const;
+  void expire(uint32_t cycles);
+
+public:
+  LatencyTracer();
+
+  // Neue Nachricht, empfangen beim Zykluszählerstand cycles (TRACE_RECEIVE);
+  // liefert die Trace-ID
+  uint16_t begin(uint32_t cycles);
+
+  // Nachricht wird nicht verarbeitet (z.B. Warteschlange voll)
+  void release(uint16_t id);
+
+  // Messpunkt einer Nachricht; pro Punkt zählt das erste Auftreten
+  void mark(uint16_t id, TracePoint point);
+
+  // Nachricht, die gerade verarbeitet wird (0 = keine)
+  void setCurrent(uint16_t id) { currentId = id; }
+  void markCurrent(TracePoint point) {
+    if (currentId) {
+      mark(currentId, point);
+    }
+  }
+
+  // Nach dem Zeichnen: alle geänderten Nachrichten abschließen
+  void complete();
+
+  const LatencyHistogram& getHistogram(TraceStage stage) const { return histograms[stage]; }
+  static const char* stageName(TraceStage stage);
+  uint32_t getOverwritten() const { return overwritten; }
+  uint32_t getExpired() const { return expired; }
+
+  void printStats(Print &out) const;
+  void dump(Print &out) const;
+  void reset();
+};
+
+extern LatencyTracer latencyTracer;
+
+#endif // LATENCY_TRACER_H
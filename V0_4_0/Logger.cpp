@@ -0,0 +1,271 @@
+/**
+ * Logger.cpp - Implementierung der gepufferten Protokollausgabe
+ */
+
+#define LOG_MODULE LOG_MOD_TOOLS
+
+#include "Logger.h"
+#include <stdarg.h>
+
+// Globale Instanz
+Logger logger;
+
+Logger::Logger() {
+  memset(levels, LOG_DEFAULT_LEVEL, sizeof(levels));
+}
+
+void Logger::begin() {
+  if (drainTask) {
+    return;
+  }
+  // Kern 0 neben WLAN/lwIP (höhere Priorität); loop() läuft auf Kern 1
+  xTaskCreatePinnedToCore(drainLoop, "log", LOG_TASK_STACK, this, LOG_TASK_PRIORITY, &drainTask, 0);
+}
+
+void Logger::drainLoop(void *param) {
+  Logger *self = (Logger*)param;
+  for (;;) {
+    // Erst belegen, dann prüfen: pauseOutput() wartet auf das Ende
+    self->draining = true;
+    size_t count = self->paused ? 0 : self->drain(DEBUG_SERIAL, 8);
+    self->draining = false;
+    if (count == 0) {
+      vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL));
+    }
+  }
+}
+
+void Logger::pauseOutput(bool pause) {
+  paused = pause;
+  while (pause && draining) {
+    delay(1);
+  }
+}
+
+void Logger::setLevel(LogModule module, LogLevel level) {
+  levels[module] = level;
+}
+
+void Logger::setLevel(LogLevel level) {
+  memset(levels, level, sizeof(levels));
+}
+
+void Logger::store(const Entry &entry) {
+  entries[writeSeq % LOG_ENTRIES] = entry;
+  writeSeq++;
+}
+
+Logger::OpenLine* Logger::findLine(TaskHandle_t task) {
+  for (auto& line : lines) {
+    if (line.task == task) {
+      return &line;
+    }
+  }
+  return nullptr;
+}
+
+Logger::OpenLine* Logger::openLine(TaskHandle_t task, LogLevel level, LogModule module) {
+  // Freien Platz nehmen, sonst die älteste offene Zeile gekürzt abschließen
+  OpenLine* line = findLine(nullptr);
+  if (!line) {
+    line = &lines[0];
+    for (auto& candidate : lines) {
+      if ((int32_t)(candidate.opened - line->opened) < 0) {
+        line = &candidate;
+      }
+    }
+    if (!line->skip) {
+      line->entry.text[line->entry.length] = '\0';
+      line->entry.truncated = true;
+      store(line->entry);
+    }
+  }
+
+  line->task = task;
+  line->opened = linesOpened++;
+  line->skip = !enabled(level, module);
+  line->entry.time = millis();
+  line->entry.level = level;
+  line->entry.module = module;
+  line->entry.length = 0;
+  line->entry.truncated = false;
+  return line;
+}
+
+void Logger::logf(LogLevel level, LogModule module, const char *format, ...) {
+  if (!enabled(level, module)) {
+    filtered++;
+    return;
+  }
+
+  Entry entry;
+  entry.time = millis();
+  entry.level = level;
+  entry.module = module;
+
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(entry.text, sizeof(entry.text), format, args);
+  va_end(args);
+  if (length < 0) {
+    return;
+  }
+  entry.truncated = length >= (int)sizeof(entry.text);
+  entry.length = entry.truncated ? sizeof(entry.text) - 1 : length;
+
+  portENTER_CRITICAL(&lock);
+  store(entry);
+  portEXIT_CRITICAL(&lock);
+}
+
+Print& Logger::at(LogLevel level, LogModule module) {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL(&lock);
+  if (!findLine(task)) {
+    openLine(task, level, module);
+  }
+  portEXIT_CRITICAL(&lock);
+  return *this;
+}
+
+size_t Logger::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t Logger::write(const uint8_t *buffer, size_t size) {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL(&lock);
+  OpenLine* line = findLine(task);
+  // Ohne at() gilt Info im Hauptmodul, Folgezeilen behalten Stufe und Modul
+  LogLevel level = LOG_LEVEL_INFO;
+  LogModule module = LOG_MOD_MAIN;
+  for (size_t i = 0; i < size; i++) {
+    if (!line) {
+      line = openLine(task, level, module);
+    }
+    Entry& entry = line->entry;
+    char c = buffer[i];
+    if (c == '\n') {
+      if (line->skip) {
+        filtered++;
+      } else {
+        entry.text[entry.length] = '\0';
+        store(entry);
+      }
+      level = (LogLevel)entry.level;
+      module = (LogModule)entry.module;
+      line->task = nullptr;
+      line = nullptr;
+    } else if (c != '\r' && !line->skip) {
+      if (entry.length < sizeof(entry.text) - 1) {
+        entry.text[entry.length++] = c;
+      } else {
+        entry.truncated = true;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+  return size;
+}
+
+size_t Logger::drain(Print &out, size_t maxEntries) {
+  size_t count = 0;
+  Entry entry;
+
+  while (count < maxEntries) {
+    uint32_t lost = 0;
+    portENTER_CRITICAL(&lock);
+    if (drainSeq == writeSeq) {
+      portEXIT_CRITICAL(&lock);
+      break;
+    }
+    if (writeSeq - drainSeq > LOG_ENTRIES) {
+      lost = writeSeq - drainSeq - LOG_ENTRIES;
+      drainSeq = writeSeq - LOG_ENTRIES;
+      dropped += lost;
+    }
+    entry = entries[drainSeq % LOG_ENTRIES];
+    drainSeq++;
+    portEXIT_CRITICAL(&lock);
+
+    if (lost > 0) {
+      out.print("[Log] ");
+      out.print(lost);
+      out.println(" Einträge verworfen");
+    }
+    printEntry(out, entry);
+    count++;
+  }
+  return count;
+}
+
+bool Logger::read(uint32_t seq, Entry &entry) {
+  portENTER_CRITICAL(&lock);
+  bool valid = seq < writeSeq && writeSeq - seq <= LOG_ENTRIES;
+  if (valid) {
+    entry = entries[seq % LOG_ENTRIES];
+  }
+  portEXIT_CRITICAL(&lock);
+  return valid;
+}
+
+void Logger::printEntry(Print &out, const Entry &entry) const {
+  char prefix[24];
+  snprintf(prefix, sizeof(prefix), "[%6lu.%03lu] %c %-6s ",
+           (unsigned long)(entry.time / 1000), (unsigned long)(entry.time % 1000),
+           levelName((LogLevel)entry.level)[0], moduleName((LogModule)entry.module));
+  out.print(prefix);
+  out.write((const uint8_t*)entry.text, entry.length);
+  if (entry.truncated) {
+    out.print("...");
+  }
+  out.println();
+}
+
+void Logger::printStatus(Print &out) const {
+  out.println("Modul   Stufe");
+  for (uint8_t module = 0; module < LOG_MODULES; module++) {
+    char line[32];
+    snprintf(line, sizeof(line), "%-7s %s", moduleName((LogModule)module), levelName((LogLevel)levels[module]));
+    out.println(line);
+  }
+  out.print("Einträge: ");
+  out.print(writeSeq);
+  out.print(", wartend: ");
+  out.print(min(writeSeq - drainSeq, (uint32_t)LOG_ENTRIES));
+  out.print(", verworfen: ");
+  out.print(dropped);
+  out.print(", gefiltert: ");
+  out.print(filtered);
+  out.println(paused ? ", Ausgabe angehalten" : "");
+}
+
+const char* Logger::levelName(LogLevel level) {
+  static const char* names[LOG_LEVELS] = { "error", "warn", "info", "debug" };
+  return level < LOG_LEVELS ? names[level] : "?";
+}
+
+const char* Logger::moduleName(LogModule module) {
+  static const char* names[LOG_MODULES] = { "main", "config", "mqtt", "data", "ui", "tools" };
+  return module < LOG_MODULES ? names[module] : "?";
+}
+
+bool Logger::levelFromName(const String &name, LogLevel &level) {
+  for (uint8_t i = 0; i < LOG_LEVELS; i++) {
+    if (name.equalsIgnoreCase(levelName((LogLevel)i))) {
+      level = (LogLevel)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Logger::moduleFromName(const String &name, LogModule &module) {
+  for (uint8_t i = 0; i < LOG_MODULES; i++) {
+    if (name.equalsIgnoreCase(moduleName((LogModule)i))) {
+      module = (LogModule)i;
+      return true;
+    }
+  }
+  return false;
+}
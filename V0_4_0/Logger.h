@@ -0,0 +1,155 @@
+/**
+ * Logger.h - Gepufferte Protokollausgabe
+ *
+ * Meldungen werden vorformatiert in einen Ringpuffer im RAM geschrieben;
+ * eine eigene Task mit niedriger Priorität gibt sie über die serielle
+ * Schnittstelle aus. Der Aufrufer wartet so nie auf den UART.
+ *   - Stufen (Fehler, Warnung, Info, Debug) je Modul zur Laufzeit filterbar
+ *   - Gefilterte LOG_D()-Aufrufe kosten nur einen Vergleich, formatiert
+ *     wird erst nach der Prüfung
+ *   - Ist der Puffer voll, bevor die Task ihn leeren konnte, werden die
+ *     ältesten Einträge überschrieben und als verworfen gezählt
+ *   - Die letzten LOG_ENTRIES Einträge bleiben für die Log-Ansicht lesbar
+ *
+ * DEBUG_PRINT/DEBUG_PRINTLN schreiben ebenfalls hierher (Stufe Info); ein
+ * Eintrag endet mit dem Zeilenumbruch. Jede Task sammelt ihre Zeile getrennt,
+ * Bruchstücke verschiedener Tasks mischen sich also nicht. Das Modul legt
+ * jede .cpp-Datei mit LOG_MODULE vor den Includes fest.
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum LogLevel : uint8_t {
+  LOG_LEVEL_ERROR,
+  LOG_LEVEL_WARN,
+  LOG_LEVEL_INFO,
+  LOG_LEVEL_DEBUG,
+  LOG_LEVELS
+};
+
+enum LogModule : uint8_t {
+  LOG_MOD_MAIN,
+  LOG_MOD_CONFIG,
+  LOG_MOD_MQTT,
+  LOG_MOD_DATA,
+  LOG_MOD_UI,
+  LOG_MOD_TOOLS,     // Mitschnitt, Konsole, Messwerkzeuge
+  LOG_MODULES
+};
+
+#ifndef LOG_MODULE
+#define LOG_MODULE LOG_MOD_MAIN
+#endif
+
+class Logger : public Print {
+public:
+  struct Entry {
+    uint32_t time;                 // millis()
+    uint8_t level;
+    uint8_t module;
+    uint8_t length;
+    bool truncated;
+    char text[LOG_ENTRY_TEXT];
+  };
+
+private:
+  Entry entries[LOG_ENTRIES];
+  uint32_t writeSeq = 0;           // Anzahl geschriebener Einträge
+  uint32_t drainSeq = 0;           // Nächster auszugebender Eintrag
+  uint32_t dropped = 0;            // Vor der Ausgabe überschrieben
+  uint32_t filtered = 0;
+  uint8_t levels[LOG_MODULES];
+
+  // Offene DEBUG_PRINT-Zeilen, eine je schreibender Task
+  struct OpenLine {
+    TaskHandle_t task = nullptr;   // nullptr = frei
+    uint32_t opened = 0;           // Reihenfolge zum Verdrängen
+    bool skip = false;             // Stufe gefiltert
+    Entry entry;
+  };
+  OpenLine lines[LOG_OPEN_LINES];
+  uint32_t linesOpened = 0;
+
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+  TaskHandle_t drainTask = nullptr;
+  volatile bool paused = false;    // Serielle Ausgabe angehalten (Mitschnitt)
+  volatile bool draining = false;  // Ausgabe-Task schreibt gerade
+
+  // Nur mit gehaltenem lock aufrufen
+  void store(const Entry &entry);
+  OpenLine* findLine(TaskHandle_t task);
+  OpenLine* openLine(TaskHandle_t task, LogLevel level, LogModule module);
+  static void drainLoop(void *param);
+
+public:
+  Logger();
+
+  // Startet die Ausgabe-Task; davor geschriebene Einträge bleiben erhalten
+  void begin();
+
+  bool enabled(LogLevel level, LogModule module) const {
+    return level <= levels[module];
+  }
+
+  void setLevel(LogModule module, LogLevel level);
+  void setLevel(LogLevel level);   // alle Module
+  LogLevel getLevel(LogModule module) const { return (LogLevel)levels[module]; }
+
+  // Formatierte Meldung als ein Eintrag
+  void logf(LogLevel level, LogModule module, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+  // Beginnt eine DEBUG_PRINT-Zeile, falls die aufrufende Task keine offen hat
+  Print& at(LogLevel level, LogModule module);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  // Bis zu maxEntries Einträge ausgeben; liefert die Anzahl
+  size_t drain(Print &out, size_t maxEntries);
+
+  // Serielle Ausgabe anhalten, z.B. solange ein Binärstrom über Serial läuft.
+  // Kehrt erst zurück, wenn die Task keinen Eintrag mehr schreibt; Einträge
+  // bleiben im Puffer (die ältesten werden bei Bedarf verworfen)
+  void pauseOutput(bool pause);
+  bool isPaused() const { return paused; }
+
+  // Zum Lesen der letzten Einträge (Log-Ansicht, "log dump")
+  uint32_t sequence() const { return writeSeq; }
+  bool read(uint32_t seq, Entry &entry);
+
+  uint32_t getDropped() const { return dropped; }
+  uint32_t getFiltered() const { return filtered; }
+
+  void printEntry(Print &out, const Entry &entry) const;
+  void printStatus(Print &out) const;
+
+  static const char* levelName(LogLevel level);
+  static const char* moduleName(LogModule module);
+  static bool levelFromName(const String &name, LogLevel &level);
+  static bool moduleFromName(const String &name, LogModule &module);
+};
+
+extern Logger logger;
+
+#if DEBUG_ENABLED
+  #define LOG_AT(level, ...) do { \
+    if (logger.enabled(level, LOG_MODULE)) { \
+      logger.logf(level, LOG_MODULE, __VA_ARGS__); \
+    } \
+  } while (0)
+#else
+  #define LOG_AT(level, ...) do { } while (0)
+#endif
+
+#define LOG_E(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_W(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_I(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_D(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -0,0 +1,206 @@
+/**
+ * MemoryMonitor.cpp - Implementierung der Heap-Überwachung und des Dauertests
+ */
+
+#define LOG_MODULE LOG_MOD_TOOLS
+
+#include "MemoryMonitor.h"
+#include "MqttManager.h"
+#include <esp_heap_caps.h>
+
+// Globale Instanz
+MemoryMonitor memoryMonitor;
+MemoryScope* MemoryScope::current = nullptr;
+
+MemoryScope::MemoryScope(LogModule module) : parent(current), module(module) {
+  current = this;
+  freeBefore = ESP.getFreeHeap();
+}
+
+MemoryScope::~MemoryScope() {
+  int32_t retained = (int32_t)(freeBefore - ESP.getFreeHeap());
+  memoryMonitor.account(module, retained - nested);
+  if (parent) {
+    parent->nested += retained;
+  }
+  current = parent;
+}
+
+MemorySample MemoryMonitor::sample() {
+  MemorySample sample;
+  sample.uptime = millis() / 60000;
+  sample.freeHeap = ESP.getFreeHeap();
+  sample.largestBlock = ESP.getMaxAllocHeap();
+  return sample;
+}
+
+uint32_t MemoryMonitor::allocatedBlocks() {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+  return info.allocated_blocks;
+}
+
+void MemoryMonitor::account(LogModule module, int32_t retained) {
+  if (module >= LOG_MODULES) {
+    return;
+  }
+  ModuleBalance &balance = modules[module];
+  balance.scopes++;
+  balance.retained += retained;
+  if (retained > 0) {
+    balance.growing++;
+    balance.largest = max(balance.largest, (uint32_t)retained);
+  }
+}
+
+void MemoryMonitor::update() {
+  if (soakMessages > 0) {
+    updateSoak();
+  }
+
+  unsigned long now = millis();
+  if (historyCount > 0 && now - lastSample < MEMORY_SAMPLE_INTERVAL) {
+    return;
+  }
+  lastSample = now;
+  history[historyNext] = sample();
+  historyNext = (historyNext + 1) % MEMORY_HISTORY;
+  if (historyCount < MEMORY_HISTORY) {
+    historyCount++;
+  }
+}
+
+// Feste Topics mit Messgröße; Steuerungen, JSON-Payloads und über
+// Wildcards gebundene Topics bleiben außen vor
+static bool isSoakTopic(const MqttTopic &topic) {
+  return topic.metric != METRIC_NONE && topic.parent < 0 && !topic.hasJsonFields() && !topic.bound;
+}
+
+bool MemoryMonitor::startSoak(uint16_t days) {
+  uint32_t topicCount = 0;
+  for (const MqttTopic &topic : mqttManager.getTopics()) {
+    if (isSoakTopic(topic)) {
+      topicCount++;
+    }
+  }
+  if (topicCount == 0 || days == 0) {
+    LOG_W("Dauertest: keine Topics mit Messgröße");
+    return false;
+  }
+
+  // Ein Wert je Topic und MQTT_UPDATE_INTERVAL
+  soakPerDay = topicCount * (86400000UL / MQTT_UPDATE_INTERVAL);
+  soakMessages = soakPerDay * days;
+  soakSent = 0;
+  soakDay = 0;
+  soakSeed = 12345;
+  soakFirst = sample();
+  soakFirstBlocks = allocatedBlocks();
+  LOG_I("Dauertest: %u Tage, %lu Nachrichten für %lu Topics", (unsigned)days,
+        (unsigned long)soakMessages, (unsigned long)topicCount);
+  printSoakLine(Serial, soakFirst);
+  return true;
+}
+
+void MemoryMonitor::stopSoak() {
+  if (soakMessages == 0) {
+    return;
+  }
+  soakMessages = 0;
+  LOG_I("Dauertest nach %u Tagen abgebrochen", (unsigned)soakDay);
+}
+
+void MemoryMonitor::updateSoak() {
+  const std::vector<MqttTopic> &topics = mqttManager.getTopics();
+  char topicBuffer[MQTT_REPLAY_MAX_TOPIC + 1];
+  char payload[16];
+
+  // Wenige Nachrichten je Durchlauf, damit die Eingangswarteschlange nicht
+  // überläuft und Anzeige und Touch weiterlaufen
+  for (int i = 0; i < MEMORY_SOAK_BATCH && soakMessages > 0 && !topics.empty(); i++) {
+    const MqttTopic &topic = topics[soakSent++ % topics.size()];
+    if (!isSoakTopic(topic)) {
+      continue;
+    }
+
+    // Werte wechselnder Länge, damit String-Puffer ständig neu angelegt werden
+    soakSeed = soakSeed * 1103515245UL + 12345;
+    int decimals = (soakSeed >> 24) % 4;
+    float value = ((soakSeed >> 8) % 100000) / 10.0f;
+    int length = snprintf(payload, sizeof(payload), "%.*f", decimals, value);
+
+    // handleCallback erwartet einen veränderbaren Topic-Puffer wie PubSubClient
+    snprintf(topicBuffer, sizeof(topicBuffer), "%s", topic.topic.c_str());
+    mqttManager.handleCallback(topicBuffer, (byte*)payload, length);
+    soakMessages--;
+
+    if (soakMessages % soakPerDay == 0) {
+      soakDay++;
+      printSoakLine(Serial, sample());
+      if (soakMessages == 0) {
+        MemorySample last = sample();
+        LOG_I("Dauertest beendet: größter Block %ld B, Zerstückelung %d Prozentpunkte, belegte Blöcke %ld gegenüber dem Start",
+              (long)last.largestBlock - (long)soakFirst.largestBlock,
+              (int)last.fragmentation() - (int)soakFirst.fragmentation(),
+              (long)allocatedBlocks() - (long)soakFirstBlocks);
+      }
+    }
+  }
+}
+
+void MemoryMonitor::printSoakLine(Print &out, const MemorySample &sample) const {
+  char line[160];
+  snprintf(line, sizeof(line), "Tag %3u: frei %6lu B, größter Block %6lu B, zerstückelt %3u %%, Minimum %6lu B, Blöcke %5lu",
+           (unsigned)soakDay, (unsigned long)sample.freeHeap, (unsigned long)sample.largestBlock,
+           (unsigned)sample.fragmentation(), (unsigned long)ESP.getMinFreeHeap(),
+           (unsigned long)allocatedBlocks());
+  out.println(line);
+}
+
+void MemoryMonitor::resetStats() {
+  for (int i = 0; i < LOG_MODULES; i++) {
+    modules[i] = ModuleBalance();
+  }
+}
+
+void MemoryMonitor::printStatus(Print &out) const {
+  MemorySample now = sample();
+  char line[96];
+  snprintf(line, sizeof(line), "Heap frei %lu B, größter Block %lu B, zerstückelt %u %%",
+           (unsigned long)now.freeHeap, (unsigned long)now.largestBlock, (unsigned)now.fragmentation());
+  out.println(line);
+  snprintf(line, sizeof(line), "Minimum seit Start: %lu B", (unsigned long)ESP.getMinFreeHeap());
+  out.println(line);
+
+  out.println("Modul    Abschnitte  behalten B  wachsend  größter B");
+  for (int i = 0; i < LOG_MODULES; i++) {
+    const ModuleBalance &balance = modules[i];
+    snprintf(line, sizeof(line), "%-8s %10lu %11ld %9lu %10lu", Logger::moduleName((LogModule)i),
+             (unsigned long)balance.scopes, (long)balance.retained,
+             (unsigned long)balance.growing, (unsigned long)balance.largest);
+    out.println(line);
+  }
+
+  snprintf(line, sizeof(line), "Belegte Heap-Blöcke: %lu (Abschnitte zählen Aufrufe, keine Allokationen)",
+           (unsigned long)allocatedBlocks());
+  out.println(line);
+
+  if (soakMessages > 0) {
+    snprintf(line, sizeof(line), "Dauertest läuft: Tag %u, noch %lu Nachrichten",
+             (unsigned)soakDay + 1, (unsigned long)soakMessages);
+    out.println(line);
+  }
+}
+
+void MemoryMonitor::printHistory(Print &out) const {
+  out.println("Minute     frei B   Block B  zerstückelt");
+  uint16_t first = (historyNext + MEMORY_HISTORY - historyCount) % MEMORY_HISTORY;
+  for (uint16_t i = 0; i < historyCount; i++) {
+    const MemorySample &entry = history[(first + i) % MEMORY_HISTORY];
+    char line[64];
+    snprintf(line, sizeof(line), "%6lu %10lu %9lu %9u %%", (unsigned long)entry.uptime,
+             (unsigned long)entry.freeHeap, (unsigned long)entry.largestBlock,
+             (unsigned)entry.fragmentation());
+    out.println(line);
+  }
+}
@@ -0,0 +1,98 @@
+/**
+ * MemoryMonitor.h - Heap-Belegung und Zerstückelung über lange Laufzeit
+ *
+ * update() hält alle MEMORY_SAMPLE_INTERVAL ms freien Heap, größten freien
+ * Block und das Minimum seit dem Start in einem Ringpuffer fest; der Anteil
+ * des freien Speichers, der nicht im größten Block liegt, zeigt die
+ * Zerstückelung. Ohne Eingriff in malloc() ist keine Zählung einzelner
+ * Allokationen möglich; stattdessen bilanziert MemoryScope je Modul, wie
+ * viele Bytes ein Abschnitt (MQTT-Empfang, Datenübernahme, Anzeige, ...)
+ * dauerhaft behalten hat. Verschachtelte Abschnitte werden nur dem inneren
+ * Modul angerechnet.
+ *
+ * Der Dauertest (soak) spielt Tage an Verkehr im Zeitraffer ein: künstliche
+ * Nachrichten wechselnder Länge für alle festen Topics laufen durch
+ * Eingangswarteschlange, DataManager und Anzeige; je simuliertem Tag wird
+ * eine Zeile mit dem Trend ausgegeben. Die Zahl der belegten Heap-Blöcke
+ * stammt aus heap_caps_get_info() und ist ein Bestand, keine Allokationsrate.
+ */
+
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <Arduino.h>
+#include "config.h"
+
+struct MemorySample {
+  uint32_t uptime;             // Minuten
+  uint32_t freeHeap;
+  uint32_t largestBlock;
+
+  uint8_t fragmentation() const {
+    return freeHeap > 0 ? 100 - (uint64_t)largestBlock * 100 / freeHeap : 0;
+  }
+};
+
+class MemoryMonitor {
+private:
+  struct ModuleBalance {
+    uint32_t scopes = 0;       // Durchlaufene Abschnitte, keine Allokationen
+    int32_t retained = 0;      // Bytes, Summe über alle Abschnitte
+    uint32_t growing = 0;      // Abschnitte, die Speicher behalten haben
+    uint32_t largest = 0;      // Größter in einem Abschnitt behaltener Betrag
+  };
+  ModuleBalance modules[LOG_MODULES];
+
+  MemorySample history[MEMORY_HISTORY];
+  uint16_t historyCount = 0;
+  uint16_t historyNext = 0;
+  unsigned long lastSample = 0;
+
+  // Dauertest
+  uint32_t soakMessages = 0;   // Noch einzuspielen
+  uint32_t soakSent = 0;
+  uint32_t soakPerDay = 0;
+  uint16_t soakDay = 0;
+  MemorySample soakFirst;
+  uint32_t soakFirstBlocks = 0;
+  uint32_t soakSeed = 0;
+
+  void updateSoak();
+  void printSoakLine(Print &out, const MemorySample &sample) const;
+
+public:
+  static MemorySample sample();
+  static uint32_t allocatedBlocks();  // Belegte Blöcke im Heap
+
+  void update();
+
+  // Aufruf aus MemoryScope
+  void account(LogModule module, int32_t retained);
+
+  // Simulierte Tage mit dem Nachrichtenaufkommen eines Tages je Topic
+  bool startSoak(uint16_t days);
+  void stopSoak();
+  bool isSoaking() const { return soakMessages > 0; }
+
+  void resetStats();
+  void printStatus(Print &out) const;
+  void printHistory(Print &out) const;
+};
+
+// Bilanz eines Abschnitts: freier Heap beim Betreten und Verlassen
+class MemoryScope {
+private:
+  static MemoryScope* current;
+  MemoryScope* parent;
+  LogModule module;
+  uint32_t freeBefore;
+  int32_t nested = 0;          // Von inneren Abschnitten behalten
+
+public:
+  explicit MemoryScope(LogModule module);
+  ~MemoryScope();
+};
+
+extern MemoryMonitor memoryMonitor;
+
+#endif // MEMORY_MONITOR_H
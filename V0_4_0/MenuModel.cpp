@@ -0,0 +1,156 @@
+/**
+ * MenuModel.cpp - Aufbau und Abfrage des Menübaums
+ */
+
+#define LOG_MODULE LOG_MOD_UI
+
+#include "MenuModel.h"
+
+void MenuModel::clear() {
+  nodeCount = 1;
+  textStart = MENU_ARENA_SIZE;
+  overflow = false;
+  Node *root = node(ROOT);
+  root->label = NONE;
+  root->function = NONE;
+  root->firstChild = NONE;
+  root->childCount = 0;
+  root->reserved = 0;
+}
+
+bool MenuModel::addChildren(NodeId parent, size_t count) {
+  if (count == 0) {
+    return true;
+  }
+  if (count > 255 || (nodeCount + count) * sizeof(Node) > textStart) {
+    overflow = true;
+    return false;
+  }
+  node(parent)->firstChild = nodeCount;
+  node(parent)->childCount = count;
+  for (size_t i = 0; i < count; i++) {
+    Node *child = node(nodeCount++);
+    child->label = NONE;
+    child->function = NONE;
+    child->firstChild = NONE;
+    child->childCount = 0;
+    child->reserved = 0;
+  }
+  return true;
+}
+
+uint16_t MenuModel::addText(const char* text) {
+  size_t length = strlen(text) + 1;
+  if (nodeCount * sizeof(Node) + length > textStart) {
+    overflow = true;
+    return NONE;
+  }
+  textStart -= length;
+  memcpy(arena + textStart, text, length);
+  return textStart;
+}
+
+void MenuModel::addJson(NodeId parent, JsonArrayConst items, uint8_t depth) {
+  if (depth > MENU_MAX_DEPTH) {
+    LOG_W("Menü: '%s' liegt tiefer als %d Ebenen, Einträge entfallen", label(parent), MENU_MAX_DEPTH);
+    return;
+  }
+  if (!addChildren(parent, items.size())) {
+    return;
+  }
+
+  // Erst alle Geschwister, dann deren Kinder: so bleiben sie zusammenhängend
+  NodeId id = node(parent)->firstChild;
+  for (JsonVariantConst item : items) {
+    node(id)->label = addText(item[depth == 1 ? "title" : "name"] | "");
+    if (item["items"].is<JsonArrayConst>()) {
+      addJson(id, item["items"].as<JsonArrayConst>(), depth + 1);
+    } else if (item["function"].is<const char*>()) {
+      node(id)->function = addText(item["function"].as<const char*>());
+    }
+    if (overflow) {
+      return;
+    }
+    id++;
+  }
+}
+
+void MenuModel::addDefaults(NodeId parent, const DefaultMenuItem* items, uint8_t count, uint8_t depth) {
+  if (depth > MENU_MAX_DEPTH || !addChildren(parent, count)) {
+    return;
+  }
+  NodeId id = node(parent)->firstChild;
+  for (uint8_t i = 0; i < count && !overflow; i++, id++) {
+    node(id)->label = addText(items[i].name);
+    if (items[i].items) {
+      addDefaults(id, items[i].items, items[i].itemCount, depth + 1);
+    } else if (items[i].function) {
+      node(id)->function = addText(items[i].function);
+    }
+  }
+}
+
+bool MenuModel::load(JsonDocument &doc) {
+  clear();
+  addJson(ROOT, doc["tabs"].as<JsonArrayConst>(), 1);
+  if (overflow) {
+    LOG_E("Menü passt nicht in %u Bytes", (unsigned)MENU_ARENA_SIZE);
+    clear();
+    return false;
+  }
+  return tabCount() > 0;
+}
+
+bool MenuModel::loadDefaults() {
+  clear();
+  if (!addChildren(ROOT, DEFAULT_MENU_TABS)) {
+    return false;
+  }
+  for (uint8_t t = 0; t < DEFAULT_MENU_TABS && !overflow; t++) {
+    NodeId id = tab(t);
+    node(id)->label = addText(DEFAULT_MENU[t].title);
+    addDefaults(id, DEFAULT_MENU[t].items, DEFAULT_MENU[t].itemCount, 2);
+  }
+  if (overflow) {
+    LOG_E("Standardmenü passt nicht in %u Bytes", (unsigned)MENU_ARENA_SIZE);
+    clear();
+    return false;
+  }
+  return true;
+}
+
+MenuModel::NodeId MenuModel::child(NodeId id, uint8_t index) const {
+  if (index >= childCount(id)) {
+    return NONE;
+  }
+  return node(id)->firstChild + index;
+}
+
+const char* MenuModel::label(NodeId id) const {
+  if (id >= nodeCount || node(id)->label == NONE) {
+    return "";
+  }
+  return (const char*)arena + node(id)->label;
+}
+
+const char* MenuModel::function(NodeId id) const {
+  if (id >= nodeCount || node(id)->function == NONE) {
+    return "";
+  }
+  return (const char*)arena + node(id)->function;
+}
+
+bool MenuModel::sameSubtree(NodeId id, const MenuModel &other, NodeId otherId) const {
+  uint8_t count = childCount(id);
+  if (count != other.childCount(otherId) ||
+      strcmp(label(id), other.label(otherId)) != 0 ||
+      strcmp(function(id), other.function(otherId)) != 0) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    if (!sameSubtree(child(id, i), other, other.child(otherId, i))) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * MenuModel.h - Menübaum in einem zusammenhängenden Speicherblock
+ *
+ * Das ganze Menü (Tabs, Einträge, Untermenüs) liegt in einem festen Array
+ * von MENU_ARENA_SIZE Bytes: Knoten wachsen von vorne, die Texte mit
+ * Nullzeichen von hinten. Knoten verweisen über Offsets auf ihren Text und
+ * auf ihr erstes Kind; die Kinder eines Knotens liegen direkt hintereinander.
+ *   - Knoten 0 ist die Wurzel, ihre Kinder sind die Tabs
+ *   - Ein Knoten mit Kindern ist ein Untermenü, sonst ein Eintrag mit Funktion
+ *   - Aufgebaut wird einmal beim Laden, danach wird nichts mehr angelegt;
+ *     mehr Tabs oder Ebenen belegen keinen zusätzlichen Heap
+ */
+
+#ifndef MENU_MODEL_H
+#define MENU_MODEL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "config.h"
+#include "default_data.h"
+
+class MenuModel {
+public:
+  typedef uint16_t NodeId;
+  static const NodeId ROOT = 0;
+  static const NodeId NONE = 0xFFFF;
+
+private:
+  struct Node {
+    uint16_t label;            // Offset des Textes
+    uint16_t function;         // Offset des Funktionsnamens oder NONE
+    uint16_t firstChild;
+    uint8_t childCount;
+    uint8_t reserved;
+  };
+
+  alignas(Node) uint8_t arena[MENU_ARENA_SIZE];
+  uint16_t nodeCount = 0;
+  uint16_t textStart = MENU_ARENA_SIZE;   // Texte belegen [textStart, Ende)
+  bool overflow = false;
+
+  Node* node(NodeId id) { return reinterpret_cast<Node*>(arena) + id; }
+  const Node* node(NodeId id) const { return reinterpret_cast<const Node*>(arena) + id; }
+
+  // count Kinder direkt hintereinander für parent anlegen
+  bool addChildren(NodeId parent, size_t count);
+  uint16_t addText(const char* text);
+
+  void addJson(NodeId parent, JsonArrayConst items, uint8_t depth);
+  void addDefaults(NodeId parent, const DefaultMenuItem* items, uint8_t count, uint8_t depth);
+
+public:
+  MenuModel() { clear(); }
+
+  void clear();
+
+  // Aus {"tabs": [{"title", "items": [{"name", "function" | "items"}]}]};
+  // false, wenn keine Tabs darin sind oder der Platz nicht reicht
+  bool load(JsonDocument &doc);
+
+  // Aus dem Standardmenü (default_data.h)
+  bool loadDefaults();
+
+  uint8_t tabCount() const { return childCount(ROOT); }
+  NodeId tab(uint8_t index) const { return child(ROOT, index); }
+
+  uint8_t childCount(NodeId id) const { return id < nodeCount ? node(id)->childCount : 0; }
+  NodeId child(NodeId id, uint8_t index) const;
+  bool hasChildren(NodeId id) const { return childCount(id) > 0; }
+
+  const char* label(NodeId id) const;
+  const char* function(NodeId id) const;  // "" bei Untermenüs
+
+  // Gleicher Text, gleiche Funktion und gleiche Kinder in beiden Modellen
+  bool sameSubtree(NodeId id, const MenuModel &other, NodeId otherId) const;
+
+  size_t bytesUsed() const { return nodeCount * sizeof(Node) + (MENU_ARENA_SIZE - textStart); }
+  size_t nodes() const { return nodeCount; }
+};
+
+#endif // MENU_MODEL_H
@@ -2,96 +2,122 @@
  * MenuSystem.cpp - Implementierung des Touch-Menüs
  */
 
+#define LOG_MODULE LOG_MOD_UI
+
 #include "MenuSystem.h"
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
+#include <new>
 #include "ConfigManager.h"
+#include "JsonArena.h"
+#include "MemoryMonitor.h"
 
 // Globale Instanz wird in der externen Datei definiert (Hauptdatei)
 // Hier nur extern deklariert
 extern MenuSystem menuSystem;
 extern TFT_eSPI tft;
 
-void MenuSystem::addTab(const String &title) {
-  tabs.push_back(MenuTab(title));
-}
-
-void MenuSystem::addMenuItem(const String &tabTitle, const String &name, const String &functionName) {
-  // Suche den Tab mit dem angegebenen Titel
-  for (auto &tab : tabs) {
-    if (tab.title == tabTitle) {
-      tab.addItem(MenuItem(name, functionName));
-      return;
-    }
-  }
-  
-  // Tab nicht gefunden, erstelle neuen Tab
-  MenuTab newTab(tabTitle);
-  newTab.addItem(MenuItem(name, functionName));
-  tabs.push_back(newTab);
+bool MenuSystem::readMenu(const String &filename, MenuModel &result) {
+  // JSON-Konfiguration laden, die Texte werden in das Modell kopiert
+  JsonDocument doc(&jsonArena); // Nur während des Einlesens
+  return configManager.loadJsonConfig(filename, doc) && result.load(doc);
 }
 
 bool MenuSystem::loadFromJson(const String &filename) {
-  // Bestehende Tabs und Menüeinträge leeren
-  tabs.clear();
-  
-  // JSON-Konfiguration laden
-  JsonDocument doc; // Die Größenbeschränkung ist nicht mehr erforderlich
-  if (!configManager.loadJsonConfig(filename, doc)) {
-    return false;
-  }
-  
-  // Tabs und Menüeinträge aus JSON laden
-  JsonArray tabsArray = doc["tabs"];
-  if (!tabsArray || tabsArray.size() == 0) {
-    DEBUG_PRINTLN("Keine Tabs in der Menü-Konfiguration gefunden");
-    
-    // Erstelle ein Standard-Menü anstatt abzustürzen
-    addTab("System");
-    addMenuItem("System", "Standardansicht", "drawSolarStatus");
-    
-    // Vollständiges Redraw erforderlich
-    needsFullRedraw = true;
-    
-    return false;
-  }
-  
-  for (JsonObject tabObj : tabsArray) {
-    String tabTitle = tabObj["title"].as<String>();
-    
-    // Tab hinzufügen
-    addTab(tabTitle);
-    
-    // Menüeinträge für Tab laden
-    JsonArray itemsArray = tabObj["items"];
-    if (itemsArray) {
-      for (JsonObject itemObj : itemsArray) {
-        String itemName = itemObj["name"].as<String>();
-        String functionName = itemObj["function"].as<String>();
-        
-        // Menüeintrag hinzufügen
-        addMenuItem(tabTitle, itemName, functionName);
-      }
-    }
+  // Bestehende Tabs und Menüeinträge ersetzen
+  if (!readMenu(filename, menu)) {
+    // Nur beim Start: Standardmenü direkt aus dem Flash, ohne JSON
+    DEBUG_PRINTLN("Keine Tabs in der Menü-Konfiguration, verwende Standardmenü");
+    menu.loadDefaults();
   }
   
   DEBUG_PRINT("Menü-Konfiguration geladen: ");
-  DEBUG_PRINT(tabs.size());
-  DEBUG_PRINTLN(" Tabs");
+  DEBUG_PRINT(menu.tabCount());
+  DEBUG_PRINT(" Tabs, ");
+  DEBUG_PRINT(menu.bytesUsed());
+  DEBUG_PRINT(" von ");
+  DEBUG_PRINT(MENU_ARENA_SIZE);
+  DEBUG_PRINTLN(" Bytes");
   
   // Grundeinstellungen zurücksetzen
   currentTab = 0;
-  scrollPosition = 0;
+  tabOffset = 0;
+  depth = 0;
+  scrollOffset = 0;
+  stopFling();
   selectedMenuItem = -1;
   touchedMenuItem = -1;
   
   // Vollständiges Redraw erforderlich
   needsFullRedraw = true;
   
-  return true;
+  return menu.tabCount() > 0;
+}
+
+int MenuSystem::reload(const String &filename) {
+  // Neues Modell nur kurz für den Vergleich, danach wird es übernommen
+  MenuModel *fresh = new (std::nothrow) MenuModel();
+  if (!fresh) {
+    return 0;
+  }
+  if (!readMenu(filename, *fresh)) {
+    // Fehlerhafte Datei: bisheriges Menü behalten statt auf das Standardmenü zu fallen
+    LOG_E("Menü-Konfiguration %s nicht lesbar, bisheriges Menü bleibt", filename.c_str());
+    delete fresh;
+    return 0;
+  }
+  
+  // Tabs zählen, deren Titel, Einträge oder Untermenüs sich geändert haben
+  int oldCount = menu.tabCount();
+  int newCount = fresh->tabCount();
+  int changed = 0;
+  bool currentChanged = false;
+  bool tabBarChanged = oldCount != newCount;
+  for (int i = 0; i < max(oldCount, newCount); i++) {
+    if (i < oldCount && i < newCount) {
+      MenuModel::NodeId oldTab = menu.tab(i);
+      MenuModel::NodeId newTab = fresh->tab(i);
+      if (menu.sameSubtree(oldTab, *fresh, newTab)) {
+        continue;
+      }
+      tabBarChanged |= strcmp(menu.label(oldTab), fresh->label(newTab)) != 0;
+    }
+    changed++;
+    currentChanged |= i == currentTab;
+  }
+  if (changed == 0) {
+    delete fresh;
+    return 0;
+  }
+  menu = *fresh;
+  delete fresh;
+  
+  // Auswahl nur im betroffenen Tab zurücksetzen; im unveränderten Tab
+  // bleibt auch das geöffnete Untermenü offen
+  if (currentTab >= newCount) {
+    currentTab = 0;
+  }
+  if (currentChanged) {
+    depth = 0;
+    scrollOffset = 0;
+    stopFling();
+    touchedMenuItem = -1;
+  }
+  keepTabVisible();
+  
+  // Neu zeichnen nur, wenn der sichtbare Tab oder die Tableiste betroffen ist
+  if (currentChanged || tabBarChanged) {
+    needsFullRedraw = true;
+  }
+  
+  DEBUG_PRINT("Menü neu geladen: ");
+  DEBUG_PRINT(changed);
+  DEBUG_PRINTLN(" Tabs geändert");
+  return changed;
 }
 
 void MenuSystem::drawMenu(bool fullRedraw) {
+  MemoryScope memoryScope(LOG_MODULE);
   if (fullRedraw || needsFullRedraw) {
     // Bildschirm löschen
     tft.fillScreen(BACKGROUND);
@@ -105,12 +131,19 @@ void MenuSystem::drawMenu(bool fullRedraw) {
     // Scroll-Pfeile zeichnen
     drawScrollArrows();
     
-    // Alle Menüpunkte zeichnen
-    int maxItems = tabs[currentTab].items.size();
-    for (int i = 0; i < min(MENU_VISIBLE_ITEMS, maxItems - scrollPosition); i++) {
-      drawMenuItem(i + scrollPosition, i, (i + scrollPosition) == touchedMenuItem);
+    // Bildpuffer einmal anlegen und behalten, damit der Heap nicht zerstückelt
+    if (!list.created()) {
+      list.setColorDepth(MENU_SPRITE_DEPTH);
+      if (list.createSprite(MENU_ITEM_WIDTH, MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT)) {
+        list.setScrollRect(0, 0, MENU_ITEM_WIDTH, MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT, BACKGROUND);
+      } else {
+        LOG_W("Kein Speicher für den Bildpuffer des Menüs, zeichne direkt");
+      }
     }
     
+    // Alle Menüpunkte zeichnen
+    drawList(true);
+    
     needsFullRedraw = false;
   } else {
     // Partielles Redraw - nur was sich geändert hat
@@ -118,44 +151,149 @@ void MenuSystem::drawMenu(bool fullRedraw) {
     // Scroll-Pfeile aktualisieren, falls nötig
     if (prevTouchedUpScroll != touchedUpScroll || 
         prevTouchedDownScroll != touchedDownScroll ||
-        prevScrollPosition != scrollPosition) {
+        prevCanScrollUp != canScrollUp() ||
+        prevCanScrollDown != canScrollDown()) {
       drawScrollArrows();
     }
     
-    // Menüpunkte bei Bedarf neu zeichnen
-    int maxItems = tabs[currentTab].items.size();
-    if (prevScrollPosition != scrollPosition) {
-      // Bei Scroll-Änderung alle sichtbaren Punkte neu zeichnen
-      for (int i = 0; i < min(MENU_VISIBLE_ITEMS, maxItems - scrollPosition); i++) {
-        drawMenuItem(i + scrollPosition, i, (i + scrollPosition) == touchedMenuItem);
-      }
-    } else if (previousTouchedMenuItem != touchedMenuItem) {
-      // Nur die geänderten Elemente neu zeichnen
-      if (previousTouchedMenuItem >= 0 && 
-          previousTouchedMenuItem >= scrollPosition && 
-          previousTouchedMenuItem < scrollPosition + MENU_VISIBLE_ITEMS) {
-        drawMenuItem(previousTouchedMenuItem, previousTouchedMenuItem - scrollPosition, false);
-      }
-      
-      if (touchedMenuItem >= 0 && 
-          touchedMenuItem >= scrollPosition && 
-          touchedMenuItem < scrollPosition + MENU_VISIBLE_ITEMS) {
-        drawMenuItem(touchedMenuItem, touchedMenuItem - scrollPosition, true);
-      }
+    // Hervorhebung sofort, Verschiebung höchstens einmal je Bildintervall;
+    // der Rest folgt aus update()
+    if (previousTouchedMenuItem != touchedMenuItem ||
+        (scrollOffset != drawnOffset && millis() - lastFrame >= MENU_FRAME_INTERVAL)) {
+      drawList(false);
     }
   }
   
   // Speichere aktuelle Zustände für nächstes partielles Redraw
-  prevScrollPosition = scrollPosition;
   previousTouchedMenuItem = touchedMenuItem;
   prevTouchedUpScroll = touchedUpScroll;
   prevTouchedDownScroll = touchedDownScroll;
+  prevCanScrollUp = canScrollUp();
+  prevCanScrollDown = canScrollDown();
+}
+
+void MenuSystem::drawList(bool full) {
+  unsigned long start = micros();
+  const int height = MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT;
+  
+  // Ohne Puffer direkt auf das Display, beschnitten auf den Listenbereich;
+  // verschieben lässt sich dort nichts, also immer alles zeichnen
+  bool sprite = list.created();
+  TFT_eSPI &target = sprite ? (TFT_eSPI&)list : tft;
+  if (!sprite) {
+    tft.setViewport(MENU_START_X, MENU_START_Y, MENU_ITEM_WIDTH, height);
+    full = true;
+  }
+  
+  // Listenpixel [first, last), die nach dem Verschieben neu zu zeichnen sind
+  int delta = scrollOffset - drawnOffset;
+  int first = 0;
+  int last = 0;
+  if (full || abs(delta) >= height) {
+    target.fillRect(0, 0, MENU_ITEM_WIDTH, height, BACKGROUND);
+    first = scrollOffset;
+    last = scrollOffset + height;
+  } else if (delta != 0) {
+    // Vorhandene Pixel verschieben, nur der frei gewordene Streifen fehlt
+    list.scroll(0, -delta);
+    first = delta > 0 ? scrollOffset + height - delta : scrollOffset;
+    last = delta > 0 ? scrollOffset + height : scrollOffset - delta;
+  }
+  
+  int count = rowCount();
+  for (int index = max(0, first / MENU_ITEM_HEIGHT); index < count && index * MENU_ITEM_HEIGHT < last; index++) {
+    drawRow(target, index);
+  }
+  
+  // Geänderte Hervorhebung, sofern nicht schon im Streifen gezeichnet
+  if (!full && previousTouchedMenuItem != touchedMenuItem) {
+    int rows[2] = { previousTouchedMenuItem, touchedMenuItem };
+    for (int index : rows) {
+      if (index >= 0 && (index * MENU_ITEM_HEIGHT + MENU_ITEM_HEIGHT <= first || index * MENU_ITEM_HEIGHT >= last)) {
+        drawRow(target, index);
+      }
+    }
+  }
+  
+  if (sprite) {
+    list.pushSprite(MENU_START_X, MENU_START_Y);
+  } else {
+    tft.resetViewport();
+  }
+  drawnOffset = scrollOffset;
+  
+  uint32_t elapsed = micros() - start;
+  lastFrame = millis();
+  frames++;
+  frameTime += elapsed;
+  frameTimeMax = max(frameTimeMax, elapsed);
+}
+
+MenuModel::NodeId MenuSystem::currentNode() const {
+  MenuModel::NodeId node = menu.tab(currentTab);
+  for (uint8_t i = 0; i < depth; i++) {
+    node = menu.child(node, path[i]);
+  }
+  return node;
+}
+
+int MenuSystem::rowCount() const {
+  return menu.childCount(currentNode()) + (depth > 0 ? 1 : 0);
+}
+
+MenuModel::NodeId MenuSystem::rowNode(int row) const {
+  if (depth > 0) {
+    if (row == 0) {
+      return MenuModel::NONE;
+    }
+    row--;
+  }
+  return menu.child(currentNode(), row);
+}
+
+int MenuSystem::visibleTabs() const {
+  int count = menu.tabCount();
+  if (count * TAB_WIDTH <= SCREEN_WIDTH - 20) {
+    return count;
+  }
+  // Links und rechts Platz für die Blätterpfeile
+  return max(1, (SCREEN_WIDTH - 2 * TAB_ARROW_WIDTH - 20) / TAB_WIDTH);
+}
+
+int MenuSystem::tabX(int index) const {
+  return (tabPaging() ? TAB_ARROW_WIDTH : 0) + (index - tabOffset) * TAB_WIDTH + 10;
+}
+
+void MenuSystem::keepTabVisible() {
+  int visible = visibleTabs();
+  if (currentTab < tabOffset) {
+    tabOffset = currentTab;
+  } else if (currentTab >= tabOffset + visible) {
+    tabOffset = currentTab - visible + 1;
+  }
+  if (tabOffset + visible > menu.tabCount()) {
+    tabOffset = max(0, menu.tabCount() - visible);
+  }
+}
+
+void MenuSystem::selectTab(int index) {
+  if (index < 0 || index >= menu.tabCount()) {
+    return;
+  }
+  currentTab = index;
+  depth = 0;
+  scrollOffset = 0;  // Zurück zum Anfang bei Tab-Wechsel
+  stopFling();
+  keepTabVisible();
+  needsFullRedraw = true; // Vollständiges Redraw erforderlich
 }
 
 void MenuSystem::drawTabs() {
-  for (size_t i = 0; i < tabs.size(); i++) {
-    int tabX = i * TAB_WIDTH + 10;
-    uint16_t tabColor = (i == (size_t)currentTab) ? TAB_ACTIVE_COLOR : TAB_INACTIVE_COLOR;
+  int lastTab = min(tabOffset + visibleTabs(), (int)menu.tabCount());
+  for (int i = tabOffset; i < lastTab; i++) {
+    int tabX = this->tabX(i);
+    uint16_t tabColor = (i == currentTab) ? TAB_ACTIVE_COLOR : TAB_INACTIVE_COLOR;
+    const char* title = menu.label(menu.tab(i));
     
     // Tab zeichnen
     tft.fillRoundRect(tabX, 10, TAB_WIDTH - 5, TAB_HEIGHT, 5, tabColor);
@@ -166,11 +304,21 @@ void MenuSystem::drawTabs() {
     tft.setTextSize(1);
     
     // Text zentrieren
-    int textWidth = tabs[i].title.length() * 6; // Ungefähre Breite bei Textgröße 1
+    int textWidth = strlen(title) * 6; // Ungefähre Breite bei Textgröße 1
     int textX = tabX + (TAB_WIDTH - 5 - textWidth) / 2;
     
     tft.setCursor(textX, 22);
-    tft.print(tabs[i].title);
+    tft.print(title);
+  }
+  
+  // Blätterpfeile, grau nur wenn in diese Richtung noch Tabs folgen
+  if (tabPaging()) {
+    int arrowY = 10 + TAB_HEIGHT / 2;
+    int rightX = SCREEN_WIDTH - TAB_ARROW_WIDTH;
+    tft.fillTriangle(4, arrowY, TAB_ARROW_WIDTH - 4, arrowY - 8, TAB_ARROW_WIDTH - 4, arrowY + 8,
+                     currentTab > 0 ? SCROLL_INACTIVE_COLOR : BACKGROUND);
+    tft.fillTriangle(rightX + TAB_ARROW_WIDTH - 4, arrowY, rightX + 4, arrowY - 8, rightX + 4, arrowY + 8,
+                     currentTab < menu.tabCount() - 1 ? SCROLL_INACTIVE_COLOR : BACKGROUND);
   }
   
   // Bereich zwischen Tabs und Menü löschen
@@ -190,16 +338,17 @@ void MenuSystem::drawStatusBar() {
   tft.print("Menü aktiv");
 }
 
-void MenuSystem::drawMenuItem(int index, int screenIndex, bool selected) {
-  if (currentTab >= (int)tabs.size() || index >= (int)tabs[currentTab].items.size()) {
+void MenuSystem::drawRow(TFT_eSPI &target, int index) {
+  if (currentTab >= menu.tabCount() || index >= rowCount()) {
     return;  // Sicherheitscheck
   }
   
-  int y = MENU_START_Y + screenIndex * MENU_ITEM_HEIGHT;
+  // Relativ zum Listenbereich; Zeilen am Rand schneidet das Ziel ab
+  int y = index * MENU_ITEM_HEIGHT - scrollOffset;
   uint16_t itemColor;
   uint16_t textColor;
   
-  if (selected) {
+  if (index == touchedMenuItem) {
     // Aktuell berührt
     itemColor = HIGHLIGHT_COLOR;
     textColor = TEXT_COLOR;
@@ -213,15 +362,26 @@ void MenuSystem::drawMenuItem(int index, int screenIndex, bool selected) {
     textColor = TEXT_COLOR;
   }
   
-  // Rechteck um Menüpunkt zeichnen
-  tft.fillRoundRect(MENU_START_X, y, MENU_ITEM_WIDTH, MENU_ITEM_HEIGHT - 5, 5, itemColor);
-  tft.drawRoundRect(MENU_START_X, y, MENU_ITEM_WIDTH, MENU_ITEM_HEIGHT - 5, 5, BORDER_COLOR);
+  // Rechteck um Menüpunkt zeichnen, samt Abstand zur nächsten Zeile
+  target.fillRect(0, y, MENU_ITEM_WIDTH, MENU_ITEM_HEIGHT, BACKGROUND);
+  target.fillRoundRect(0, y, MENU_ITEM_WIDTH, MENU_ITEM_HEIGHT - 5, 5, itemColor);
+  target.drawRoundRect(0, y, MENU_ITEM_WIDTH, MENU_ITEM_HEIGHT - 5, 5, BORDER_COLOR);
   
   // Text zeichnen
-  tft.setTextColor(textColor, itemColor);
-  tft.setTextSize(2);
-  tft.setCursor(MENU_START_X + 20, y + (MENU_ITEM_HEIGHT - 5)/2 - 7);
-  tft.print(tabs[currentTab].items[index].name);
+  target.setTextColor(textColor, itemColor);
+  target.setTextSize(2);
+  target.setCursor(20, y + (MENU_ITEM_HEIGHT - 5)/2 - 7);
+  MenuModel::NodeId node = rowNode(index);
+  if (node == MenuModel::NONE) {
+    // Zurück zur übergeordneten Ebene
+    target.print("< ");
+    target.print(menu.label(currentNode()));
+  } else {
+    target.print(menu.label(node));
+    if (menu.hasChildren(node)) {
+      target.print(" >");
+    }
+  }
 }
 
 void MenuSystem::drawScrollArrows() {
@@ -234,7 +394,7 @@ void MenuSystem::drawScrollArrows() {
   
   // Pfeil nach oben
   int upArrowY = MENU_START_Y + MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT / 2 - 30;
-  if (scrollPosition > 0) {
+  if (canScrollUp()) {
     uint16_t arrowColor = touchedUpScroll ? SCROLL_ACTIVE_COLOR : SCROLL_INACTIVE_COLOR;
     
     tft.fillTriangle(
@@ -247,7 +407,7 @@ void MenuSystem::drawScrollArrows() {
   
   // Pfeil nach unten
   int downArrowY = MENU_START_Y + MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT / 2 + 10;
-  if (scrollPosition < (int)tabs[currentTab].items.size() - MENU_VISIBLE_ITEMS) {
+  if (canScrollDown()) {
     uint16_t arrowColor = touchedDownScroll ? SCROLL_ACTIVE_COLOR : SCROLL_INACTIVE_COLOR;
     
     tft.fillTriangle(
@@ -258,7 +418,7 @@ void MenuSystem::drawScrollArrows() {
     );
   }
 }
-void MenuSystem::handleTouch(int x, int y) {
+void MenuSystem::handleGesture(const Gesture &gesture) {
   // Speichere vorherige Zustände für partielles Redraw
   prevTouchedUpScroll = touchedUpScroll;
   prevTouchedDownScroll = touchedDownScroll;
@@ -269,14 +429,115 @@ void MenuSystem::handleTouch(int x, int y) {
   touchedDownScroll = false;
   touchedMenuItem = -1;
   
+  switch (gesture.type) {
+    case GESTURE_TAP:
+    case GESTURE_LONG_PRESS:
+      // Tippen in die laufende Liste hält sie nur an
+      if (isScrolling()) {
+        stopFling();
+        break;
+      }
+      handleTap(gesture.x, gesture.y);
+      break;
+    
+    case GESTURE_SWIPE:
+      if (gesture.horizontal()) {
+        // Nach links wischen zeigt den nächsten Tab
+        selectTab(currentTab + (gesture.dx < 0 ? 1 : -1));
+        break;
+      }
+      // Senkrecht: wie Loslassen nach dem Ziehen
+      startFling(-gesture.vy);
+      break;
+    
+    case GESTURE_DRAG:
+      // Inhalt folgt dem Finger: nach oben ziehen zeigt spätere Einträge
+      stopFling();
+      scrollTo(scrollOffset - gesture.dy);
+      break;
+    
+    case GESTURE_DRAG_END:
+      // Ohne Schwung beim Loslassen ist vy 0
+      startFling(-gesture.vy);
+      break;
+    
+    default:
+      break;
+  }
+}
+
+void MenuSystem::update() {
+  unsigned long now = millis();
+  if (now - lastFrame < MENU_FRAME_INTERVAL) {
+    return;
+  }
+  
+  if (isScrolling()) {
+    // Weg in px*ms/s, Bruchteile eines Pixels gehen ins nächste Bild
+    int32_t dt = min(now - flingTime, 100UL);
+    flingTime = now;
+    int32_t travel = flingVelocity * dt + flingRemainder;
+    flingRemainder = travel % 1000;
+    int target = scrollOffset + travel / 1000;
+    scrollTo(target);
+    
+    // Exponentiell abklingend, am Rand sofort Schluss
+    flingVelocity -= flingVelocity * dt / MENU_FLING_FRICTION;
+    if (abs(flingVelocity) < MENU_FLING_MIN_SPEED || target != scrollOffset) {
+      stopFling();
+    }
+  }
+  
+  if (scrollOffset != drawnOffset) {
+    drawMenu();
+  }
+}
+
+void MenuSystem::startFling(int32_t velocity) {
+  if (abs(velocity) < MENU_FLING_MIN_SPEED) {
+    stopFling();
+    return;
+  }
+  flingVelocity = constrain(velocity, (int32_t)-MENU_FLING_MAX_SPEED, (int32_t)MENU_FLING_MAX_SPEED);
+  flingRemainder = 0;
+  flingTime = millis();
+}
+
+int MenuSystem::maxScroll() const {
+  return max(0, (rowCount() - MENU_VISIBLE_ITEMS) * MENU_ITEM_HEIGHT);
+}
+
+void MenuSystem::scrollTo(int offset) {
+  scrollOffset = constrain(offset, 0, maxScroll());
+}
+
+void MenuSystem::scrollBy(int rows) {
+  // Pfeile rasten auf ganze Zeilen ein
+  stopFling();
+  scrollTo((scrollOffset / MENU_ITEM_HEIGHT + rows) * MENU_ITEM_HEIGHT);
+}
+
+void MenuSystem::handleTap(int x, int y) {
+  // Blätterpfeile der Tableiste wechseln zum vorigen bzw. nächsten Tab
+  if (tabPaging()) {
+    if (isInBounds(x, y, 0, 10, TAB_ARROW_WIDTH, TAB_HEIGHT)) {
+      selectTab(currentTab - 1);
+      return;
+    }
+    if (isInBounds(x, y, SCREEN_WIDTH - TAB_ARROW_WIDTH, 10, SCREEN_WIDTH, TAB_HEIGHT)) {
+      selectTab(currentTab + 1);
+      return;
+    }
+  }
+  
   // Prüfe, ob ein Tab berührt wurde
-  for (size_t i = 0; i < tabs.size(); i++) {
-    int tabX = i * TAB_WIDTH + 10;
+  int lastTab = min(tabOffset + visibleTabs(), (int)menu.tabCount());
+  for (int i = tabOffset; i < lastTab; i++) {
+    int tabX = this->tabX(i);
     if (isInBounds(x, y, tabX, 10, tabX + TAB_WIDTH - 5, TAB_HEIGHT)) {
-      if (currentTab != (int)i) {
-        currentTab = i;
-        scrollPosition = 0;  // Zurück zum Anfang bei Tab-Wechsel
-        needsFullRedraw = true; // Vollständiges Redraw erforderlich
+      // Auch im selben Tab zurück zu dessen Einträgen
+      if (currentTab != i || depth > 0) {
+        selectTab(i);
       }
       return; // Weitere Prüfungen überspringen
     }
@@ -286,35 +547,54 @@ void MenuSystem::handleTouch(int x, int y) {
   int arrowX = MENU_START_X + MENU_ITEM_WIDTH + 10;
   int upArrowY = MENU_START_Y + MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT / 2 - 30;
   
-  if (scrollPosition > 0 && 
+  if (canScrollUp() && 
       isInBounds(x, y, arrowX, upArrowY, arrowX + SCROLL_ARROW_WIDTH, upArrowY + 15)) {
-    scrollPosition--;
+    // Angeschnittene oberste Zeile zuerst ganz zeigen
+    scrollBy(scrollOffset % MENU_ITEM_HEIGHT ? 0 : -1);
     touchedUpScroll = true;
     return;
   }
   
   // Prüfe auf Scroll-nach-unten Button
   int downArrowY = MENU_START_Y + MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT / 2 + 10;
-  if (scrollPosition < (int)tabs[currentTab].items.size() - MENU_VISIBLE_ITEMS && 
+  if (canScrollDown() && 
       isInBounds(x, y, arrowX, downArrowY, arrowX + SCROLL_ARROW_WIDTH, downArrowY + 15)) {
-    scrollPosition++;
+    scrollBy(1);
     touchedDownScroll = true;
     return;
   }
   
-  // Prüfe, ob ein Menüpunkt berührt wurde
-  for (int i = 0; i < min(MENU_VISIBLE_ITEMS, (int)tabs[currentTab].items.size() - scrollPosition); i++) {
-    int index = i + scrollPosition;
-    int menuItemY = MENU_START_Y + i * MENU_ITEM_HEIGHT;
+  // Prüfe, ob ein Menüpunkt berührt wurde; auch angeschnittene Zeilen am Rand
+  int listBottom = MENU_START_Y + MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT - 1;
+  if (isInBounds(x, y, MENU_START_X, MENU_START_Y, MENU_START_X + MENU_ITEM_WIDTH, listBottom)) {
+    int index = (y - MENU_START_Y + scrollOffset) / MENU_ITEM_HEIGHT;
     
-    if (isInBounds(x, y, 
-                  MENU_START_X, menuItemY, 
-                  MENU_START_X + MENU_ITEM_WIDTH, menuItemY + MENU_ITEM_HEIGHT)) {
+    if (index < rowCount()) {
+      MenuModel::NodeId node = rowNode(index);
+      if (node == MenuModel::NONE) {
+        // Zurück: das verlassene Untermenü bleibt sichtbar
+        depth--;
+        int row = path[depth] + (depth > 0 ? 1 : 0);
+        scrollTo(row * MENU_ITEM_HEIGHT);
+        needsFullRedraw = true;
+        return;
+      }
+      if (menu.hasChildren(node)) {
+        // Untermenü öffnen
+        if (depth < MENU_MAX_DEPTH) {
+          path[depth] = index - (depth > 0 ? 1 : 0);
+          depth++;
+          scrollOffset = 0;
+          needsFullRedraw = true;
+        }
+        return;
+      }
+      
       touchedMenuItem = index;
       
       // Menüauswahl verarbeiten, wenn Callback gesetzt ist
       if (onMenuSelection) {
-        onMenuSelection(tabs[currentTab].items[index].functionName);
+        onMenuSelection(menu.function(node));
       }
       
       // Menüpunkt als ausgewählt markieren
@@ -325,16 +605,43 @@ void MenuSystem::handleTouch(int x, int y) {
   }
 }
 
+void MenuSystem::printStatus(Print &out) {
+  out.print("Bildpuffer: ");
+  if (list.created()) {
+    out.print(MENU_ITEM_WIDTH);
+    out.print("x");
+    out.print(MENU_VISIBLE_ITEMS * MENU_ITEM_HEIGHT);
+    out.print(", ");
+    out.print(MENU_SPRITE_DEPTH);
+    out.println(" Bit");
+  } else {
+    out.println("keiner, Zeilen werden direkt gezeichnet");
+  }
+  out.print("Bilder: ");
+  out.print(frames);
+  if (frames > 0) {
+    uint32_t average = frameTime / frames;
+    out.print(", Dauer ");
+    out.print(average);
+    out.print(" us (max ");
+    out.print(frameTimeMax);
+    out.print(" us), möglich ");
+    out.print(average > 0 ? 1000000UL / average : 0);
+    out.print(" fps");
+  }
+  out.println();
+}
+
 // Hilfsfunktion zur Überprüfung der Bereichsgrenzen
 bool MenuSystem::isInBounds(int x, int y, int x1, int y1, int x2, int y2) {
   return (x >= x1 && x <= x2 && y >= y1 && y <= y2);
 }
 
 // Funktion zur Rückgabe der aktuell ausgewählten Funktion
-String MenuSystem::getSelectedFunction() const {
-  if (currentTab >= 0 && currentTab < (int)tabs.size() && 
-      selectedMenuItem >= 0 && selectedMenuItem < (int)tabs[currentTab].items.size()) {
-    return tabs[currentTab].items[selectedMenuItem].functionName;
+const char* MenuSystem::getSelectedFunction() const {
+  if (currentTab >= 0 && currentTab < menu.tabCount() && 
+      selectedMenuItem >= 0 && selectedMenuItem < rowCount()) {
+    return menu.function(rowNode(selectedMenuItem));
   }
   return "";
 }
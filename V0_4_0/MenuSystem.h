@@ -1,5 +1,12 @@
 /**
  * MenuSystem.h - Verwaltet das Touch-Menü mit JSON-Konfiguration
+ *
+ * Die Liste scrollt pixelgenau: Ziehen verschiebt sie mit dem Finger,
+ * nach dem Loslassen läuft sie mit abklingendem Schwung weiter. Gezeichnet
+ * wird in einen Bildpuffer (Sprite) von der Größe der Liste; beim Scrollen
+ * werden dessen Pixel verschoben und nur die frei gewordenen Zeilen neu
+ * gezeichnet, höchstens alle MENU_FRAME_INTERVAL ms. Reicht der Speicher
+ * für den Puffer nicht, werden die sichtbaren Zeilen direkt gezeichnet.
  */
 
 #ifndef MENU_SYSTEM_H
@@ -7,38 +14,21 @@
 
 #include <Arduino.h>
 #include <TFT_eSPI.h>
-#include <vector>
 #include <functional>
 #include "config.h"
-
-class MenuItem {
-public:
-  String name;
-  String functionName;
-  
-  MenuItem(const String &name, const String &functionName) 
-    : name(name), functionName(functionName) {}
-};
-
-class MenuTab {
-public:
-  String title;
-  std::vector<MenuItem> items;
-  
-  MenuTab(const String &title) : title(title) {}
-  
-  void addItem(const MenuItem &item) {
-    items.push_back(item);
-  }
-};
+#include "MenuModel.h"
+#include "TouchInput.h"
 
 class MenuSystem {
 private:
   TFT_eSPI &tft;
-  std::vector<MenuTab> tabs;
+  MenuModel menu;
   
   int currentTab = 0;
-  int scrollPosition = 0;
+  int tabOffset = 0;         // Erster sichtbarer Tab beim Blättern
+  uint8_t path[MENU_MAX_DEPTH];  // Index je geöffnetem Untermenü
+  uint8_t depth = 0;         // 0 = Einträge des Tabs
+  int scrollOffset = 0;      // px vom Listenanfang bis zur obersten sichtbaren Zeile
   int selectedMenuItem = -1;
   int touchedMenuItem = -1;
   
@@ -48,39 +38,90 @@ private:
   bool needsFullRedraw = true;
   
   // Vorherige Zustände für partielles Redraw
-  int prevScrollPosition = 0;
+  int drawnOffset = 0;       // scrollOffset des Bildes im Puffer
   int previousTouchedMenuItem = -1;
   bool prevTouchedUpScroll = false;
   bool prevTouchedDownScroll = false;
+  bool prevCanScrollUp = false;
+  bool prevCanScrollDown = false;
+  
+  // Schwung nach dem Loslassen
+  int32_t flingVelocity = 0; // px/s, positiv: Liste läuft nach oben
+  int32_t flingRemainder = 0;  // Angefangene Pixel in px*ms/s
+  unsigned long flingTime = 0;
+  
+  // Bildpuffer der Liste und Zeichenzeiten
+  TFT_eSprite list;
+  unsigned long lastFrame = 0;
+  uint32_t frames = 0;
+  uint32_t frameTime = 0;    // µs, Summe
+  uint32_t frameTimeMax = 0;
+  
+  // Menü aus der Datei bzw. dem Standardmenü (default_data.h)
+  bool readMenu(const String &filename, MenuModel &result);
+  
+  // Angezeigte Ebene; in Untermenüs ist Zeile 0 "Zurück"
+  MenuModel::NodeId currentNode() const;
+  int rowCount() const;
+  MenuModel::NodeId rowNode(int row) const;  // NONE für "Zurück"
+  
+  // Tableiste: passen nicht alle Tabs, wird mit Pfeilen geblättert
+  int visibleTabs() const;
+  bool tabPaging() const { return visibleTabs() < menu.tabCount(); }
+  int tabX(int index) const;
+  void selectTab(int index);
+  void keepTabVisible();
+  
+  void handleTap(int x, int y);
+  void scrollBy(int rows);
+  void scrollTo(int offset);
+  int maxScroll() const;
+  bool canScrollUp() const { return scrollOffset > 0; }
+  bool canScrollDown() const { return scrollOffset < maxScroll(); }
+  void startFling(int32_t velocity);
+  void stopFling() { flingVelocity = 0; }
+  
+  // Liste zeichnen; ohne full nur Verschiebung und geänderte Hervorhebung
+  void drawList(bool full);
+  void drawRow(TFT_eSPI &target, int index);
   
 public:
-  MenuSystem(TFT_eSPI &tft) : tft(tft) {}
+  MenuSystem(TFT_eSPI &tft) : tft(tft), list(&tft) {}
   
   // Menü-Verwaltung
-  void addTab(const String &title);
-  void addMenuItem(const String &tabTitle, const String &name, const String &functionName);
   bool loadFromJson(const String &filename);
   
+  // Menü neu laden; liefert die Anzahl geänderter Tabs. Ist der sichtbare
+  // Tab betroffen, zeichnet der nächste drawMenu() neu
+  int reload(const String &filename);
+  bool needsRedraw() const { return needsFullRedraw; }
+  
   // Zeichnen-Funktionen
   void drawMenu(bool fullRedraw = false);
   void drawTabs();
   void drawStatusBar();
-  void drawMenuItem(int index, int screenIndex, bool selected);
   void drawScrollArrows();
   
-  // Touch-Handling
-  void handleTouch(int x, int y);
+  // Touch-Handling: Tippen wählt, waagrecht Wischen wechselt den Tab,
+  // senkrechtes Ziehen scrollt mit dem Finger und gibt Schwung
+  void handleGesture(const Gesture &gesture);
+  
+  // Aus loop(), solange das Menü sichtbar ist: Schwung und ausstehende Bilder
+  void update();
+  bool isScrolling() const { return flingVelocity != 0; }
+  
+  void printStatus(Print &out);
   bool isInBounds(int x, int y, int x1, int y1, int x2, int y2);
   
   // Getter/Setter
   int getCurrentTab() const { return currentTab; }
   int getSelectedMenuItem() const { return selectedMenuItem; }
-  String getSelectedFunction() const;
+  const char* getSelectedFunction() const;
   
   bool isMenuActive() const { return selectedMenuItem < 0; }
   void resetSelection() { selectedMenuItem = -1; touchedMenuItem = -1; }
   
-  typedef std::function<void(const String&)> MenuCallback;
+  typedef std::function<void(const char*)> MenuCallback;
   MenuCallback onMenuSelection = nullptr;
 };
 
@@ -0,0 +1,794 @@
+/**
+ * MqttClient.cpp - Implementierung des nicht blockierenden MQTT-Clients
+ */
+
+#define LOG_MODULE LOG_MOD_MQTT
+
+#include "MqttClient.h"
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <unistd.h>
+#include <errno.h>
+
+// MQTT-Pakettypen (oberes Nibble des ersten Bytes)
+static const uint8_t MQTT_CONNECT = 0x10;
+static const uint8_t MQTT_CONNACK = 0x20;
+static const uint8_t MQTT_PUBLISH = 0x30;
+static const uint8_t MQTT_PUBACK = 0x40;
+static const uint8_t MQTT_SUBSCRIBE = 0x82;  // inkl. vorgeschriebener Flags
+static const uint8_t MQTT_SUBACK = 0x90;
+static const uint8_t MQTT_UNSUBSCRIBE = 0xA2;  // inkl. vorgeschriebener Flags
+static const uint8_t MQTT_PINGREQ = 0xC0;
+static const uint8_t MQTT_PINGRESP = 0xD0;
+static const uint8_t MQTT_DISCONNECT = 0xE0;
+
+static const uint8_t PUBLISH_DUP = 0x08;
+
+MqttClient::MqttClient() {
+  // Konstruktor
+}
+
+MqttClient::~MqttClient() {
+  closeSocket(0);
+}
+
+void MqttClient::setServer(const char* host, uint16_t port) {
+  this->host = host;
+  this->port = port;
+  resolved = false;
+}
+
+size_t MqttClient::encodeLength(uint8_t* out, size_t length) {
+  size_t used = 0;
+  do {
+    uint8_t digit = length % 128;
+    length /= 128;
+    out[used++] = length > 0 ? (digit | 0x80) : digit;
+  } while (length > 0);
+  return used;
+}
+
+uint16_t MqttClient::allocatePacketId() {
+  uint16_t id = nextPacketId++;
+  if (nextPacketId == 0) {
+    nextPacketId = 1;  // 0 ist laut Spezifikation ungültig
+  }
+  return id;
+}
+
+bool MqttClient::connect(const char* clientId) {
+  if (state != DISCONNECTED) {
+    return true;  // Verbindungsaufbau läuft bereits
+  }
+  this->clientId = clientId;
+
+  // Adresse nur einmal auflösen; IP-Adressen ohne DNS-Anfrage
+  if (!resolved && !address.fromString(host.c_str())) {
+    // Eine noch laufende Auflösung abwarten statt eine zweite zu starten
+    if (resolveState != RESOLVE_RUNNING) {
+      resolveHost = host;
+      resolveState = RESOLVE_RUNNING;
+      if (xTaskCreatePinnedToCore(resolveTask, "mqtt_dns", MQTT_DNS_TASK_STACK, this, 1, nullptr, 0) != pdPASS) {
+        resolveState = RESOLVE_IDLE;
+        lastError = ENOMEM;
+        return false;
+      }
+    }
+    state = RESOLVING;
+    return true;
+  }
+  resolved = true;
+  return openSocket();
+}
+
+void MqttClient::resolveTask(void* param) {
+  // WiFi.hostByName() wartet auf die DNS-Antwort, daher nicht in loop()
+  MqttClient* self = (MqttClient*)param;
+  IPAddress result;
+  bool found = WiFi.hostByName(self->resolveHost.c_str(), result) == 1;
+  self->resolveResult = result;
+  self->resolveState = found ? RESOLVE_DONE : RESOLVE_FAILED;
+  vTaskDelete(nullptr);
+}
+
+bool MqttClient::pollResolve() {
+  ResolveState result = resolveState;
+  if (result == RESOLVE_RUNNING) {
+    return false;
+  }
+  resolveState = RESOLVE_IDLE;
+  state = DISCONNECTED;
+
+  // Nach setServer() gilt das Ergebnis nicht mehr
+  if (result != RESOLVE_DONE || resolveHost != host) {
+    lastError = EHOSTUNREACH;
+    return false;
+  }
+  address = resolveResult;
+  resolved = true;
+  return openSocket();
+}
+
+bool MqttClient::openSocket() {
+  sockfd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (sockfd < 0) {
+    lastError = errno;
+    return false;
+  }
+  fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL, 0) | O_NONBLOCK);
+  int one = 1;
+  setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  struct sockaddr_in server;
+  memset(&server, 0, sizeof(server));
+  server.sin_family = AF_INET;
+  server.sin_port = htons(port);
+  server.sin_addr.s_addr = (uint32_t)address;
+
+  connectStarted = millis();
+  rxLength = txLength = 0;
+  pendingSubacks = 0;
+  pendingAckCount = 0;
+  pingOutstanding = false;
+  subscribeDuration = 0;
+
+  if (::connect(sockfd, (struct sockaddr*)&server, sizeof(server)) < 0 && errno != EINPROGRESS) {
+    closeSocket(errno);
+    return false;
+  }
+
+  state = TCP_CONNECTING;
+  return true;
+}
+
+void MqttClient::disconnect() {
+  if (state == CONNECTED) {
+    uint8_t packet[2] = {MQTT_DISCONNECT, 0};
+    send(sockfd, packet, sizeof(packet), MSG_DONTWAIT);
+  }
+  closeSocket(0);
+}
+
+void MqttClient::closeSocket(int error) {
+  if (sockfd >= 0) {
+    close(sockfd);
+    sockfd = -1;
+  }
+  if (error) {
+    lastError = error;
+  }
+  state = DISCONNECTED;
+  rxLength = txLength = 0;
+  pendingSubacks = 0;
+  pendingAckCount = 0;
+  
+  // Nach dem Reconnect abonniert der MqttManager ohnehin alle Filter neu
+  pendingFilters.clear();
+  pendingFilterIndex = 0;
+  
+  // Abgebrochene große Nachricht melden
+  if (streamRemaining > 0) {
+    streamRemaining = 0;
+    endStream(false);
+  }
+}
+
+bool MqttClient::pollConnect() {
+  // Schreibbereitschaft ohne Wartezeit abfragen
+  fd_set writeSet;
+  FD_ZERO(&writeSet);
+  FD_SET(sockfd, &writeSet);
+  struct timeval timeout = {0, 0};
+
+  int ready = select(sockfd + 1, nullptr, &writeSet, nullptr, &timeout);
+  if (ready < 0) {
+    closeSocket(errno);
+    return false;
+  }
+  if (ready == 0) {
+    return false;
+  }
+
+  int error = 0;
+  socklen_t length = sizeof(error);
+  getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &length);
+  if (error) {
+    closeSocket(error);
+    return false;
+  }
+
+  return sendConnect();
+}
+
+bool MqttClient::sendConnect() {
+  size_t idLength = clientId.length();
+  size_t remaining = 10 + 2 + idLength;
+
+  uint8_t header[16];
+  size_t used = 0;
+  header[used++] = MQTT_CONNECT;
+  used += encodeLength(header + used, remaining);
+  const uint8_t variable[10] = {
+    0, 4, 'M', 'Q', 'T', 'T',
+    4,                              // Protokollversion 3.1.1
+    0x02,                           // Clean Session
+    (uint8_t)(keepAlive >> 8), (uint8_t)(keepAlive & 0xFF)
+  };
+  memcpy(header + used, variable, sizeof(variable));
+  used += sizeof(variable);
+  header[used++] = idLength >> 8;
+  header[used++] = idLength & 0xFF;
+
+  if (!queuePacket(header, used) || !queuePacket((const uint8_t*)clientId.c_str(), idLength)) {
+    closeSocket(ENOBUFS);
+    return false;
+  }
+
+  state = MQTT_CONNECTING;
+  lastInbound = millis();
+  flush();
+  return true;
+}
+
+bool MqttClient::loop() {
+  unsigned long now = millis();
+
+  switch (state) {
+    case DISCONNECTED:
+      return false;
+
+    case RESOLVING:
+      pollResolve();
+      return false;
+
+    case TCP_CONNECTING:
+    case MQTT_CONNECTING:
+      if (now - connectStarted > MQTT_CONNECT_TIMEOUT) {
+        closeSocket(ETIMEDOUT);
+        return false;
+      }
+      if (state == TCP_CONNECTING && !pollConnect()) {
+        return false;
+      }
+      break;
+
+    case CONNECTED:
+      break;
+  }
+
+  flush();
+  receive();
+  if (state == CONNECTED) {
+    queuePendingAcks();
+    queuePendingFilters();
+    checkTimers(now);
+    flush();
+  }
+  return state == CONNECTED;
+}
+
+bool MqttClient::queuePacket(const uint8_t* data, size_t length) {
+  if (txLength + length > sizeof(txBuffer)) {
+    return false;
+  }
+  memcpy(txBuffer + txLength, data, length);
+  txLength += length;
+  return true;
+}
+
+bool MqttClient::queueAck(uint8_t type, uint16_t packetId) {
+  uint8_t packet[4] = {type, 2, (uint8_t)(packetId >> 8), (uint8_t)(packetId & 0xFF)};
+  return queuePacket(packet, sizeof(packet));
+}
+
+void MqttClient::acknowledge(uint16_t packetId) {
+  // Reihenfolge der PUBACKs wie beim Empfang: hinter bereits wartende stellen
+  if (pendingAckCount == 0 && queueAck(MQTT_PUBACK, packetId)) {
+    return;
+  }
+  if (pendingAckCount < MQTT_PENDING_ACKS) {
+    pendingAcks[pendingAckCount++] = packetId;
+  } else {
+    lostAcks++;
+  }
+}
+
+void MqttClient::queuePendingAcks() {
+  uint8_t sent = 0;
+  while (sent < pendingAckCount && queueAck(MQTT_PUBACK, pendingAcks[sent])) {
+    sent++;
+  }
+  if (sent > 0) {
+    pendingAckCount -= sent;
+    memmove(pendingAcks, pendingAcks + sent, pendingAckCount * sizeof(pendingAcks[0]));
+  }
+}
+
+void MqttClient::flush() {
+  if (txLength == 0 || sockfd < 0) {
+    return;
+  }
+
+  int sent = send(sockfd, txBuffer, txLength, MSG_DONTWAIT);
+  if (sent < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      closeSocket(errno);
+    }
+    return;
+  }
+
+  txLength -= sent;
+  if (txLength > 0) {
+    memmove(txBuffer, txBuffer + sent, txLength);
+  }
+  lastOutbound = millis();
+}
+
+void MqttClient::receive() {
+  while (sockfd >= 0 && rxLength < sizeof(rxBuffer)) {
+    int received = recv(sockfd, rxBuffer + rxLength, sizeof(rxBuffer) - rxLength, MSG_DONTWAIT);
+    if (received == 0) {
+      closeSocket(ECONNRESET);  // Gegenstelle hat geschlossen
+      return;
+    }
+    if (received < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        closeSocket(errno);
+      }
+      return;
+    }
+    lastInbound = millis();
+    rxLength += received;
+
+    // Alle vollständigen Pakete im Puffer verarbeiten
+    size_t offset = 0;
+    while (offset < rxLength && sockfd >= 0) {
+      // Fortsetzung einer großen Nachricht weiterreichen oder verwerfen
+      if (streamRemaining > 0) {
+        size_t length = min(streamRemaining, rxLength - offset);
+        if (streamActive && onStreamData) {
+          onStreamData(rxBuffer + offset, length);
+        }
+        streamRemaining -= length;
+        offset += length;
+        if (streamRemaining == 0) {
+          endStream(true);
+        }
+        continue;
+      }
+
+      size_t remaining = 0;
+      size_t headerLength = 1;
+      int shift = 0;
+      bool complete = false;
+      while (offset + headerLength < rxLength && headerLength <= 4) {
+        uint8_t digit = rxBuffer[offset + headerLength++];
+        remaining |= (size_t)(digit & 0x7F) << shift;
+        shift += 7;
+        if (!(digit & 0x80)) {
+          complete = true;
+          break;
+        }
+      }
+      if (!complete) {
+        if (headerLength > 4) {
+          closeSocket(EPROTO);  // Ungültige Längenkodierung
+          return;
+        }
+        break;
+      }
+
+      size_t total = headerLength + remaining;
+      if (total > sizeof(rxBuffer)) {
+        // Passt nie in den Puffer: als Strom weiterreichen oder überspringen
+        int consumed = beginStream(rxBuffer + offset, rxLength - offset, headerLength, remaining);
+        if (consumed < 0) {
+          break;  // Kopf noch unvollständig
+        }
+        offset += consumed;
+        continue;
+      }
+      if (offset + total > rxLength) {
+        break;
+      }
+
+      if (!processPacket(rxBuffer + offset, headerLength, remaining)) {
+        return;
+      }
+      offset += total;
+    }
+
+    if (sockfd < 0) {
+      return;
+    }
+    rxLength -= offset;
+    if (rxLength > 0 && offset > 0) {
+      memmove(rxBuffer, rxBuffer + offset, rxLength);
+    }
+  }
+}
+
+bool MqttClient::processPacket(uint8_t* packet, size_t headerLength, size_t remainingLength) {
+  uint8_t type = packet[0] & 0xF0;
+  uint8_t* body = packet + headerLength;
+  uint16_t packetId = remainingLength >= 2 ? (body[0] << 8) | body[1] : 0;
+
+  switch (type) {
+    case MQTT_CONNACK:
+      if (state != MQTT_CONNECTING || remainingLength < 2) {
+        break;
+      }
+      if (body[1] != 0) {
+        closeSocket(body[1]);  // Vom Broker abgelehnt
+        return false;
+      }
+      state = CONNECTED;
+      connectDuration = millis() - connectStarted;
+      reconnectCount++;
+      // Unbestätigte QoS-1-Nachrichten der letzten Verbindung erneut senden
+      retransmit(millis(), true);
+      break;
+
+    case MQTT_PUBLISH:
+      handlePublish(packet[0] & 0x0F, body, remainingLength);
+      break;
+
+    case MQTT_PUBACK:
+      for (auto& slot : inFlight) {
+        if (slot.packetId == packetId) {
+          slot.packetId = 0;
+          slot.packet.clear();
+          if (onPublishAck) {
+            onPublishAck(packetId);
+          }
+          break;
+        }
+      }
+      break;
+
+    case MQTT_SUBACK:
+      for (size_t i = 2; i < remainingLength; i++) {
+        if (body[i] == 0x80) {
+          DEBUG_PRINT("MQTT: Abonnement abgelehnt in Paket ");
+          DEBUG_PRINTLN(packetId);
+        }
+      }
+      if (pendingSubacks > 0 && --pendingSubacks == 0 && pendingFilters.empty()) {
+        subscribeDuration = millis() - connectStarted;
+      }
+      break;
+
+    case MQTT_PINGRESP:
+      pingOutstanding = false;
+      break;
+
+    default:
+      break;
+  }
+
+  return sockfd >= 0;
+}
+
+size_t MqttClient::extractTopic(uint8_t* body, size_t length, uint8_t qos, uint16_t* packetId) {
+  if (length < 2) {
+    return 0;
+  }
+  size_t topicLength = (body[0] << 8) | body[1];
+  size_t payloadOffset = 2 + topicLength + (qos > 0 ? 2 : 0);
+  if (payloadOffset > length) {
+    return 0;
+  }
+  *packetId = qos > 0 ? (body[2 + topicLength] << 8) | body[3 + topicLength] : 0;
+
+  // Topic um ein Byte nach vorn schieben und nullterminieren (wie PubSubClient)
+  memmove(body + 1, body + 2, topicLength);
+  body[1 + topicLength] = '\0';
+  return payloadOffset;
+}
+
+void MqttClient::handlePublish(uint8_t flags, uint8_t* body, size_t length) {
+  uint8_t qos = (flags >> 1) & 0x03;
+  uint16_t packetId;
+  size_t payloadOffset = extractTopic(body, length, qos, &packetId);
+  if (payloadOffset == 0) {
+    return;
+  }
+
+  if (callback) {
+    callback((char*)body + 1, body + payloadOffset, length - payloadOffset);
+  }
+
+  // QoS 1 nach der Verarbeitung bestätigen
+  if (qos == 1 && sockfd >= 0) {
+    acknowledge(packetId);
+  }
+}
+
+int MqttClient::beginStream(uint8_t* packet, size_t available, size_t headerLength, size_t remainingLength) {
+  uint8_t type = packet[0] & 0xF0;
+  uint8_t qos = (packet[0] >> 1) & 0x03;
+  streamActive = false;
+  streamPacketId = 0;
+
+  if (type == MQTT_PUBLISH && onStreamBegin) {
+    // Topic und Paket-ID müssen vollständig im Puffer liegen
+    if (available < headerLength + 2) {
+      return -1;
+    }
+    size_t topicLength = (packet[headerLength] << 8) | packet[headerLength + 1];
+    size_t prefix = 2 + topicLength + (qos > 0 ? 2 : 0);
+    if (headerLength + prefix < sizeof(rxBuffer)) {
+      if (available < headerLength + prefix) {
+        return -1;
+      }
+
+      uint16_t packetId;
+      extractTopic(packet + headerLength, prefix, qos, &packetId);
+      streamActive = onStreamBegin((const char*)packet + headerLength + 1, remainingLength - prefix);
+      streamPacketId = qos == 1 ? packetId : 0;
+      streamRemaining = remainingLength - prefix;
+      if (streamActive) {
+        streamedPackets++;
+      } else {
+        droppedPackets++;
+      }
+      if (streamRemaining == 0) {
+        endStream(true);
+      }
+      return headerLength + prefix;
+    }
+  }
+
+  // Kein Empfänger: ganzes Paket überspringen
+  droppedPackets++;
+  streamRemaining = remainingLength;
+  return headerLength;
+}
+
+void MqttClient::endStream(bool complete) {
+  if (streamActive && onStreamEnd) {
+    onStreamEnd(complete);
+  }
+  streamActive = false;
+
+  // QoS 1 erst nach vollständiger Verarbeitung bestätigen
+  if (complete && streamPacketId != 0 && sockfd >= 0) {
+    acknowledge(streamPacketId);
+  }
+  streamPacketId = 0;
+}
+
+void MqttClient::checkTimers(unsigned long now) {
+  retransmit(now, false);
+
+  // Keepalive 0 schaltet den Mechanismus laut Spezifikation ab
+  if (keepAlive == 0) {
+    return;
+  }
+  unsigned long interval = keepAlive * 1000UL;
+
+  if (pingOutstanding && now - pingSentAt > interval) {
+    closeSocket(ETIMEDOUT);  // Keine PINGRESP innerhalb eines Keepalive-Intervalls
+    return;
+  }
+  if (!pingOutstanding && (now - lastOutbound >= interval || now - lastInbound >= interval)) {
+    uint8_t packet[2] = {MQTT_PINGREQ, 0};
+    if (queuePacket(packet, sizeof(packet))) {
+      pingOutstanding = true;
+      pingSentAt = now;
+    }
+  }
+}
+
+void MqttClient::retransmit(unsigned long now, bool all) {
+  for (auto& slot : inFlight) {
+    if (slot.packetId == 0 || (!all && now - slot.sentAt < MQTT_RETRY_TIMEOUT)) {
+      continue;
+    }
+    if (queuePacket(slot.packet.data(), slot.packet.size())) {
+      slot.packet[0] |= PUBLISH_DUP;
+      slot.sentAt = now;
+      retransmitCount++;
+    }
+  }
+}
+
+bool MqttClient::subscribe(const char* const* filters, const uint8_t* qos, size_t count) {
+  return queueFilters(MQTT_SUBSCRIBE, filters, qos, count);
+}
+
+bool MqttClient::unsubscribe(const char* const* filters, size_t count) {
+  return queueFilters(MQTT_UNSUBSCRIBE, filters, nullptr, count);
+}
+
+bool MqttClient::queueFilters(uint8_t type, const char* const* filters, const uint8_t* qos, size_t count) {
+  if (state != CONNECTED) {
+    return false;
+  }
+
+  // Hinter bereits wartende Filter stellen, damit die Reihenfolge bleibt.
+  // Was nicht in den Sendepuffer passt, wird kopiert und von loop() gesendet
+  size_t queued = pendingFilters.empty() ? packFilters(type, filters, qos, count) : 0;
+  for (size_t i = queued; i < count; i++) {
+    pendingFilters.push_back({type, qos ? qos[i] : (uint8_t)0, String(filters[i])});
+  }
+
+  flush();
+  return true;
+}
+
+size_t MqttClient::packFilters(uint8_t type, const char* const* filters, const uint8_t* qos, size_t count) {
+  // SUBSCRIBE mit QoS-Byte je Filter, UNSUBSCRIBE nur mit den Filtern
+  size_t qosLength = type == MQTT_SUBSCRIBE ? 1 : 0;
+  size_t index = 0;
+  while (index < count) {
+    // So viele Filter wie möglich in ein Paket packen
+    size_t remaining = 2;
+    size_t last = index;
+    while (last < count) {
+      size_t entry = 2 + strlen(filters[last]) + qosLength;
+      if (remaining + entry + 5 > MQTT_TX_BUFFER_SIZE - txLength && last > index) {
+        break;
+      }
+      remaining += entry;
+      last++;
+    }
+
+    uint8_t header[5];
+    size_t used = 0;
+    header[used++] = type;
+    used += encodeLength(header + used, remaining);
+    if (txLength + used + remaining > sizeof(txBuffer)) {
+      flush();
+      if (txLength + used + remaining > sizeof(txBuffer)) {
+        break;
+      }
+    }
+
+    uint16_t packetId = allocatePacketId();
+    uint8_t id[2] = {(uint8_t)(packetId >> 8), (uint8_t)(packetId & 0xFF)};
+    queuePacket(header, used);
+    queuePacket(id, sizeof(id));
+    for (size_t i = index; i < last; i++) {
+      size_t length = strlen(filters[i]);
+      uint8_t prefix[2] = {(uint8_t)(length >> 8), (uint8_t)(length & 0xFF)};
+      uint8_t requested = min(qos ? qos[i] : (uint8_t)0, (uint8_t)1);
+      queuePacket(prefix, sizeof(prefix));
+      queuePacket((const uint8_t*)filters[i], length);
+      queuePacket(&requested, qosLength);
+    }
+    if (type == MQTT_SUBSCRIBE) {
+      pendingSubacks++;
+    }
+    index = last;
+  }
+  return index;
+}
+
+void MqttClient::queuePendingFilters() {
+  // Aufeinanderfolgende Filter gleichen Typs wieder gebündelt senden
+  std::vector<const char*> filters;
+  std::vector<uint8_t> qos;
+  while (pendingFilterIndex < pendingFilters.size()) {
+    uint8_t type = pendingFilters[pendingFilterIndex].type;
+    filters.clear();
+    qos.clear();
+    for (size_t i = pendingFilterIndex; i < pendingFilters.size() && pendingFilters[i].type == type; i++) {
+      filters.push_back(pendingFilters[i].filter.c_str());
+      qos.push_back(pendingFilters[i].qos);
+    }
+
+    size_t sent = packFilters(type, filters.data(), qos.data(), filters.size());
+    pendingFilterIndex += sent;
+    if (sent < filters.size()) {
+      return;  // Sendepuffer voll, im nächsten Durchlauf weiter
+    }
+  }
+  pendingFilters.clear();
+  pendingFilterIndex = 0;
+}
+
+bool MqttClient::publish(const char* topic, const uint8_t* payload, size_t length,
+                         uint8_t qos, bool retain, uint16_t* packetId) {
+  if (state != CONNECTED) {
+    return false;
+  }
+  qos = min(qos, (uint8_t)1);
+
+  InFlight* slot = nullptr;
+  if (qos == 1) {
+    for (auto& candidate : inFlight) {
+      if (candidate.packetId == 0) {
+        slot = &candidate;
+        break;
+      }
+    }
+    if (!slot) {
+      return false;  // Fenster voll
+    }
+  }
+
+  size_t topicLength = strlen(topic);
+  size_t remaining = 2 + topicLength + (qos ? 2 : 0) + length;
+  uint8_t header[5];
+  size_t used = 0;
+  header[used++] = MQTT_PUBLISH | (qos << 1) | (retain ? 1 : 0);
+  used += encodeLength(header + used, remaining);
+  if (txLength + used + remaining > sizeof(txBuffer)) {
+    return false;
+  }
+
+  std::vector<uint8_t> packet;
+  packet.reserve(used + remaining);
+  packet.insert(packet.end(), header, header + used);
+  packet.push_back(topicLength >> 8);
+  packet.push_back(topicLength & 0xFF);
+  packet.insert(packet.end(), topic, topic + topicLength);
+  uint16_t id = 0;
+  if (qos) {
+    id = allocatePacketId();
+    packet.push_back(id >> 8);
+    packet.push_back(id & 0xFF);
+  }
+  packet.insert(packet.end(), payload, payload + length);
+
+  queuePacket(packet.data(), packet.size());
+  if (slot) {
+    // Wiederholungen tragen das DUP-Flag
+    packet[0] |= PUBLISH_DUP;
+    slot->packetId = id;
+    slot->sentAt = millis();
+    slot->packet.swap(packet);
+  }
+  if (packetId) {
+    *packetId = id;
+  }
+
+  flush();
+  return true;
+}
+
+size_t MqttClient::inFlightCount() const {
+  size_t count = 0;
+  for (const auto& slot : inFlight) {
+    if (slot.packetId != 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void MqttClient::printStatus(Print &out) const {
+  static const char* stateNames[] = {"getrennt", "DNS", "TCP-Aufbau", "MQTT-Aufbau", "verbunden"};
+  out.print("MQTT: ");
+  out.print(stateNames[state]);
+  if (lastError) {
+    out.print(" (letzter Fehler ");
+    out.print(lastError);
+    out.print(")");
+  }
+  out.println();
+  out.print("Verbindungen: ");
+  out.print(reconnectCount);
+  out.print(", CONNACK nach ");
+  out.print(connectDuration);
+  out.print(" ms, alle SUBACKs nach ");
+  out.print(subscribeDuration);
+  out.println(" ms");
+  out.print("QoS 1 offen: ");
+  out.print(inFlightCount());
+  out.print("/");
+  out.print(MQTT_MAX_INFLIGHT);
+  out.print(", Wiederholungen: ");
+  out.print(retransmitCount);
+  out.print(", gestreamt: ");
+  out.print(streamedPackets);
+  out.print(", verworfene Pakete: ");
+  out.print(droppedPackets);
+  out.print(", PUBACK wartend: ");
+  out.print(pendingAckCount);
+  out.print(", verloren: ");
+  out.print(lostAcks);
+  out.print(", Filter wartend: ");
+  out.println(pendingFilters.size() - pendingFilterIndex);
+}
@@ -0,0 +1,193 @@
+/**
+ * MqttClient.h - Nicht blockierender MQTT-3.1.1-Client
+ *
+ * Ersetzt PubSubClient unterhalb des MqttManagers:
+ *   - Verbindungsaufbau (DNS, TCP-Connect, CONNECT/CONNACK) als
+ *     Zustandsautomat über ein nicht blockierendes lwIP-Socket; loop()
+ *     wartet nie. Der Brokername wird in einer kurzlebigen Task aufgelöst
+ *   - Beliebig viele Topic-Filter in einem SUBSCRIBE- bzw. UNSUBSCRIBE-Paket;
+ *     was nicht mehr in den Sendepuffer passt, sendet loop() nach
+ *   - QoS 1 für Abonnements und Veröffentlichungen, ausgehend mit
+ *     begrenztem In-Flight-Fenster und Wiederholung
+ *   - Keepalive (PINGREQ/PINGRESP) mit Zeitüberwachung statt Warten
+ *   - PUBLISH-Pakete, die nicht in den Empfangspuffer passen, werden in
+ *     Stücken an onStreamData weitergereicht statt verworfen
+ */
+
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <Arduino.h>
+#include <vector>
+#include <functional>
+#include "config.h"
+
+class MqttClient {
+public:
+  enum State : uint8_t {
+    DISCONNECTED,
+    RESOLVING,          // Brokername wird in der DNS-Task aufgelöst
+    TCP_CONNECTING,     // Warten auf den TCP-Verbindungsaufbau
+    MQTT_CONNECTING,    // CONNECT gesendet, warten auf CONNACK
+    CONNECTED
+  };
+
+  // Gleiche Signatur wie bei PubSubClient; topic ist nullterminiert und veränderbar
+  typedef void (*MessageCallback)(char* topic, uint8_t* payload, unsigned int length);
+  typedef std::function<void(uint16_t packetId)> AckCallback;
+
+  // Große Nachrichten: Beginn (false = überspringen), Daten in Stücken, Ende
+  typedef std::function<bool(const char* topic, size_t length)> StreamBeginCallback;
+  typedef std::function<void(const uint8_t* data, size_t length)> StreamDataCallback;
+  typedef std::function<void(bool complete)> StreamEndCallback;
+
+private:
+  struct InFlight {
+    uint16_t packetId = 0;          // 0 = Platz frei
+    unsigned long sentAt = 0;
+    std::vector<uint8_t> packet;    // Vollständiges PUBLISH-Paket für Wiederholungen
+  };
+
+  // Filter, die nicht mehr in den Sendepuffer passten
+  struct PendingFilter {
+    uint8_t type;                   // SUBSCRIBE oder UNSUBSCRIBE
+    uint8_t qos;
+    String filter;
+  };
+
+  enum ResolveState : uint8_t {
+    RESOLVE_IDLE,
+    RESOLVE_RUNNING,
+    RESOLVE_DONE,
+    RESOLVE_FAILED
+  };
+
+  String host;
+  uint16_t port = MQTT_PORT;
+  IPAddress address;
+  bool resolved = false;
+
+  // Nur die DNS-Task schreibt resolveResult, danach resolveState
+  String resolveHost;
+  IPAddress resolveResult;
+  volatile ResolveState resolveState = RESOLVE_IDLE;
+  String clientId;
+  uint16_t keepAlive = MQTT_KEEPALIVE;
+
+  int sockfd = -1;
+  State state = DISCONNECTED;
+  int lastError = 0;               // errno oder CONNACK-Rückgabecode
+
+  uint8_t rxBuffer[MQTT_PACKET_SIZE];
+  size_t rxLength = 0;
+  size_t streamRemaining = 0;      // Restbytes eines zu großen Pakets
+  bool streamActive = false;       // Restbytes weiterreichen statt verwerfen
+  uint16_t streamPacketId = 0;     // PUBACK nach dem letzten Stück (QoS 1)
+  uint8_t txBuffer[MQTT_TX_BUFFER_SIZE];
+  size_t txLength = 0;
+
+  // PUBACKs in Empfangsreihenfolge, falls der Sendepuffer voll war
+  uint16_t pendingAcks[MQTT_PENDING_ACKS];
+  uint8_t pendingAckCount = 0;
+
+  std::vector<PendingFilter> pendingFilters;
+  size_t pendingFilterIndex = 0;   // Nächster noch nicht gesendeter Filter
+
+  uint16_t nextPacketId = 1;
+  InFlight inFlight[MQTT_MAX_INFLIGHT];
+  uint8_t pendingSubacks = 0;
+
+  unsigned long connectStarted = 0;
+  unsigned long lastInbound = 0;
+  unsigned long lastOutbound = 0;
+  unsigned long pingSentAt = 0;
+  bool pingOutstanding = false;
+
+  // Zeitmessung für den Vergleich mit PubSubClient
+  unsigned long connectDuration = 0;   // connect() bis CONNACK
+  unsigned long subscribeDuration = 0; // connect() bis zum letzten SUBACK
+  uint32_t reconnectCount = 0;
+  uint32_t retransmitCount = 0;
+  uint32_t droppedPackets = 0;
+  uint32_t streamedPackets = 0;
+  uint32_t lostAcks = 0;               // Warteliste voll, PUBACK nicht gesendet
+
+  MessageCallback callback = nullptr;
+
+  uint16_t allocatePacketId();
+  void closeSocket(int error);
+  static void resolveTask(void* param);
+  bool pollResolve();
+  bool openSocket();
+  bool pollConnect();
+  bool sendConnect();
+  void receive();
+  bool processPacket(uint8_t* packet, size_t headerLength, size_t remainingLength);
+  void handlePublish(uint8_t flags, uint8_t* body, size_t length);
+  int beginStream(uint8_t* packet, size_t available, size_t headerLength, size_t remainingLength);
+  void endStream(bool complete);
+  static size_t extractTopic(uint8_t* body, size_t length, uint8_t qos, uint16_t* packetId);
+  void checkTimers(unsigned long now);
+  void retransmit(unsigned long now, bool all);
+  bool queuePacket(const uint8_t* data, size_t length);
+  bool queueAck(uint8_t type, uint16_t packetId);
+  void acknowledge(uint16_t packetId);
+  void queuePendingAcks();
+  bool queueFilters(uint8_t type, const char* const* filters, const uint8_t* qos, size_t count);
+  size_t packFilters(uint8_t type, const char* const* filters, const uint8_t* qos, size_t count);
+  void queuePendingFilters();
+  void flush();
+
+  static size_t encodeLength(uint8_t* out, size_t length);
+
+public:
+  MqttClient();
+  ~MqttClient();
+
+  void setServer(const char* host, uint16_t port);
+  void setCallback(MessageCallback callback) { this->callback = callback; }
+  void setKeepAlive(uint16_t seconds) { keepAlive = seconds; }  // 0 = kein PINGREQ
+
+  // Startet den Verbindungsaufbau und kehrt sofort zurück
+  bool connect(const char* clientId);
+  void disconnect();
+
+  // Verbindungsaufbau, Empfang, Keepalive und Wiederholungen voranbringen
+  bool loop();
+
+  bool connected() const { return state == CONNECTED; }
+  // Große Nachricht wird gerade an onStreamData weitergereicht
+  bool isStreaming() const { return streamActive; }
+  State getState() const { return state; }
+  int getLastError() const { return lastError; }
+
+  // Alle Filter in möglichst wenigen SUBSCRIBE-Paketen (QoS je Filter 0 oder 1)
+  bool subscribe(const char* const* filters, const uint8_t* qos, size_t count);
+  bool subscribe(const char* filter, uint8_t qos = 0) { return subscribe(&filter, &qos, 1); }
+  bool allSubscribed() const { return pendingSubacks == 0 && pendingFilters.empty(); }
+
+  // Abonnements beenden (UNSUBACK wird nicht ausgewertet)
+  bool unsubscribe(const char* const* filters, size_t count);
+
+  // QoS 1: false, wenn das In-Flight-Fenster voll ist; packetId für onPublishAck
+  bool publish(const char* topic, const uint8_t* payload, size_t length,
+               uint8_t qos = 0, bool retain = false, uint16_t* packetId = nullptr);
+  bool publish(const char* topic, const char* payload, uint8_t qos = 0, bool retain = false) {
+    return publish(topic, (const uint8_t*)payload, strlen(payload), qos, retain);
+  }
+  size_t inFlightCount() const;
+
+  // Wird bei PUBACK einer QoS-1-Nachricht aufgerufen
+  AckCallback onPublishAck = nullptr;
+
+  // Ohne onStreamBegin werden zu große Nachrichten verworfen
+  StreamBeginCallback onStreamBegin = nullptr;
+  StreamDataCallback onStreamData = nullptr;
+  StreamEndCallback onStreamEnd = nullptr;
+
+  unsigned long getConnectDuration() const { return connectDuration; }
+  unsigned long getSubscribeDuration() const { return subscribeDuration; }
+  void printStatus(Print &out) const;
+};
+
+#endif // MQTT_CLIENT_H
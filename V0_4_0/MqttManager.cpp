@@ -2,7 +2,15 @@
  * MqttManager.cpp - Implementierung der MQTT-Funktionen
  */
 
+#define LOG_MODULE LOG_MOD_MQTT
+
 #include "MqttManager.h"
+#include "MqttRecorder.h"
+#include "LatencyTracer.h"
+#include "ConfigManager.h"
+#include "JsonArena.h"
+#include "MemoryMonitor.h"
+#include "default_data.h"
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
 
@@ -17,45 +25,268 @@ void MqttManager::staticCallback(char* topic, byte* payload, unsigned int length
 
 // Instanzmethode für die Callback-Verarbeitung
 void MqttManager::handleCallback(char* topic, byte* payload, unsigned int length) {
-  // Konvertiere Payload zu String
-  String message;
-  message.reserve(length);
+  MemoryScope memoryScope(LOG_MODULE);
+  uint32_t receivedAt = ESP.getCycleCount();
   
-  for (unsigned int i = 0; i < length; i++) {
-    message += (char)payload[i];
+  // Mitschnitt vor jeder weiteren Verarbeitung
+  if (mqttRecorder.isRecording()) {
+    mqttRecorder.record(topic, payload, length);
   }
   
-  DEBUG_PRINT("MQTT Nachricht [");
-  DEBUG_PRINT(topic);
-  DEBUG_PRINT("]: ");
-  DEBUG_PRINTLN(message);
+  // Topic über den Trie zuordnen; unbekannte Topics werden ohne Allokation verworfen
+  int binding = topicTrie.match(topic);
+  if (binding == TopicTrie::NO_BINDING) {
+    unmatchedCount++;
+    LOG_D("Unbekanntes Topic empfangen: %s", topic);
+    return;
+  }
   
-  // Aktualisiere das entsprechende Topic
-  String topicStr = String(topic);
-  bool topicFound = false;
+  if (binding & WILDCARD_BINDING) {
+    // Erstes Auftreten eines Topics unter einem Wildcard-Filter
+    binding = bindWildcardTopic(binding & ~WILDCARD_BINDING, topic);
+    if (binding < 0) {
+      return;
+    }
+  }
   
-  for (auto& mqttTopic : topics) {
-    if (mqttTopic.topic == topicStr) {
-      mqttTopic.value = message;
-      mqttTopic.lastUpdate = millis();
-      topicFound = true;
-      
-      // Benachrichtigung über Datenänderung
-      if (onDataUpdate) {
-        onDataUpdate();
-      }
-      break;
+  // Nur ablegen; verarbeitet wird in update() nach Priorität. Verfolgt
+  // werden nur zugeordnete Nachrichten
+  MqttTopic& mqttTopic = topics[binding];
+  uint16_t traceId = latencyTracer.begin(receivedAt);
+  if (!ingestQueue.push(binding, (IngestPriority)mqttTopic.priority, mqttTopic.coalesce, payload, length, traceId)) {
+    latencyTracer.release(traceId);
+    LOG_W("Eingangswarteschlange voll, verworfen: %s", topic);
+  }
+}
+
+void MqttManager::processIngest() {
+  // Zeitbudget begrenzen, damit Touch und Anzeige nicht warten
+  unsigned long start = micros();
+  uint16_t index;
+  uint16_t traceId;
+  const char* payload;
+  size_t length;
+  int processed = 0;
+  
+  // payload zeigt in die Warteschlange; während der Verarbeitung kommt kein push()
+  while (micros() - start < INGEST_BUDGET_US && ingestQueue.pop(index, payload, length, &traceId)) {
+    latencyTracer.mark(traceId, TRACE_DEQUEUE);
+    latencyTracer.setCurrent(traceId);
+    processMessage(index, (const uint8_t*)payload, length);
+    latencyTracer.setCurrent(0);
+    processed++;
+  }
+  
+  // Anzeige einmal pro Durchlauf statt pro Nachricht aktualisieren
+  if (processed > 0 && onDataUpdate) {
+    onDataUpdate();
+  }
+}
+
+void MqttManager::drainIngest() {
+  while (ingestQueue.size() > 0) {
+    processIngest();
+  }
+}
+
+void MqttManager::processMessage(int index, const uint8_t* payload, size_t length) {
+  MemoryScope memoryScope(LOG_MOD_DATA);
+  MqttTopic& mqttTopic = topics[index];
+  unsigned long now = millis();
+  
+  // JSON-Payload: nur die konfigurierten Felder übernehmen
+  if (mqttTopic.hasJsonFields()) {
+    beginJson(queuedJson, index, length);
+    bool ok = jsonFilters[mqttTopic.jsonFilter].extract(payload, length, [this](uint16_t index, const char* value) {
+      updateField(index, value);
+    });
+    finishJson(queuedJson, ok);
+    return;
+  }
+  
+  // Payload direkt in den Wert des Topics kopieren
+  updateTopic(mqttTopic, (const char*)payload, length, now, length);
+  LOG_D("MQTT Nachricht [%s]: %s", mqttTopic.topic.c_str(), mqttTopic.value.c_str());
+}
+
+void MqttManager::updateTopic(MqttTopic &topic, const char* value, size_t valueLength,
+                              unsigned long now, unsigned int length) {
+  topic.stats.record(now, topic.lastUpdate, length);
+  topic.value.assign(value, valueLength);
+  topic.lastUpdate = now;
+  topic.restored = false;
+  
+  if (onTopicUpdate && !onTopicUpdate(topic)) {
+    topic.stats.parseFailures++;
+  }
+}
+
+bool MqttManager::beginStream(const char* topic, size_t length) {
+  // Nachricht größer als der Empfangspuffer: nur JSON-Topics mit Feldern
+  int binding = topicTrie.match(topic);
+  if (binding == TopicTrie::NO_BINDING) {
+    unmatchedCount++;
+    return false;
+  }
+  if (binding & WILDCARD_BINDING) {
+    binding = bindWildcardTopic(binding & ~WILDCARD_BINDING, topic);
+    if (binding < 0) {
+      return false;
     }
   }
   
-  if (!topicFound) {
-    DEBUG_PRINT("Warnung: Unbekanntes Topic empfangen: ");
-    DEBUG_PRINTLN(topicStr);
+  MqttTopic& mqttTopic = topics[binding];
+  if (!mqttTopic.hasJsonFields()) {
+    DEBUG_PRINT("Nachricht zu groß, verworfen: ");
+    DEBUG_PRINTLN(topic);
+    mqttTopic.stats.record(millis(), mqttTopic.lastUpdate, length);
+    mqttTopic.stats.parseFailures++;
+    return false;
+  }
+  
+  // Werte wie bei kleinen Nachrichten über die vorkompilierten Pfade zuordnen
+  int filterIndex = mqttTopic.jsonFilter;
+  beginJson(streamJson, binding, length);
+  jsonParser.begin([this, filterIndex](const char* path, const char* value) {
+    jsonFilters[filterIndex].match(path, value, [this](uint16_t index, const char* fieldValue) {
+      updateField(index, fieldValue);
+    });
+  });
+  return true;
+}
+
+void MqttManager::beginJson(JsonMessage &message, int index, size_t length) {
+  message.topic = index;
+  message.length = length;
+  message.heapStart = message.heapMin = ESP.getFreeHeap();
+  
+  MqttTopic& parent = topics[index];
+  unsigned long now = millis();
+  parent.stats.record(now, parent.lastUpdate, length);
+  parent.lastUpdate = now;
+  parent.restored = false;
+}
+
+void MqttManager::updateField(uint16_t index, const char* value) {
+  size_t length = strlen(value);
+  updateTopic(topics[index], value, length, millis(), length);
+  trackHeap();
+}
+
+void MqttManager::trackHeap() {
+  uint32_t freeHeap = ESP.getFreeHeap();
+  // Ein laufender Strom zählt auch Nachrichten aus der Warteschlange mit
+  for (JsonMessage* message : {&queuedJson, &streamJson}) {
+    if (message->topic >= 0 && freeHeap < message->heapMin) {
+      message->heapMin = freeHeap;
+    }
+  }
+}
+
+void MqttManager::finishJson(JsonMessage &message, bool ok) {
+  if (message.topic < 0) {
+    return;
+  }
+  trackHeap();
+  
+  size_t jsonLength = message.length;
+  MqttTopic& parent = topics[message.topic];
+  char summary[MQTT_VALUE_LENGTH];
+  snprintf(summary, sizeof(summary), "JSON, %lu Bytes", (unsigned long)jsonLength);
+  parent.value = summary;
+  if (!ok) {
+    parent.stats.parseFailures++;
+  }
+  
+  // Statistik nach Größenklasse: im Puffer, <= 4 KB, <= 16 KB, <= 64 KB, größer
+  int sizeClass = jsonLength <= MQTT_PACKET_SIZE ? 0 : jsonLength <= 4096 ? 1 :
+                  jsonLength <= 16384 ? 2 : jsonLength <= 65536 ? 3 : 4;
+  PayloadStats& stats = payloadStats[sizeClass];
+  stats.count++;
+  stats.largest = max(stats.largest, (uint32_t)jsonLength);
+  stats.peakHeap = max(stats.peakHeap, message.heapStart > message.heapMin ? message.heapStart - message.heapMin : 0);
+  if (!ok) {
+    stats.errors++;
+  }
+  message.topic = -1;
+}
+
+void TopicStats::record(unsigned long now, unsigned long previous, unsigned int length) {
+  count++;
+  bytes += length;
+  if (count < 2 || previous == 0) {
+    return;
+  }
+  
+  // Gleitende Mittelwerte mit Gewicht 1/16 (wie der Jitter in RFC 3550)
+  float gap = now - previous;
+  if (count == 2) {
+    interval = gap;
+    return;
+  }
+  float deviation = fabsf(gap - interval);
+  interval += (gap - interval) / 16.0f;
+  jitter += (deviation - jitter) / 16.0f;
+  if (deviation > jitterMax) {
+    jitterMax = deviation;
+  }
+}
+
+int MqttManager::bindWildcardTopic(int wildcardIndex, const char* topic) {
+  if (dynamicTopicCount >= MQTT_MAX_DYNAMIC_TOPICS) {
+    DEBUG_PRINT("Warnung: Zu viele Wildcard-Topics, ignoriere ");
+    DEBUG_PRINTLN(topic);
+    return -1;
+  }
+  if (strlen(topic) >= MQTT_TOPIC_LENGTH) {
+    LOG_W("Topic zu lang, ignoriere %s", topic);
+    return -1;
+  }
+  
+  const MqttWildcard& wildcard = wildcards[wildcardIndex];
+  
+  // Namen aus der Vorlage bilden, z.B. "inverter_1/+" -> "inverter_1/pv_power"
+  String level;
+  String name = TopicTrie::expandName(wildcard.nameTemplate.c_str(), wildcard.filter.c_str(), topic, &level);
+  
+  // Messgröße aus der letzten erfassten Ebene, Einheit aus der Nummer im
+  // Namen ("inverter_2/pv_power" -> Wechselrichter 2)
+  SolarMetric metric = (SolarMetric)wildcard.metric;
+  if (metric == METRIC_NONE) {
+    metric = DataManager::metricFromName(level);
   }
+  uint8_t unit = DataManager::unitFromName(name, wildcard.unitIndex);
+  
+  // Platz wurde beim Anlegen der Topics reserviert, die Liste wandert nicht
+  topics.push_back(MqttTopic(name.c_str(), topic, metric, unit));
+  topics.back().bound = true;
+  int index = topics.size() - 1;
+  topicTrie.insert(topic, index);
+  dynamicTopicCount++;
+  
+  DEBUG_PRINT("Wildcard-Topic gebunden: ");
+  DEBUG_PRINT(name);
+  DEBUG_PRINT(" -> ");
+  DEBUG_PRINTLN(topic);
+  
+  return index;
 }
 
-MqttManager::MqttManager() : mqttClient(wifiClient) {
-  // Konstruktor
+MqttManager::MqttManager() {
+  // Große Nachrichten stückweise in den JSON-Parser leiten
+  mqttClient.onStreamBegin = [this](const char* topic, size_t length) {
+    return beginStream(topic, length);
+  };
+  mqttClient.onStreamData = [this](const uint8_t* data, size_t length) {
+    jsonParser.feed(data, length);
+    trackHeap();
+  };
+  mqttClient.onStreamEnd = [this](bool complete) {
+    finishJson(streamJson, complete && jsonParser.end());
+    if (onDataUpdate) {
+      onDataUpdate();
+    }
+  };
 }
 
 bool MqttManager::begin(const String &broker, int port) {
@@ -73,82 +304,174 @@ bool MqttManager::begin(const String &broker, int port) {
   mqttClient.setServer(broker.c_str(), port);
   mqttClient.setCallback(MqttManager::staticCallback);
   
-  // Default Topics laden
-  loadDefaultTopics();
+  // Default Topics laden, falls beim Start noch keine geladen wurden
+  if (topics.empty()) {
+    loadDefaultTopics();
+  }
+  
+  // Verbindungsaufbau starten; abgeschlossen wird er in update()
+  DEBUG_PRINT("Verbinde mit MQTT-Broker ");
+  DEBUG_PRINT(broker);
+  DEBUG_PRINT(":");
+  DEBUG_PRINTLN(port);
   
-  // Verbindung versuchen
-  if (!mqttClient.connected()) {
-    DEBUG_PRINT("Verbinde mit MQTT-Broker ");
-    DEBUG_PRINT(broker);
-    DEBUG_PRINT(":");
-    DEBUG_PRINTLN(port);
-    
-    if (mqttClient.connect(clientId.c_str())) {
-      connected = true;
-      DEBUG_PRINTLN("MQTT verbunden!");
-      
-      // Abonniere alle konfigurierten Topics
-      for (const auto& topic : topics) {
-        mqttClient.subscribe(topic.topic.c_str());
-        DEBUG_PRINT("Abonniert: ");
-        DEBUG_PRINTLN(topic.topic);
-      }
-    } else {
-      DEBUG_PRINT("MQTT-Verbindung fehlgeschlagen, rc=");
-      DEBUG_PRINTLN(mqttClient.state());
-      connected = false;
-    }
+  lastReconnectAttempt = millis();
+  if (!mqttClient.connect(clientId.c_str())) {
+    DEBUG_PRINT("MQTT-Verbindung fehlgeschlagen, Fehler ");
+    DEBUG_PRINTLN(mqttClient.getLastError());
+    return false;
   }
   
-  return connected;
+  return true;
 }
 
 void MqttManager::update() {
-  // MQTT-Verbindung prüfen und wiederherstellen
-  if (!mqttClient.connected()) {
-    connected = false;
+  // Verbindungsaufbau, Empfang und Keepalive laufen ohne Blockieren
+  bool wasConnected = connected;
+  connected = mqttClient.loop();
+  
+  if (connected && !wasConnected) {
+    DEBUG_PRINT("MQTT verbunden nach ");
+    DEBUG_PRINT(mqttClient.getConnectDuration());
+    DEBUG_PRINTLN(" ms");
+    
+    // Abonniere alle konfigurierten Topics
+    subscribeAll();
+  } else if (!connected && wasConnected) {
+    DEBUG_PRINT("MQTT Verbindung verloren, Fehler ");
+    DEBUG_PRINTLN(mqttClient.getLastError());
+  }
+  
+  // Wartende Nachrichten verarbeiten
+  processIngest();
+  
+  // MQTT-Verbindung wiederherstellen
+  if (mqttClient.getState() == MqttClient::DISCONNECTED && broker.length() > 0) {
     unsigned long now = millis();
     
     if (now - lastReconnectAttempt > 5000) {  // Alle 5 Sekunden versuchen
       lastReconnectAttempt = now;
       
-      DEBUG_PRINTLN("MQTT Verbindung verloren, versuche erneut...");
-      
-      if (mqttClient.connect(clientId.c_str())) {
-        DEBUG_PRINTLN("MQTT Verbindung wiederhergestellt");
-        connected = true;
-        
-        // Abonniere alle konfigurierten Topics
-        for (const auto& topic : topics) {
-          mqttClient.subscribe(topic.topic.c_str());
-          DEBUG_PRINT("Erneut abonniert: ");
-          DEBUG_PRINTLN(topic.topic);
-        }
-      } else {
-        DEBUG_PRINT("MQTT-Reconnect fehlgeschlagen, rc=");
-        DEBUG_PRINTLN(mqttClient.state());
-      }
+      DEBUG_PRINTLN("MQTT nicht verbunden, versuche erneut...");
+      mqttClient.connect(clientId.c_str());
     }
-  } else {
-    // MQTT Client Loop
-    mqttClient.loop();
   }
 }
 
-bool MqttManager::subscribe(const String &name, const String &topic) {
-  // Prüfe, ob Topic bereits existiert
-  for (const auto& t : topics) {
-    if (t.name == name) {
-      return true;  // Bereits abonniert
+void MqttManager::collectFilters(std::map<String, uint8_t> &filters) const {
+  // Wildcard-Filter und alle nicht abgedeckten Einzel-Topics
+  for (const auto& wildcard : wildcards) {
+    uint8_t& qos = filters[wildcard.filter];
+    qos = max(qos, wildcard.qos);
+  }
+  
+  for (const auto& topic : topics) {
+    // JSON-Felder teilen sich das Abonnement ihres Topics
+    if (topic.parent >= 0 || isCoveredByWildcard(topic.topic)) {
+      continue;
     }
+    uint8_t& qos = filters[String(topic.topic.c_str())];
+    qos = max(qos, topic.qos);
+  }
+}
+
+void MqttManager::subscribeAll() {
+  std::map<String, uint8_t> active;
+  collectFilters(active);
+  
+  std::vector<const char*> filters;
+  std::vector<uint8_t> qos;
+  for (const auto& entry : active) {
+    filters.push_back(entry.first.c_str());
+    qos.push_back(entry.second);
   }
   
-  // Füge neues Topic hinzu
-  topics.push_back(MqttTopic(name, topic));
+  // Alle Filter gebündelt in möglichst wenigen SUBSCRIBE-Paketen
+  if (!filters.empty() && !mqttClient.subscribe(filters.data(), qos.data(), filters.size())) {
+    DEBUG_PRINTLN("MQTT: Abonnieren fehlgeschlagen");
+  }
+  
+  DEBUG_PRINT(filters.size());
+  DEBUG_PRINT(" Abonnements für ");
+  DEBUG_PRINT(topics.size());
+  DEBUG_PRINTLN(" Topics");
+}
+
+bool MqttManager::isCoveredByWildcard(const char* topic) const {
+  for (const auto& wildcard : wildcards) {
+    if (TopicTrie::covers(wildcard.filter.c_str(), topic)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void MqttManager::clearTopics() {
+  topics.clear();
+  wildcards.clear();
+  topicTrie.clear();
+  jsonFilters.clear();
+  ingestQueue.clear();
+  dynamicTopicCount = 0;
+}
+
+void MqttManager::reserveTopics() {
+  // Platz für ein weiteres Topic und, sobald es Wildcards gibt, für alle noch
+  // möglichen Bindungen: bindWildcardTopic() läuft beim Empfang und soll die
+  // Liste (rund 270 Bytes je Topic) nicht auf einem zerstückelten Heap
+  // umkopieren; Zeiger aus findTopic() bleiben so bis zum nächsten Laden gültig
+  size_t needed = topics.size() + 1;
+  if (!wildcards.empty()) {
+    needed += MQTT_MAX_DYNAMIC_TOPICS - dynamicTopicCount;
+  }
+  if (topics.capacity() < needed) {
+    topics.reserve(needed + topics.size() / 2);
+  }
+}
+
+bool MqttManager::subscribe(const String &name, const String &topic,
+                            SolarMetric metric, uint8_t unitIndex, uint8_t qos) {
+  if (topic.length() >= MQTT_TOPIC_LENGTH || name.length() >= MQTT_NAME_LENGTH) {
+    LOG_W("Topic oder Name zu lang, nicht abonniert: %s", topic.c_str());
+    return false;
+  }
+  
+  if (TopicTrie::isWildcard(topic.c_str())) {
+    // Prüfe, ob der Filter bereits existiert
+    for (const auto& w : wildcards) {
+      if (w.filter == topic) {
+        return true;  // Bereits abonniert
+      }
+    }
+    
+    wildcards.push_back(MqttWildcard(name, topic, metric, unitIndex, qos));
+    topicTrie.insert(topic.c_str(), WILDCARD_BINDING | (wildcards.size() - 1));
+    reserveTopics();
+  } else {
+    // Prüfe, ob Topic bereits existiert
+    for (const auto& t : topics) {
+      if (t.name == name) {
+        return true;  // Bereits abonniert
+      }
+    }
+    
+    // Füge neues Topic hinzu und binde es an eine Messgröße
+    if (metric == METRIC_NONE) {
+      metric = DataManager::metricFromName(name);
+    }
+    reserveTopics();
+    topics.push_back(MqttTopic(name.c_str(), topic.c_str(), metric, unitIndex, qos));
+    topicTrie.insert(topic.c_str(), topics.size() - 1);
+    
+    // Bereits durch einen Wildcard-Filter abonniert
+    if (isCoveredByWildcard(topic.c_str())) {
+      return true;
+    }
+  }
   
   // Abonniere, falls verbunden
-  if (mqttClient.connected()) {
-    bool result = mqttClient.subscribe(topic.c_str());
+  if (mqttClient.connected() && !holdSubscriptions) {
+    bool result = mqttClient.subscribe(topic.c_str(), qos);
     DEBUG_PRINT("Topic abonniert: ");
     DEBUG_PRINTLN(topic);
     return result;
@@ -157,53 +480,189 @@ bool MqttManager::subscribe(const String &name, const String &topic) {
   return true;  // Wird abonniert, sobald verbunden
 }
 
-String MqttManager::getValue(const String &name) {
+const char* MqttManager::getValue(const char* name) const {
   for (const auto& t : topics) {
     if (t.name == name) {
-      return t.value;
+      return t.value.c_str();
     }
   }
   
   return "N/A";  // Topic nicht gefunden
 }
 
+const MqttTopic* MqttManager::findTopic(const char* name) const {
+  for (const auto& t : topics) {
+    if (t.name == name) {
+      return &t;
+    }
+  }
+  return nullptr;
+}
 
-bool MqttManager::loadDefaultTopics() {
-  // Standard-Topics für Solar Monitoring
-  subscribe("battery_soc", "solar_assistant/total/battery_state_of_charge/state");
-  subscribe("load_power", "solar_assistant/inverter_1/load_power_essential/state");
-  subscribe("grid_power", "solar_assistant/inverter_1/grid_power/state");
-  subscribe("pv_power", "solar_assistant/inverter_1/pv_power/state");
-  subscribe("battery_power", "solar_assistant/total/battery_power/state");
-  subscribe("battery_voltage", "solar_assistant/inverter_1/battery_voltage/state");
-  subscribe("daily_yield", "solar_assistant/inverter_1/energy_day/state");
+bool MqttManager::addJsonField(const String &parentName, const String &name, const String &path,
+                               SolarMetric metric, uint8_t unitIndex) {
+  int parentIndex = -1;
+  for (size_t i = 0; i < topics.size(); i++) {
+    if (topics[i].name == name) {
+      return true;  // Bereits vorhanden
+    }
+    if (topics[i].name == parentName && topics[i].parent < 0) {
+      parentIndex = i;
+    }
+  }
+  if (parentIndex < 0 || path.length() == 0) {
+    return false;
+  }
   
-  DEBUG_PRINTLN("Default MQTT-Topics geladen");
+  if (metric == METRIC_NONE) {
+    metric = DataManager::metricFromName(name);
+  }
+  // Pfad beim Laden kompilieren, nicht bei jeder Nachricht
+  MqttTopic& parent = topics[parentIndex];
+  if (!parent.hasJsonFields()) {
+    jsonFilters.emplace_back();
+    parent.jsonFilter = jsonFilters.size() - 1;
+  }
+  if (!jsonFilters[parent.jsonFilter].add(path, topics.size())) {
+    DEBUG_PRINT("Ungültiger JSON-Pfad: ");
+    DEBUG_PRINTLN(path);
+    return false;
+  }
+  
+  // Das JSON-Topic erhält die Spur seines wichtigsten Felds
+  parent.priority = min(parent.priority, (uint8_t)priorityForMetric(metric));
+  
+  MqttTopic field(name.c_str(), parent.topic, metric, unitIndex);
+  field.jsonPath = path;
+  field.parent = parentIndex;
+  reserveTopics();
+  topics.push_back(field);
+  
+  DEBUG_PRINT("JSON-Feld: ");
+  DEBUG_PRINT(parentName);
+  DEBUG_PRINT(" ");
+  DEBUG_PRINT(path);
+  DEBUG_PRINT(" -> ");
+  DEBUG_PRINTLN(name);
   return true;
 }
 
-bool MqttManager::loadTopicsFromConfig(const String &filename) {
-  // Laden der MQTT-Topics aus einer JSON-Konfigurationsdatei
-  if (!SPIFFS.exists(filename)) {
-    DEBUG_PRINT("MQTT-Konfigurationsdatei nicht gefunden: ");
-    DEBUG_PRINTLN(filename);
-    return false;
+bool MqttManager::publish(const String &topic, const String &payload, uint8_t qos, bool retain,
+                          uint16_t* packetId) {
+  return mqttClient.publish(topic.c_str(), (const uint8_t*)payload.c_str(), payload.length(),
+                            qos, retain, packetId);
+}
+
+bool MqttManager::restoreValue(const char* name, const char* value) {
+  for (auto& t : topics) {
+    if (t.name == name) {
+      if (t.lastUpdate != 0) {
+        return false;  // Live-Wert hat Vorrang
+      }
+      t.value = value;
+      t.restored = true;
+      return true;
+    }
   }
+  return false;
+}
+
+bool MqttManager::isStale(const MqttTopic &topic) const {
+  return topic.lastUpdate == 0 || millis() - topic.lastUpdate > MQTT_STALE_TIMEOUT;
+}
+
+void MqttManager::printStats(Print &out) const {
+  unsigned long now = millis();
   
-  File file = SPIFFS.open(filename, "r");
-  if (!file) {
-    DEBUG_PRINTLN("Fehler beim Öffnen der MQTT-Konfigurationsdatei");
-    return false;
+  out.println("Topic                          Anz.   /min  Jitter   Max  Bytes  Fehler  Alter");
+  for (const auto& t : topics) {
+    char line[112];
+    long age = t.lastUpdate ? (long)((now - t.lastUpdate) / 1000) : -1;
+    snprintf(line, sizeof(line), "%-30.30s %5lu %6.1f %5.0fms %5lu %6lu %6lu  %s%ld s",
+             t.name.c_str(), (unsigned long)t.stats.count, t.stats.ratePerMinute(),
+             t.stats.jitter, (unsigned long)t.stats.jitterMax, (unsigned long)t.stats.bytes,
+             (unsigned long)t.stats.parseFailures, isStale(t) ? "!" : " ", age);
+    out.println(line);
   }
   
-  // JSON deserialisieren
-  JsonDocument doc; // Die Größenbeschränkung ist nicht mehr erforderlich
-  DeserializationError error = deserializeJson(doc, file);
-  file.close();
+  out.print("Ohne Zuordnung: ");
+  out.println(unmatchedCount);
+}
+
+void MqttManager::printPayloadStats(Print &out) const {
+  static const char* classNames[PAYLOAD_SIZE_CLASSES] = {
+    "im Puffer", "<= 4 KB", "<= 16 KB", "<= 64 KB", "> 64 KB"
+  };
+  
+  out.println("JSON-Payloads     Anz.  größte  Heap-Spitze  Fehler");
+  for (int i = 0; i < PAYLOAD_SIZE_CLASSES; i++) {
+    char line[80];
+    snprintf(line, sizeof(line), "%-12s %9lu %7lu %10lu B %7lu", classNames[i],
+             (unsigned long)payloadStats[i].count, (unsigned long)payloadStats[i].largest,
+             (unsigned long)payloadStats[i].peakHeap, (unsigned long)payloadStats[i].errors);
+    out.println(line);
+  }
   
-  if (error) {
-    DEBUG_PRINT("JSON Parsing Fehler: ");
-    DEBUG_PRINTLN(error.c_str());
+  out.print("Fester Bedarf: Empfangspuffer ");
+  out.print(MQTT_PACKET_SIZE);
+  out.print(" B, Parser ");
+  out.print((unsigned long)sizeof(JsonStreamParser));
+  out.println(" B");
+}
+
+void MqttManager::resetStats() {
+  for (auto& t : topics) {
+    t.stats = TopicStats();
+  }
+  unmatchedCount = 0;
+  ingestQueue.resetStats();
+}
+
+bool MqttManager::setIngestOptions(const String &name, IngestPriority priority, bool coalesce) {
+  for (auto& t : topics) {
+    if (t.name == name) {
+      t.priority = priority;
+      t.coalesce = coalesce;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool MqttManager::loadDefaultTopics() {
+  // Standard-Topics aus data/mqtt_topics.json, als Tabelle im Flash
+  clearTopics();
+  
+  for (const DefaultTopic &entry : DEFAULT_TOPICS) {
+    SolarMetric metric = DataManager::metricFromName(entry.metric ? entry.metric : entry.name);
+    uint8_t unit = DataManager::isBatteryMetric(metric) ? entry.battery : entry.inverter;
+    subscribe(entry.name, entry.topic, metric, unit - 1, entry.qos);
+    
+    for (uint8_t i = 0; i < entry.fieldCount; i++) {
+      const DefaultTopicField &field = entry.fields[i];
+      SolarMetric fieldMetric = DataManager::metricFromName(field.metric ? field.metric : field.name);
+      uint8_t fieldUnit = DataManager::isBatteryMetric(fieldMetric) ? field.battery : field.inverter;
+      addJsonField(entry.name, field.name, field.path, fieldMetric, fieldUnit - 1);
+    }
+    
+    const MqttTopic* loaded = findTopic(entry.name);
+    if (loaded) {
+      IngestPriority priority = IngestQueue::priorityFromName(entry.priority, (IngestPriority)loaded->priority);
+      setIngestOptions(entry.name, priority, entry.coalesce);
+    }
+  }
+  
+  DEBUG_PRINTLN("Default MQTT-Topics geladen");
+  return true;
+}
+
+bool MqttManager::loadTopicsFromConfig(const String &filename) {
+  // Laden der MQTT-Topics über den ConfigManager (Binär-Snapshot, nur bei
+  // geänderter Datei wird JSON geparst)
+  JsonDocument doc(&jsonArena); // Nur während des Einlesens
+  if (!configManager.loadJsonConfig(filename, doc)) {
+    DEBUG_PRINT("MQTT-Konfigurationsdatei nicht lesbar: ");
+    DEBUG_PRINTLN(filename);
     return false;
   }
   
@@ -214,24 +673,147 @@ bool MqttManager::loadTopicsFromConfig(const String &filename) {
     return false;
   }
   
-  // Bestehende Topics löschen
-  topics.clear();
+  // Bestehende Topics und Wildcards löschen
+  clearTopics();
   
   // Neue Topics aus JSON hinzufügen
   for (JsonObject topicObj : topicList) {
     String name = topicObj["name"].as<String>();
     String topic = topicObj["topic"].as<String>();
     
+    // Optionale Bindung: "metric" (Standard: name) und Einheit 1..N
+    String metricName = topicObj["metric"] | name.c_str();
+    SolarMetric metric = DataManager::metricFromName(metricName);
+    int unit = DataManager::isBatteryMetric(metric) ? (topicObj["battery"] | 1) : (topicObj["inverter"] | 1);
+    uint8_t qos = min(topicObj["qos"] | 0, 1);
+    
     if (name.length() > 0 && topic.length() > 0) {
       DEBUG_PRINT("MQTT Topic geladen: ");
       DEBUG_PRINT(name);
       DEBUG_PRINT(" -> ");
       DEBUG_PRINTLN(topic);
       
-      subscribe(name, topic);
+      subscribe(name, topic, metric, (uint8_t)max(0, unit - 1), qos);
+      
+      // Felder aus JSON-Payloads, z.B. {"path": "ENERGY.Power", "name": "load_power"}
+      for (JsonObject field : topicObj["fields"].as<JsonArray>()) {
+        String fieldName = field["name"].as<String>();
+        SolarMetric fieldMetric = DataManager::metricFromName(field["metric"] | fieldName.c_str());
+        int fieldUnit = DataManager::isBatteryMetric(fieldMetric) ? (field["battery"] | 1) : (field["inverter"] | 1);
+        addJsonField(name, fieldName, field["path"].as<String>(), fieldMetric, (uint8_t)max(0, fieldUnit - 1));
+      }
+      
+      // Optional: "priority" (high, normal, low) und "coalesce" (Standard: true)
+      const MqttTopic* loaded = findTopic(name.c_str());
+      if (loaded) {
+        IngestPriority priority = IngestQueue::priorityFromName(topicObj["priority"], (IngestPriority)loaded->priority);
+        setIngestOptions(name, priority, topicObj["coalesce"] | true);
+      }
     }
   }
   
   DEBUG_PRINTLN("MQTT-Topics aus Konfiguration geladen");
   return true;
+}
+bool MqttManager::reloadTopics(const String &filename, ExtraTopics addExtras) {
+  // Eine laufende große JSON-Nachricht verweist noch auf die alten Indizes und Filter
+  if (mqttClient.isStreaming()) {
+    return false;
+  }
+  
+  // Wartende Nachrichten mit den bisherigen Zuordnungen verarbeiten
+  processIngest();
+  
+  std::map<String, uint8_t> before;
+  collectFilters(before);
+  std::vector<MqttTopic> previous;
+  previous.swap(topics);
+  
+  // Neu aufbauen, ohne schon zu abonnieren
+  holdSubscriptions = true;
+  if (!loadTopicsFromConfig(filename)) {
+    // Fehlerhafte Datei: bisherige Topics behalten, Standard-Topics nur beim Start.
+    // loadTopicsFromConfig() bricht vor clearTopics() ab, Trie und Filter sind unverändert.
+    holdSubscriptions = false;
+    topics.swap(previous);
+    LOG_E("Topic-Konfiguration %s nicht lesbar, bisherige Topics bleiben", filename.c_str());
+    return true;  // Kein erneuter Versuch, erst die nächste Änderung der Datei
+  }
+  if (addExtras) {
+    addExtras();
+  }
+  
+  // Über Wildcards gebundene Topics, deren Filter geblieben ist
+  for (const auto& old : previous) {
+    if (!old.bound || findTopic(old.name)) {
+      continue;
+    }
+    int binding = topicTrie.match(old.topic.c_str());
+    if (binding != TopicTrie::NO_BINDING && (binding & WILDCARD_BINDING)) {
+      bindWildcardTopic(binding & ~WILDCARD_BINDING, old.topic.c_str());
+    }
+  }
+  holdSubscriptions = false;
+  
+  // Werte und Statistik unveränderter Topics übernehmen
+  int added = 0;
+  int changed = 0;
+  int kept = 0;
+  for (auto& topic : topics) {
+    const MqttTopic* old = nullptr;
+    for (const auto& candidate : previous) {
+      if (candidate.name == topic.name) {
+        old = &candidate;
+        break;
+      }
+    }
+    if (!old) {
+      added++;
+      continue;
+    }
+    kept++;
+    if (old->topic != topic.topic || old->jsonPath != topic.jsonPath || old->metric != topic.metric ||
+        old->unitIndex != topic.unitIndex || old->qos != topic.qos ||
+        old->priority != topic.priority || old->coalesce != topic.coalesce) {
+      changed++;
+    }
+    if (old->topic == topic.topic && old->jsonPath == topic.jsonPath) {
+      topic.value = old->value;
+      topic.lastUpdate = old->lastUpdate;
+      topic.restored = old->restored;
+      topic.stats = old->stats;
+    }
+  }
+  int removed = previous.size() - kept;
+  
+  // Nur die Unterschiede an den Broker senden
+  std::map<String, uint8_t> after;
+  collectFilters(after);
+  std::vector<const char*> unsubscribeList;
+  std::vector<const char*> subscribeList;
+  std::vector<uint8_t> subscribeQos;
+  for (const auto& entry : before) {
+    if (after.find(entry.first) == after.end()) {
+      unsubscribeList.push_back(entry.first.c_str());
+    }
+  }
+  for (const auto& entry : after) {
+    auto old = before.find(entry.first);
+    if (old == before.end() || old->second != entry.second) {
+      subscribeList.push_back(entry.first.c_str());
+      subscribeQos.push_back(entry.second);
+    }
+  }
+  if (mqttClient.connected()) {
+    if (!unsubscribeList.empty()) {
+      mqttClient.unsubscribe(unsubscribeList.data(), unsubscribeList.size());
+    }
+    if (!subscribeList.empty()) {
+      mqttClient.subscribe(subscribeList.data(), subscribeQos.data(), subscribeList.size());
+    }
+  }
+  
+  LOG_I("Topics neu geladen: %d neu, %d entfernt, %d geändert; %u abonniert, %u abbestellt",
+        added, removed, changed, (unsigned)subscribeList.size(), (unsigned)unsubscribeList.size());
+  return true;
 }
\ No newline at end of file
@@ -7,26 +7,89 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <PubSubClient.h>
 #include <vector>
+#include <map>
 #include <functional>
 #include "config.h"
+#include "FixedString.h"
+#include "MqttClient.h"
+#include "JsonStreamParser.h"
+#include "JsonFieldFilter.h"
+#include "IngestQueue.h"
+#include "TopicTrie.h"
+#include "DataManager.h"
 
-// MQTT Topic Struktur
+// Empfangsstatistik je Topic (Abstände und Jitter in ms)
+struct TopicStats {
+  uint32_t count = 0;          // Empfangene Nachrichten
+  uint32_t bytes = 0;          // Summe der Payload-Bytes
+  uint32_t parseFailures = 0;  // Payloads, die nicht als Zahl gelesen werden konnten
+  float interval = 0;          // Gleitender Mittelwert des Nachrichtenabstands
+  float jitter = 0;            // Gleitender Mittelwert der Abweichung vom Abstand
+  uint32_t jitterMax = 0;      // Größte Abweichung seit dem letzten Zurücksetzen
+
+  // Neue Nachricht erfassen; previous = Zeitpunkt der vorherigen Nachricht
+  void record(unsigned long now, unsigned long previous, unsigned int length);
+  
+  // Nachrichten pro Minute aus dem mittleren Abstand
+  float ratePerMinute() const { return interval > 0 ? 60000.0f / interval : 0; }
+};
+
+// Verarbeitungsreihenfolge bei Nachrichtenflut: Leistungen zuerst, Tageswerte zuletzt
+inline IngestPriority priorityForMetric(int8_t metric) {
+  switch (metric) {
+    case METRIC_PV_POWER:
+    case METRIC_GRID_POWER:
+    case METRIC_LOAD_POWER:
+    case METRIC_BATTERY_POWER:
+      return INGEST_HIGH;
+    case METRIC_DAILY_YIELD:
+      return INGEST_LOW;
+    default:
+      return INGEST_NORMAL;
+  }
+}
+
+// MQTT Topic Struktur; Texte ohne Heap, damit neue Werte nichts allokieren
 struct MqttTopic {
-  String name;             // Interner Name (z.B. "battery_soc")
-  String topic;            // MQTT Topic (z.B. "solar/battery/soc")
-  String value;            // Aktueller Wert
+  FixedString<MQTT_NAME_LENGTH> name;    // Interner Name (z.B. "battery_soc")
+  FixedString<MQTT_TOPIC_LENGTH> topic;  // MQTT Topic (z.B. "solar/battery/soc")
+  FixedString<MQTT_VALUE_LENGTH> value;  // Aktueller Wert
   unsigned long lastUpdate; // Zeitstempel der letzten Aktualisierung
+  int8_t metric;           // Gebundene Messgröße (SolarMetric) oder METRIC_NONE
+  uint8_t unitIndex;       // Wechselrichter/Batterie (0-basiert)
+  uint8_t qos;             // Abonnement mit QoS 0 oder 1
+  bool restored;           // Wert stammt aus dem Snapshot, noch keine Live-Nachricht
+  TopicStats stats;        // Rate, Jitter, Bytes, Fehler
+  FixedString<JSON_STREAM_MAX_PATH> jsonPath; // Feld im JSON-Payload des übergeordneten Topics (z.B. "ENERGY.Power")
+  int16_t parent;          // Index des Topics mit dem JSON-Payload, sonst -1
+  int16_t jsonFilter;      // Index der vorkompilierten Pfade, falls der Payload JSON ist, sonst -1
+  uint8_t priority;        // Spur in der Eingangswarteschlange (IngestPriority)
+  bool coalesce;           // Nur den neuesten wartenden Wert verarbeiten
+  bool bound;              // Beim Empfang über einen Wildcard-Filter angelegt
+
+  MqttTopic(const char* n, const char* t, int8_t m = METRIC_NONE, uint8_t u = 0, uint8_t q = 0) : 
+    name(n), topic(t), value("N/A"), lastUpdate(0), metric(m), unitIndex(u), qos(q), restored(false), parent(-1), jsonFilter(-1),
+    priority(priorityForMetric(m)), coalesce(true), bound(false) {}
 
-  MqttTopic(const String& n, const String& t) : 
-    name(n), topic(t), value("N/A"), lastUpdate(0) {}
+  bool hasJsonFields() const { return jsonFilter >= 0; }
+};
+
+// Wildcard-Abonnement (z.B. "solar_assistant/inverter_1/+/state")
+struct MqttWildcard {
+  String nameTemplate;     // '+'/'#' im Namen werden durch die erfassten Ebenen ersetzt
+  String filter;           // MQTT Topic-Filter mit '+' oder '#'
+  int8_t metric;           // Konfigurierte Messgröße, sonst aus der letzten erfassten Ebene
+  uint8_t unitIndex;       // Einheit, falls der gebildete Name keine Nummer enthält
+  uint8_t qos;
+
+  MqttWildcard(const String& n, const String& f, int8_t m = METRIC_NONE, uint8_t u = 0, uint8_t q = 0) :
+    nameTemplate(n), filter(f), metric(m), unitIndex(u), qos(q) {}
 };
 
 class MqttManager {
 private:
-  WiFiClient wifiClient;
-  PubSubClient mqttClient;
+  MqttClient mqttClient;
   
   String broker;
   int port;
@@ -38,6 +101,54 @@ private:
   friend void mqttCallback(char* topic, byte* payload, unsigned int length);
   
   std::vector<MqttTopic> topics;
+  std::vector<MqttWildcard> wildcards;
+  
+  // Zuordnung eingehender Topics zu Bindungen (Index in topics oder Wildcard)
+  static const int WILDCARD_BINDING = 0x10000;
+  TopicTrie topicTrie;
+  int dynamicTopicCount = 0;
+  uint32_t unmatchedCount = 0;  // Nachrichten ohne passendes Topic
+  
+  // Empfangene Nachrichten warten hier auf die Verarbeitung in update()
+  IngestQueue ingestQueue;
+  
+  // JSON-Payloads: eine Nachricht aus der Warteschlange und ein Strom je für sich
+  struct PayloadStats {
+    uint32_t count = 0;
+    uint32_t largest = 0;     // Größte Nachricht in Bytes
+    uint32_t peakHeap = 0;    // Größter Heap-Verbrauch während einer Nachricht
+    uint32_t errors = 0;
+  };
+  static const int PAYLOAD_SIZE_CLASSES = 5;
+  PayloadStats payloadStats[PAYLOAD_SIZE_CLASSES];
+  std::vector<JsonFieldFilter> jsonFilters;  // Je JSON-Topic, beim Laden kompiliert
+  JsonStreamParser jsonParser;
+  struct JsonMessage {
+    int topic = -1;           // -1 = keine Nachricht offen
+    size_t length = 0;
+    uint32_t heapStart = 0;
+    uint32_t heapMin = 0;
+  };
+  JsonMessage queuedJson;     // Aus processIngest(), vollständig im Speicher
+  JsonMessage streamJson;     // Über mehrere loop()-Durchläufe in Stücken
+  
+  // Beim Neuladen erst nach dem Vergleich abonnieren
+  bool holdSubscriptions = false;
+  
+  void clearTopics();
+  void reserveTopics();
+  void subscribeAll();
+  void collectFilters(std::map<String, uint8_t> &filters) const;
+  bool isCoveredByWildcard(const char* topic) const;
+  int bindWildcardTopic(int wildcardIndex, const char* topic);
+  void processIngest();
+  void processMessage(int index, const uint8_t* payload, size_t length);
+  void updateTopic(MqttTopic &topic, const char* value, size_t valueLength, unsigned long now, unsigned int length);
+  bool beginStream(const char* topic, size_t length);
+  void beginJson(JsonMessage &message, int index, size_t length);
+  void updateField(uint16_t index, const char* value);
+  void finishJson(JsonMessage &message, bool ok);
+  void trackHeap();
   
 public:
   MqttManager();
@@ -49,8 +160,32 @@ public:
   bool loadDefaultTopics();
   bool loadTopicsFromConfig(const String &filename);
   
-  bool subscribe(const String &name, const String &topic);
-  String getValue(const String &name);
+  // Topics neu laden, ohne die Verbindung zu trennen: Werte und Statistik
+  // unveränderter Topics bleiben erhalten, nur weggefallene bzw. neue Filter
+  // werden ab- bzw. abonniert. addExtras legt Topics außerhalb der Datei
+  // (z.B. Status der Steuerungen) erneut an. false, solange eine große
+  // JSON-Nachricht empfangen wird (später erneut versuchen)
+  typedef std::function<void()> ExtraTopics;
+  bool reloadTopics(const String &filename, ExtraTopics addExtras);
+  
+  // metric = METRIC_NONE: Messgröße aus dem Namen ableiten
+  bool subscribe(const String &name, const String &topic,
+                 SolarMetric metric = METRIC_NONE, uint8_t unitIndex = 0, uint8_t qos = 0);
+  
+  // Wert aus einem JSON-Payload des Topics parentName als eigenes Topic führen
+  bool addJsonField(const String &parentName, const String &name, const String &path,
+                    SolarMetric metric = METRIC_NONE, uint8_t unitIndex = 0);
+  
+  // Veröffentlichen; bei QoS 1 false, solange das In-Flight-Fenster voll ist
+  bool publish(const String &topic, const String &payload, uint8_t qos = 0, bool retain = false,
+               uint16_t* packetId = nullptr);
+  void setAckCallback(MqttClient::AckCallback callback) { mqttClient.onPublishAck = callback; }
+  // Zeiger in die Topic-Liste, gültig bis zum nächsten Laden der Topics
+  const char* getValue(const char* name) const;
+  const MqttTopic* findTopic(const char* name) const;
+  
+  // Wert aus dem Snapshot setzen, solange noch keine Live-Nachricht vorliegt
+  bool restoreValue(const char* name, const char* value);
 
   
   bool isConnected() { return connected; }
@@ -58,8 +193,33 @@ public:
   // Getter für topics hinzufügen (optional, für Debugging)
   const std::vector<MqttTopic>& getTopics() const { return topics; }
   
+  // Empfangsstatistik je Topic
+  bool isStale(const MqttTopic &topic) const;
+  uint32_t getUnmatchedCount() const { return unmatchedCount; }
+  void printStats(Print &out) const;
+  void resetStats();
+  
+  // Spur und Zusammenfassung eines Topics in der Eingangswarteschlange
+  bool setIngestOptions(const String &name, IngestPriority priority, bool coalesce);
+  void printIngestStats(Print &out) const { ingestQueue.printStats(out); }
+  size_t ingestFree() const { return INGEST_QUEUE_DEPTH - ingestQueue.size(); }
+  
+  // Alle wartenden Nachrichten sofort verarbeiten (Wiedergabe-Benchmark)
+  void drainIngest();
+  
+  // Speicherbedarf der JSON-Verarbeitung je Nachrichtengröße
+  void printPayloadStats(Print &out) const;
+  
+  // Verbindungszustand, Aufbau- und Abonnementdauer
+  void printStatus(Print &out) const { mqttClient.printStatus(out); }
+  
   typedef std::function<void()> DataCallback;
   DataCallback onDataUpdate = nullptr;
+  
+  // Wird vor onDataUpdate mit dem geänderten Topic aufgerufen;
+  // false zählt als Parse-Fehler in der Topic-Statistik
+  typedef std::function<bool(const MqttTopic&)> TopicCallback;
+  TopicCallback onTopicUpdate = nullptr;
 };
 
 
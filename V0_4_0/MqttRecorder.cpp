@@ -0,0 +1,334 @@
+/**
+ * MqttRecorder.cpp - Implementierung von Mitschnitt und Wiedergabe
+ */
+
+#define LOG_MODULE LOG_MOD_TOOLS
+
+#include "MqttRecorder.h"
+#include "MqttManager.h"
+
+// Globale Instanz
+MqttRecorder mqttRecorder;
+
+static const uint8_t CAPTURE_MAGIC[4] = {'M', 'Q', 'R', 'C'};
+static const uint8_t CAPTURE_VERSION = 1;
+static const uint8_t RECORD_TOPIC = 'T';
+static const uint8_t RECORD_MESSAGE = 'M';
+
+MqttRecorder::MqttRecorder() {
+  // Konstruktor
+}
+
+bool MqttRecorder::startRecording(const String &filename) {
+  stopRecording();
+
+  recordFile = SPIFFS.open(filename, "w");
+  if (!recordFile) {
+    DEBUG_PRINT("Mitschnitt-Datei konnte nicht geöffnet werden: ");
+    DEBUG_PRINTLN(filename);
+    return false;
+  }
+
+  DEBUG_PRINT("MQTT-Mitschnitt gestartet: ");
+  DEBUG_PRINTLN(filename);
+  return startRecording(recordFile);
+}
+
+bool MqttRecorder::startRecording(Print &out) {
+  stopRecording();
+
+  // Binärdaten und Protokollzeilen dürfen sich auf Serial nicht mischen
+  if (&out == &DEBUG_SERIAL) {
+    logger.pauseOutput(true);
+    logPaused = true;
+  }
+  sink = &out;
+  recordTopics.clear();
+  recordedMessages = 0;
+  recordedBytes = 0;
+  recordStart = millis();
+
+  writeHeader();
+  recording = true;
+  return true;
+}
+
+void MqttRecorder::stopRecording() {
+  if (!recording) {
+    return;
+  }
+
+  recording = false;
+  sink = nullptr;
+  if (recordFile) {
+    recordFile.close();
+  }
+  if (logPaused) {
+    logger.pauseOutput(false);
+    logPaused = false;
+  }
+
+  DEBUG_PRINT("MQTT-Mitschnitt beendet: ");
+  DEBUG_PRINT(recordedMessages);
+  DEBUG_PRINT(" Nachrichten, ");
+  DEBUG_PRINT(recordedBytes);
+  DEBUG_PRINTLN(" Bytes");
+}
+
+void MqttRecorder::writeHeader() {
+  sink->write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+  sink->write(CAPTURE_VERSION);
+  recordedBytes = sizeof(CAPTURE_MAGIC) + 1;
+}
+
+void MqttRecorder::writeU16(uint16_t value) {
+  sink->write((uint8_t)(value & 0xFF));
+  sink->write((uint8_t)(value >> 8));
+}
+
+void MqttRecorder::writeU32(uint32_t value) {
+  writeU16((uint16_t)(value & 0xFFFF));
+  writeU16((uint16_t)(value >> 16));
+}
+
+int MqttRecorder::topicIdFor(const char *topic) {
+  for (size_t i = 0; i < recordTopics.size(); i++) {
+    if (strcmp(recordTopics[i].c_str(), topic) == 0) {
+      return i;
+    }
+  }
+
+  size_t length = strlen(topic);
+  if (length > MQTT_REPLAY_MAX_TOPIC || recordTopics.size() >= 0xFFFF) {
+    return -1;
+  }
+
+  // Neues Topic: Definition vor der ersten Nachricht schreiben
+  uint16_t id = recordTopics.size();
+  recordTopics.push_back(String(topic));
+
+  sink->write(RECORD_TOPIC);
+  writeU16(id);
+  sink->write((uint8_t)length);
+  sink->write((const uint8_t *)topic, length);
+  recordedBytes += 4 + length;
+
+  return id;
+}
+
+void MqttRecorder::record(const char *topic, const byte *payload, unsigned int length) {
+  if (!recording || length > 0xFFFF) {
+    return;
+  }
+
+  int id = topicIdFor(topic);
+  if (id < 0) {
+    return;
+  }
+
+  sink->write(RECORD_MESSAGE);
+  writeU32(millis() - recordStart);
+  writeU16((uint16_t)id);
+  writeU16((uint16_t)length);
+  sink->write(payload, length);
+
+  recordedMessages++;
+  recordedBytes += 9 + length;
+}
+
+bool MqttRecorder::startReplay(const String &filename, uint8_t speed) {
+  stopReplay();
+
+  replayFile = SPIFFS.open(filename, "r");
+  if (!replayFile) {
+    DEBUG_PRINT("Mitschnitt nicht gefunden: ");
+    DEBUG_PRINTLN(filename);
+    return false;
+  }
+
+  uint8_t header[5];
+  if (!readBytes(header, sizeof(header)) ||
+      memcmp(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 ||
+      header[4] != CAPTURE_VERSION) {
+    DEBUG_PRINTLN("Ungültiges Mitschnitt-Format");
+    replayFile.close();
+    return false;
+  }
+
+  replayTopics.clear();
+  replaySpeed = speed;
+  pendingValid = false;
+  replayedMessages = 0;
+  replayedBytes = 0;
+  skippedMessages = 0;
+  replayBusyMicros = 0;
+  replayStart = millis();
+  replayMicrosStart = micros();
+  replaying = true;
+
+  DEBUG_PRINT("MQTT-Wiedergabe gestartet: ");
+  DEBUG_PRINT(filename);
+  DEBUG_PRINT(" (");
+  if (speed == 0) {
+    DEBUG_PRINTLN("maximal)");
+  } else {
+    DEBUG_PRINT(speed);
+    DEBUG_PRINTLN("x)");
+  }
+  return true;
+}
+
+void MqttRecorder::stopReplay() {
+  if (!replaying) {
+    return;
+  }
+  finishReplay();
+}
+
+bool MqttRecorder::readBytes(uint8_t *buffer, size_t length) {
+  return replayFile.read(buffer, length) == length;
+}
+
+bool MqttRecorder::readNextMessage() {
+  uint8_t type;
+
+  while (readBytes(&type, 1)) {
+    if (type == RECORD_TOPIC) {
+      uint8_t head[3];
+      if (!readBytes(head, sizeof(head))) {
+        return false;
+      }
+      uint16_t id = head[0] | (head[1] << 8);
+      uint8_t length = head[2];
+      if (length > MQTT_REPLAY_MAX_TOPIC || !readBytes((uint8_t *)topicBuffer, length)) {
+        return false;
+      }
+      topicBuffer[length] = '\0';
+
+      if (id >= replayTopics.size()) {
+        replayTopics.resize(id + 1);
+      }
+      replayTopics[id] = String(topicBuffer);
+    } else if (type == RECORD_MESSAGE) {
+      uint8_t head[8];
+      if (!readBytes(head, sizeof(head))) {
+        return false;
+      }
+      pendingTimestamp = (uint32_t)head[0] | ((uint32_t)head[1] << 8) |
+                         ((uint32_t)head[2] << 16) | ((uint32_t)head[3] << 24);
+      pendingTopicId = head[4] | (head[5] << 8);
+      pendingLength = head[6] | (head[7] << 8);
+
+      if (pendingLength > MQTT_REPLAY_MAX_PAYLOAD) {
+        // Zu große Nachrichten überspringen
+        replayFile.seek(pendingLength, fs::SeekCur);
+        skippedMessages++;
+        continue;
+      }
+      if (!readBytes(payloadBuffer, pendingLength)) {
+        return false;
+      }
+      payloadBuffer[pendingLength] = '\0';
+      return true;
+    } else {
+      DEBUG_PRINTLN("Beschädigter Datensatz im Mitschnitt");
+      return false;
+    }
+  }
+
+  return false;
+}
+
+void MqttRecorder::update() {
+  if (!replaying) {
+    return;
+  }
+
+  // Bei maximaler Geschwindigkeit nur eine begrenzte Anzahl pro Durchlauf,
+  // damit loop() weiterhin Touch und Anzeige bedient. Nie mehr als die
+  // Warteschlange aufnehmen kann, sonst misst die Wiedergabe Verwerfungen
+  int budget = min((int)MQTT_REPLAY_BATCH, (int)mqttManager.ingestFree());
+  int delivered = 0;
+  bool finished = false;
+
+  while (budget-- > 0) {
+    if (!pendingValid) {
+      if (!readNextMessage()) {
+        finished = true;
+        break;
+      }
+      pendingValid = true;
+    }
+
+    if (replaySpeed > 0) {
+      unsigned long elapsed = (millis() - replayStart) * replaySpeed;
+      if (elapsed < pendingTimestamp) {
+        break;  // Noch nicht fällig
+      }
+    }
+
+    pendingValid = false;
+    if (pendingTopicId >= replayTopics.size() || replayTopics[pendingTopicId].length() == 0) {
+      skippedMessages++;
+      continue;
+    }
+
+    // handleCallback erwartet einen veränderbaren Topic-Puffer wie PubSubClient
+    const String &topic = replayTopics[pendingTopicId];
+    memcpy(topicBuffer, topic.c_str(), topic.length() + 1);
+
+    unsigned long start = micros();
+    mqttManager.handleCallback(topicBuffer, payloadBuffer, pendingLength);
+    replayBusyMicros += micros() - start;
+    delivered++;
+
+    replayedMessages++;
+    replayedBytes += pendingLength;
+  }
+
+  // Zeit bis die Nachrichten verarbeitet und angezeigt sind, nicht nur eingereiht
+  if (delivered > 0) {
+    unsigned long start = micros();
+    mqttManager.drainIngest();
+    replayBusyMicros += micros() - start;
+  }
+  if (finished) {
+    finishReplay();
+  }
+}
+
+void MqttRecorder::finishReplay() {
+  replaying = false;
+  pendingValid = false;
+  replayFile.close();
+
+  DEBUG_PRINTLN("MQTT-Wiedergabe beendet");
+  printStatus();
+}
+
+void MqttRecorder::printStatus() {
+  DEBUG_PRINT("Aufnahme: ");
+  DEBUG_PRINT(recording ? "aktiv, " : "inaktiv, ");
+  DEBUG_PRINT(recordedMessages);
+  DEBUG_PRINT(" Nachrichten, ");
+  DEBUG_PRINT(recordedBytes);
+  DEBUG_PRINTLN(" Bytes");
+
+  unsigned long wall = micros() - replayMicrosStart;
+  DEBUG_PRINT("Wiedergabe: ");
+  DEBUG_PRINT(replaying ? "aktiv, " : "inaktiv, ");
+  DEBUG_PRINT(replayedMessages);
+  DEBUG_PRINT(" Nachrichten, ");
+  DEBUG_PRINT(replayedBytes);
+  DEBUG_PRINT(" Bytes, ");
+  DEBUG_PRINT(skippedMessages);
+  DEBUG_PRINTLN(" übersprungen");
+
+  if (replayedMessages > 0 && wall > 0) {
+    DEBUG_PRINT("  Durchsatz: ");
+    DEBUG_PRINT((float)replayedMessages * 1000000.0f / wall, 1);
+    DEBUG_PRINT(" Nachrichten/s, Verarbeitung: ");
+    DEBUG_PRINT(replayBusyMicros / replayedMessages);
+    DEBUG_PRINTLN(" us/Nachricht");
+  }
+}
@@ -0,0 +1,87 @@
+/**
+ * MqttRecorder.h - Mitschnitt und Wiedergabe des MQTT-Verkehrs
+ *
+ * Binärformat eines Mitschnitts:
+ *   Header:  "MQRC" (4 Bytes), Version (1 Byte)
+ *   Topic:   'T', ID (uint16), Länge (uint8), Topic-Zeichen
+ *   Message: 'M', Zeitstempel in ms (uint32), ID (uint16), Länge (uint16), Payload
+ * Alle Zahlen sind Little-Endian. Eine Topic-Definition wird einmalig vor
+ * der ersten Nachricht mit dieser ID geschrieben.
+ */
+
+#ifndef MQTT_RECORDER_H
+#define MQTT_RECORDER_H
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <vector>
+#include "config.h"
+
+class MqttRecorder {
+private:
+  // Aufnahme
+  Print *sink = nullptr;
+  File recordFile;
+  bool logPaused = false;            // Logger schweigt, solange auf Serial aufgezeichnet wird
+  bool recording = false;
+  unsigned long recordStart = 0;
+  uint32_t recordedMessages = 0;
+  uint32_t recordedBytes = 0;
+  std::vector<String> recordTopics;  // Index = Topic-ID im Mitschnitt
+
+  // Wiedergabe
+  File replayFile;
+  bool replaying = false;
+  uint8_t replaySpeed = 1;           // 1, 10 oder 0 (= maximal)
+  unsigned long replayStart = 0;
+  std::vector<String> replayTopics;
+  bool pendingValid = false;         // Nächste Nachricht bereits gelesen
+  uint32_t pendingTimestamp = 0;
+  uint16_t pendingTopicId = 0;
+  uint16_t pendingLength = 0;
+  uint8_t payloadBuffer[MQTT_REPLAY_MAX_PAYLOAD + 1];
+  char topicBuffer[MQTT_REPLAY_MAX_TOPIC + 1];
+
+  // Benchmark der Wiedergabe
+  uint32_t replayedMessages = 0;
+  uint32_t replayedBytes = 0;
+  uint32_t skippedMessages = 0;
+  unsigned long replayMicrosStart = 0;
+  unsigned long replayBusyMicros = 0;  // Empfang bis Ende von processIngest()
+
+  void writeHeader();
+  int topicIdFor(const char *topic);
+  void writeU16(uint16_t value);
+  void writeU32(uint32_t value);
+
+  bool readBytes(uint8_t *buffer, size_t length);
+  bool readNextMessage();
+  void finishReplay();
+
+public:
+  MqttRecorder();
+
+  // Aufnahme in eine SPIFFS-Datei oder einen beliebigen Ausgabestrom (z.B. Serial)
+  bool startRecording(const String &filename);
+  bool startRecording(Print &out);
+  void stopRecording();
+  bool isRecording() const { return recording; }
+
+  // Wird aus MqttManager::handleCallback für jede empfangene Nachricht aufgerufen
+  void record(const char *topic, const byte *payload, unsigned int length);
+
+  // Wiedergabe eines Mitschnitts über den normalen Callback-Pfad
+  bool startReplay(const String &filename, uint8_t speed);
+  void stopReplay();
+  bool isReplaying() const { return replaying; }
+
+  // Periodische Verarbeitung der Wiedergabe (aus loop() aufrufen)
+  void update();
+
+  // Status und Benchmark-Ergebnis auf der seriellen Schnittstelle ausgeben
+  void printStatus();
+};
+
+extern MqttRecorder mqttRecorder;
+
+#endif // MQTT_RECORDER_H
@@ -0,0 +1,213 @@
+/**
+ * PublishQueue.cpp - Implementierung der Befehlswarteschlange
+ */
+
+#define LOG_MODULE LOG_MOD_MQTT
+
+#include "PublishQueue.h"
+#include "MqttManager.h"
+
+// Globale Instanz
+PublishQueue publishQueue;
+
+PublishQueue::PublishQueue() {
+  // Konstruktor
+}
+
+void PublishQueue::begin() {
+  mqttManager.setAckCallback([this](uint16_t packetId) {
+    handleAck(packetId);
+  });
+}
+
+PublishEntry* PublishQueue::find(const String &topic) {
+  for (auto& entry : entries) {
+    if (entry.state != COMMAND_IDLE && entry.topic == topic) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+const PublishEntry* PublishQueue::find(const String &topic) const {
+  for (const auto& entry : entries) {
+    if (entry.state != COMMAND_IDLE && entry.topic == topic) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+bool PublishQueue::enqueue(const String &topic, const String &payload, uint8_t qos,
+                           bool retain, const String &echoName) {
+  PublishEntry* entry = find(topic);
+  if (entry && (entry->state == COMMAND_QUEUED || entry->state == COMMAND_SENT)) {
+    // Gleicher Befehl läuft bereits: nichts zu tun
+    if (entry->payload == payload) {
+      coalescedCount++;
+      return true;
+    }
+    // Neuerer Befehl ersetzt den alten; ein verspätetes PUBACK wird ignoriert
+    coalescedCount++;
+  } else if (!entry) {
+    // Freien Platz suchen, sonst den ältesten abgeschlossenen Befehl ersetzen
+    for (auto& candidate : entries) {
+      if (candidate.state == COMMAND_IDLE) {
+        entry = &candidate;
+        break;
+      }
+    }
+    if (!entry) {
+      for (auto& candidate : entries) {
+        if ((candidate.state == COMMAND_CONFIRMED || candidate.state == COMMAND_FAILED) &&
+            (!entry || candidate.queuedAt < entry->queuedAt)) {
+          entry = &candidate;
+        }
+      }
+    }
+    if (!entry) {
+      rejectedCount++;
+      DEBUG_PRINTLN("Befehlswarteschlange voll");
+      return false;
+    }
+  }
+
+  entry->topic = topic;
+  entry->payload = payload;
+  entry->echoName = echoName;
+  entry->qos = min(qos, (uint8_t)1);
+  entry->retain = retain;
+  entry->packetId = 0;
+  entry->acked = false;
+  entry->queuedAt = millis();
+  entry->sentAt = 0;
+  queuedCount++;
+  setState(*entry, COMMAND_QUEUED);
+  return true;
+}
+
+bool PublishQueue::send(PublishEntry &entry) {
+  if (!mqttManager.isConnected()) {
+    return false;
+  }
+
+  uint16_t packetId = 0;
+  if (!mqttManager.publish(entry.topic, entry.payload, entry.qos, entry.retain, &packetId)) {
+    return false;  // In-Flight-Fenster oder Sendepuffer voll, später erneut
+  }
+
+  entry.packetId = packetId;
+  entry.sentAt = millis();
+  if (entry.qos == 0 && entry.echoName.length() == 0) {
+    setState(entry, COMMAND_CONFIRMED);
+  } else {
+    setState(entry, COMMAND_SENT);
+  }
+  return true;
+}
+
+bool PublishQueue::echoMatches(const PublishEntry &entry) const {
+  const MqttTopic* echo = mqttManager.findTopic(entry.echoName.c_str());
+  return echo && echo->lastUpdate >= entry.sentAt && echo->value.equalsIgnoreCase(entry.payload);
+}
+
+void PublishQueue::setState(PublishEntry &entry, CommandState state) {
+  entry.state = state;
+
+  if (state == COMMAND_CONFIRMED) {
+    confirmedCount++;
+    lastConfirmTime = millis() - entry.queuedAt;
+  } else if (state == COMMAND_FAILED) {
+    failedCount++;
+    DEBUG_PRINT("Befehl nicht bestätigt: ");
+    DEBUG_PRINT(entry.topic);
+    DEBUG_PRINT(" = ");
+    DEBUG_PRINTLN(entry.payload);
+  }
+
+  if (onStateChange) {
+    onStateChange(entry.topic, state);
+  }
+}
+
+void PublishQueue::update() {
+  unsigned long now = millis();
+
+  for (auto& entry : entries) {
+    switch (entry.state) {
+      case COMMAND_QUEUED:
+        if (!send(entry) && now - entry.queuedAt > PUBLISH_CONFIRM_TIMEOUT) {
+          setState(entry, COMMAND_FAILED);
+        }
+        break;
+
+      case COMMAND_SENT:
+        if (entry.echoName.length() > 0 ? echoMatches(entry) : entry.acked) {
+          setState(entry, COMMAND_CONFIRMED);
+        } else if (now - entry.queuedAt > PUBLISH_CONFIRM_TIMEOUT) {
+          setState(entry, COMMAND_FAILED);
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
+void PublishQueue::handleAck(uint16_t packetId) {
+  for (auto& entry : entries) {
+    if (entry.state == COMMAND_SENT && entry.packetId == packetId) {
+      entry.acked = true;
+      if (entry.echoName.length() == 0) {
+        setState(entry, COMMAND_CONFIRMED);
+      }
+      return;
+    }
+  }
+}
+
+CommandState PublishQueue::getState(const String &topic, String *payload) const {
+  const PublishEntry* entry = find(topic);
+  if (!entry) {
+    return COMMAND_IDLE;
+  }
+  if (payload) {
+    *payload = entry->payload;
+  }
+  return entry->state;
+}
+
+void PublishQueue::printStatus(Print &out) const {
+  static const char* stateNames[] = { "frei", "wartet", "gesendet", "bestätigt", "fehlgeschlagen" };
+
+  out.print("Befehle: ");
+  out.print(queuedCount);
+  out.print(" eingereiht, ");
+  out.print(coalescedCount);
+  out.print(" zusammengefasst, ");
+  out.print(confirmedCount);
+  out.print(" bestätigt, ");
+  out.print(failedCount);
+  out.print(" fehlgeschlagen, ");
+  out.print(rejectedCount);
+  out.println(" abgewiesen");
+
+  out.print("Letzte Bestätigung nach ");
+  out.print(lastConfirmTime);
+  out.println(" ms");
+
+  for (const auto& entry : entries) {
+    if (entry.state == COMMAND_IDLE) {
+      continue;
+    }
+    out.print("  ");
+    out.print(entry.topic);
+    out.print(" = ");
+    out.print(entry.payload);
+    out.print(" (QoS ");
+    out.print(entry.qos);
+    out.print(entry.echoName.length() > 0 ? ", Echo): " : "): ");
+    out.println(stateNames[entry.state]);
+  }
+}
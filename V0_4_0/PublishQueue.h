@@ -0,0 +1,86 @@
+/**
+ * PublishQueue.h - Warteschlange für ausgehende Schaltbefehle
+ *
+ * Die Oberfläche reiht Befehle nur ein und kehrt sofort zurück; gesendet
+ * wird aus loop(). Wiederholte Befehle an dasselbe Topic ersetzen den noch
+ * nicht bestätigten Befehl (z.B. mehrfaches Tippen oder gehaltener Finger).
+ * Ein Befehl gilt als bestätigt
+ *   - bei QoS 0 mit der Übergabe an den Client,
+ *   - bei QoS 1 mit dem PUBACK,
+ *   - mit Echo-Topic, sobald dessen Wert dem gesendeten Payload entspricht.
+ */
+
+#ifndef PUBLISH_QUEUE_H
+#define PUBLISH_QUEUE_H
+
+#include <Arduino.h>
+#include <functional>
+#include "config.h"
+
+enum CommandState : uint8_t {
+  COMMAND_IDLE,        // Platz frei, kein Befehl bekannt
+  COMMAND_QUEUED,      // Wartet auf Verbindung oder freies In-Flight-Fenster
+  COMMAND_SENT,        // Gesendet, Bestätigung steht aus
+  COMMAND_CONFIRMED,
+  COMMAND_FAILED       // Keine Bestätigung innerhalb von PUBLISH_CONFIRM_TIMEOUT
+};
+
+struct PublishEntry {
+  String topic;
+  String payload;
+  String echoName;          // Topic-Name, dessen Wert den Befehl bestätigt (optional)
+  uint8_t qos = 0;
+  bool retain = false;
+  CommandState state = COMMAND_IDLE;
+  uint16_t packetId = 0;
+  bool acked = false;
+  unsigned long queuedAt = 0;
+  unsigned long sentAt = 0;
+};
+
+class PublishQueue {
+public:
+  typedef std::function<void(const String &topic, CommandState state)> StateCallback;
+
+private:
+  PublishEntry entries[PUBLISH_QUEUE_SIZE];
+
+  uint32_t queuedCount = 0;
+  uint32_t coalescedCount = 0;     // Durch einen neueren Befehl ersetzt
+  uint32_t confirmedCount = 0;
+  uint32_t failedCount = 0;
+  uint32_t rejectedCount = 0;      // Warteschlange voll
+  unsigned long lastConfirmTime = 0;  // Einreihen bis Bestätigung, letzter Befehl
+
+  PublishEntry* find(const String &topic);
+  const PublishEntry* find(const String &topic) const;
+  void setState(PublishEntry &entry, CommandState state);
+  bool send(PublishEntry &entry);
+  bool echoMatches(const PublishEntry &entry) const;
+
+public:
+  PublishQueue();
+
+  // PUBACKs vom MqttManager entgegennehmen
+  void begin();
+
+  // Befehl einreihen, kehrt sofort zurück; false, wenn kein Platz frei ist
+  bool enqueue(const String &topic, const String &payload, uint8_t qos = 0,
+               bool retain = false, const String &echoName = "");
+
+  // Senden, Bestätigungen und Zeitüberschreitungen (aus loop() aufrufen)
+  void update();
+
+  // Zustand des letzten Befehls an das Topic; payload erhält dessen Wert
+  CommandState getState(const String &topic, String *payload = nullptr) const;
+
+  void handleAck(uint16_t packetId);
+  void printStatus(Print &out) const;
+
+  // Wird bei jedem Zustandswechsel aufgerufen (z.B. für die Anzeige)
+  StateCallback onStateChange = nullptr;
+};
+
+extern PublishQueue publishQueue;
+
+#endif // PUBLISH_QUEUE_H
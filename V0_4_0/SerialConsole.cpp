@@ -0,0 +1,74 @@
+/**
+ * SerialConsole.cpp - Implementierung der seriellen Befehlszeile
+ */
+
+#define LOG_MODULE LOG_MOD_TOOLS
+
+#include "SerialConsole.h"
+
+// Globale Instanz
+SerialConsole serialConsole;
+
+SerialConsole::SerialConsole() {
+  // Konstruktor
+}
+
+void SerialConsole::begin(Stream &stream) {
+  input = &stream;
+  lineLength = 0;
+
+  addCommand("help", "Liste der Befehle", [this](const String &) {
+    printHelp();
+  });
+}
+
+void SerialConsole::addCommand(const String &name, const String &description, CommandHandler handler) {
+  commands[name] = handler;
+  descriptions[name] = description;
+}
+
+void SerialConsole::update() {
+  if (!input) {
+    return;
+  }
+
+  while (input->available() > 0) {
+    char c = (char)input->read();
+
+    if (c == '\r' || c == '\n') {
+      if (lineLength > 0) {
+        lineBuffer[lineLength] = '\0';
+        execute(lineBuffer);
+        lineLength = 0;
+      }
+    } else if (lineLength < CONSOLE_LINE_LENGTH) {
+      lineBuffer[lineLength++] = c;
+    }
+  }
+}
+
+void SerialConsole::execute(const char *line) {
+  // Befehlswort und Argumente trennen
+  const char *space = strchr(line, ' ');
+  String name = space ? String(line).substring(0, space - line) : String(line);
+  String args = space ? String(space + 1) : String("");
+
+  auto it = commands.find(name);
+  if (it == commands.end()) {
+    DEBUG_PRINT("Unbekannter Befehl: ");
+    DEBUG_PRINTLN(name);
+    return;
+  }
+
+  it->second(args);
+}
+
+void SerialConsole::printHelp() {
+  DEBUG_PRINTLN("Verfügbare Befehle:");
+  for (const auto &entry : descriptions) {
+    DEBUG_PRINT("  ");
+    DEBUG_PRINT(entry.first);
+    DEBUG_PRINT(" - ");
+    DEBUG_PRINTLN(entry.second);
+  }
+}
@@ -0,0 +1,45 @@
+/**
+ * SerialConsole.h - Einfache Befehlszeile über die serielle Schnittstelle
+ */
+
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <Arduino.h>
+#include <map>
+#include <functional>
+#include "config.h"
+
+class SerialConsole {
+public:
+  // Erhält den Rest der Zeile nach dem Befehlswort
+  typedef std::function<void(const String &args)> CommandHandler;
+
+private:
+  Stream *input = nullptr;
+  char lineBuffer[CONSOLE_LINE_LENGTH + 1];
+  size_t lineLength = 0;
+
+  // Registrierte Befehle und deren Kurzbeschreibung
+  std::map<String, CommandHandler> commands;
+  std::map<String, String> descriptions;
+
+  void execute(const char *line);
+
+public:
+  SerialConsole();
+
+  void begin(Stream &stream);
+
+  // Befehl registrieren, z.B. "rec" -> Handler
+  void addCommand(const String &name, const String &description, CommandHandler handler);
+
+  // Liest verfügbare Zeichen ohne zu blockieren (aus loop() aufrufen)
+  void update();
+
+  void printHelp();
+};
+
+extern SerialConsole serialConsole;
+
+#endif // SERIAL_CONSOLE_H
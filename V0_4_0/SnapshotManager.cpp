@@ -0,0 +1,172 @@
+/**
+ * SnapshotManager.cpp - Implementierung des Warmstart-Snapshots
+ */
+
+#define LOG_MODULE LOG_MOD_DATA
+
+#include "SnapshotManager.h"
+#include "MqttManager.h"
+
+// Globale Instanz
+SnapshotManager snapshotManager;
+
+static const uint32_t SNAPSHOT_MAGIC = 0x534E4150;  // "SNAP"
+static const uint8_t SNAPSHOT_VERSION = 2;  // 2: TopicEntry ohne Alter
+
+SnapshotManager::SnapshotManager() {
+  // Konstruktor
+}
+
+bool SnapshotManager::begin() {
+  opened = prefs.begin("snapshot", false);
+  if (!opened) {
+    DEBUG_PRINTLN("NVS-Snapshot konnte nicht geöffnet werden");
+  }
+  lastSave = millis();
+  return opened;
+}
+
+uint32_t SnapshotManager::hashName(const char *name) {
+  uint32_t hash = 2166136261UL;
+  while (*name) {
+    hash ^= (uint8_t)*name++;
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+bool SnapshotManager::restoreData() {
+  if (!opened || prefs.getBytesLength("data") != sizeof(DataSnapshot)) {
+    return false;
+  }
+
+  DataSnapshot snapshot;
+  prefs.getBytes("data", &snapshot, sizeof(snapshot));
+  if (snapshot.magic != SNAPSHOT_MAGIC || snapshot.version != SNAPSHOT_VERSION) {
+    DEBUG_PRINTLN("Snapshot veraltet oder ungültig, ignoriere");
+    return false;
+  }
+
+  dataManager.restoreUnits(snapshot.inverters, snapshot.batteries);
+
+  DEBUG_PRINT("Snapshot wiederhergestellt (gespeichert nach ");
+  DEBUG_PRINT(snapshot.uptime / 60);
+  DEBUG_PRINTLN(" Minuten Laufzeit)");
+  return true;
+}
+
+bool SnapshotManager::restoreTopics() {
+  size_t length = opened ? prefs.getBytesLength("topics") : 0;
+  if (length < offsetof(TopicSnapshot, entries) || length > sizeof(TopicSnapshot)) {
+    return false;
+  }
+
+  TopicSnapshot snapshot;
+  prefs.getBytes("topics", &snapshot, length);
+  if (snapshot.magic != SNAPSHOT_MAGIC || snapshot.version != SNAPSHOT_VERSION ||
+      length != offsetof(TopicSnapshot, entries) + snapshot.count * sizeof(TopicEntry)) {
+    return false;
+  }
+
+  int restored = 0;
+  for (const auto &topic : mqttManager.getTopics()) {
+    uint32_t hash = hashName(topic.name.c_str());
+    for (uint8_t i = 0; i < snapshot.count; i++) {
+      if (snapshot.entries[i].nameHash == hash) {
+        snapshot.entries[i].value[SNAPSHOT_VALUE_LENGTH - 1] = '\0';
+        if (mqttManager.restoreValue(topic.name, snapshot.entries[i].value)) {
+          restored++;
+        }
+        break;
+      }
+    }
+  }
+
+  DEBUG_PRINT("Snapshot: ");
+  DEBUG_PRINT(restored);
+  DEBUG_PRINTLN(" Topic-Werte wiederhergestellt");
+  return restored > 0;
+}
+
+bool SnapshotManager::save() {
+  if (!opened) {
+    return false;
+  }
+
+  unsigned long now = millis();
+
+  DataSnapshot data = {};
+  data.magic = SNAPSHOT_MAGIC;
+  data.version = SNAPSHOT_VERSION;
+  data.uptime = now / 1000;
+  data.inverters = dataManager.getInverters();
+  data.batteries = dataManager.getBatteries();
+  bool ok = prefs.putBytes("data", &data, sizeof(data)) == sizeof(data);
+
+  // Nur Topics mit bekanntem Wert speichern
+  TopicSnapshot topics;
+  memset(&topics, 0, sizeof(topics));
+  topics.magic = SNAPSHOT_MAGIC;
+  topics.version = SNAPSHOT_VERSION;
+  for (const auto &topic : mqttManager.getTopics()) {
+    if (topics.count >= SNAPSHOT_MAX_TOPICS) {
+      break;
+    }
+    if ((topic.lastUpdate == 0 && !topic.restored) || topic.hasJsonFields()) {
+      continue;  // Ohne Wert oder JSON-Payload (die Felder werden einzeln gespeichert)
+    }
+
+    TopicEntry &entry = topics.entries[topics.count++];
+    entry.nameHash = hashName(topic.name.c_str());
+    strncpy(entry.value, topic.value.c_str(), SNAPSHOT_VALUE_LENGTH - 1);
+  }
+  size_t length = offsetof(TopicSnapshot, entries) + topics.count * sizeof(TopicEntry);
+  ok = prefs.putBytes("topics", &topics, length) == length && ok;
+
+  dataManager.clearDirty();
+  lastSave = now;
+  saveCount++;
+
+  DEBUG_PRINT("Snapshot gespeichert: ");
+  DEBUG_PRINT(topics.count);
+  DEBUG_PRINTLN(" Topics");
+  return ok;
+}
+
+bool SnapshotManager::topicsChangedSince(unsigned long time) {
+  for (const auto &topic : mqttManager.getTopics()) {
+    if (topic.lastUpdate > time) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SnapshotManager::update() {
+  // Schreibhäufigkeit begrenzen, um den Flash zu schonen
+  if (!opened || millis() - lastSave < SNAPSHOT_INTERVAL) {
+    return;
+  }
+
+  // Simulierte Werte nicht speichern
+  if (dataManager.isSimulationMode()) {
+    lastSave = millis();
+    return;
+  }
+
+  if (dataManager.isDirty() || topicsChangedSince(lastSave)) {
+    save();
+  } else {
+    lastSave = millis();
+  }
+}
+
+void SnapshotManager::printStatus() {
+  DEBUG_PRINT("Snapshot: ");
+  DEBUG_PRINT(saveCount);
+  DEBUG_PRINT(" mal gespeichert, letzter vor ");
+  DEBUG_PRINT((millis() - lastSave) / 1000);
+  DEBUG_PRINT(" s, Intervall ");
+  DEBUG_PRINT(SNAPSHOT_INTERVAL / 1000);
+  DEBUG_PRINTLN(" s");
+}
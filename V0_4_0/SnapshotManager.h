@@ -0,0 +1,75 @@
+/**
+ * SnapshotManager.h - Speichert die letzten Messwerte im NVS für einen Warmstart
+ *
+ * Zwei kompakte Binärblöcke im NVS-Namensraum "snapshot":
+ *   "data"   - Einheitenwerte des DataManagers (Struct-of-Arrays)
+ *   "topics" - Letzter Wert je MQTT-Topic (Namens-Hash, Wert)
+ * Ohne Uhrzeit ist nicht bekannt, wie lange das Gerät aus war: wiederhergestellte
+ * Werte gelten bis zur ersten Live-Nachricht immer als veraltet.
+ * Geschrieben wird höchstens alle SNAPSHOT_INTERVAL ms und nur bei Änderungen.
+ */
+
+#ifndef SNAPSHOT_MANAGER_H
+#define SNAPSHOT_MANAGER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config.h"
+#include "DataManager.h"
+
+class SnapshotManager {
+private:
+  struct DataSnapshot {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t uptime;          // Laufzeit beim Speichern in Sekunden
+    InverterArray inverters;
+    BatteryArray batteries;
+  };
+
+  struct TopicEntry {
+    uint32_t nameHash;        // FNV-1a des Topic-Namens
+    char value[SNAPSHOT_VALUE_LENGTH];
+  };
+
+  struct TopicSnapshot {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t count;
+    uint8_t reserved[2];
+    TopicEntry entries[SNAPSHOT_MAX_TOPICS];
+  };
+
+  Preferences prefs;
+  bool opened = false;
+  unsigned long lastSave = 0;
+  uint32_t saveCount = 0;
+
+  bool topicsChangedSince(unsigned long time);
+
+public:
+  SnapshotManager();
+
+  bool begin();
+
+  // Einheitenwerte vor dem ersten Frame wiederherstellen
+  bool restoreData();
+
+  // Topic-Werte wiederherstellen (nach dem Laden der Topics)
+  bool restoreTopics();
+
+  // Snapshot sofort schreiben
+  bool save();
+
+  // Periodisches, begrenztes Speichern (aus loop() aufrufen)
+  void update();
+
+  void printStatus();
+
+  static uint32_t hashName(const char *name);
+};
+
+extern SnapshotManager snapshotManager;
+
+#endif // SNAPSHOT_MANAGER_H
@@ -0,0 +1,188 @@
+/**
+ * TopicTrie.cpp - Implementierung des Topic-Tries
+ */
+
+#include "TopicTrie.h"
+
+TopicTrie::TopicTrie() {
+  clear();
+}
+
+void TopicTrie::clear() {
+  nodes.clear();
+  nodes.push_back(Node());  // Wurzel
+}
+
+int TopicTrie::findChild(int node, const char *level, size_t length) const {
+  for (int child = nodes[node].firstChild; child >= 0; child = nodes[child].nextSibling) {
+    const String &name = nodes[child].level;
+    if (name.length() == length && strncmp(name.c_str(), level, length) == 0) {
+      return child;
+    }
+  }
+  return -1;
+}
+
+void TopicTrie::insert(const char *filter, int binding) {
+  int node = 0;
+  const char *level = filter;
+
+  while (true) {
+    const char *end = strchr(level, '/');
+    size_t length = end ? (size_t)(end - level) : strlen(level);
+
+    // '#' ist immer die letzte Ebene
+    if (length == 1 && level[0] == '#') {
+      nodes[node].hashBinding = binding;
+      return;
+    }
+
+    int child;
+    if (length == 1 && level[0] == '+') {
+      child = nodes[node].plusChild;
+      if (child < 0) {
+        child = nodes.size();
+        nodes.push_back(Node());
+        nodes[node].plusChild = child;
+      }
+    } else {
+      child = findChild(node, level, length);
+      if (child < 0) {
+        Node newNode;
+        newNode.level.concat(level, length);
+        newNode.nextSibling = nodes[node].firstChild;
+
+        child = nodes.size();
+        nodes.push_back(newNode);
+        nodes[node].firstChild = child;
+      }
+    }
+
+    node = child;
+    if (!end) {
+      nodes[node].binding = binding;
+      return;
+    }
+    level = end + 1;
+  }
+}
+
+int TopicTrie::matchFrom(int node, const char *level, bool firstLevel) const {
+  const Node &current = nodes[node];
+
+  if (level == nullptr) {
+    // Topic vollständig zerlegt; "a/#" passt laut Spezifikation auch auf "a"
+    return current.binding != NO_BINDING ? current.binding : current.hashBinding;
+  }
+
+  const char *end = strchr(level, '/');
+  size_t length = end ? (size_t)(end - level) : strlen(level);
+  const char *next = end ? end + 1 : nullptr;
+
+  int child = findChild(node, level, length);
+  if (child >= 0) {
+    int result = matchFrom(child, next, false);
+    if (result != NO_BINDING) {
+      return result;
+    }
+  }
+
+  // Wildcards passen nicht auf System-Topics wie "$SYS/..."
+  if (firstLevel && length > 0 && level[0] == '$') {
+    return NO_BINDING;
+  }
+
+  if (current.plusChild >= 0) {
+    int result = matchFrom(current.plusChild, next, false);
+    if (result != NO_BINDING) {
+      return result;
+    }
+  }
+
+  return current.hashBinding;
+}
+
+int TopicTrie::match(const char *topic) const {
+  return matchFrom(0, topic, true);
+}
+
+bool TopicTrie::isWildcard(const char *filter) {
+  return strchr(filter, '+') != nullptr || strchr(filter, '#') != nullptr;
+}
+
+bool TopicTrie::covers(const char *filter, const char *topic) {
+  while (true) {
+    const char *filterEnd = strchr(filter, '/');
+    const char *topicEnd = strchr(topic, '/');
+    size_t filterLength = filterEnd ? (size_t)(filterEnd - filter) : strlen(filter);
+    size_t topicLength = topicEnd ? (size_t)(topicEnd - topic) : strlen(topic);
+
+    if (filterLength == 1 && filter[0] == '#') {
+      return true;
+    }
+
+    bool levelMatches = (filterLength == 1 && filter[0] == '+') ||
+                        (filterLength == topicLength && strncmp(filter, topic, filterLength) == 0);
+    if (!levelMatches) {
+      return false;
+    }
+
+    if (!filterEnd || !topicEnd) {
+      // Beide müssen gleichzeitig enden ("a/#" deckt auch "a" ab)
+      if (!filterEnd && !topicEnd) {
+        return true;
+      }
+      return filterEnd && strcmp(filterEnd + 1, "#") == 0;
+    }
+
+    filter = filterEnd + 1;
+    topic = topicEnd + 1;
+  }
+}
+
+String TopicTrie::expandName(const char *nameTemplate, const char *filter, const char *topic,
+                             String *lastLevel) {
+  // Von '+' und '#' erfasste Ebenen sammeln
+  std::vector<String> captures;
+  while (*filter) {
+    const char *filterEnd = strchr(filter, '/');
+    const char *topicEnd = strchr(topic, '/');
+
+    if (filter[0] == '#') {
+      captures.push_back(String(topic));
+      break;
+    }
+    if (filter[0] == '+') {
+      String level;
+      level.concat(topic, topicEnd ? topicEnd - topic : strlen(topic));
+      captures.push_back(level);
+    }
+    if (!filterEnd || !topicEnd) {
+      break;
+    }
+    filter = filterEnd + 1;
+    topic = topicEnd + 1;
+  }
+
+  String name;
+  size_t used = 0;
+  for (const char *c = nameTemplate; *c; c++) {
+    if ((*c == '+' || *c == '#') && used < captures.size()) {
+      name += captures[used++];
+    } else {
+      name += *c;
+    }
+  }
+  if (used == 0) {
+    for (const auto &capture : captures) {
+      name += "/";
+      name += capture;
+    }
+  }
+
+  if (lastLevel) {
+    // Bei '#' nur die letzte Ebene des erfassten Rests
+    *lastLevel = captures.empty() ? String() : captures.back().substring(captures.back().lastIndexOf('/') + 1);
+  }
+  return name;
+}
@@ -0,0 +1,61 @@
+/**
+ * TopicTrie.h - Ebenenweiser Trie zur Zuordnung von MQTT-Topics
+ *
+ * Jede Ebene eines Topic-Filters ("a/+/c", "a/#") ist ein Knoten. Die
+ * Suche zerlegt das eingehende Topic direkt im Puffer und legt dabei
+ * keinen Speicher an. Exakte Ebenen haben Vorrang vor '+', '+' vor '#'.
+ */
+
+#ifndef TOPIC_TRIE_H
+#define TOPIC_TRIE_H
+
+#include <Arduino.h>
+#include <vector>
+
+class TopicTrie {
+public:
+  static const int NO_BINDING = -1;
+
+private:
+  struct Node {
+    String level;            // Name der Ebene (leer für Wurzel und '+')
+    int firstChild = -1;     // Erstes exaktes Kind
+    int nextSibling = -1;    // Nächstes Geschwister
+    int plusChild = -1;      // Kind für '+'
+    int hashBinding = NO_BINDING; // '#' unterhalb dieses Knotens
+    int binding = NO_BINDING;     // Filter endet an diesem Knoten
+  };
+
+  std::vector<Node> nodes;
+
+  int findChild(int node, const char *level, size_t length) const;
+  int matchFrom(int node, const char *level, bool firstLevel) const;
+
+public:
+  TopicTrie();
+
+  void clear();
+
+  // Filter mit Bindung eintragen (vorhandene Bindung wird ersetzt)
+  void insert(const char *filter, int binding);
+
+  // Bindung für ein konkretes Topic suchen, NO_BINDING falls keine passt
+  int match(const char *topic) const;
+
+  size_t nodeCount() const { return nodes.size(); }
+
+  // Prüft, ob ein Filter Wildcards enthält
+  static bool isWildcard(const char *filter);
+
+  // Prüft, ob ein Filter ein Topic (oder einen anderen Filter) vollständig abdeckt
+  static bool covers(const char *filter, const char *topic);
+
+  // Namen für ein vom Filter erfasstes Topic bilden: '+'/'#' in der Vorlage
+  // werden durch die erfassten Ebenen ersetzt ("inverter_1/+" wird zu
+  // "inverter_1/pv_power"), ohne Platzhalter werden sie angehängt.
+  // lastLevel erhält die letzte erfasste Ebene, z.B. "pv_power"
+  static String expandName(const char *nameTemplate, const char *filter, const char *topic,
+                           String *lastLevel = nullptr);
+};
+
+#endif // TOPIC_TRIE_H
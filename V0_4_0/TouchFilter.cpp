@@ -0,0 +1,59 @@
+/**
+ * TouchFilter.cpp - Ausreißerfeste Zusammenfassung der Touch-Messungen
+ */
+
+#include "TouchFilter.h"
+
+static bool near(const TouchSample &a, const TouchSample &b) {
+  return abs(a.x - b.x) <= TOUCH_FILTER_TOLERANCE && abs(a.y - b.y) <= TOUCH_FILTER_TOLERANCE;
+}
+
+bool TouchFilter::valid(const TouchSample &sample) {
+  return sample.z >= TOUCH_PRESSURE_MIN && sample.x >= 0 && sample.x <= 4095 &&
+         sample.y >= 0 && sample.y <= 4095;
+}
+
+bool TouchFilter::combine(const TouchSample *samples, uint8_t count, int16_t &x, int16_t &y) {
+  count = min(count, (uint8_t)TOUCH_FILTER_MAX_SAMPLES);
+  TouchSample good[TOUCH_FILTER_MAX_SAMPLES];
+  uint8_t goodCount = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (valid(samples[i])) {
+      good[goodCount++] = samples[i];
+    }
+  }
+  uint8_t needed = (count + 1) / 2;
+  if (goodCount == 0 || goodCount < needed) {
+    return false;
+  }
+
+  // Messung mit den meisten Nachbarn innerhalb der Toleranz
+  uint8_t best = 0;
+  uint8_t bestIndex = 0;
+  for (uint8_t i = 0; i < goodCount; i++) {
+    uint8_t neighbours = 0;
+    for (uint8_t j = 0; j < goodCount; j++) {
+      neighbours += near(good[i], good[j]);
+    }
+    if (neighbours > best) {
+      best = neighbours;
+      bestIndex = i;
+    }
+  }
+  if (best < needed) {
+    return false;
+  }
+
+  // Gerundetes Mittel dieser Gruppe
+  int32_t sumX = 0;
+  int32_t sumY = 0;
+  for (uint8_t j = 0; j < goodCount; j++) {
+    if (near(good[bestIndex], good[j])) {
+      sumX += good[j].x;
+      sumY += good[j].y;
+    }
+  }
+  x = (sumX + best / 2) / best;
+  y = (sumY + best / 2) / best;
+  return true;
+}
@@ -0,0 +1,35 @@
+/**
+ * TouchFilter.h - Ein Punkt aus mehreren Messungen des XPT2046
+ *
+ * Jede Abtastung besteht aus TOUCH_OVERSAMPLING Messungen mit eigenem
+ * Druckwert. Messungen mit zu wenig Druck (Finger setzt auf, hebt ab oder
+ * liegt nur leicht auf) und ungültige Werte (8191 bei offenem Bus) fallen
+ * weg. Aus den übrigen wird die größte Gruppe gemittelt, deren Messungen
+ * höchstens TOUCH_FILTER_TOLERANCE Rohwerte um eine von ihnen liegen:
+ * RANSAC, bei dem jede Messung einmal das Modell ist statt zufälliger
+ * Auswahl, was bei höchstens TOUCH_FILTER_MAX_SAMPLES Messungen billiger ist.
+ * Bleibt weniger als die Hälfte übrig, gibt es keinen Punkt.
+ */
+
+#ifndef TOUCH_FILTER_H
+#define TOUCH_FILTER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+struct TouchSample {
+  int16_t x;                   // Rohwerte 0..4095
+  int16_t y;
+  int16_t z;                   // Druck: z1 + 4095 - z2
+};
+
+class TouchFilter {
+public:
+  // false: zu wenig gültige bzw. übereinstimmende Messungen
+  static bool combine(const TouchSample *samples, uint8_t count, int16_t &x, int16_t &y);
+
+  // Messung brauchbar: genug Druck, Werte im 12-Bit-Bereich
+  static bool valid(const TouchSample &sample);
+};
+
+#endif // TOUCH_FILTER_H
@@ -0,0 +1,422 @@
+/**
+ * TouchInput.cpp - Abtast-Task, Ereignispuffer und Gestenerkennung
+ */
+
+#define LOG_MODULE LOG_MOD_UI
+
+#include "TouchInput.h"
+#include "default_data.h"
+
+// Grenzen einer brauchbaren Matrix: höchstens ein Pixel je Rohwert und ein
+// Versatz, bei dem a*rx + b*ry + c für 12-Bit-Rohwerte in int32 bleibt
+static const int32_t MATRIX_MAX_SCALE = 65536;
+static const int32_t MATRIX_MAX_OFFSET = 1L << 29;
+// Kleinere Determinanten: Punkte liegen fast auf einer Geraden
+static const int64_t MATRIX_MIN_DET = 1024;
+
+static bool matrixValid(const TouchMatrix &m) {
+  if (abs(m.a) > MATRIX_MAX_SCALE || abs(m.b) > MATRIX_MAX_SCALE ||
+      abs(m.d) > MATRIX_MAX_SCALE || abs(m.e) > MATRIX_MAX_SCALE ||
+      abs(m.c) > MATRIX_MAX_OFFSET || abs(m.f) > MATRIX_MAX_OFFSET) {
+    return false;
+  }
+  // Nicht umkehrbar: alle Punkte fielen auf eine Linie
+  return (int64_t)m.a * m.e - (int64_t)m.b * m.d != 0;
+}
+
+// Gerundete Division, auch für negative Zähler
+static int64_t divRound(int64_t num, int64_t den) {
+  if (den < 0) {
+    num = -num;
+    den = -den;
+  }
+  return num >= 0 ? (num + den / 2) / den : (num - den / 2) / den;
+}
+
+// Globale Instanz
+TouchInput touchInput;
+TouchInput *TouchInput::instance = nullptr;
+
+bool TouchInput::begin(SPIClass &spi) {
+  if (sampleTask) {
+    return true;
+  }
+  this->spi = &spi;
+  instance = this;
+
+  // Noch keine Einstellungen geladen: Grenzen aus den Standardwerten
+  if (!hasMatrix) {
+    const DefaultSettings &defaults = DEFAULT_SETTINGS;
+    setRange(defaults.touch.min_x, defaults.touch.max_x, defaults.touch.min_y, defaults.touch.max_y);
+  }
+
+  // Gleicher Kern wie loop(), höhere Priorität: abgetastet wird auch,
+  // während loop() zeichnet
+  if (xTaskCreatePinnedToCore(sampleLoop, "touch", TOUCH_TASK_STACK, this, TOUCH_TASK_PRIORITY,
+                              &sampleTask, 1) != pdPASS) {
+    LOG_E("Touch-Task nicht gestartet");
+    return false;
+  }
+
+  // Interrupt der Bibliothek ersetzen: hier wird die Task geweckt
+  detachInterrupt(digitalPinToInterrupt(XPT2046_IRQ));
+  attachInterrupt(digitalPinToInterrupt(XPT2046_IRQ), onInterrupt, FALLING);
+
+  // Liegt beim Start schon ein Finger auf, kommt keine Flanke mehr
+  xTaskNotifyGive(sampleTask);
+  return true;
+}
+
+void IRAM_ATTR TouchInput::onInterrupt() {
+  if (!instance) {
+    return;
+  }
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(instance->sampleTask, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+void TouchInput::sampleLoop(void *param) {
+  TouchInput *self = (TouchInput*)param;
+  for (;;) {
+    // Ohne Berührung schlafen, bis der IRQ-Pin fällt
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    do {
+      while (self->sample()) {
+        vTaskDelay(pdMS_TO_TICKS(TOUCH_SAMPLE_INTERVAL));
+      }
+      // Jede Messung zieht den IRQ-Pin kurz auf LOW; diese Flanken verwerfen.
+      // Ein gerade aufgesetzter Finger hält den Pin danach weiter LOW
+      ulTaskNotifyTake(pdTRUE, 0);
+    } while (digitalRead(XPT2046_IRQ) == LOW);
+  }
+}
+
+bool TouchInput::setMatrix(const TouchMatrix &matrix) {
+  if (!matrixValid(matrix)) {
+    LOG_W("Touch-Matrix verworfen: %ld %ld %ld / %ld %ld %ld", (long)matrix.a, (long)matrix.b,
+          (long)matrix.c, (long)matrix.d, (long)matrix.e, (long)matrix.f);
+    return false;
+  }
+  portENTER_CRITICAL(&lock);
+  this->matrix = matrix;
+  hasMatrix = true;
+  portEXIT_CRITICAL(&lock);
+  return true;
+}
+
+TouchMatrix TouchInput::getMatrix() {
+  portENTER_CRITICAL(&lock);
+  TouchMatrix copy = matrix;
+  portEXIT_CRITICAL(&lock);
+  return copy;
+}
+
+bool TouchInput::setRange(int32_t minX, int32_t maxX, int32_t minY, int32_t maxY) {
+  if (minX == maxX || minY == maxY) {
+    return false;
+  }
+  // Wie map(raw, min, max, 0, Breite), nur ohne Drehung
+  TouchMatrix range = {};
+  range.a = divRound((int64_t)SCREEN_WIDTH << 16, maxX - minX);
+  range.c = -range.a * minX;
+  range.e = divRound((int64_t)SCREEN_HEIGHT << 16, maxY - minY);
+  range.f = -range.e * minY;
+  return setMatrix(range);
+}
+
+bool TouchInput::computeMatrix(const int16_t screen[3][2], const int16_t raw[3][2], TouchMatrix &matrix) {
+  // Cramersche Regel relativ zum dritten Punkt; Produkte bleiben für
+  // 12-Bit-Rohwerte weit unter 2^63
+  int64_t dx0 = raw[0][0] - raw[2][0];
+  int64_t dy0 = raw[0][1] - raw[2][1];
+  int64_t dx1 = raw[1][0] - raw[2][0];
+  int64_t dy1 = raw[1][1] - raw[2][1];
+  int64_t det = dx0 * dy1 - dx1 * dy0;
+  if (det > -MATRIX_MIN_DET && det < MATRIX_MIN_DET) {
+    return false;
+  }
+
+  int32_t *row[2][3] = { { &matrix.a, &matrix.b, &matrix.c }, { &matrix.d, &matrix.e, &matrix.f } };
+  for (uint8_t axis = 0; axis < 2; axis++) {
+    int64_t u0 = screen[0][axis] - screen[2][axis];
+    int64_t u1 = screen[1][axis] - screen[2][axis];
+    int64_t scaleX = divRound((u0 * dy1 - u1 * dy0) * 65536, det);
+    int64_t scaleY = divRound((dx0 * u1 - dx1 * u0) * 65536, det);
+    if (scaleX < -MATRIX_MAX_SCALE || scaleX > MATRIX_MAX_SCALE ||
+        scaleY < -MATRIX_MAX_SCALE || scaleY > MATRIX_MAX_SCALE) {
+      return false;
+    }
+    // Versatz über alle drei Punkte gemittelt, verteilt den Rundungsfehler
+    int64_t offset = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+      offset += ((int64_t)screen[i][axis] << 16) - scaleX * raw[i][0] - scaleY * raw[i][1];
+    }
+    *row[axis][0] = scaleX;
+    *row[axis][1] = scaleY;
+    *row[axis][2] = divRound(offset, 3);
+  }
+  return matrixValid(matrix);
+}
+
+void TouchInput::transform(const TouchMatrix &m, int32_t rawX, int32_t rawY, int16_t &x, int16_t &y) {
+  // Halbes Pixel addieren: rundet statt abzuschneiden, auch am Rand
+  int32_t sx = (m.a * rawX + m.b * rawY + m.c + 0x8000) >> 16;
+  int32_t sy = (m.d * rawX + m.e * rawY + m.f + 0x8000) >> 16;
+  // Knapp außerhalb liegende Punkte auf den Rand ziehen, damit ein
+  // Ziehen zum Rand nicht abreißt
+  x = constrain(sx, (int32_t)0, (int32_t)(SCREEN_WIDTH - 1));
+  y = constrain(sy, (int32_t)0, (int32_t)(SCREEN_HEIGHT - 1));
+}
+
+void TouchInput::toScreen(int16_t rawX, int16_t rawY, int16_t &x, int16_t &y) {
+  portENTER_CRITICAL(&lock);
+  TouchMatrix m = matrix;
+  portEXIT_CRITICAL(&lock);
+  transform(m, rawX, rawY, x, y);
+}
+
+TouchInput::ReadResult TouchInput::readRaw(int16_t &rawX, int16_t &rawY) {
+  TouchSample samples[TOUCH_OVERSAMPLING];
+  spi->beginTransaction(SPISettings(2000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(XPT2046_CS, LOW);
+
+  // Jede Übertragung liefert das Ergebnis des vorigen Befehls
+  spi->transfer(0xB1 /* Z1 */);
+  int16_t z1 = spi->transfer16(0xC1 /* Z2 */) >> 3;
+  int16_t z2 = spi->transfer16(0x91 /* X */) >> 3;
+  bool pressed = z1 + 4095 - z2 >= TOUCH_PRESSURE_MIN;
+  if (pressed) {
+    spi->transfer16(0x91 /* X */);  // Erste X-Messung ist immer verrauscht
+    for (uint8_t i = 0; i < TOUCH_OVERSAMPLING; i++) {
+      samples[i].x = spi->transfer16(0xD1 /* Y */) >> 3;
+      samples[i].y = spi->transfer16(0xB1 /* Z1 */) >> 3;
+      z1 = spi->transfer16(0xC1 /* Z2 */) >> 3;
+      // Nach der letzten Messung abschalten, damit der IRQ-Pin wieder meldet
+      z2 = spi->transfer16(i + 1 < TOUCH_OVERSAMPLING ? 0x91 /* X */ : 0xD0 /* Y, aus */) >> 3;
+      samples[i].z = z1 + 4095 - z2;
+    }
+  } else {
+    spi->transfer16(0xD0 /* Y, aus */);
+  }
+  spi->transfer16(0);
+  digitalWrite(XPT2046_CS, HIGH);
+  spi->endTransaction();
+
+  if (!pressed) {
+    return READ_NONE;
+  }
+  return TouchFilter::combine(samples, TOUCH_OVERSAMPLING, rawX, rawY) ? READ_POINT : READ_REJECTED;
+}
+
+bool TouchInput::sample() {
+  int16_t x = 0;
+  int16_t y = 0;
+  int16_t rawX = 0;
+  int16_t rawY = 0;
+  ReadResult result = readRaw(rawX, rawY);
+  if (result == READ_REJECTED) {
+    // Aufsetzen, Abheben oder Störung: Zustand halten und nach
+    // TOUCH_SAMPLE_INTERVAL erneut messen
+    rejected++;
+    return true;
+  }
+  bool down = result == READ_POINT;
+  if (down) {
+    toScreen(rawX, rawY, x, y);
+  }
+
+  if (down) {
+    releaseCount = 0;
+    if (!pressed) {
+      pressed = true;
+      sampleX = x;
+      sampleY = y;
+      rawSumX = rawSumY = 0;
+      rawCount = 0;
+      push(TOUCH_DOWN, x, y, rawX, rawY);
+    } else if (abs(x - sampleX) >= TOUCH_MOVE_THRESHOLD || abs(y - sampleY) >= TOUCH_MOVE_THRESHOLD) {
+      sampleX = x;
+      sampleY = y;
+      push(TOUCH_MOVE, x, y, rawX, rawY);
+    }
+    // Für die Kalibrierung: ruhig gehaltener Finger, Mittel über die Berührung
+    if (rawCount < 0xFFFF) {
+      rawSumX += rawX;
+      rawSumY += rawY;
+      rawCount++;
+    }
+    return true;
+  }
+
+  if (!pressed) {
+    return false;  // Flanke ohne messbaren Druck
+  }
+  // Kurze Aussetzer beim Ziehen sind kein Loslassen
+  if (++releaseCount < TOUCH_RELEASE_SAMPLES) {
+    return true;
+  }
+  pressed = false;
+  releaseCount = 0;
+  push(TOUCH_UP, sampleX, sampleY, rawSumX / rawCount, rawSumY / rawCount);
+  return false;
+}
+
+void TouchInput::push(TouchEventType type, int16_t x, int16_t y, int16_t rawX, int16_t rawY) {
+  TouchEvent event;
+  event.time = millis();
+  event.x = x;
+  event.y = y;
+  event.rawX = rawX;
+  event.rawY = rawY;
+  event.type = type;
+
+  portENTER_CRITICAL(&lock);
+  // Voll: ältestes Ereignis verwerfen, damit UP nie verloren geht
+  if ((uint16_t)(writeSeq - readSeq) >= TOUCH_QUEUE_SIZE) {
+    readSeq++;
+    dropped++;
+  }
+  events[writeSeq % TOUCH_QUEUE_SIZE] = event;
+  writeSeq++;
+  portEXIT_CRITICAL(&lock);
+}
+
+bool TouchInput::pop(TouchEvent &event) {
+  bool available;
+  portENTER_CRITICAL(&lock);
+  available = readSeq != writeSeq;
+  if (available) {
+    event = events[readSeq % TOUCH_QUEUE_SIZE];
+    readSeq++;
+  }
+  portEXIT_CRITICAL(&lock);
+  return available;
+}
+
+void TouchInput::update() {
+  TouchEvent event;
+  while (pop(event)) {
+    eventCount++;
+    recognize(event);
+  }
+
+  // Gehaltener Finger erzeugt keine Ereignisse mehr, daher hier prüfen
+  uint32_t now = millis();
+  if (track.active && !track.dragging && !track.longPressSent &&
+      now - track.startTime >= GESTURE_LONG_PRESS_TIME) {
+    track.longPressSent = true;
+    emit(GESTURE_LONG_PRESS, track.startX, track.startY, 0, 0, now);
+  }
+}
+
+void TouchInput::recognize(const TouchEvent &event) {
+  if (event.type == TOUCH_DOWN) {
+    track = Track();
+  }
+  track.rawX = event.rawX;
+  track.rawY = event.rawY;
+  switch (event.type) {
+    case TOUCH_DOWN:
+      track.active = true;
+      track.startX = track.lastX = event.x;
+      track.startY = track.lastY = event.y;
+      track.startTime = track.lastTime = event.time;
+      break;
+
+    case TOUCH_MOVE: {
+      // Nach einem langen Drücken zählt die Bewegung nicht mehr
+      if (!track.active || track.longPressSent) {
+        break;
+      }
+      if (!track.dragging &&
+          abs(event.x - track.startX) <= GESTURE_TAP_SLOP &&
+          abs(event.y - track.startY) <= GESTURE_TAP_SLOP) {
+        break;
+      }
+      int16_t dx = event.x - track.lastX;
+      int16_t dy = event.y - track.lastY;
+      uint32_t dt = event.time - track.lastTime;
+      if (dt > 0) {
+        // Über zwei Abschnitte geglättet, der erste zählt allein
+        int32_t vx = dx * 1000L / (int32_t)dt;
+        int32_t vy = dy * 1000L / (int32_t)dt;
+        track.vx = track.dragging ? (track.vx + vx) / 2 : vx;
+        track.vy = track.dragging ? (track.vy + vy) / 2 : vy;
+      }
+      track.dragging = true;
+      track.lastX = event.x;
+      track.lastY = event.y;
+      track.lastTime = event.time;
+      emit(GESTURE_DRAG, event.x, event.y, dx, dy, event.time);
+      break;
+    }
+
+    case TOUCH_UP:
+      if (!track.active) {
+        break;
+      }
+      track.active = false;
+      if (track.dragging) {
+        int16_t dx = event.x - track.startX;
+        int16_t dy = event.y - track.startY;
+        // Vor dem Loslassen angehalten: kein Schwung
+        if (event.time - track.lastTime > GESTURE_STOP_TIME) {
+          track.vx = 0;
+          track.vy = 0;
+        }
+        bool swipe = event.time - track.startTime <= GESTURE_SWIPE_MAX_TIME &&
+                     max(abs(dx), abs(dy)) >= GESTURE_SWIPE_MIN_DISTANCE;
+        emit(swipe ? GESTURE_SWIPE : GESTURE_DRAG_END, track.startX, track.startY, dx, dy, event.time);
+      } else if (!track.longPressSent) {
+        // Zeitstempel zählen, auch wenn loop() verspätet auswertet
+        bool longPress = event.time - track.startTime >= GESTURE_LONG_PRESS_TIME;
+        emit(longPress ? GESTURE_LONG_PRESS : GESTURE_TAP, track.startX, track.startY, 0, 0, event.time);
+      }
+      break;
+  }
+}
+
+void TouchInput::emit(GestureType type, int16_t x, int16_t y, int16_t dx, int16_t dy, uint32_t time) {
+  Gesture gesture;
+  gesture.type = type;
+  gesture.x = x;
+  gesture.y = y;
+  gesture.dx = dx;
+  gesture.dy = dy;
+  gesture.vx = constrain(track.vx, (int32_t)-32767, (int32_t)32767);
+  gesture.vy = constrain(track.vy, (int32_t)-32767, (int32_t)32767);
+  gesture.duration = time - track.startTime;
+  gesture.rawX = track.rawX;
+  gesture.rawY = track.rawY;
+
+  counts[type]++;
+  LOG_D("Geste %s bei %d,%d (%d,%d)", gestureName(type), x, y, dx, dy);
+  if (onGesture) {
+    onGesture(gesture);
+  }
+}
+
+void TouchInput::printStatus(Print &out) {
+  out.print("Touch-Ereignisse: ");
+  out.print(eventCount);
+  out.print(", verworfen: ");
+  out.println(dropped);
+  TouchMatrix m = getMatrix();
+  char line[96];
+  snprintf(line, sizeof(line), "Matrix (Q16): x = %ld %ld %ld, y = %ld %ld %ld",
+           (long)m.a, (long)m.b, (long)m.c, (long)m.d, (long)m.e, (long)m.f);
+  out.println(line);
+  out.print("Verworfene Abtastungen (zu wenig übereinstimmende Messungen): ");
+  out.println(rejected);
+  for (uint8_t i = 0; i < GESTURE_TYPES; i++) {
+    char line[40];
+    snprintf(line, sizeof(line), "  %-11s %lu", gestureName((GestureType)i), (unsigned long)counts[i]);
+    out.println(line);
+  }
+}
+
+const char* TouchInput::gestureName(GestureType type) {
+  static const char* names[GESTURE_TYPES] = { "tap", "long-press", "drag", "drag-end", "swipe" };
+  return type < GESTURE_TYPES ? names[type] : "?";
+}
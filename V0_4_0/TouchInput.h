@@ -0,0 +1,184 @@
+/**
+ * TouchInput.h - Touch-Ereignisse aus dem XPT2046-Interrupt und Gesten
+ *
+ * Der IRQ-Pin des XPT2046 weckt eine eigene Task. Solange ein Finger
+ * aufliegt, tastet sie alle TOUCH_SAMPLE_INTERVAL ms ab und legt
+ * DOWN/MOVE/UP mit Zeitstempel in einen Ringpuffer; danach schläft sie bis
+ * zum nächsten Interrupt. Der Touch-Controller hat einen eigenen SPI-Bus
+ * (VSPI), die Task kommt dem Display also nicht in die Quere.
+ *
+ * update() aus loop() leert den Puffer und erkennt daraus Gesten:
+ *   - TAP: kurz berührt, nicht bewegt; genau einmal je Berührung
+ *   - LONG_PRESS: GESTURE_LONG_PRESS_TIME ms gehalten, ohne Bewegung
+ *   - DRAG: Bewegung über GESTURE_TAP_SLOP hinaus, dx/dy seit dem letzten DRAG
+ *   - SWIPE: schnelles Ziehen beim Loslassen, sonst DRAG_END;
+ *     beide beenden ein Ziehen und tragen die Gesamtstrecke und die
+ *     Geschwindigkeit beim Loslassen
+ *
+ * Jede Abtastung liest TOUCH_OVERSAMPLING Messungen direkt über SPI und
+ * fasst sie mit TouchFilter zusammen; die Bibliothek XPT2046_Touchscreen
+ * richtet nur Pins und Bus ein.
+ *
+ * Rohwerte werden über eine affine Matrix in Festkomma (Q16) auf das
+ * Display abgebildet: x = (a*rx + b*ry + c) >> 16, y entsprechend mit d, e, f.
+ * Damit lassen sich neben Versatz und Maßstab auch Drehung und Scherung des
+ * Panels ausgleichen, ohne Gleitkomma in der Abtast-Task. Die Matrix kommt
+ * aus der Kalibrierung über drei Punkte (computeMatrix) oder aus den
+ * Grenzen in config.json (setRange).
+ */
+
+#ifndef TOUCH_INPUT_H
+#define TOUCH_INPUT_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <functional>
+#include "config.h"
+#include "TouchFilter.h"
+
+enum TouchEventType : uint8_t {
+  TOUCH_DOWN,
+  TOUCH_MOVE,
+  TOUCH_UP
+};
+
+struct TouchEvent {
+  uint32_t time;               // millis()
+  int16_t x;                   // Displaykoordinaten
+  int16_t y;
+  int16_t rawX;                // Rohwerte; bei UP gemittelt über die Berührung
+  int16_t rawY;
+  TouchEventType type;
+};
+
+enum GestureType : uint8_t {
+  GESTURE_TAP,
+  GESTURE_LONG_PRESS,
+  GESTURE_DRAG,
+  GESTURE_DRAG_END,
+  GESTURE_SWIPE,
+  GESTURE_TYPES
+};
+
+struct Gesture {
+  GestureType type;
+  int16_t x;                   // Startpunkt, bei DRAG die aktuelle Position
+  int16_t y;
+  int16_t dx;                  // DRAG: seit dem letzten DRAG, sonst gesamt
+  int16_t dy;
+  int16_t vx;                  // px/s beim Loslassen (DRAG_END, SWIPE)
+  int16_t vy;
+  uint32_t duration;           // ms seit DOWN
+  int16_t rawX;                // Rohwerte; bei TAP gemittelt über die Berührung
+  int16_t rawY;
+
+  bool horizontal() const { return abs(dx) > abs(dy); }
+};
+
+// Festkomma Q16: 65536 = 1 Pixel je Rohwert
+struct TouchMatrix {
+  int32_t a, b, c;             // x = (a*rx + b*ry + c) >> 16
+  int32_t d, e, f;             // y = (d*rx + e*ry + f) >> 16
+};
+
+class TouchInput {
+public:
+  typedef std::function<void(const Gesture&)> GestureHandler;
+
+private:
+  SPIClass *spi = nullptr;
+  TaskHandle_t sampleTask = nullptr;
+
+  // Ringpuffer zwischen Abtast-Task und loop()
+  TouchEvent events[TOUCH_QUEUE_SIZE];
+  uint16_t writeSeq = 0;
+  uint16_t readSeq = 0;
+  uint32_t dropped = 0;
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+  // Abbildung auf das Display; unter lock, gelesen in der Task
+  TouchMatrix matrix = {};
+  bool hasMatrix = false;
+
+  // Abtastung, nur in der Task
+  bool pressed = false;
+  int16_t sampleX = 0;
+  int16_t sampleY = 0;
+  uint8_t releaseCount = 0;
+  int32_t rawSumX = 0;         // Summe der Rohwerte seit DOWN
+  int32_t rawSumY = 0;
+  uint16_t rawCount = 0;
+  uint32_t rejected = 0;       // Abtastungen ohne übereinstimmende Messungen
+
+  // Gestenerkennung, nur in loop()
+  struct Track {
+    bool active = false;
+    bool dragging = false;
+    bool longPressSent = false;
+    int16_t startX = 0;
+    int16_t startY = 0;
+    int16_t lastX = 0;
+    int16_t lastY = 0;
+    uint32_t startTime = 0;
+    uint32_t lastTime = 0;
+    int32_t vx = 0;            // px/s, geglättet
+    int32_t vy = 0;
+    int16_t rawX = 0;          // Rohwerte des letzten Ereignisses
+    int16_t rawY = 0;
+  } track;
+  uint32_t counts[GESTURE_TYPES] = {};
+  uint32_t eventCount = 0;
+
+  static TouchInput *instance;
+  static void IRAM_ATTR onInterrupt();
+  static void sampleLoop(void *param);
+
+  enum ReadResult : uint8_t {
+    READ_NONE,                 // Kein Druck
+    READ_POINT,
+    READ_REJECTED              // Druck, aber die Messungen stimmen nicht überein
+  };
+
+  // Druck prüfen und TOUCH_OVERSAMPLING Messungen lesen, wie die Bibliothek
+  // im Modus mit Drehung 1 (Rohwerte unverändert)
+  ReadResult readRaw(int16_t &rawX, int16_t &rawY);
+  // Eine Abtastung; false, solange der Finger aufliegt
+  bool sample();
+  void toScreen(int16_t rawX, int16_t rawY, int16_t &x, int16_t &y);
+  void push(TouchEventType type, int16_t x, int16_t y, int16_t rawX, int16_t rawY);
+  bool pop(TouchEvent &event);
+
+  void recognize(const TouchEvent &event);
+  void emit(GestureType type, int16_t x, int16_t y, int16_t dx, int16_t dy, uint32_t time);
+
+public:
+  // Nach touch.begin(spi) aufrufen; übernimmt den IRQ-Pin und liest selbst über spi
+  bool begin(SPIClass &spi);
+
+  // Aus loop(): Ereignisse auswerten und Gesten an onGesture melden
+  void update();
+
+  GestureHandler onGesture = nullptr;
+
+  // Kalibrierung übernehmen; false bei unbrauchbarer Matrix (z.B. entartet)
+  bool setMatrix(const TouchMatrix &matrix);
+  TouchMatrix getMatrix();
+
+  // Ohne Kalibrierung: Rohwertbereich auf das ganze Display strecken
+  bool setRange(int32_t minX, int32_t maxX, int32_t minY, int32_t maxY);
+
+  // Matrix aus drei Displaypunkten und den dort gemessenen Rohwerten;
+  // false, wenn die Punkte (nahezu) auf einer Geraden liegen
+  static bool computeMatrix(const int16_t screen[3][2], const int16_t raw[3][2], TouchMatrix &matrix);
+
+  // Rohwert abbilden, auf das Display begrenzt; nur Ganzzahlen
+  static void transform(const TouchMatrix &matrix, int32_t rawX, int32_t rawY, int16_t &x, int16_t &y);
+
+  void printStatus(Print &out);
+
+  static const char* gestureName(GestureType type);
+};
+
+extern TouchInput touchInput;
+
+#endif // TOUCH_INPUT_H
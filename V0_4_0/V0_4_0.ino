@@ -1,6 +1,6 @@
 /**
  * ESP32_SolarMonitor.ino - Hauptsketch für den ESP32 Solar Monitor
- * Version 0.4.0 - Modulare Struktur mit JSON-Konfiguration
+ * Version 0.4.1 - Modulare Struktur mit JSON-Konfiguration
  */
 
 #include <SPI.h>
@@ -15,6 +15,18 @@
 #include "ConfigManager.h"
 #include "MenuSystem.h"
 #include "ViewManager.h"
+#include "MqttRecorder.h"
+#include "SerialConsole.h"
+#include "SnapshotManager.h"
+#include "PublishQueue.h"
+#include "LatencyTracer.h"
+#include "BootSequence.h"
+#include "default_data.h"
+#include "ConfigStore.h"
+#include "HotReload.h"
+#include "JsonArena.h"
+#include "MemoryMonitor.h"
+#include "TouchInput.h"
 
 // Display Setup
 TFT_eSPI tft = TFT_eSPI();
@@ -31,241 +43,385 @@ ViewManager viewManager(tft, dataManager);
 bool inDetailView = false;
 String currentDetailFunction = "";
 
+// Startkonfiguration, bis die Netzwerkphasen sie übernommen haben
+JsonDocument bootConfig;
+String wifiSsid;
+String wifiPassword;
+String mqttBroker;
+int mqttPort = 1883;
+
 // Hilfsfunktionen
 bool isInBounds(int x, int y, int x1, int y1, int x2, int y2);
+void registerConsoleCommands();
+void registerBootPhases();
+void registerReloadHandlers();
+void loadSettings(JsonDocument &config);
+void applyUnits(JsonDocument &config);
+void applyTouch(JsonDocument &config);
+void addExtraTopics(JsonObjectConst controls);
+void handleGesture(const Gesture &gesture);
 
 void setup() {
-  // Serielle Verbindung initialisieren
+  // Serielle Verbindung initialisieren; Ausgaben laufen gepuffert, kein Warten nötig
   Serial.begin(DEBUG_BAUD_RATE);
-  delay(1000);
-  DEBUG_PRINTLN("ESP32 Solar Monitor - Version 0.4.0");
+  logger.begin();
+  DEBUG_PRINTLN("ESP32 Solar Monitor - Version 0.4.1");
+  
+  // Serielle Befehlszeile (Mitschnitt, Wiedergabe, ...)
+  serialConsole.begin(Serial);
+  registerConsoleCommands();
   
   // Random-Initialisierung für MQTT-Client-ID
   randomSeed(analogRead(0));
   
-  // Display initialisieren
-  tft.init();
-  tft.setRotation(1); // Landscape
-  tft.fillScreen(BACKGROUND);
-  tft.setTextColor(TEXT_COLOR, BACKGROUND);
-  
-  // Touchscreen initialisieren
-  touchSPI.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
-  touch.begin(touchSPI);
-  
-  // Splashscreen anzeigen
-  tft.setTextSize(2);
-  tft.setCursor(40, 80);
-  tft.println("ESP32 Solar Monitor v0.4.0");
-  tft.setCursor(80, 120);
-  tft.println("Initialisiere...");
-  
-  // SPIFFS und Konfigurationsmanager initialisieren
-  if (!configManager.begin()) {
-    tft.setTextColor(TFT_RED, BACKGROUND);
-    tft.setCursor(40, 160);
-    tft.println("SPIFFS Fehler!");
-    delay(3000);
-  }
+  // Nur das geänderte Topic übernehmen, Summen werden inkrementell nachgeführt
+  mqttManager.onTopicUpdate = [](const MqttTopic &topic) {
+    if (topic.metric == METRIC_NONE && topic.name == "reload") {
+      return hotReload.request(topic.value);
+    }
+    return dataManager.applyTopic(topic);
+  };
+  mqttManager.onDataUpdate = []() {
+    // Wenn wir in einer Detailansicht sind, aktualisieren
+    if (inDetailView) {
+      viewManager.updateView(); // Partielles Neuzeichnen
+    }
+  };
   
-  // Versuche, Konfiguration aus SPIFFS zu laden
-  JsonDocument config;
-  if (configManager.loadJsonConfig("/config.json", config)) {
-    // WLAN-Konfiguration laden
-    const char* ssid = config["wlan"]["ssid"];
-    const char* password = config["wlan"]["password"];
-    
-    // WLAN-Verbindung aufbauen
-    DEBUG_PRINTLN("Starte WLAN-Verbindung...");
-    DEBUG_PRINT("SSID: ");
-    DEBUG_PRINTLN(ssid);
-    DEBUG_PRINT("Passwort: ");
-    DEBUG_PRINTLN(password);
-    //WiFi.begin(ssid, password);
-    setup_wifi(ssid, password);
-    DEBUG_PRINT("WLAN-Status nach Verbindungsversuch: ");
-    DEBUG_PRINTLN(WiFi.status());
+  // Befehl gesendet, bestätigt oder fehlgeschlagen: Schaltflächen nachführen
+  publishQueue.onStateChange = [](const String &topic, CommandState state) {
+    if (inDetailView) {
+      viewManager.updateView();
+    }
+  };
+  
+  // Touch-Gesten gehen an das Menü bzw. die Detailansicht
+  touchInput.onGesture = handleGesture;
+  
+  // Alle Phasen bis zum bedienbaren Menü laufen hier in einem Durchgang;
+  // WLAN und MQTT werden aus loop() weitergeführt
+  registerBootPhases();
+  registerReloadHandlers();
+  bootSequence.update();
+}
 
-    // Warte auf WLAN-Verbindung mit Statusanzeige
-    tft.setTextSize(1);
+// Startphasen und ihre Abhängigkeiten
+void registerBootPhases() {
+  int display = bootSequence.add("display", {}, []() {
+    tft.init();
+    tft.setRotation(1); // Landscape
+    tft.fillScreen(BACKGROUND);
     tft.setTextColor(TEXT_COLOR, BACKGROUND);
-    tft.setCursor(80, 160);
-    tft.print("Verbinde mit WLAN: ");
-    tft.println(ssid);
     
-    int dots = 0;
-    unsigned long startAttempt = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startAttempt < 60000) { // Max. 20 Sekunden warten
-      delay(500);
-      tft.print(".");
-      dots++;
-      // Innerhalb der while-Schleife
-      if (dots % 5 == 0) {
-        DEBUG_PRINT("Status: ");
-        DEBUG_PRINTLN(WiFi.status());
-      }
-      // Zeilenumbruch nach 20 Punkten
-      if (dots % 20 == 0) {
-        tft.println();
-        tft.setCursor(80, tft.getCursorY());
-      }
+    // Splashscreen, bis das Menü steht
+    tft.setTextSize(2);
+    tft.setCursor(40, 80);
+    tft.println("ESP32 Solar Monitor v0.4.1");
+    tft.setCursor(80, 120);
+    tft.println("Initialisiere...");
+    return BOOT_DONE;
+  });
+  
+  int touchscreen = bootSequence.add("touch", {}, []() {
+    touchSPI.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
+    touch.begin(touchSPI);
+    return touchInput.begin(touchSPI) ? BOOT_DONE : BOOT_FAILED;
+  });
+  
+  // SPIFFS und Konfigurationsmanager
+  int files = bootSequence.add("spiffs", {display}, []() {
+    if (!configManager.begin()) {
+      tft.setTextColor(TFT_RED, BACKGROUND);
+      tft.setCursor(40, 160);
+      tft.println("SPIFFS Fehler!");
+      
+      // Konfiguration, Menü und Topics laufen mit den Standardwerten weiter
+      LOG_E("SPIFFS nicht verfügbar, verwende Standardwerte aus dem Flash");
+      return BOOT_FAILED;
+    }
+    return BOOT_DONE;
+  });
+  
+  // Letzte bekannte Werte aus dem NVS laden, damit die erste Ansicht nicht leer ist
+  int snapshot = bootSequence.add("snapshot", {}, []() {
+    // Wiederhergestellte Werte nicht von Simulationsdaten überschreiben lassen
+    if (snapshotManager.begin() && snapshotManager.restoreData()) {
+      dataManager.setSimulationMode(false);
+    }
+    return BOOT_DONE;
+  });
+  
+  int config = bootSequence.add("config", {BootSequence::after(files)}, []() {
+    // Ohne SPIFFS gelten nur die Standardwerte, Änderungen werden nicht gespeichert
+    if (configManager.isMounted()) {
+      configStore.begin(SPIFFS);
     }
+    loadSettings(bootConfig);
+    applyUnits(bootConfig);
+    applyTouch(bootConfig);
     
-    if (WiFi.status() == WL_CONNECTED) {
-
-      DEBUG_PRINTLN("WLAN-Verbindung Timeout erreicht!");
-      DEBUG_PRINT("Letzter Status: ");
-      DEBUG_PRINTLN(WiFi.status());
-      // Status-Codes: 0=IDLE, 1=NO_SSID_AVAIL, 3=CONNECTED, 4=CONNECT_FAILED, 6=DISCONNECTED
-      
-      DEBUG_PRINT("RSSI: ");
-      DEBUG_PRINTLN(WiFi.RSSI()); // Signalstärke, falls verfügbar
-      tft.println("\nVerbunden!");
+    // Fehlende Werte aus data/config.json, als Tabelle im Flash
+    const DefaultSettings &defaults = DEFAULT_SETTINGS;
+    wifiSsid = bootConfig["wlan"]["ssid"] | defaults.wlan.ssid;
+    wifiPassword = bootConfig["wlan"]["password"] | defaults.wlan.password;
+    mqttBroker = bootConfig["mqtt"]["broker"] | defaults.mqtt.broker;
+    mqttPort = bootConfig["mqtt"]["port"] | (int)defaults.mqtt.port;
+    return BOOT_DONE;
+  });
+  
+  // Menü zeichnen: ab hier ist das Gerät bedienbar. Ohne Touch bleibt es
+  // wenigstens sichtbar und über die serielle Konsole erreichbar
+  bootSequence.add("menu", {display, BootSequence::after(touchscreen), BootSequence::after(files)}, []() {
+    if (!menuSystem.loadFromJson("/menu.json")) {
       tft.setCursor(80, tft.getCursorY() + 10);
-      tft.print("IP: ");
-      tft.println(WiFi.localIP().toString());
-      
-      // MQTT-Konfiguration laden und initialisieren
-      const char* mqtt_broker = config["mqtt"]["broker"];
-      int mqtt_port = config["mqtt"]["port"];
-      
-      if (mqttManager.begin(mqtt_broker, mqtt_port)) {
-        tft.println("MQTT verbunden!");
-        
-        // MQTT-Topics aus Konfigurationsdatei laden
-        if (mqttManager.loadTopicsFromConfig("/mqtt_topics.json")) {
-          tft.println("MQTT-Topics geladen");
-        } else {
-          tft.println("Standard-MQTT-Topics verwendet");
-          mqttManager.loadDefaultTopics();
-        }
-        
-        // Simulationsmodus ausschalten, da wir echte Daten haben
-        dataManager.setSimulationMode(false);
-        
-        // Callback für Datenaktualisierung
-        mqttManager.onDataUpdate = []() {
-          dataManager.updateFromMqtt(mqttManager);
-          
-          // Wenn wir in einer Detailansicht sind, aktualisieren
-          if (inDetailView) {
-            viewManager.showView(currentDetailFunction);
-          }
-        };
-      } else {
-        tft.println("MQTT-Verbindung fehlgeschlagen");
-        tft.println("Verwende Simulationsdaten...");
-        
-        // Simulationsmodus beibehalten
-        dataManager.setSimulationMode(true);
-      }
-    } else {
-      tft.println("\nWLAN-Verbindung fehlgeschlagen!");
-      tft.println("Verwende Simulationsdaten...");
-      
-      // Simulationsmodus beibehalten
-      dataManager.setSimulationMode(true);
+      tft.println("Fehler beim Laden des Menüs!");
+      return BOOT_FAILED;
     }
-  } else {
-    // Keine Konfiguration gefunden
-    tft.setTextColor(TFT_YELLOW, BACKGROUND);
-    tft.setCursor(40, 160);
-    tft.println("Keine Konfiguration gefunden!");
-    tft.println("Verwende Standardwerte...");
+    menuSystem.drawMenu(true);
     
-    // WLAN-Verbindung mit Standard-Werten aufbauen
-    WiFi.begin(DEFAULT_WIFI_SSID, DEFAULT_WIFI_PASS);
-    DEBUG_PRINT("WLAN-Status: ");
-    DEBUG_PRINTLN(WiFi.status());
-    // Simulationsmodus beibehalten
-    dataManager.setSimulationMode(true);
-  }
-  
-  delay(2000); // Kurz anzeigen
-  
-  // Menüsystem aus JSON laden
-  if (menuSystem.loadFromJson("/menu.json")) {
-    tft.setCursor(80, tft.getCursorY() + 10);
-    tft.println("Menü geladen!");
-  } else {
-    tft.setCursor(80, tft.getCursorY() + 10);
-    tft.println("Fehler beim Laden des Menüs!");
-  }
+    // Simuliere Datenaktualisierung falls nötig
+    dataManager.update();
+    bootSequence.markInteractive();
+    return BOOT_DONE;
+  });
   
-  delay(1000);
+  // Topics unabhängig vom Netz, damit Snapshot-Werte sofort sichtbar sind
+  int topics = bootSequence.add("topics", {config, snapshot}, []() {
+    if (!mqttManager.loadTopicsFromConfig("/mqtt_topics.json")) {
+      LOG_W("Standard-MQTT-Topics verwendet");
+      mqttManager.loadDefaultTopics();
+    }
+    
+    // Letzte Topic-Werte bis zur ersten Live-Nachricht anzeigen
+    snapshotManager.restoreTopics();
+    
+    // Steuerungen (Heizung, Pool) und deren Status-Topics
+    addExtraTopics(bootConfig["controls"]);
+    publishQueue.begin();
+    
+    // Die Konfiguration wird danach nicht mehr gebraucht
+    bootConfig.clear();
+    
+    // Ab hier ersetzen Änderungen keine Startwerte mehr, sondern werden neu geladen
+    hotReload.begin();
+    return BOOT_DONE;
+  });
   
-  // Menü zeichnen
-  menuSystem.drawMenu(true);
+  // WLAN-Verbindung im Hintergrund
+  int wifi = bootSequence.add("wifi", {config}, [started = false, warned = false]() mutable {
+    if (!started) {
+      DEBUG_PRINT("Starte WLAN-Verbindung mit ");
+      DEBUG_PRINTLN(wifiSsid);
+      WiFi.mode(WIFI_STA);
+      WiFi.begin(wifiSsid.c_str(), wifiPassword.c_str());
+      started = true;
+      return BOOT_PENDING;
+    }
+    if (WiFi.status() != WL_CONNECTED) {
+      // Weiter versuchen, bis dahin bleiben die Simulationsdaten aktiv
+      if (!warned && millis() > WIFI_CONNECT_WARN) {
+        LOG_W("WLAN noch nicht verbunden (Status %d), verwende Simulationsdaten", (int)WiFi.status());
+        warned = true;
+      }
+      return BOOT_PENDING;
+    }
+    
+    DEBUG_PRINT("WLAN verbunden, IP: ");
+    DEBUG_PRINT(WiFi.localIP().toString());
+    DEBUG_PRINT(", RSSI: ");
+    DEBUG_PRINTLN(WiFi.RSSI());
+    return BOOT_DONE;
+  });
   
-  // Simuliere Datenaktualisierung falls nötig
-  dataManager.update();
+  // Der Verbindungsaufbau läuft im Hintergrund weiter (mqttManager.update())
+  bootSequence.add("mqtt", {wifi, topics}, [started = false]() mutable {
+    if (!started) {
+      if (mqttBroker.length() == 0) {
+        LOG_W("Kein MQTT-Broker konfiguriert, verwende Simulationsdaten");
+        return BOOT_FAILED;
+      }
+      // Ein fehlgeschlagener Versuch wird in update() wiederholt
+      mqttManager.begin(mqttBroker, mqttPort);
+      started = true;
+      return BOOT_PENDING;
+    }
+    if (!mqttManager.isConnected()) {
+      return BOOT_PENDING;
+    }
+    
+    // Simulationsmodus ausschalten, da wir echte Daten haben
+    dataManager.setSimulationMode(false);
+    return BOOT_DONE;
+  });
 }
 
 void loop() {
+  // Offene Startphasen (WLAN, MQTT) weiterführen
+  bootSequence.update();
+  
   // MQTT-Verbindung prüfen und aktualisieren
   mqttManager.update();
+  publishQueue.update();
+  
+  // Serielle Befehle und laufende Wiedergabe eines Mitschnitts
+  serialConsole.update();
+  mqttRecorder.update();
+  
+  // Geänderte Konfiguration übernehmen
+  hotReload.update();
+  
+  // Letzte Werte in begrenzten Abständen sichern
+  snapshotManager.update();
+  
+  // Heap-Verlauf und laufender Dauertest
+  memoryMonitor.update();
   
   // Datenmanager regelmäßig aktualisieren
   dataManager.update();
   
-  // Prüfe auf Touch-Events
-  if (touch.tirqTouched() && touch.touched()) {
-    TS_Point p = touch.getPoint();
-    
-    // Validierung von ungültigen Touch-Werten
-    if (p.x == 8191 || p.y == 8191) {
-      // Ungültige Touch-Werte, ignorieren
-      delay(10);
-      return;
+  // Touch-Ereignisse aus der Abtast-Task auswerten, Gesten an handleGesture()
+  touchInput.update();
+  
+  // Schwung der Menüliste und noch nicht gezeichnete Verschiebung bzw.
+  // zeitabhängige Werte der Detailansicht
+  if (!inDetailView) {
+    menuSystem.update();
+  } else {
+    viewManager.update();
+  }
+  
+  // Kleine Verzögerung
+  delay(10);
+}
+
+// Eine erkannte Geste je nach Ansichtsmodus verarbeiten
+void handleGesture(const Gesture &gesture) {
+  if (inDetailView) {
+    // Zurück-Button oder nach rechts wischen
+    bool back = gesture.type == GESTURE_TAP && viewManager.isBackButtonTouched(gesture.x, gesture.y);
+    back |= gesture.type == GESTURE_SWIPE && gesture.horizontal() && gesture.dx > 0;
+    if (back) {
+      inDetailView = false;
+      currentDetailFunction = "";
+      menuSystem.drawMenu(true);
+    } else {
+      // Schaltflächen der Detailansicht, z.B. EIN/AUS der Steuerungen
+      viewManager.handleGesture(gesture);
     }
-    
-    // Touchpoint auf Displaykoordinaten mappen
-    int x = map(p.x, TOUCH_MIN_X, TOUCH_MAX_X, 0, SCREEN_WIDTH);
-    int y = map(p.y, TOUCH_MIN_Y, TOUCH_MAX_Y, 0, SCREEN_HEIGHT);
-    
-    // Prüfe auf gültige Werte innerhalb des Bildschirms
-    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
-      DEBUG_PRINTLN("Touch außerhalb des Bildschirms, ignoriere...");
+    return;
+  }
+  
+  // Im Menü: An das Menüsystem weiterleiten
+  menuSystem.handleGesture(gesture);
+  menuSystem.drawMenu();
+  
+  // Prüfen, ob ein Menüpunkt ausgewählt wurde
+  if (menuSystem.getSelectedMenuItem() >= 0) {
+    const char* functionName = menuSystem.getSelectedFunction();
+    if (functionName[0] != '\0') {
+      inDetailView = true;
+      currentDetailFunction = functionName;
+      // Für die erste Anzeige showView() verwenden
+      viewManager.showView(functionName);
+    }
+    // Auswahl zurücksetzen
+    menuSystem.resetSelection();
+  }
+}
+
+// config.json (bzw. Standardwerte) mit den Einstellungen aus dem Journal
+void loadSettings(JsonDocument &config) {
+  if (!configManager.loadJsonConfig("/config.json", config)) {
+    LOG_I("Keine config.json, verwende Standardwerte");
+  }
+  
+  // Einzeln geänderte Einstellungen liegen über Datei und Standardwerten
+  configStore.apply(config);
+}
+
+// Anzahl der Wechselrichter und Batteriebänke
+void applyUnits(JsonDocument &config) {
+  const DefaultSettings &defaults = DEFAULT_SETTINGS;
+  JsonObject units = config["units"];
+  float capacities[MAX_BATTERIES] = {0};
+  JsonArray capacityList = units["battery_capacity_ah"];
+  if (capacityList.isNull()) {
+    const int capacityCount = sizeof(defaults.units.battery_capacity_ah) / sizeof(defaults.units.battery_capacity_ah[0]);
+    for (int i = 0; i < capacityCount && i < MAX_BATTERIES; i++) {
+      capacities[i] = defaults.units.battery_capacity_ah[i];
+    }
+  } else {
+    int i = 0;
+    for (JsonVariant capacity : capacityList) {
+      if (i >= MAX_BATTERIES) break;
+      capacities[i++] = capacity.as<float>();
+    }
+  }
+  dataManager.configureUnits(units["inverters"] | (int)defaults.units.inverters,
+                             units["batteries"] | (int)defaults.units.batteries, capacities);
+}
+
+// Touch-Abbildung: kalibrierte Matrix, sonst die Grenzen der Rohwerte
+void applyTouch(JsonDocument &config) {
+  JsonObject touchConfig = config["touch"];
+  JsonArray values = touchConfig["matrix"];
+  if (values.size() == 6) {
+    TouchMatrix matrix = { values[0].as<int32_t>(), values[1].as<int32_t>(), values[2].as<int32_t>(),
+                           values[3].as<int32_t>(), values[4].as<int32_t>(), values[5].as<int32_t>() };
+    if (touchInput.setMatrix(matrix)) {
       return;
     }
-    
-    DEBUG_PRINT("Touch bei x=");
-    DEBUG_PRINT(x);
-    DEBUG_PRINT(", y=");
-    DEBUG_PRINTLN(y);
-    
-    // Behandlung je nach Ansichtsmodus
-    if (inDetailView) {
-      // In Detailansicht: Prüfe auf Zurück-Button
-      if (viewManager.isBackButtonTouched(x, y)) {
-        inDetailView = false;
-        currentDetailFunction = "";
-        menuSystem.drawMenu(true);
-        delay(200);
-      }
-      // Weitere Touch-Handling in der Detailansicht könnte hier implementiert werden
-    } else {
-      // Im Menü: An das Menüsystem weiterleiten
-      menuSystem.handleTouch(x, y);
+    LOG_W("touch.matrix ungültig, verwende min_x..max_y");
+  }
+  const DefaultSettings &defaults = DEFAULT_SETTINGS;
+  if (!touchInput.setRange(touchConfig["min_x"] | defaults.touch.min_x, touchConfig["max_x"] | defaults.touch.max_x,
+                           touchConfig["min_y"] | defaults.touch.min_y, touchConfig["max_y"] | defaults.touch.max_y)) {
+    LOG_W("Touch-Grenzen ungültig");
+  }
+}
+
+// Topics außerhalb von mqtt_topics.json: Status der Steuerungen, Neuladen
+void addExtraTopics(JsonObjectConst controls) {
+  viewManager.loadControls(controls);
+  mqttManager.subscribe("reload", CONFIG_RELOAD_TOPIC);
+}
+
+// Neuladen ohne Neustart; jeder Handler übernimmt nur die Unterschiede
+void registerReloadHandlers() {
+  hotReload.setHandler(RELOAD_MENU, "/menu.json", []() {
+    // Im Menü sofort zeichnen, sonst beim Verlassen der Detailansicht
+    if (menuSystem.reload("/menu.json") > 0 && !inDetailView && menuSystem.needsRedraw()) {
       menuSystem.drawMenu();
-      
-      // Prüfen, ob ein Menüpunkt ausgewählt wurde
-      if (menuSystem.getSelectedMenuItem() >= 0) {
-        String functionName = menuSystem.getSelectedFunction();
-        if (functionName.length() > 0) {
-          inDetailView = true;
-          currentDetailFunction = functionName;
-          viewManager.showView(functionName);
-        }
-        
-        // Auswahl zurücksetzen
-        menuSystem.resetSelection();
-      }
     }
-  }
+    return true;
+  });
   
-  // Kleine Verzögerung
-  delay(10);
+  hotReload.setHandler(RELOAD_TOPICS, "/mqtt_topics.json", []() {
+    JsonDocument config(&jsonArena);
+    loadSettings(config);
+    return mqttManager.reloadTopics("/mqtt_topics.json", [&config]() {
+      addExtraTopics(config["controls"]);
+    });
+  });
+  
+  hotReload.setHandler(RELOAD_SETTINGS, "/config.json", []() {
+    JsonDocument config(&jsonArena);
+    loadSettings(config);
+    applyUnits(config);
+    applyTouch(config);
+    
+    // WLAN und Broker nicht im laufenden Betrieb wechseln
+    const DefaultSettings &defaults = DEFAULT_SETTINGS;
+    if (wifiSsid != (config["wlan"]["ssid"] | defaults.wlan.ssid) ||
+        mqttBroker != (config["mqtt"]["broker"] | defaults.mqtt.broker) ||
+        mqttPort != (config["mqtt"]["port"] | (int)defaults.mqtt.port)) {
+      LOG_W("WLAN- und MQTT-Einstellungen werden erst nach einem Neustart übernommen");
+    }
+    
+    // Steuerungen und ihre Status-Topics über den Topic-Vergleich
+    hotReload.request(RELOAD_TOPICS);
+    return true;
+  });
 }
 
 // Hilfsfunktion: Prüft, ob ein Punkt (x,y) innerhalb eines Rechtecks (x1,y1,x2,y2) liegt
@@ -273,42 +429,227 @@ bool isInBounds(int x, int y, int x1, int y1, int x2, int y2) {
   return (x >= x1 && x <= x2 && y >= y1 && y <= y2);
 }
 
-void setup_wifi(const char* ssid, const char* password) {
-  delay(10);
-  DEBUG_PRINTLN();
-  DEBUG_PRINT("Verbinde mit ");
-  DEBUG_PRINTLN(ssid);
-  
-  WiFi.disconnect(true);  // Trenne alle bestehenden Verbindungen
-  delay(500);
-  WiFi.mode(WIFI_STA);
-  delay(500);
-  
-  WiFi.begin(ssid, password);
-  
-  int dots = 0;
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    tft.print(".");
-    DEBUG_PRINT(".");
-    dots++;
+// Registriert die Befehle der seriellen Konsole
+void registerConsoleCommands() {
+  // rec start [datei|serial] / rec stop / rec status
+  serialConsole.addCommand("rec", "MQTT-Mitschnitt: rec start [datei|serial] | stop | status", [](const String &args) {
+    if (args.startsWith("start")) {
+      String target = args.length() > 6 ? args.substring(6) : String(MQTT_CAPTURE_FILE);
+      if (target == "serial") {
+        mqttRecorder.startRecording(Serial);
+      } else {
+        mqttRecorder.startRecording(target);
+      }
+    } else if (args == "stop") {
+      mqttRecorder.stopRecording();
+    } else {
+      mqttRecorder.printStatus();
+    }
+  });
+  
+  // replay [datei] [1|10|max] / replay stop
+  serialConsole.addCommand("replay", "Mitschnitt abspielen: replay [datei] [1|10|max] | stop", [](const String &args) {
+    if (args == "stop") {
+      mqttRecorder.stopReplay();
+      return;
+    }
     
-    // Zeilenumbruch nach 20 Punkten
-    if (dots % 20 == 0) {
-      tft.println();
-      tft.setCursor(80, tft.getCursorY());
-      DEBUG_PRINTLN();
+    String filename = MQTT_CAPTURE_FILE;
+    uint8_t speed = 1;
+    int space = args.indexOf(' ');
+    String first = space >= 0 ? args.substring(0, space) : args;
+    String second = space >= 0 ? args.substring(space + 1) : String("");
+    
+    if (first.startsWith("/")) {
+      filename = first;
+    } else {
+      second = first;
+    }
+    if (second == "max") {
+      speed = 0;
+    } else if (second == "10") {
+      speed = 10;
     }
     
-    // Alle 5 Punkte den Status ausgeben
-    if (dots % 5 == 0) {
-      DEBUG_PRINT("Status: ");
-      DEBUG_PRINTLN(WiFi.status());
+    mqttRecorder.startReplay(filename, speed);
+  });
+  
+  // mqtt: Verbindungszustand und Dauer bis alle Topics abonniert sind
+  serialConsole.addCommand("mqtt", "MQTT-Verbindungsstatus", [](const String &args) {
+    mqttManager.printStatus(Serial);
+    publishQueue.printStatus(Serial);
+  });
+  
+  // json: Speicherbedarf der JSON-Verarbeitung je Nachrichtengröße
+  serialConsole.addCommand("json", "JSON-Payloads und Arena: json | json reset", [](const String &args) {
+    if (args == "reset") {
+      jsonArena.resetStats();
+      return;
     }
-  }
+    mqttManager.printPayloadStats(Serial);
+    jsonArena.printStatus(Serial);
+  });
+  
+  // jsonbench [n]: vollständige vs. gefilterte vs. inkrementelle Verarbeitung
+  serialConsole.addCommand("jsonbench", "JSON-Vergleich: jsonbench [durchläufe]", [](const String &args) {
+    int iterations = args.length() > 0 ? args.toInt() : 100;
+    JsonFieldFilter::runBenchmark(Serial, constrain(iterations, 1, 10000));
+  });
+  
+  // memory / memory history / memory reset / memory soak <tage|stop>
+  serialConsole.addCommand("memory", "Heap: memory | history | reset | soak <tage|stop>", [](const String &args) {
+    if (args == "history") {
+      memoryMonitor.printHistory(Serial);
+    } else if (args == "reset") {
+      memoryMonitor.resetStats();
+    } else if (args == "soak stop") {
+      memoryMonitor.stopSoak();
+    } else if (args.startsWith("soak")) {
+      String rest = args.substring(4);
+      rest.trim();
+      int days = rest.length() > 0 ? rest.toInt() : 7;
+      memoryMonitor.startSoak(constrain(days, 1, 365));
+    } else {
+      memoryMonitor.printStatus(Serial);
+    }
+  });
+  
+  // touch: Ereignisse und erkannte Gesten
+  serialConsole.addCommand("touch", "Touch-Ereignisse und Gesten | touch reset (Kalibrierung löschen)", [](const String &args) {
+    if (args == "reset") {
+      // Zurück auf die Grenzen aus config.json, falls die Kalibrierung misslungen ist
+      configStore.remove("touch.matrix");
+      JsonDocument config(&jsonArena);
+      loadSettings(config);
+      config["touch"].remove("matrix");
+      applyTouch(config);
+      Serial.println("Touch-Kalibrierung gelöscht");
+      return;
+    }
+    touchInput.printStatus(Serial);
+  });
+  
+  // menu: Bildpuffer und Zeichenzeit der Menüliste
+  serialConsole.addCommand("menu", "Menüliste: Bildpuffer und Zeichenzeit je Bild", [](const String &args) {
+    menuSystem.printStatus(Serial);
+  });
   
-  DEBUG_PRINTLN("");
-  DEBUG_PRINTLN("WiFi verbunden");
-  DEBUG_PRINT("IP-Adresse: ");
-  DEBUG_PRINTLN(WiFi.localIP());
-}
\ No newline at end of file
+  // ingest: Spuren der Eingangswarteschlange
+  serialConsole.addCommand("ingest", "Eingangswarteschlange: Ersetzungen, Verwerfungen, Wartezeit", [](const String &args) {
+    mqttManager.printIngestStats(Serial);
+  });
+  
+  // log / log dump / log level <modul|all> <stufe>
+  serialConsole.addCommand("log", "Protokoll: log | log dump | log level <modul|all> <error|warn|info|debug>", [](const String &args) {
+    if (args == "dump") {
+      for (uint32_t seq = 0; seq < logger.sequence(); seq++) {
+        Logger::Entry entry;
+        if (logger.read(seq, entry)) {
+          logger.printEntry(Serial, entry);
+        }
+      }
+    } else if (args.startsWith("level ")) {
+      String rest = args.substring(6);
+      rest.trim();
+      int space = rest.indexOf(' ');
+      String moduleName = space > 0 ? rest.substring(0, space) : "";
+      String levelName = space > 0 ? rest.substring(space + 1) : "";
+      levelName.trim();
+      
+      LogLevel level;
+      LogModule module;
+      if (!Logger::levelFromName(levelName, level)) {
+        Serial.println("Unbekannte Stufe (error, warn, info, debug)");
+      } else if (moduleName == "all") {
+        logger.setLevel(level);
+      } else if (Logger::moduleFromName(moduleName, module)) {
+        logger.setLevel(module, level);
+      } else {
+        Serial.println("Unbekanntes Modul (main, config, mqtt, data, ui, tools, all)");
+      }
+    } else {
+      logger.printStatus(Serial);
+    }
+  });
+  
+  // config / config rebuild
+  serialConsole.addCommand("config", "Konfigurations-Snapshots: config | config rebuild", [](const String &args) {
+    if (args == "rebuild") {
+      configManager.clearSnapshots();
+      Serial.println("Snapshots gelöscht, beim nächsten Laden wird JSON geparst");
+    } else {
+      configManager.printStatus(Serial);
+    }
+  });
+  
+  // settings / settings set <schlüssel> <wert> / settings del <schlüssel> / settings compact
+  serialConsole.addCommand("settings", "Einstellungsjournal: settings | settings set <schlüssel> <wert> | settings del <schlüssel> | settings compact", [](const String &args) {
+    if (args.startsWith("set ")) {
+      String rest = args.substring(4);
+      rest.trim();
+      int space = rest.indexOf(' ');
+      if (space <= 0) {
+        Serial.println("Aufruf: settings set <schlüssel> <wert>");
+      } else if (configStore.set(rest.substring(0, space), rest.substring(space + 1))) {
+        Serial.println("Gespeichert");
+        hotReload.request(RELOAD_SETTINGS);
+      } else {
+        Serial.println("Speichern fehlgeschlagen");
+      }
+    } else if (args.startsWith("del ")) {
+      String key = args.substring(4);
+      key.trim();
+      configStore.remove(key);
+      hotReload.request(RELOAD_SETTINGS);
+    } else if (args == "compact") {
+      configStore.compact();
+      configStore.printStatus(Serial);
+    } else {
+      configStore.printValues(Serial);
+      configStore.printStatus(Serial);
+    }
+  });
+  
+  // reload / reload menu|topics|settings|all
+  serialConsole.addCommand("reload", "Ohne Neustart neu laden: reload | reload <menu|topics|settings|all>", [](const String &args) {
+    if (args.length() == 0) {
+      hotReload.printStatus(Serial);
+    } else if (!hotReload.request(args.c_str())) {
+      Serial.println("Unbekanntes Ziel (menu, topics, settings, all)");
+    }
+  });
+  
+  // boot
+  serialConsole.addCommand("boot", "Dauer der Startphasen und Zeit bis zum bedienbaren Menü", [](const String &args) {
+    bootSequence.printReport(Serial);
+  });
+  
+  // trace / trace dump / trace reset
+  serialConsole.addCommand("trace", "Latenz Empfang bis Anzeige: trace | trace dump | trace reset", [](const String &args) {
+    if (args == "dump") {
+      latencyTracer.dump(Serial);
+    } else if (args == "reset") {
+      latencyTracer.reset();
+    } else {
+      latencyTracer.printStats(Serial);
+    }
+  });
+  
+  // stats / stats reset
+  serialConsole.addCommand("stats", "MQTT-Statistik je Topic: stats | stats reset", [](const String &args) {
+    if (args == "reset") {
+      mqttManager.resetStats();
+    } else {
+      mqttManager.printStats(Serial);
+    }
+  });
+  
+  // snapshot save / snapshot status
+  serialConsole.addCommand("snapshot", "Warmstart-Snapshot: snapshot save | status", [](const String &args) {
+    if (args == "save") {
+      snapshotManager.save();
+    } else {
+      snapshotManager.printStatus();
+    }
+  });
+}
@@ -2,9 +2,17 @@
  * ViewManager.cpp - Implementierung der Detailansichten
  */
 
+#define LOG_MODULE LOG_MOD_UI
+
 #include "ViewManager.h"
 #include "MqttManager.h"
+#include "LatencyTracer.h"
+#include "default_data.h"
+#include "JsonArena.h"
+#include "MemoryMonitor.h"
+#include "ConfigStore.h"
 #include <WiFi.h>
+#include <algorithm>
 
 // Externe Globale Variablen
 extern TFT_eSPI tft;
@@ -30,6 +38,8 @@ ViewManager::ViewManager(TFT_eSPI &tft, DataManager &dataManager)
   viewFunctions["drawAutarky"] = &ViewManager::drawAutarky;
   viewFunctions["drawDailyValues"] = &ViewManager::drawDailyValues;
   viewFunctions["drawStatistics"] = &ViewManager::drawStatistics;
+  viewFunctions["drawInverters"] = &ViewManager::drawInverters;
+  viewFunctions["drawBatteries"] = &ViewManager::drawBatteries;
   
   viewFunctions["controlHeating"] = &ViewManager::controlHeating;
   viewFunctions["controlPool"] = &ViewManager::controlPool;
@@ -37,7 +47,11 @@ ViewManager::ViewManager(TFT_eSPI &tft, DataManager &dataManager)
   viewFunctions["setupWifi"] = &ViewManager::setupWifi;
   viewFunctions["setupMqtt"] = &ViewManager::setupMqtt;
   viewFunctions["setupDisplay"] = &ViewManager::setupDisplay;
+  viewFunctions["calibrateTouch"] = &ViewManager::calibrateTouch;
   viewFunctions["showSystemInfo"] = &ViewManager::showSystemInfo;
+  viewFunctions["showTopicStats"] = &ViewManager::showTopicStats;
+  viewFunctions["showLatency"] = &ViewManager::showLatency;
+  viewFunctions["viewLogs"] = &ViewManager::showLogs;
 
   // Registriere alle Update-Funktionen in der Map
   updateFunctions["drawSolarStatus"] = &ViewManager::updateSolarStatus;
@@ -48,6 +62,8 @@ ViewManager::ViewManager(TFT_eSPI &tft, DataManager &dataManager)
   updateFunctions["drawAutarky"] = &ViewManager::updateAutarky;
   updateFunctions["drawDailyValues"] = &ViewManager::updateDailyValues;
   updateFunctions["drawStatistics"] = &ViewManager::updateStatistics;
+  updateFunctions["drawInverters"] = &ViewManager::updateInverters;
+  updateFunctions["drawBatteries"] = &ViewManager::updateBatteries;
   
   updateFunctions["controlHeating"] = &ViewManager::updateHeating;
   updateFunctions["controlPool"] = &ViewManager::updatePool;
@@ -56,9 +72,13 @@ ViewManager::ViewManager(TFT_eSPI &tft, DataManager &dataManager)
   updateFunctions["setupMqtt"] = &ViewManager::updateMqtt;
   updateFunctions["setupDisplay"] = &ViewManager::updateDisplay;
   updateFunctions["showSystemInfo"] = &ViewManager::updateSystemInfo;
+  updateFunctions["showTopicStats"] = &ViewManager::updateTopicStats;
+  updateFunctions["showLatency"] = &ViewManager::updateLatency;
+  updateFunctions["viewLogs"] = &ViewManager::updateLogs;
 }
 
-bool ViewManager::showView(const String &functionName) {
+bool ViewManager::showView(const char* functionName) {
+  MemoryScope memoryScope(LOG_MODULE);
   currentView = functionName;
   
   // Bildschirm löschen
@@ -81,6 +101,9 @@ bool ViewManager::showView(const String &functionName) {
   
   // Speichere aktuelle Daten als Referenz
   lastDrawnData = dataManager.getData();
+  lastDrawnInverters = dataManager.getInverters();
+  lastDrawnBatteries = dataManager.getBatteries();
+  lastDrawnStaleMask = dataManager.getStaleMask();
   
   // Prüfe, ob die Funktion existiert
   auto it = viewFunctions.find(functionName);
@@ -95,13 +118,17 @@ bool ViewManager::showView(const String &functionName) {
     // Nach dem ersten Zeichnen Flag zurücksetzen
     isInitialDraw = false;
     
+    // Pixel sind übertragen: Latenzmessung der angezeigten Werte abschließen
+    latencyTracer.complete();
+    
     return true;
   } else {
     // Funktion nicht gefunden
     tft.setTextColor(TEXT_COLOR, BACKGROUND);
     tft.setTextSize(1);
     tft.setCursor(20, 70);
-    tft.println("Ansicht nicht implementiert: " + functionName);
+    tft.print("Ansicht nicht implementiert: ");
+    tft.println(functionName);
     
     drawStatusBar();
     
@@ -112,11 +139,17 @@ bool ViewManager::showView(const String &functionName) {
 }
 
 bool ViewManager::updateView() {
+  MemoryScope memoryScope(LOG_MODULE);
   // Nur aktualisieren, wenn wir eine aktuelle Ansicht haben
   if (currentView.length() == 0) {
     return false;
   }
   
+  // Werte aus dem Snapshot sind live geworden: Farben komplett neu zeichnen
+  if (dataManager.getStaleMask() != lastDrawnStaleMask) {
+    return showView(currentView);
+  }
+  
   // Prüfe, ob die Update-Funktion existiert
   auto it = updateFunctions.find(currentView);
   if (it != updateFunctions.end()) {
@@ -129,6 +162,11 @@ bool ViewManager::updateView() {
     
     // Aktualisiere gespeicherte Daten
     lastDrawnData = dataManager.getData();
+    lastDrawnInverters = dataManager.getInverters();
+    lastDrawnBatteries = dataManager.getBatteries();
+    
+    // TFT_eSPI schreibt synchron, die Pixel sind bereits übertragen
+    latencyTracer.complete();
     
     return true;
   }
@@ -148,7 +186,7 @@ void ViewManager::updateSolarStatus() {
     
     // Neuen Wert schreiben
     tft.setCursor(200, 80);
-    tft.setTextColor(TFT_GREEN, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_PV_POWER, TFT_GREEN), BACKGROUND);
     tft.print(currentData.pvPower);
     tft.print(" W");
   }
@@ -160,7 +198,7 @@ void ViewManager::updateSolarStatus() {
     
     // Neuen Wert schreiben
     tft.setCursor(200, 100);
-    tft.setTextColor(TFT_RED, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_LOAD_POWER, TFT_RED), BACKGROUND);
     tft.print(currentData.loadPower);
     tft.print(" W");
   }
@@ -173,11 +211,11 @@ void ViewManager::updateSolarStatus() {
     // Neuen Wert schreiben
     tft.setCursor(200, 120);
     if (currentData.gridPower < 0) {
-      tft.setTextColor(TFT_GREEN, BACKGROUND); // Einspeisung
+      tft.setTextColor(valueColor(METRIC_GRID_POWER, TFT_GREEN), BACKGROUND); // Einspeisung
       tft.print(abs(currentData.gridPower));
       tft.print(" W (Einspeisung)");
     } else {
-      tft.setTextColor(TFT_RED, BACKGROUND); // Bezug
+      tft.setTextColor(valueColor(METRIC_GRID_POWER, TFT_RED), BACKGROUND); // Bezug
       tft.print(currentData.gridPower);
       tft.print(" W (Bezug)");
     }
@@ -191,11 +229,11 @@ void ViewManager::updateSolarStatus() {
     // Neuen Wert schreiben
     tft.setCursor(200, 140);
     if (currentData.batteryPower > 0) {
-      tft.setTextColor(TFT_GREEN, BACKGROUND); // Laden
+      tft.setTextColor(valueColor(METRIC_BATTERY_POWER, TFT_GREEN), BACKGROUND); // Laden
       tft.print(currentData.batteryPower);
       tft.print(" W (Laden)");
     } else {
-      tft.setTextColor(TFT_RED, BACKGROUND); // Entladen
+      tft.setTextColor(valueColor(METRIC_BATTERY_POWER, TFT_RED), BACKGROUND); // Entladen
       tft.print(abs(currentData.batteryPower));
       tft.print(" W (Entladen)");
     }
@@ -220,7 +258,7 @@ void ViewManager::updateSolarStatus() {
     
     // Neuen Wert schreiben
     tft.setCursor(200, 180);
-    tft.setTextColor(TFT_YELLOW, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_BATTERY_SOC, TFT_YELLOW), BACKGROUND);
     tft.print(currentData.batterySOC);
     tft.print(" %");
   }
@@ -233,7 +271,7 @@ void ViewManager::updateBatteryStatus() {
   tft.setTextSize(1);
   
   // Batterieparameter aus der Konfiguration laden
-  JsonDocument config;
+  JsonDocument config(&jsonArena);
   float batteryCapacityAh = 360.0;  // Standardwert
   float batteryNomVoltage = 51.2;   // Standardwert für 16S LiFePO4
   float targetSOC = 80.0;           // Standard-Ziel-SOC
@@ -255,7 +293,7 @@ void ViewManager::updateBatteryStatus() {
     
     // Neuen Wert schreiben
     tft.setCursor(200, 80);
-    tft.setTextColor(TFT_YELLOW, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_BATTERY_SOC, TFT_YELLOW), BACKGROUND);
     tft.print(currentData.batterySOC);
     tft.print(" %");
     
@@ -305,11 +343,11 @@ void ViewManager::updateBatteryStatus() {
     // Neuen Wert schreiben
     tft.setCursor(200, 150);
     if (currentData.batteryPower > 0) {
-      tft.setTextColor(TFT_GREEN, BACKGROUND);
+      tft.setTextColor(valueColor(METRIC_BATTERY_POWER, TFT_GREEN), BACKGROUND);
       tft.print(currentData.batteryPower);
       tft.print(" W (Laden)");
     } else {
-      tft.setTextColor(TFT_RED, BACKGROUND);
+      tft.setTextColor(valueColor(METRIC_BATTERY_POWER, TFT_RED), BACKGROUND);
       tft.print(abs(currentData.batteryPower));
       tft.print(" W (Entladen)");
     }
@@ -402,7 +440,7 @@ void ViewManager::updateBatteryStatus() {
     
     // Neuen Wert schreiben
     tft.setCursor(200, 170);
-    tft.setTextColor(TFT_CYAN, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_BATTERY_VOLTAGE, TFT_CYAN), BACKGROUND);
     tft.print(currentData.batteryVoltage);
     tft.print(" V");
   }
@@ -421,11 +459,11 @@ void ViewManager::updateGridStatus() {
     // Neuen Wert schreiben
     tft.setCursor(200, 80);
     if (currentData.gridPower < 0) {
-      tft.setTextColor(TFT_GREEN, BACKGROUND);
+      tft.setTextColor(valueColor(METRIC_GRID_POWER, TFT_GREEN), BACKGROUND);
       tft.print(abs(currentData.gridPower));
       tft.print(" W (Einspeisung)");
     } else {
-      tft.setTextColor(TFT_RED, BACKGROUND);
+      tft.setTextColor(valueColor(METRIC_GRID_POWER, TFT_RED), BACKGROUND);
       tft.print(currentData.gridPower);
       tft.print(" W (Bezug)");
     }
@@ -497,12 +535,70 @@ void ViewManager::updateStatistics() {
   // Implementierung entsprechend der Ansicht
 }
 
+void ViewManager::updateInverters() {
+  const InverterArray& inverters = dataManager.getInverters();
+  SolarData& currentData = dataManager.getData();
+  bool countChanged = inverters.count != lastDrawnInverters.count;
+  
+  if (countChanged) {
+    // Tabellenbereich leeren, alle Zeilen neu zeichnen
+    tft.fillRect(0, 75, SCREEN_WIDTH, 140, BACKGROUND);
+    int lineY = 80 + inverters.count * 20 + 2;
+    tft.drawLine(20, lineY, SCREEN_WIDTH - 20, lineY, TFT_DARKGREY);
+  }
+  
+  // Nur Zeilen mit geänderten Werten neu zeichnen
+  for (int i = 0; i < inverters.count; i++) {
+    if (countChanged ||
+        inverters.pvPower[i] != lastDrawnInverters.pvPower[i] ||
+        inverters.loadPower[i] != lastDrawnInverters.loadPower[i] ||
+        inverters.gridPower[i] != lastDrawnInverters.gridPower[i]) {
+      drawInverterRow(i, "WR " + String(i + 1), inverters.pvPower[i], inverters.loadPower[i], inverters.gridPower[i]);
+    }
+  }
+  
+  if (countChanged ||
+      currentData.pvPower != lastDrawnData.pvPower ||
+      currentData.loadPower != lastDrawnData.loadPower ||
+      currentData.gridPower != lastDrawnData.gridPower) {
+    drawInverterRow(inverters.count, "Gesamt", currentData.pvPower, currentData.loadPower, currentData.gridPower);
+  }
+}
+
+void ViewManager::updateBatteries() {
+  const BatteryArray& batteries = dataManager.getBatteries();
+  SolarData& currentData = dataManager.getData();
+  bool countChanged = batteries.count != lastDrawnBatteries.count;
+  
+  if (countChanged) {
+    tft.fillRect(0, 75, SCREEN_WIDTH, 140, BACKGROUND);
+    int lineY = 80 + batteries.count * 20 + 2;
+    tft.drawLine(20, lineY, SCREEN_WIDTH - 20, lineY, TFT_DARKGREY);
+  }
+  
+  for (int i = 0; i < batteries.count; i++) {
+    if (countChanged ||
+        batteries.soc[i] != lastDrawnBatteries.soc[i] ||
+        batteries.power[i] != lastDrawnBatteries.power[i] ||
+        batteries.voltage[i] != lastDrawnBatteries.voltage[i]) {
+      drawBatteryRow(i, "Bank " + String(i + 1), batteries.soc[i], batteries.power[i], batteries.voltage[i]);
+    }
+  }
+  
+  if (countChanged ||
+      currentData.batterySOC != lastDrawnData.batterySOC ||
+      currentData.batteryPower != lastDrawnData.batteryPower ||
+      currentData.batteryVoltage != lastDrawnData.batteryVoltage) {
+    drawBatteryRow(batteries.count, "Gesamt", currentData.batterySOC, currentData.batteryPower, currentData.batteryVoltage);
+  }
+}
+
 void ViewManager::updateHeating() {
-  // Implementierung entsprechend der Ansicht
+  drawControlState(false);
 }
 
 void ViewManager::updatePool() {
-  // Implementierung entsprechend der Ansicht
+  drawControlState(false);
 }
 
 void ViewManager::updateWifi() {
@@ -540,6 +636,25 @@ void ViewManager::updateSystemInfo() {
   tft.print("Speicher: ");
   tft.print(ESP.getFreeHeap() / 1024);
   tft.println(" KB frei");
+  
+  drawMemoryInfo();
+}
+
+// Zerstückelung: wie viel vom freien Speicher nicht am Stück verfügbar ist
+void ViewManager::drawMemoryInfo() {
+  MemorySample sample = MemoryMonitor::sample();
+  tft.fillRect(20, 190, 300, 30, BACKGROUND);
+  tft.setCursor(20, 190);
+  tft.print("Größter Block: ");
+  tft.print(sample.largestBlock / 1024);
+  tft.print(" KB (");
+  tft.print(sample.fragmentation());
+  tft.println(" % zerstückelt)");
+  
+  tft.setCursor(20, 210);
+  tft.print("Minimum: ");
+  tft.print(ESP.getMinFreeHeap() / 1024);
+  tft.println(" KB frei");
 }
 void ViewManager::drawBackButton() {
   tft.fillRoundRect(10, 10, 50, 30, 5, TFT_DARKGREY);
@@ -610,7 +725,7 @@ void ViewManager::drawSolarStatus() {
   tft.setCursor(20, 80);
   tft.print("PV Leistung:");
   tft.setCursor(200, 80);
-  tft.setTextColor(TFT_GREEN, BACKGROUND);
+  tft.setTextColor(valueColor(METRIC_PV_POWER, TFT_GREEN), BACKGROUND);
   tft.print(solarData.pvPower);
   tft.print(" W");
   
@@ -619,7 +734,7 @@ void ViewManager::drawSolarStatus() {
   tft.setTextColor(TEXT_COLOR, BACKGROUND);
   tft.print("Verbrauch:");
   tft.setCursor(200, 100);
-  tft.setTextColor(TFT_RED, BACKGROUND);
+  tft.setTextColor(valueColor(METRIC_LOAD_POWER, TFT_RED), BACKGROUND);
   tft.print(solarData.loadPower);
   tft.print(" W");
   
@@ -629,11 +744,11 @@ void ViewManager::drawSolarStatus() {
   tft.print("Netz:");
   tft.setCursor(200, 120);
   if (solarData.gridPower < 0) {
-    tft.setTextColor(TFT_GREEN, BACKGROUND); // Einspeisung
+    tft.setTextColor(valueColor(METRIC_GRID_POWER, TFT_GREEN), BACKGROUND); // Einspeisung
     tft.print(abs(solarData.gridPower));
     tft.print(" W (Einspeisung)");
   } else {
-    tft.setTextColor(TFT_RED, BACKGROUND); // Bezug
+    tft.setTextColor(valueColor(METRIC_GRID_POWER, TFT_RED), BACKGROUND); // Bezug
     tft.print(solarData.gridPower);
     tft.print(" W (Bezug)");
   }
@@ -644,11 +759,11 @@ void ViewManager::drawSolarStatus() {
   tft.print("Batterie:");
   tft.setCursor(200, 140);
   if (solarData.batteryPower > 0) {
-    tft.setTextColor(TFT_GREEN, BACKGROUND); // Laden
+    tft.setTextColor(valueColor(METRIC_BATTERY_POWER, TFT_GREEN), BACKGROUND); // Laden
     tft.print(solarData.batteryPower);
     tft.print(" W (Laden)");
   } else {
-    tft.setTextColor(TFT_RED, BACKGROUND); // Entladen
+    tft.setTextColor(valueColor(METRIC_BATTERY_POWER, TFT_RED), BACKGROUND); // Entladen
     tft.print(abs(solarData.batteryPower));
     tft.print(" W (Entladen)");
   }
@@ -667,7 +782,7 @@ void ViewManager::drawSolarStatus() {
   tft.setTextColor(TEXT_COLOR, BACKGROUND);
   tft.print("Batterieladung:");
   tft.setCursor(200, 180);
-  tft.setTextColor(TFT_YELLOW, BACKGROUND);
+  tft.setTextColor(valueColor(METRIC_BATTERY_SOC, TFT_YELLOW), BACKGROUND);
   tft.print(solarData.batterySOC);
   tft.print(" %");
 }
@@ -682,7 +797,7 @@ void ViewManager::drawBatteryStatus() {
   SolarData& solarData = dataManager.getData();
   
   // Batterieparameter aus der Konfiguration laden
-  JsonDocument config;
+  JsonDocument config(&jsonArena);
   float batteryCapacityAh = 360.0;  // Standardwert
   float batteryNomVoltage = 51.2;   // Standardwert für 16S LiFePO4
   float targetSOC = 80.0;           // Standard-Ziel-SOC
@@ -704,7 +819,7 @@ void ViewManager::drawBatteryStatus() {
   tft.setCursor(20, 80);
   tft.print("Ladezustand (SOC):");
   tft.setCursor(200, 80);
-  tft.setTextColor(TFT_YELLOW, BACKGROUND);
+  tft.setTextColor(valueColor(METRIC_BATTERY_SOC, TFT_YELLOW), BACKGROUND);
   tft.print(solarData.batterySOC);
   tft.print(" %");
   
@@ -738,11 +853,11 @@ void ViewManager::drawBatteryStatus() {
   tft.print("Batterieleistung:");
   tft.setCursor(200, 150);
   if (solarData.batteryPower > 0) {
-    tft.setTextColor(TFT_GREEN, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_BATTERY_POWER, TFT_GREEN), BACKGROUND);
     tft.print(solarData.batteryPower);
     tft.print(" W (Laden)");
   } else {
-    tft.setTextColor(TFT_RED, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_BATTERY_POWER, TFT_RED), BACKGROUND);
     tft.print(abs(solarData.batteryPower));
     tft.print(" W (Entladen)");
   }
@@ -752,7 +867,7 @@ void ViewManager::drawBatteryStatus() {
   tft.setTextColor(TEXT_COLOR, BACKGROUND);
   tft.print("Batteriespannung:");
   tft.setCursor(200, 170);
-  tft.setTextColor(TFT_CYAN, BACKGROUND);
+  tft.setTextColor(valueColor(METRIC_BATTERY_VOLTAGE, TFT_CYAN), BACKGROUND);
   tft.print(solarData.batteryVoltage);
   tft.print(" V");
   
@@ -863,11 +978,11 @@ void ViewManager::drawGridStatus() {
   tft.print("Aktuelle Leistung:");
   tft.setCursor(200, 80);
   if (solarData.gridPower < 0) {
-    tft.setTextColor(TFT_GREEN, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_GRID_POWER, TFT_GREEN), BACKGROUND);
     tft.print(abs(solarData.gridPower));
     tft.print(" W (Einspeisung)");
   } else {
-    tft.setTextColor(TFT_RED, BACKGROUND);
+    tft.setTextColor(valueColor(METRIC_GRID_POWER, TFT_RED), BACKGROUND);
     tft.print(solarData.gridPower);
     tft.print(" W (Bezug)");
   }
@@ -952,49 +1067,252 @@ void ViewManager::drawStatistics() {
   tft.println("Statistik Ansicht wird geladen...");
 }
 
-// Steuerungsfunktionen
-void ViewManager::controlHeating() {
+// Tabellenzeile für einen Wechselrichter; die Summenzeile folgt nach den Einheiten
+uint16_t ViewManager::valueColor(SolarMetric metric, uint16_t liveColor) {
+  // Noch nicht bestätigte Werte aus dem Snapshot grau darstellen
+  return dataManager.isStale(metric) ? STALE_COLOR : liveColor;
+}
+
+void ViewManager::drawInverterRow(int row, const String &label, float pv, float load, float grid) {
+  int y = 80 + row * 20 + (row == dataManager.getInverters().count ? 10 : 0);
+  tft.fillRect(20, y, SCREEN_WIDTH - 20, 10, BACKGROUND);
   tft.setTextSize(1);
+  
   tft.setTextColor(TEXT_COLOR, BACKGROUND);
+  tft.setCursor(20, y);
+  tft.print(label);
   
-  // Einfache Platzhalter-Anzeige für Steuerungsfunktionen
-  tft.setCursor(20, 70);
-  tft.println("Steuerungsfunktion: Heizung");
+  tft.setTextColor(valueColor(METRIC_PV_POWER, TFT_GREEN), BACKGROUND);
+  tft.setCursor(100, y);
+  tft.print(pv, 0);
+  tft.print(" W");
   
-  // ON/OFF Schaltflächen
-  drawButton(60, 100, 80, 40, "EIN", TFT_GREEN);
-  drawButton(180, 100, 80, 40, "AUS", TFT_RED);
+  tft.setTextColor(valueColor(METRIC_LOAD_POWER, TFT_RED), BACKGROUND);
+  tft.setCursor(170, y);
+  tft.print(load, 0);
+  tft.print(" W");
   
-  // Status
-  tft.setCursor(20, 160);
-  tft.println("Status: Inaktiv");
+  tft.setTextColor(valueColor(METRIC_GRID_POWER, grid < 0 ? TFT_GREEN : TFT_RED), BACKGROUND);
+  tft.setCursor(240, y);
+  tft.print(grid, 0);
+  tft.print(" W");
+}
+
+void ViewManager::drawBatteryRow(int row, const String &label, float soc, float power, float voltage) {
+  int y = 80 + row * 20 + (row == dataManager.getBatteries().count ? 10 : 0);
+  tft.fillRect(20, y, SCREEN_WIDTH - 20, 10, BACKGROUND);
+  tft.setTextSize(1);
   
-  // Weitere Informationen
-  tft.setCursor(20, 180);
-  tft.println("Tippen Sie auf EIN oder AUS, um das Gerät zu steuern.");
+  tft.setTextColor(TEXT_COLOR, BACKGROUND);
+  tft.setCursor(20, y);
+  tft.print(label);
+  
+  tft.setTextColor(valueColor(METRIC_BATTERY_SOC, TFT_YELLOW), BACKGROUND);
+  tft.setCursor(100, y);
+  tft.print(soc, 1);
+  tft.print(" %");
+  
+  tft.setTextColor(valueColor(METRIC_BATTERY_POWER, power > 0 ? TFT_GREEN : TFT_RED), BACKGROUND);
+  tft.setCursor(170, y);
+  tft.print(power, 0);
+  tft.print(" W");
+  
+  tft.setTextColor(valueColor(METRIC_BATTERY_VOLTAGE, TFT_CYAN), BACKGROUND);
+  tft.setCursor(240, y);
+  tft.print(voltage, 1);
+  tft.print(" V");
+}
+
+void ViewManager::drawInverters() {
+  const InverterArray& inverters = dataManager.getInverters();
+  SolarData& solarData = dataManager.getData();
+  
+  tft.setTextSize(1);
+  tft.setTextColor(TEXT_COLOR, BACKGROUND);
+  tft.setCursor(20, 60);
+  tft.print("Einheit");
+  tft.setCursor(100, 60);
+  tft.print("PV");
+  tft.setCursor(170, 60);
+  tft.print("Verbrauch");
+  tft.setCursor(240, 60);
+  tft.print("Netz");
+  
+  for (int i = 0; i < inverters.count; i++) {
+    drawInverterRow(i, "WR " + String(i + 1), inverters.pvPower[i], inverters.loadPower[i], inverters.gridPower[i]);
+  }
+  
+  // Summenzeile unter einer Trennlinie
+  int lineY = 80 + inverters.count * 20 + 2;
+  tft.drawLine(20, lineY, SCREEN_WIDTH - 20, lineY, TFT_DARKGREY);
+  drawInverterRow(inverters.count, "Gesamt", solarData.pvPower, solarData.loadPower, solarData.gridPower);
+}
+
+void ViewManager::drawBatteries() {
+  const BatteryArray& batteries = dataManager.getBatteries();
+  SolarData& solarData = dataManager.getData();
+  
+  tft.setTextSize(1);
+  tft.setTextColor(TEXT_COLOR, BACKGROUND);
+  tft.setCursor(20, 60);
+  tft.print("Einheit");
+  tft.setCursor(100, 60);
+  tft.print("SOC");
+  tft.setCursor(170, 60);
+  tft.print("Leistung");
+  tft.setCursor(240, 60);
+  tft.print("Spannung");
+  
+  for (int i = 0; i < batteries.count; i++) {
+    drawBatteryRow(i, "Bank " + String(i + 1), batteries.soc[i], batteries.power[i], batteries.voltage[i]);
+  }
+  
+  int lineY = 80 + batteries.count * 20 + 2;
+  tft.drawLine(20, lineY, SCREEN_WIDTH - 20, lineY, TFT_DARKGREY);
+  drawBatteryRow(batteries.count, "Gesamt", solarData.batterySOC, solarData.batteryPower, solarData.batteryVoltage);
+}
+
+// Steuerungsfunktionen
+void ViewManager::controlHeating() {
+  drawControl();
 }
 
 void ViewManager::controlPool() {
+  drawControl();
+}
+
+// Standardwerte der Steuerungen (Topics aus data/config.json), überschreibbar
+// in der config.json im SPIFFS
+struct ControlDefaults {
+  const char* view;
+  const char* key;
+  const char* title;
+  const char* commandTopic;
+  const char* stateTopic;
+  int qos;
+};
+
+static const ControlDefaults CONTROL_DEFAULTS[] = {
+  { "controlHeating", "heating", "Heizung", DEFAULT_SETTINGS.controls.heating.command_topic,
+    DEFAULT_SETTINGS.controls.heating.state_topic, DEFAULT_SETTINGS.controls.heating.qos },
+  { "controlPool", "pool", "Pool", DEFAULT_SETTINGS.controls.pool.command_topic,
+    DEFAULT_SETTINGS.controls.pool.state_topic, DEFAULT_SETTINGS.controls.pool.qos }
+};
+
+void ViewManager::loadControls(JsonObjectConst config) {
+  for (const ControlDefaults& defaults : CONTROL_DEFAULTS) {
+    JsonObjectConst entry = config[defaults.key];
+    ControlConfig control;
+    control.title = defaults.title;
+    control.commandTopic = entry["command_topic"] | defaults.commandTopic;
+    control.onPayload = entry["on"] | "ON";
+    control.offPayload = entry["off"] | "OFF";
+    control.qos = min(entry["qos"] | defaults.qos, 1);
+    
+    // Ohne Status-Topic gilt der Befehl mit dem PUBACK als bestätigt
+    String stateTopic = entry["state_topic"] | defaults.stateTopic;
+    if (stateTopic.length() > 0) {
+      control.stateName = String(defaults.key) + "_state";
+      mqttManager.subscribe(control.stateName, stateTopic, METRIC_NONE, 0, control.qos);
+    }
+    controls[defaults.view] = control;
+  }
+}
+
+void ViewManager::drawControl() {
   tft.setTextSize(1);
   tft.setTextColor(TEXT_COLOR, BACKGROUND);
   
-  // Einfache Platzhalter-Anzeige für Steuerungsfunktionen
+  auto it = controls.find(currentView);
   tft.setCursor(20, 70);
-  tft.println("Steuerungsfunktion: Pool");
+  tft.print("Steuerungsfunktion: ");
+  tft.println(it != controls.end() ? it->second.title.c_str() : currentView.c_str());
   
-  // ON/OFF Schaltflächen
-  drawButton(60, 100, 80, 40, "EIN", TFT_GREEN);
-  drawButton(180, 100, 80, 40, "AUS", TFT_RED);
-  
-  // Status
-  tft.setCursor(20, 160);
-  tft.println("Status: Inaktiv");
+  // Schaltflächen und Status
+  drawControlState(true);
   
   // Weitere Informationen
+  tft.setTextColor(TEXT_COLOR, BACKGROUND);
   tft.setCursor(20, 180);
   tft.println("Tippen Sie auf EIN oder AUS, um das Gerät zu steuern.");
 }
 
+void ViewManager::drawControlState(bool force) {
+  auto it = controls.find(currentView);
+  const ControlConfig* control = it != controls.end() ? &it->second : nullptr;
+  
+  // Laufender Befehl wird sofort angezeigt (optimistisch), sonst der gemeldete Zustand
+  String payload;
+  CommandState command = control ? publishQueue.getState(control->commandTopic, &payload) : COMMAND_IDLE;
+  String echo = control && control->stateName.length() > 0 ? mqttManager.getValue(control->stateName.c_str()) : "";
+  String value = command == COMMAND_IDLE || command == COMMAND_FAILED ? echo : payload;
+  
+  if (!force && command == lastDrawnCommand && value == lastDrawnSwitchValue) {
+    return;
+  }
+  lastDrawnCommand = command;
+  lastDrawnSwitchValue = value;
+  
+  bool on = control && value.equalsIgnoreCase(control->onPayload);
+  bool off = control && value.equalsIgnoreCase(control->offPayload);
+  drawButton(60, 100, 80, 40, "EIN", off ? TFT_DARKGREY : TFT_GREEN);
+  drawButton(180, 100, 80, 40, "AUS", on ? TFT_DARKGREY : TFT_RED);
+  
+  String status = on ? "EIN" : off ? "AUS" : "Unbekannt";
+  switch (command) {
+    case COMMAND_QUEUED:    status += " - wird gesendet"; break;
+    case COMMAND_SENT:      status += " - warte auf Bestätigung"; break;
+    case COMMAND_CONFIRMED: status += " - bestätigt"; break;
+    case COMMAND_FAILED:    status += " - Befehl nicht bestätigt"; break;
+    default: break;
+  }
+  if (!control) {
+    status = "Nicht konfiguriert";
+  }
+  
+  tft.fillRect(20, 160, SCREEN_WIDTH - 40, 10, BACKGROUND);
+  tft.setTextSize(1);
+  tft.setTextColor(command == COMMAND_FAILED ? TFT_RED : TEXT_COLOR, BACKGROUND);
+  tft.setCursor(20, 160);
+  tft.print("Status: ");
+  tft.print(status);
+}
+
+bool ViewManager::handleGesture(const Gesture &gesture) {
+  if (currentView == "calibrateTouch") {
+    return handleCalibration(gesture);
+  }
+  
+  auto it = controls.find(currentView);
+  if (gesture.type != GESTURE_TAP || it == controls.end()) {
+    return false;
+  }
+  
+  int x = gesture.x;
+  int y = gesture.y;
+  bool onButton = x >= 60 && x <= 140 && y >= 100 && y <= 140;
+  bool offButton = x >= 180 && x <= 260 && y >= 100 && y <= 140;
+  if (!onButton && !offButton) {
+    return false;
+  }
+  
+  // Ein Tippen kommt je Berührung nur einmal, gehaltene Finger lösen nicht erneut aus
+  const ControlConfig& control = it->second;
+  const String& payload = onButton ? control.onPayload : control.offPayload;
+  
+  // Nur einreihen; gesendet wird aus loop(), die Anzeige folgt sofort
+  unsigned long start = micros();
+  publishQueue.enqueue(control.commandTopic, payload, control.qos, false, control.stateName);
+  drawControlState(false);
+  
+  DEBUG_PRINT("Befehl ");
+  DEBUG_PRINT(payload);
+  DEBUG_PRINT(" angezeigt nach ");
+  DEBUG_PRINT(micros() - start);
+  DEBUG_PRINTLN(" us");
+  return true;
+}
+
 // Einstellungsfunktionen
 void ViewManager::setupWifi() {
   tft.setCursor(20, 70);
@@ -1061,6 +1379,97 @@ void ViewManager::setupDisplay() {
   drawButton(180, 180, 80, 30, "Dunkel", TFT_BLUE);
 }
 
+// Zielkreuze der Kalibrierung, weit auseinander und abseits von Zurück-Button
+// und Statusleiste; der letzte Punkt prüft die berechnete Matrix
+static const int16_t CALIBRATION_POINTS[4][2] = {
+  { 32, 72 }, { 288, 112 }, { 96, 200 }, { 224, 176 }
+};
+
+void ViewManager::calibrateTouch() {
+  calibrationStep = 0;
+  drawCalibrationMessage("Kreuz genau antippen (1/3)");
+  drawCalibrationTarget(0, TFT_YELLOW);
+}
+
+void ViewManager::drawCalibrationTarget(uint8_t step, uint16_t color) {
+  int x = CALIBRATION_POINTS[step][0];
+  int y = CALIBRATION_POINTS[step][1];
+  tft.drawFastHLine(x - 10, y, 21, color);
+  tft.drawFastVLine(x, y - 10, 21, color);
+  tft.drawCircle(x, y, 6, color);
+}
+
+void ViewManager::drawCalibrationMessage(const char* message) {
+  tft.fillRect(20, 50, SCREEN_WIDTH - 40, 10, BACKGROUND);
+  tft.setTextSize(1);
+  tft.setTextColor(TEXT_COLOR, BACKGROUND);
+  tft.setCursor(20, 50);
+  tft.print(message);
+}
+
+bool ViewManager::handleCalibration(const Gesture &gesture) {
+  if (gesture.type != GESTURE_TAP) {
+    return false;
+  }
+  
+  // Fertig: Tippen zeigt, wo die neue Matrix den Finger sieht
+  if (calibrationStep > 3) {
+    tft.fillCircle(gesture.x, gesture.y, 2, TFT_GREEN);
+    return true;
+  }
+  
+  drawCalibrationTarget(calibrationStep, BACKGROUND);
+  
+  if (calibrationStep < 3) {
+    // Gemittelte Rohwerte der Berührung, unabhängig von der alten Matrix
+    calibrationRaw[calibrationStep][0] = gesture.rawX;
+    calibrationRaw[calibrationStep][1] = gesture.rawY;
+    if (++calibrationStep < 3) {
+      char message[40];
+      snprintf(message, sizeof(message), "Kreuz genau antippen (%u/3)", calibrationStep + 1);
+      drawCalibrationMessage(message);
+      drawCalibrationTarget(calibrationStep, TFT_YELLOW);
+      return true;
+    }
+    
+    if (!TouchInput::computeMatrix(CALIBRATION_POINTS, calibrationRaw, calibrationMatrix)) {
+      calibrationStep = 0;
+      drawCalibrationMessage("Punkte unbrauchbar, bitte wiederholen (1/3)");
+      drawCalibrationTarget(0, TFT_YELLOW);
+      return true;
+    }
+    drawCalibrationMessage("Zur Kontrolle das grüne Kreuz antippen");
+    drawCalibrationTarget(3, TFT_GREEN);
+    return true;
+  }
+  
+  // Prüfpunkt mit der neuen Matrix abbilden; erst bei Treffer übernehmen,
+  // damit eine verunglückte Kalibrierung das Gerät nicht unbedienbar macht
+  int16_t x, y;
+  TouchInput::transform(calibrationMatrix, gesture.rawX, gesture.rawY, x, y);
+  int error = max(abs(x - CALIBRATION_POINTS[3][0]), abs(y - CALIBRATION_POINTS[3][1]));
+  if (error > TOUCH_CALIBRATION_TOLERANCE || !touchInput.setMatrix(calibrationMatrix)) {
+    char message[48];
+    snprintf(message, sizeof(message), "Abweichung %d px, bitte wiederholen (1/3)", error);
+    calibrationStep = 0;
+    drawCalibrationMessage(message);
+    drawCalibrationTarget(0, TFT_YELLOW);
+    return true;
+  }
+  
+  // Als Einstellung "touch.matrix" ablegen, überlagert config.json
+  const TouchMatrix &m = calibrationMatrix;
+  char value[80];
+  snprintf(value, sizeof(value), "[%ld,%ld,%ld,%ld,%ld,%ld]",
+           (long)m.a, (long)m.b, (long)m.c, (long)m.d, (long)m.e, (long)m.f);
+  bool stored = configStore.set("touch.matrix", value);
+  LOG_I("Touch kalibriert: %s%s", value, stored ? "" : " (nicht gespeichert)");
+  
+  calibrationStep = 4;
+  drawCalibrationMessage(stored ? "Gespeichert. Tippen zeigt den Punkt" : "Aktiv, aber nicht gespeichert!");
+  return true;
+}
+
 void ViewManager::showSystemInfo() {
   tft.setCursor(20, 70);
   tft.println("Systeminformationen:");
@@ -1085,4 +1494,217 @@ void ViewManager::showSystemInfo() {
   tft.print("Laufzeit: ");
   tft.print(millis() / 1000 / 60);
   tft.println(" Minuten");
+  
+  drawMemoryInfo();
+}
+
+void ViewManager::update() {
+  // Alter und Verstummt-Status der Topics laufen weiter, auch wenn keine
+  // Nachricht eintrifft; updateTopicStats() zeichnet höchstens einmal pro Sekunde
+  if (currentView == "showTopicStats") {
+    updateTopicStats();
+  }
+}
+
+void ViewManager::showTopicStats() {
+  tft.setTextSize(1);
+  tft.setTextColor(TEXT_COLOR, BACKGROUND);
+  tft.setCursor(10, 55);
+  tft.print("Topic");
+  tft.setCursor(110, 55);
+  tft.print("Anz.");
+  tft.setCursor(150, 55);
+  tft.print("/min");
+  tft.setCursor(195, 55);
+  tft.print("Jitter");
+  tft.setCursor(245, 55);
+  tft.print("Fehl.");
+  tft.setCursor(280, 55);
+  tft.print("Alter");
+  
+  lastStatsDraw = 0;
+  updateTopicStats();
+}
+
+void ViewManager::updateTopicStats() {
+  // Höchstens einmal pro Sekunde neu zeichnen, auch wenn Topics fluten
+  if (lastStatsDraw != 0 && millis() - lastStatsDraw < 1000) {
+    return;
+  }
+  lastStatsDraw = millis();
+  
+  // Verstummte Topics zuerst, danach absteigend nach Rate
+  const std::vector<MqttTopic>& topics = mqttManager.getTopics();
+  std::vector<int> order;
+  for (size_t i = 0; i < topics.size(); i++) {
+    order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&topics](int a, int b) {
+    bool staleA = mqttManager.isStale(topics[a]);
+    bool staleB = mqttManager.isStale(topics[b]);
+    if (staleA != staleB) {
+      return staleA;
+    }
+    return topics[a].stats.ratePerMinute() > topics[b].stats.ratePerMinute();
+  });
+  
+  const int rowHeight = 11;
+  const int maxRows = (SCREEN_HEIGHT - 30 - 70) / rowHeight;
+  unsigned long now = millis();
+  
+  for (int row = 0; row < maxRows; row++) {
+    int y = 70 + row * rowHeight;
+    tft.fillRect(0, y, SCREEN_WIDTH, rowHeight, BACKGROUND);
+    
+    if (row == maxRows - 1 && (int)order.size() > maxRows) {
+      tft.setTextColor(TFT_DARKGREY, BACKGROUND);
+      tft.setCursor(10, y);
+      tft.print("+");
+      tft.print(order.size() - row);
+      tft.print(" weitere (seriell: stats)");
+      break;
+    }
+    if (row >= (int)order.size()) {
+      continue;
+    }
+    
+    const MqttTopic& topic = topics[order[row]];
+    bool stale = mqttManager.isStale(topic);
+    
+    tft.setTextColor(stale ? TFT_RED : TEXT_COLOR, BACKGROUND);
+    tft.setCursor(10, y);
+    char name[17];
+    snprintf(name, sizeof(name), "%s", topic.name.c_str());
+    tft.print(name);
+    
+    tft.setCursor(110, y);
+    tft.print(topic.stats.count);
+    tft.setCursor(150, y);
+    tft.print(topic.stats.ratePerMinute(), 1);
+    tft.setCursor(195, y);
+    tft.print(topic.stats.jitter, 0);
+    tft.print("ms");
+    
+    tft.setTextColor(topic.stats.parseFailures ? TFT_ORANGE : TEXT_COLOR, BACKGROUND);
+    tft.setCursor(245, y);
+    tft.print(topic.stats.parseFailures);
+    
+    tft.setTextColor(stale ? TFT_RED : TEXT_COLOR, BACKGROUND);
+    tft.setCursor(280, y);
+    if (topic.lastUpdate == 0) {
+      tft.print("-");
+    } else {
+      tft.print((now - topic.lastUpdate) / 1000);
+      tft.print("s");
+    }
+  }
+}
+
+void ViewManager::showLatency() {
+  tft.setTextSize(1);
+  tft.setTextColor(TEXT_COLOR, BACKGROUND);
+  tft.setCursor(10, 55);
+  tft.print("Abschnitt");
+  tft.setCursor(110, 55);
+  tft.print("Anz.");
+  tft.setCursor(160, 55);
+  tft.print("p50");
+  tft.setCursor(210, 55);
+  tft.print("p95");
+  tft.setCursor(260, 55);
+  tft.print("p99 (ms)");
+  
+  lastStatsDraw = 0;
+  updateLatency();
+}
+
+void ViewManager::updateLatency() {
+  // Höchstens einmal pro Sekunde, das Zeichnen selbst wird mitgemessen
+  if (lastStatsDraw != 0 && millis() - lastStatsDraw < 1000) {
+    return;
+  }
+  lastStatsDraw = millis();
+  
+  const int rowHeight = 14;
+  for (int stage = 0; stage < TRACE_STAGES; stage++) {
+    const LatencyHistogram& histogram = latencyTracer.getHistogram((TraceStage)stage);
+    int y = 72 + stage * rowHeight;
+    tft.fillRect(0, y, SCREEN_WIDTH, rowHeight - 2, BACKGROUND);
+    
+    tft.setTextColor(stage == STAGE_TOTAL ? TITLE_COLOR : TEXT_COLOR, BACKGROUND);
+    tft.setCursor(10, y);
+    tft.print(LatencyTracer::stageName((TraceStage)stage));
+    tft.setCursor(110, y);
+    tft.print(histogram.count());
+    
+    const uint8_t percents[3] = { 50, 95, 99 };
+    for (int i = 0; i < 3; i++) {
+      tft.setCursor(160 + i * 50, y);
+      tft.print(histogram.percentile(percents[i]) / 1000.0f, 1);
+    }
+  }
+  
+  int y = 72 + TRACE_STAGES * rowHeight + 6;
+  tft.fillRect(0, y, SCREEN_WIDTH, 10, BACKGROUND);
+  tft.setTextColor(TFT_DARKGREY, BACKGROUND);
+  tft.setCursor(10, y);
+  tft.print("Nicht gezeichnet: ");
+  tft.print(latencyTracer.getOverwritten() + latencyTracer.getExpired());
+  tft.print("  (seriell: trace)");
+}
+
+void ViewManager::showLogs() {
+  lastLogSequence = 0;
+  lastStatsDraw = 0;
+  updateLogs();
+}
+
+void ViewManager::updateLogs() {
+  // Nur bei neuen Einträgen, höchstens zweimal pro Sekunde
+  uint32_t sequence = logger.sequence();
+  if (lastStatsDraw != 0 && (sequence == lastLogSequence || millis() - lastStatsDraw < 500)) {
+    return;
+  }
+  lastStatsDraw = millis();
+  lastLogSequence = sequence;
+  
+  const int rows = 15;
+  const int rowHeight = 11;
+  const int maxChars = (SCREEN_WIDTH - 10) / 6;
+  static const uint16_t levelColors[LOG_LEVELS] = { TFT_RED, TFT_ORANGE, TEXT_COLOR, TFT_DARKGREY };
+  
+  tft.setTextSize(1);
+  uint32_t first = sequence > rows ? sequence - rows : 0;
+  for (int row = 0; row < rows; row++) {
+    int y = 55 + row * rowHeight;
+    tft.fillRect(0, y, SCREEN_WIDTH, rowHeight, BACKGROUND);
+    
+    Logger::Entry entry;
+    if (!logger.read(first + row, entry)) {
+      continue;
+    }
+    
+    // Zeit in Sekunden, Modul und so viel Text, wie in die Zeile passt
+    char text[64];
+    int length = snprintf(text, sizeof(text), "%5lu %-6s ", (unsigned long)(entry.time / 1000),
+                          Logger::moduleName((LogModule)entry.module));
+    int room = min(maxChars - length, (int)sizeof(text) - length - 1);
+    int copy = min((int)entry.length, room);
+    memcpy(text + length, entry.text, copy);
+    text[length + copy] = '\0';
+    
+    tft.setTextColor(levelColors[entry.level < LOG_LEVELS ? entry.level : LOG_LEVEL_INFO], BACKGROUND);
+    tft.setCursor(5, y);
+    tft.print(text);
+  }
+  
+  int y = 55 + rows * rowHeight + 4;
+  tft.fillRect(0, y, SCREEN_WIDTH, 10, BACKGROUND);
+  tft.setTextColor(TFT_DARKGREY, BACKGROUND);
+  tft.setCursor(5, y);
+  tft.print("Verworfen: ");
+  tft.print(logger.getDropped());
+  tft.print("  Gefiltert: ");
+  tft.print(logger.getFiltered());
+  tft.print("  (seriell: log)");
 }
\ No newline at end of file
@@ -13,6 +13,9 @@
 #include "config.h"
 #include "DataManager.h"
 #include "ConfigManager.h"  // Wichtig für JsonDocument und configManager
+#include "PublishQueue.h"
+#include "FixedString.h"
+#include "TouchInput.h"
 
 // Vorwärtsdeklaration der Klasse
 class ViewManager;
@@ -25,29 +28,70 @@ private:
   TFT_eSPI &tft;
   DataManager &dataManager;
   
-  String currentView;
+  FixedString<VIEW_NAME_LENGTH> currentView;
   
   // Variablen für partielles Neuzeichnen
   bool isInitialDraw = true;
   SolarData lastDrawnData; // Speichert die zuletzt gezeichneten Daten
+  InverterArray lastDrawnInverters;
+  BatteryArray lastDrawnBatteries;
+  uint8_t lastDrawnStaleMask = 0;
+  unsigned long lastStatsDraw = 0;
+  uint32_t lastLogSequence = 0;     // Zuletzt angezeigter Log-Eintrag
+  
+  // Textfarbe eines Werts, grau solange er nur aus dem Snapshot stammt
+  uint16_t valueColor(SolarMetric metric, uint16_t liveColor);
+  
+  // Schaltbare Geräte der Steuerungsansichten (config.json "controls")
+  struct ControlConfig {
+    String title;            // z.B. "Heizung"
+    String commandTopic;
+    String stateName;        // Topic-Name des Status-Topics (Echo), leer ohne state_topic
+    String onPayload;
+    String offPayload;
+    uint8_t qos = 0;
+  };
+  std::map<const char*, ControlConfig, CStringLess> controls;  // Schlüssel: Ansicht, z.B. "controlHeating"
+  CommandState lastDrawnCommand = COMMAND_IDLE;
+  String lastDrawnSwitchValue;
+  
+  void drawControl();
+  void drawControlState(bool force);
+  
+  // Tabellenzeilen der Einheitenansichten
+  void drawInverterRow(int row, const String &label, float pv, float load, float grid);
+  void drawBatteryRow(int row, const String &label, float soc, float power, float voltage);
+  
+  // Touch-Kalibrierung: drei Zielkreuze, danach ein Prüfpunkt
+  uint8_t calibrationStep = 0;
+  int16_t calibrationRaw[3][2] = {};
+  TouchMatrix calibrationMatrix = {};
+  
+  void drawCalibrationTarget(uint8_t step, uint16_t color);
+  void drawCalibrationMessage(const char* message);
+  bool handleCalibration(const Gesture &gesture);
   
   // Typedef für Funktionszeiger auf Memberfunktionen
   typedef void (ViewManager::*ViewFunction)();
   typedef void (ViewManager::*UpdateFunction)();
   
-  // Maps für Funktionszeiger zu Ansichten und Updates
-  std::map<String, ViewFunction> viewFunctions;
-  std::map<String, UpdateFunction> updateFunctions;
+  // Maps für Funktionszeiger zu Ansichten und Updates; die Schlüssel sind
+  // Literale, das Nachschlagen kopiert keinen Namen
+  std::map<const char*, ViewFunction, CStringLess> viewFunctions;
+  std::map<const char*, UpdateFunction, CStringLess> updateFunctions;
   
 public:
   ViewManager(TFT_eSPI &tft, DataManager &dataManager);
   
   // Zeigt eine Detailansicht an (vollständiges Neuzeichnen)
-  bool showView(const String &functionName);
+  bool showView(const char* functionName);
   
   // Aktualisiert nur die Daten in der aktuellen Ansicht (partielles Neuzeichnen)
   bool updateView();
   
+  // Aus loop(): zeitabhängige Anzeigen auch ohne neue Nachricht nachführen
+  void update();
+  
   // Zeichnet den Zurück-Button
   void drawBackButton();
   
@@ -58,6 +102,12 @@ public:
   void drawButton(int x, int y, int w, int h, String label, uint16_t color);
   bool isBackButtonTouched(int x, int y);
   
+  // Geste in der Detailansicht (z.B. Tippen auf EIN/AUS); true, wenn verarbeitet
+  bool handleGesture(const Gesture &gesture);
+  
+  // Steuerungen aus config.json übernehmen und deren Status-Topics abonnieren
+  void loadControls(JsonObjectConst config);
+  
   // Verschiedene Detailansichten und deren Update-Funktionen
   void drawSolarStatus();
   void updateSolarStatus();
@@ -83,6 +133,13 @@ public:
   void drawStatistics();
   void updateStatistics();
   
+  // Einzelne Wechselrichter und Batteriebänke mit Summen
+  void drawInverters();
+  void updateInverters();
+  
+  void drawBatteries();
+  void updateBatteries();
+  
   // Steuerungsfunktionen
   void controlHeating();
   void updateHeating();
@@ -100,8 +157,24 @@ public:
   void setupDisplay();
   void updateDisplay();
   
+  // Touch über drei Punkte kalibrieren, Matrix in der Konfiguration ablegen
+  void calibrateTouch();
+  
   void showSystemInfo();
   void updateSystemInfo();
+  void drawMemoryInfo();
+  
+  // Empfangsstatistik der MQTT-Topics
+  void showTopicStats();
+  void updateTopicStats();
+  
+  // Letzte Einträge des Protokoll-Ringpuffers
+  void showLogs();
+  void updateLogs();
+  
+  // Latenz vom MQTT-Empfang bis zur Anzeige (p50/p95/p99)
+  void showLatency();
+  void updateLatency();
 };
 
 #endif // VIEW_MANAGER_H
\ No newline at end of file
@@ -12,11 +12,38 @@
 #define DEBUG_BAUD_RATE 115200
 #define DEBUG_SERIAL Serial
 
-// Debug Makros
+// Binär-Snapshots der Konfiguration (ConfigManager)
+#define CONFIG_SNAPSHOT_MAGIC 0x31474643UL  // "CFG1"
+
+// Einstellungsjournal (ConfigStore.h)
+#define CONFIG_STORE_PATH "/settings.log"
+#define CONFIG_STORE_TEMP "/settings.tmp"   // Ziel der Verdichtung
+#define CONFIG_STORE_MAGIC 0xC5
+#define CONFIG_STORE_MAX_KEY 48
+#define CONFIG_STORE_MAX_VALUE 128
+#define CONFIG_STORE_COMPACT_SIZE 4096      // Bytes, ab denen verdichtet wird
+
+// Neuladen ohne Neustart (HotReload.h)
+#define CONFIG_RELOAD_TOPIC "esp32solar/reload"  // Payload: menu, topics, settings, all
+#define CONFIG_RELOAD_CHECK_INTERVAL 5000   // ms zwischen zwei Dateiprüfungen (je eine Datei)
+
+// Startablauf (BootSequence.h)
+#define BOOT_MAX_PHASES 12
+
+// Protokoll-Ringpuffer (Logger.h)
+#define LOG_ENTRIES 64              // Einträge im RAM, auch für die Log-Ansicht
+#define LOG_ENTRY_TEXT 96           // Zeichen je Eintrag, längere werden gekürzt
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_INFO
+#define LOG_DRAIN_INTERVAL 20       // ms Pause der Ausgabe-Task bei leerem Puffer
+#define LOG_TASK_STACK 3072
+#define LOG_TASK_PRIORITY 1
+#define LOG_OPEN_LINES 4            // Gleichzeitig offene DEBUG_PRINT-Zeilen (eine je Task)
+
+// Debug Makros: gepuffert über den Logger (Logger.h), Stufe Info
 #if DEBUG_ENABLED
   #define DEBUG_BEGIN(baud) DEBUG_SERIAL.begin(baud)
-  #define DEBUG_PRINT(...) DEBUG_SERIAL.print(__VA_ARGS__)
-  #define DEBUG_PRINTLN(...) DEBUG_SERIAL.println(__VA_ARGS__)
+  #define DEBUG_PRINT(...) logger.at(LOG_LEVEL_INFO, LOG_MODULE).print(__VA_ARGS__)
+  #define DEBUG_PRINTLN(...) logger.at(LOG_LEVEL_INFO, LOG_MODULE).println(__VA_ARGS__)
 #else
   #define DEBUG_BEGIN(baud)
   #define DEBUG_PRINT(...)
@@ -34,25 +61,49 @@
 #define XPT2046_CLK 25   // SPI Clock
 #define XPT2046_CS 33    // SPI Chip Select
 
-// Touchscreen-Kalibrierungswerte
-#define TOUCH_MIN_X 200
-#define TOUCH_MAX_X 3700
-#define TOUCH_MIN_Y 240
-#define TOUCH_MAX_Y 3800
+// Touch-Kalibrierung: Matrix in config.json "touch.matrix", sonst die
+// Grenzen min_x..max_y von dort; Kalibrieransicht "calibrateTouch"
+#define TOUCH_CALIBRATION_TOLERANCE 8 // px, erlaubte Abweichung am Prüfpunkt
+
+// Touch-Ereignisse und Gesten (TouchInput.h)
+#define TOUCH_SAMPLE_INTERVAL 10      // ms zwischen Abtastungen bei aufliegendem Finger
+#define TOUCH_MOVE_THRESHOLD 3        // px, kleinere Bewegungen erzeugen kein MOVE
+#define TOUCH_RELEASE_SAMPLES 2       // Abtastungen ohne Druck bis UP
+#define TOUCH_OVERSAMPLING 8          // Messungen je Abtastung (TouchFilter.h)
+#define TOUCH_FILTER_MAX_SAMPLES 16   // Obergrenze für TOUCH_OVERSAMPLING
+#define TOUCH_FILTER_TOLERANCE 24     // Rohwerte, etwa 2 px: Abstand innerhalb einer Gruppe
+#define TOUCH_PRESSURE_MIN 400        // Druck, ab dem eine Messung zählt (wie XPT2046_Touchscreen)
+#define TOUCH_QUEUE_SIZE 32           // Ereignisse zwischen Abtast-Task und loop()
+#define TOUCH_TASK_STACK 2048
+#define TOUCH_TASK_PRIORITY 2         // Über loop(), damit Zeichnen nicht bremst
+#define GESTURE_TAP_SLOP 10           // px Bewegung, die noch als Tippen gilt
+#define GESTURE_LONG_PRESS_TIME 600   // ms
+#define GESTURE_SWIPE_MIN_DISTANCE 40 // px
+#define GESTURE_SWIPE_MAX_TIME 400    // ms vom Aufsetzen bis zum Loslassen
+#define GESTURE_STOP_TIME 100         // ms ohne Bewegung vor dem Loslassen: kein Schwung
 
 // Menü-Konfiguration
 #define MAX_MENU_ITEMS 8  // Anzahl der Menüpunkte pro Tab
-#define MENU_ITEM_HEIGHT 40
+#define MENU_ITEM_HEIGHT 30
 #define MENU_ITEM_WIDTH 240
 #define MENU_START_X 40
 #define MENU_START_Y 70
-#define MENU_VISIBLE_ITEMS 3  // Reduziert auf 3 sichtbare Einträge
+#define MENU_VISIBLE_ITEMS 5  // 150 px zwischen Tabs und Statusleiste
+#define MENU_SPRITE_DEPTH 8   // Bit je Pixel im Bildpuffer der Liste (8: 36 KB)
+#define MENU_FRAME_INTERVAL 25    // ms je Bild beim Scrollen, höchstens 40 fps
+#define MENU_FLING_FRICTION 325   // ms, in denen der Schwung auf gut ein Drittel abfällt
+#define MENU_FLING_MIN_SPEED 20   // px/s, darunter hält die Liste an
+#define MENU_FLING_MAX_SPEED 4000 // px/s
+#define MENU_ARENA_SIZE 2048  // Knoten und Texte des ganzen Menüs (MenuModel)
+#define MENU_MAX_DEPTH 4      // Ebenen inkl. Tab, darunter liegende Einträge entfallen
+#define VIEW_NAME_LENGTH 24   // Funktionsnamen der Ansichten
 #define SCROLL_ARROW_WIDTH 30 // Breite für die Pfeile
 
 // Tab-Konfiguration
 #define NUM_TABS 3
 #define TAB_HEIGHT 30
 #define TAB_WIDTH 100
+#define TAB_ARROW_WIDTH 20    // Blätterpfeile, wenn nicht alle Tabs passen
 
 // Farben
 #define BACKGROUND TFT_BLACK
@@ -65,15 +116,78 @@
 #define TAB_INACTIVE_COLOR TFT_DARKGREY
 #define SCROLL_ACTIVE_COLOR TFT_ORANGE
 #define SCROLL_INACTIVE_COLOR TFT_DARKGREY
+#define STALE_COLOR TFT_DARKGREY       // Werte aus dem Snapshot, noch nicht bestätigt
+
+// Anlagen-Konfiguration (mehrere Wechselrichter und Batteriebänke)
+#define MAX_INVERTERS 4
+#define MAX_BATTERIES 4
+#define TOTALS_RESYNC_UPDATES 256      // Summen nach so vielen Einzelwerten exakt neu berechnen
 
 // MQTT Konfiguration
 #define MQTT_BROKER "IP_ADRESS_MQTT_BROKER"
 #define MQTT_PORT 1883
 #define MQTT_CLIENT_ID "ESP32SolarMonitor-"
 #define MQTT_UPDATE_INTERVAL 15000  // 15 Sekunden
+#define MQTT_MAX_DYNAMIC_TOPICS 64  // Max. Topics, die über Wildcards gebunden werden
+#define MQTT_NAME_LENGTH 40         // Topic-Namen inkl. Nullzeichen
+#define MQTT_TOPIC_LENGTH 96        // Längere Topics werden nicht abonniert
+#define MQTT_VALUE_LENGTH 32        // Längere Werte werden gekürzt
+#define MQTT_STALE_TIMEOUT 300000   // Topic gilt nach 5 Minuten ohne Nachricht als verstummt
+#define MQTT_KEEPALIVE 15           // Sekunden
+#define MQTT_CONNECT_TIMEOUT 5000   // TCP-Aufbau bis CONNACK
+#define MQTT_RETRY_TIMEOUT 5000     // Wiederholung unbestätigter QoS-1-Nachrichten
+#define MQTT_MAX_INFLIGHT 8         // Unbestätigte QoS-1-Veröffentlichungen
+#define MQTT_PENDING_ACKS 8         // PUBACKs, die bei vollem Sendepuffer warten
+#define MQTT_PACKET_SIZE 1024       // Größere eingehende Pakete werden verworfen
+#define MQTT_TX_BUFFER_SIZE 1024
+#define MQTT_DNS_TASK_STACK 3072    // Einmalige Task für die Namensauflösung des Brokers
+
+// Ausgehende Schaltbefehle
+#define PUBLISH_QUEUE_SIZE 8          // Gleichzeitig verfolgte Topics
+#define PUBLISH_CONFIRM_TIMEOUT 5000  // Einreihen bis PUBACK bzw. Echo
+
+// Eingangswarteschlange (Nachrichtenflut nach dem Verbindungsaufbau)
+#define INGEST_QUEUE_DEPTH 32         // Wartende Nachrichten über alle Spuren
+#define INGEST_INLINE_SIZE MQTT_VALUE_LENGTH  // Payload direkt im Platz (Einzelwerte)
+#define INGEST_LARGE_BUFFERS 4        // Puffer mit MQTT_PACKET_SIZE für längere Payloads (JSON)
+#define INGEST_BUDGET_US 4000         // Verarbeitungszeit je loop()-Durchlauf
+
+// Latenzmessung vom Empfang bis zur Anzeige
+#define TRACE_BUFFER_SIZE 128         // Ereignisse im Ringpuffer (trace dump)
+#define TRACE_PENDING 16              // Gleichzeitig verfolgte Nachrichten
+#define TRACE_MAX_AGE_MS 2000         // Danach gilt eine Nachricht als nicht gezeichnet
+
+// JSON-Payloads (Felder per Pfad, große Nachrichten werden gestreamt)
+#define JSON_STREAM_MAX_DEPTH 8     // Tiefere Ebenen werden übersprungen
+#define JSON_STREAM_MAX_PATH 64     // Längere Pfade werden übersprungen
+#define JSON_STREAM_MAX_TOKEN 32    // Längere Werte werden gekürzt
+#define JSON_ARENA_SIZE 12288       // Kurzlebige Dokumente, größere weichen auf den Heap aus
+
+// MQTT Mitschnitt und Wiedergabe
+#define MQTT_CAPTURE_FILE "/capture.bin"
+#define MQTT_REPLAY_MAX_PAYLOAD 1024  // Größere Nachrichten werden übersprungen
+#define MQTT_REPLAY_MAX_TOPIC 128
+#define MQTT_REPLAY_BATCH 16          // Nachrichten pro loop()-Durchlauf, höchstens freie Plätze der Warteschlange
+
+// Heap-Überwachung (memory) und Dauertest (memory soak)
+#define MEMORY_SAMPLE_INTERVAL 600000UL  // Alle 10 Minuten festhalten
+#define MEMORY_HISTORY 144            // Ein Tag Verlauf
+#define MEMORY_SOAK_BATCH 8           // Künstliche Nachrichten pro loop()-Durchlauf
+
+// Warmstart-Snapshot im NVS
+#define SNAPSHOT_INTERVAL 900000UL    // Höchstens alle 15 Minuten schreiben
+#define SNAPSHOT_MAX_TOPICS 32
+#define SNAPSHOT_VALUE_LENGTH 16
+
+// Serielle Konsole
+#define CONSOLE_LINE_LENGTH 96
 
 // Default WLAN-Daten
 #define DEFAULT_WIFI_SSID "Your_SSID"
 #define DEFAULT_WIFI_PASS "Your_Password"
+#define WIFI_CONNECT_WARN 20000     // ms nach dem Start: Hinweis, dass WLAN noch fehlt
+
+// Logger nach den Konstanten, damit DEBUG_PRINT überall verfügbar ist
+#include "Logger.h"
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -1,234 +1,110 @@
 /**
- * default_data.cpp - Standard-Konfigurationsdaten
+ * default_data.cpp - Standardkonfiguration als Tabellen im Flash
+ *
+ * Erzeugt von tools/gen_defaults.py - nicht von Hand ändern.
  */
 
 #include "default_data.h"
 
-// Konfigurationsdaten
-const char* DEFAULT_CONFIG_JSON = R"({
-  "wlan": {
-    "ssid": "YOUR_SSID",
-    "password": "YOUR_PASSWORD"
+// data/config.json
+constexpr DefaultSettings DEFAULT_SETTINGS = {
+  {  // wlan
+    "YOUR_SSID",  // ssid
+    "YOUR_PASSWORD"  // password
   },
-  "mqtt": {
-    "broker": "IP_ADRESS_MQTT_BROKER",
-    "port": 1883,
-    "client_id_prefix": "ESP32SolarMonitor-"
+  {  // mqtt
+    "IP_ADRESS_MQTT_BROKER",  // broker
+    1883,  // port
+    "ESP32SolarMonitor-"  // client_id_prefix
   },
-  "display": {
-    "brightness": 100,
-    "timeout": 600,
-    "theme": "dark"
+  {  // display
+    100,  // brightness
+    600,  // timeout
+    "dark"  // theme
   },
-  "touch": {
-    "min_x": 200,
-    "max_x": 3700,
-    "min_y": 240,
-    "max_y": 3800
+  {  // touch
+    200,  // min_x
+    3700,  // max_x
+    240,  // min_y
+    3800  // max_y
   },
-  "simulation_mode": false,
-  "update_interval": 5000
-})";
-
-// Menü-Struktur
-const char* DEFAULT_MENU_JSON = R"({
-  "tabs": [
-    {
-      "title": "System",
-      "items": [
-        {
-          "name": "Solar Status",
-          "function": "drawSolarStatus",
-          "icon": "sun"
-        },
-        {
-          "name": "Batterie Status",
-          "function": "drawBatteryStatus",
-          "icon": "battery"
-        },
-        {
-          "name": "Netzstatus",
-          "function": "drawGridStatus",
-          "icon": "grid"
-        },
-        {
-          "name": "PV Leistung",
-          "function": "drawPvPower",
-          "icon": "solar"
-        },
-        {
-          "name": "Verbrauch",
-          "function": "drawConsumption",
-          "icon": "home"
-        },
-        {
-          "name": "Autarkie",
-          "function": "drawAutarky",
-          "icon": "leaf"
-        },
-        {
-          "name": "Tageswerte",
-          "function": "drawDailyValues",
-          "icon": "calendar"
-        },
-        {
-          "name": "Statistik",
-          "function": "drawStatistics",
-          "icon": "chart"
-        }
-      ]
-    },
-    {
-      "title": "Steuerung",
-      "items": [
-        {
-          "name": "Heizung",
-          "function": "controlHeating",
-          "icon": "heat"
-        },
-        {
-          "name": "Pool",
-          "function": "controlPool",
-          "icon": "water"
-        },
-        {
-          "name": "Garten",
-          "function": "controlGarden",
-          "icon": "plant"
-        },
-        {
-          "name": "Licht",
-          "function": "controlLight",
-          "icon": "bulb"
-        },
-        {
-          "name": "Steckdosen",
-          "function": "controlPlugs",
-          "icon": "plug"
-        },
-        {
-          "name": "Lüftung",
-          "function": "controlVentilation",
-          "icon": "fan"
-        },
-        {
-          "name": "Rollladen",
-          "function": "controlShutters",
-          "icon": "window"
-        },
-        {
-          "name": "Kameras",
-          "function": "controlCameras",
-          "icon": "camera"
-        }
-      ]
+  {  // units
+    1,  // inverters
+    1,  // batteries
+    { 360 }  // battery_capacity_ah
+  },
+  {  // controls
+    {  // heating
+      "home/heating/set",  // command_topic
+      "home/heating/state",  // state_topic
+      1  // qos
     },
-    {
-      "title": "Einstellungen",
-      "items": [
-        {
-          "name": "WLAN Setup",
-          "function": "setupWifi",
-          "icon": "wifi"
-        },
-        {
-          "name": "MQTT Setup",
-          "function": "setupMqtt",
-          "icon": "cloud"
-        },
-        {
-          "name": "Display",
-          "function": "setupDisplay",
-          "icon": "monitor"
-        },
-        {
-          "name": "Systeminfo",
-          "function": "showSystemInfo",
-          "icon": "info"
-        },
-        {
-          "name": "Updates",
-          "function": "checkUpdates",
-          "icon": "update"
-        },
-        {
-          "name": "Logs",
-          "function": "viewLogs",
-          "icon": "file"
-        },
-        {
-          "name": "Neustart",
-          "function": "restartSystem",
-          "icon": "refresh"
-        },
-        {
-          "name": "Werkseinstellungen",
-          "function": "factoryReset",
-          "icon": "trash"
-        }
-      ]
+    {  // pool
+      "home/pool/set",  // command_topic
+      "home/pool/state",  // state_topic
+      1  // qos
     }
-  ]
-})";
+  },
+  false,  // simulation_mode
+  5000  // update_interval
+};
 
-// MQTT-Topics
-const char* DEFAULT_MQTT_TOPICS_JSON = R"({
-  "topics": [
-    {
-      "name": "battery_soc",
-      "topic": "solar_assistant/total/battery_state_of_charge/state",
-      "description": "Batterieladezustand in Prozent",
-      "unit": "%",
-      "color": "TFT_YELLOW"
-    },
-    {
-      "name": "load_power",
-      "topic": "solar_assistant/inverter_1/load_power_essential/state",
-      "description": "Verbrauchsleistung",
-      "unit": "W",
-      "color": "TFT_RED"
-    },
-    {
-      "name": "grid_power",
-      "topic": "solar_assistant/inverter_1/grid_power/state",
-      "description": "Netzleistung negativ Einspeisung",
-      "unit": "W",
-      "color": "TFT_BLUE"
-    },
-    {
-      "name": "pv_power",
-      "topic": "solar_assistant/inverter_1/pv_power/state",
-      "description": "PV-Leistung",
-      "unit": "W",
-      "color": "TFT_GREEN"
-    },
-    {
-      "name": "battery_power",
-      "topic": "solar_assistant/total/battery_power/state",
-      "description": "Batterieleistung",
-      "unit": "W",
-      "color": "TFT_PURPLE"
-    },
-    {
-      "name": "battery_voltage",
-      "topic": "solar_assistant/inverter_1/battery_voltage/state",
-      "description": "Batteriespannung",
-      "unit": "V",
-      "color": "TFT_CYAN"
-    },
-    {
-      "name": "daily_yield",
-      "topic": "solar_assistant/inverter_1/energy_day/state",
-      "description": "Tagesertrag",
-      "unit": "kWh",
-      "color": "TFT_ORANGE"
-    },
-    {
-      "name": "total_yield",
-      "topic": "solar_assistant/inverter_1/energy_total/state",
-      "description": "Gesamtertrag",
-      "unit": "kWh",
-      "color": "TFT_ORANGE"
-    }
-  ]
-})";
\ No newline at end of file
+// data/menu.json
+static constexpr DefaultMenuItem MENU_ITEMS_0[] = {
+  { "Solar Status", "drawSolarStatus", "sun", nullptr, 0 },
+  { "Batterie Status", "drawBatteryStatus", "battery", nullptr, 0 },
+  { "Netzstatus", "drawGridStatus", "grid", nullptr, 0 },
+  { "PV Leistung", "drawPvPower", "solar", nullptr, 0 },
+  { "Verbrauch", "drawConsumption", "home", nullptr, 0 },
+  { "Autarkie", "drawAutarky", "leaf", nullptr, 0 },
+  { "Tageswerte", "drawDailyValues", "calendar", nullptr, 0 },
+  { "Statistik", "drawStatistics", "chart", nullptr, 0 },
+  { "Wechselrichter", "drawInverters", "solar", nullptr, 0 },
+  { "Batterien", "drawBatteries", "battery", nullptr, 0 }
+};
+
+static constexpr DefaultMenuItem MENU_ITEMS_1[] = {
+  { "Heizung", "controlHeating", "heat", nullptr, 0 },
+  { "Pool", "controlPool", "water", nullptr, 0 },
+  { "Garten", "controlGarden", "plant", nullptr, 0 },
+  { "Licht", "controlLight", "bulb", nullptr, 0 },
+  { "Steckdosen", "controlPlugs", "plug", nullptr, 0 },
+  { "Lüftung", "controlVentilation", "fan", nullptr, 0 },
+  { "Rollladen", "controlShutters", "window", nullptr, 0 },
+  { "Kameras", "controlCameras", "camera", nullptr, 0 }
+};
+
+static constexpr DefaultMenuItem MENU_ITEMS_2[] = {
+  { "WLAN Setup", "setupWifi", "wifi", nullptr, 0 },
+  { "MQTT Setup", "setupMqtt", "cloud", nullptr, 0 },
+  { "MQTT Statistik", "showTopicStats", "chart", nullptr, 0 },
+  { "Latenz", "showLatency", "chart", nullptr, 0 },
+  { "Display", "setupDisplay", "monitor", nullptr, 0 },
+  { "Touch kalibrieren", "calibrateTouch", "target", nullptr, 0 },
+  { "Systeminfo", "showSystemInfo", "info", nullptr, 0 },
+  { "Updates", "checkUpdates", "update", nullptr, 0 },
+  { "Logs", "viewLogs", "file", nullptr, 0 },
+  { "Neustart", "restartSystem", "refresh", nullptr, 0 },
+  { "Werkseinstellungen", "factoryReset", "trash", nullptr, 0 }
+};
+
+constexpr DefaultMenuTab DEFAULT_MENU[] = {
+  { "System", MENU_ITEMS_0, 10 },
+  { "Steuerung", MENU_ITEMS_1, 8 },
+  { "Einstellungen", MENU_ITEMS_2, 11 }
+};
+static_assert(sizeof(DEFAULT_MENU) / sizeof(DEFAULT_MENU[0]) == DEFAULT_MENU_TABS, "DEFAULT_MENU_TABS");
+
+// data/mqtt_topics.json
+constexpr DefaultTopic DEFAULT_TOPICS[] = {
+  { "battery_soc", "solar_assistant/total/battery_state_of_charge/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 },
+  { "load_power", "solar_assistant/inverter_1/load_power_essential/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 },
+  { "grid_power", "solar_assistant/inverter_1/grid_power/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 },
+  { "pv_power", "solar_assistant/inverter_1/pv_power/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 },
+  { "battery_power", "solar_assistant/total/battery_power/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 },
+  { "battery_voltage", "solar_assistant/inverter_1/battery_voltage/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 },
+  { "daily_yield", "solar_assistant/inverter_1/energy_day/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 },
+  { "total_yield", "solar_assistant/inverter_1/energy_total/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 },
+  { "inverter_1/+", "solar_assistant/inverter_1/+/state", nullptr, 1, 1, 0, nullptr, true, nullptr, 0 }
+};
+static_assert(sizeof(DEFAULT_TOPICS) / sizeof(DEFAULT_TOPICS[0]) == DEFAULT_TOPIC_COUNT, "DEFAULT_TOPIC_COUNT");
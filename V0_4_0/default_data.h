@@ -1,13 +1,101 @@
 /**
- * default_data.h - Default-Konfigurationsdaten
+ * default_data.h - Standardkonfiguration als Tabellen im Flash
+ *
+ * Erzeugt von tools/gen_defaults.py aus data/config.json, data/menu.json und
+ * data/mqtt_topics.json - nicht von Hand ändern, sondern die JSON-Dateien
+ * anpassen und das Skript erneut ausführen.
+ *
+ * Ohne eigene Datei im SPIFFS werden diese Tabellen direkt verwendet.
  */
 
 #ifndef DEFAULT_DATA_H
 #define DEFAULT_DATA_H
 
-// Standard-Konfigurationsdaten als Konstanten
-extern const char* DEFAULT_CONFIG_JSON;
-extern const char* DEFAULT_MENU_JSON;
-extern const char* DEFAULT_MQTT_TOPICS_JSON;
+#include <stdint.h>
 
-#endif // DEFAULT_DATA_H
\ No newline at end of file
+struct DefaultMenuItem {
+  const char* name;
+  const char* function;        // nullptr = Untermenü
+  const char* icon;
+  const DefaultMenuItem* items;
+  uint8_t itemCount;
+};
+
+struct DefaultMenuTab {
+  const char* title;
+  const DefaultMenuItem* items;
+  uint8_t itemCount;
+};
+
+struct DefaultTopicField {
+  const char* name;
+  const char* path;
+  const char* metric;          // nullptr = name
+  uint8_t inverter;            // 1..N
+  uint8_t battery;             // 1..N
+};
+
+struct DefaultTopic {
+  const char* name;
+  const char* topic;
+  const char* metric;          // nullptr = name
+  uint8_t inverter;            // 1..N
+  uint8_t battery;             // 1..N
+  uint8_t qos;
+  const char* priority;        // nullptr = aus der Messgröße
+  bool coalesce;
+  const DefaultTopicField* fields;
+  uint8_t fieldCount;
+};
+
+// data/config.json
+struct DefaultSettings {
+  struct Wlan {
+    const char* ssid;
+    const char* password;
+  } wlan;
+  struct Mqtt {
+    const char* broker;
+    int32_t port;
+    const char* client_id_prefix;
+  } mqtt;
+  struct Display {
+    int32_t brightness;
+    int32_t timeout;
+    const char* theme;
+  } display;
+  struct Touch {
+    int32_t min_x;
+    int32_t max_x;
+    int32_t min_y;
+    int32_t max_y;
+  } touch;
+  struct Units {
+    int32_t inverters;
+    int32_t batteries;
+    int32_t battery_capacity_ah[1];
+  } units;
+  struct Controls {
+    struct Heating {
+      const char* command_topic;
+      const char* state_topic;
+      int32_t qos;
+    } heating;
+    struct Pool {
+      const char* command_topic;
+      const char* state_topic;
+      int32_t qos;
+    } pool;
+  } controls;
+  bool simulation_mode;
+  int32_t update_interval;
+};
+
+const uint8_t DEFAULT_MENU_TABS = 3;
+const uint8_t DEFAULT_TOPIC_COUNT = 9;
+
+extern const DefaultSettings DEFAULT_SETTINGS;
+extern const DefaultMenuTab DEFAULT_MENU[DEFAULT_MENU_TABS];
+extern const DefaultTopic DEFAULT_TOPICS[DEFAULT_TOPIC_COUNT];
+
+#endif // DEFAULT_DATA_H
@@ -0,0 +1,276 @@
+/**
+ * ConfigStoreTest.cpp - Einstellungsjournal nach Stromausfall
+ *
+ * Läuft auf dem Datei-Ersatz aus stubs/FS.h. Geprüft wird, dass begin()
+ * nach einem Abbruch an jeder Stelle genau den Stand des letzten
+ * vollständigen Datensatzes liefert:
+ *   - /settings.log an jeder Byteposition abgeschnitten
+ *   - Stromausfall an jedem Byte bzw. jeder Dateioperation beim Anhängen
+ *     und während der Verdichtung (inkl. Umbenennen von /settings.tmp)
+ */
+
+#include "test.h"
+#include "ConfigStore.h"
+#include <SPIFFS.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::map<std::string, std::string> Values;
+
+static std::string hostFile(const char *path) {
+  return hostFsRoot + path;
+}
+
+static void wipe() {
+  hostFsPowerOn();
+  std::filesystem::remove_all(hostFsRoot);
+  std::filesystem::create_directories(hostFsRoot);
+}
+
+static std::string readFile(const char *path) {
+  std::ifstream file(hostFile(path), std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+static void writeFile(const char *path, const std::string &content) {
+  std::ofstream file(hostFile(path), std::ios::binary | std::ios::trunc);
+  file << content;
+}
+
+struct Capture : Print {
+  std::string text;
+  size_t write(uint8_t c) override { text += (char)c; return 1; }
+  using Print::write;
+};
+
+// Alle Werte des Journals wie printValues() sie ausgibt
+static std::string dump(const ConfigStore &store) {
+  Capture out;
+  store.printValues(out);
+  return out.text;
+}
+
+static std::string dump(const Values &values) {
+  std::string text;
+  for (const auto &entry : values) {
+    text += entry.first + " = " + entry.second + "\r\n";
+  }
+  return text;
+}
+
+// Nach einem Neustart gelesener Stand
+static std::string restart(bool *ok = nullptr) {
+  hostFsPowerOn();
+  ConfigStore store;
+  bool started = store.begin(SPIFFS);
+  if (ok) {
+    *ok = started;
+  }
+  return dump(store);
+}
+
+// Änderungen mit Löschungen und wechselnden Längen, Modell nach jedem Datensatz
+struct Journal {
+  std::string bytes;
+  std::vector<size_t> boundaries;   // Dateigröße nach jedem Datensatz
+  std::vector<Values> states;       // Stand nach jedem Datensatz
+};
+
+static Journal writeJournal() {
+  wipe();
+  Journal journal;
+  journal.boundaries.push_back(0);
+  journal.states.push_back(Values());
+
+  ConfigStore store;
+  CHECK(store.begin(SPIFFS));
+  Values model;
+  const char *keys[] = {"display.brightness", "wlan.ssid", "mqtt.broker", "ui.theme"};
+  for (int i = 0; i < 24; i++) {
+    std::string key = keys[(i * 7) % 4];
+    if (i % 5 == 4) {
+      CHECK(store.remove(key.c_str()));
+      model.erase(key);
+    } else {
+      std::string value = std::to_string(i) + std::string(i % 3 * 9, 'x');
+      CHECK(store.set(key.c_str(), value.c_str()));
+      model[key] = value;
+    }
+    size_t size = readFile(CONFIG_STORE_PATH).size();
+    if (size != journal.boundaries.back()) {
+      journal.boundaries.push_back(size);
+      journal.states.push_back(model);
+    }
+  }
+  journal.bytes = readFile(CONFIG_STORE_PATH);
+  CHECK(journal.boundaries.back() == journal.bytes.size());
+  CHECK(dump(store) == dump(model));
+  return journal;
+}
+
+static void testTruncatedLog() {
+  Journal journal = writeJournal();
+  CHECK(journal.boundaries.size() > 20);
+
+  int mismatches = 0;
+  for (size_t cut = 0; cut <= journal.bytes.size(); cut++) {
+    // Letzter vollständiger Datensatz bis zur Schnittstelle
+    size_t record = 0;
+    while (record + 1 < journal.boundaries.size() && journal.boundaries[record + 1] <= cut) {
+      record++;
+    }
+    std::string expected = dump(journal.states[record]);
+
+    wipe();
+    writeFile(CONFIG_STORE_PATH, journal.bytes.substr(0, cut));
+    bool ok = false;
+    mismatches += restart(&ok) != expected || !ok;
+
+    // Der Rest ist weggeräumt: ein neuer Wert bleibt über den nächsten Start erhalten
+    {
+      ConfigStore store;
+      store.begin(SPIFFS);
+      store.set("neu", "1");
+    }
+    Values after = journal.states[record];
+    after["neu"] = "1";
+    mismatches += restart() != dump(after);
+    mismatches += readFile(CONFIG_STORE_PATH).size() > cut + 32;
+  }
+  CHECK(mismatches == 0);
+}
+
+static void testPowerLossOnAppend() {
+  int mismatches = 0;
+  for (long budget = 0; budget <= 40; budget++) {
+    wipe();
+    {
+      ConfigStore store;
+      store.begin(SPIFFS);
+      store.set("a", "1");
+      store.set("key.b", "alt");
+    }
+    {
+      ConfigStore store;
+      store.begin(SPIFFS);
+      hostFsBudget = budget;
+      store.set("key.b", "neuer Wert");
+    }
+    // Entweder der alte oder der neue Wert, nie ein halber
+    std::string state = restart();
+    mismatches += state != dump(Values{{"a", "1"}, {"key.b", "alt"}}) &&
+                  state != dump(Values{{"a", "1"}, {"key.b", "neuer Wert"}});
+  }
+  CHECK(mismatches == 0);
+}
+
+// Journal kurz vor der Verdichtungsgrenze; liefert den Stand vor und nach dem letzten set()
+static ConfigStore *prepareCompaction(Values &before, Values &after) {
+  wipe();
+  ConfigStore *store = new ConfigStore;
+  store->begin(SPIFFS);
+  for (int i = 0; i < 8; i++) {
+    std::string key = "k" + std::to_string(i);
+    store->set(key.c_str(), ("v" + std::to_string(i)).c_str());
+    before[key] = "v" + std::to_string(i);
+  }
+  int n = 0;
+  while (readFile(CONFIG_STORE_PATH).size() + 40 < CONFIG_STORE_COMPACT_SIZE) {
+    store->set("display.brightness", String(n++ % 100 + 1000));
+  }
+  store->set("display.brightness", "1500");
+  before["display.brightness"] = "1500";
+  after = before;
+  after["display.brightness"] = "2000";
+  return store;
+}
+
+static void testPowerLossDuringCompaction() {
+  int cases = 0;
+  int mismatches = 0;
+  bool completed = false;
+  for (long budget = 0; !completed; budget++) {
+    Values before, after;
+    ConfigStore *store = prepareCompaction(before, after);
+    size_t logSize = readFile(CONFIG_STORE_PATH).size();
+    hostFsBudget = budget;
+    store->set("display.brightness", "2000");
+    completed = !hostFsDead;
+    delete store;
+
+    std::string state = restart();
+    mismatches += state != dump(before) && state != dump(after);
+    mismatches += SPIFFS.exists(CONFIG_STORE_TEMP);
+    if (completed) {
+      // Verdichtet: nur noch die aktuellen Werte
+      CHECK(state == dump(after));
+      CHECK(readFile(CONFIG_STORE_PATH).size() < logSize / 4);
+    }
+    cases++;
+  }
+  printf("Verdichtung: %d Abbruchstellen\n", cases);
+  CHECK(cases > 100);
+  CHECK(mismatches == 0);
+}
+
+static void testInterruptedRename() {
+  Values before, after;
+  delete prepareCompaction(before, after);
+  std::string oldLog = readFile(CONFIG_STORE_PATH);
+  {
+    ConfigStore store;
+    store.begin(SPIFFS);
+    store.set("display.brightness", "2000");
+    store.compact();
+  }
+  std::string newLog = readFile(CONFIG_STORE_PATH);
+  CHECK(newLog.size() < oldLog.size());
+
+  // Abbruch vor dem Löschen: das alte Journal gilt, die Kopie wird verworfen
+  wipe();
+  writeFile(CONFIG_STORE_PATH, oldLog);
+  writeFile(CONFIG_STORE_TEMP, newLog);
+  CHECK(restart() == dump(before));
+  CHECK(!SPIFFS.exists(CONFIG_STORE_TEMP));
+
+  // Halb geschriebene Kopie neben dem alten Journal
+  wipe();
+  writeFile(CONFIG_STORE_PATH, oldLog);
+  writeFile(CONFIG_STORE_TEMP, newLog.substr(0, newLog.size() / 2));
+  CHECK(restart() == dump(before));
+  CHECK(!SPIFFS.exists(CONFIG_STORE_TEMP));
+
+  // Abbruch zwischen Löschen und Umbenennen: die vollständige Kopie wird übernommen
+  wipe();
+  writeFile(CONFIG_STORE_TEMP, newLog);
+  bool ok = false;
+  CHECK(restart(&ok) == dump(after));
+  CHECK(ok);
+  CHECK(!SPIFFS.exists(CONFIG_STORE_TEMP));
+  CHECK(readFile(CONFIG_STORE_PATH) == newLog);
+
+  // Stromausfall beim Übernehmen selbst: beim nächsten Start erneut
+  wipe();
+  writeFile(CONFIG_STORE_TEMP, newLog);
+  {
+    ConfigStore store;
+    hostFsBudget = 0;
+    CHECK(!store.begin(SPIFFS));
+  }
+  CHECK(restart() == dump(after));
+}
+
+int main() {
+  testTruncatedLog();
+  testPowerLossOnAppend();
+  testPowerLossDuringCompaction();
+  testInterruptedRename();
+  wipe();
+  return TEST_RESULT();
+}
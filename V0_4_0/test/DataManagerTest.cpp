@@ -0,0 +1,123 @@
+/**
+ * DataManagerTest.cpp - Summen über mehrere Wechselrichter und Batterien
+ *
+ * Bindet Topics wie MqttManager::bindWildcardTopic() über den Namen an
+ * Messgröße und Einheit und prüft die Summen in DataManager.
+ */
+
+#include "test.h"
+#include "DataManager.h"
+#include "TopicTrie.h"
+#include <random>
+
+// Wie bindWildcardTopic(): Name aus der Vorlage, Messgröße aus der letzten
+// erfassten Ebene, Einheit aus der Nummer im Namen
+static void receive(DataManager &data, const char *nameTemplate, const char *filter,
+                    const char *topic, float value, uint8_t configuredUnit = 0) {
+  String level;
+  String name = TopicTrie::expandName(nameTemplate, filter, topic, &level);
+  SolarMetric metric = DataManager::metricFromName(level);
+  CHECK(metric != METRIC_NONE);
+  data.setMetric(metric, DataManager::unitFromName(name, configuredUnit), value);
+}
+
+static void testNames() {
+  String level;
+  CHECK(TopicTrie::expandName("+/+", "solar_assistant/+/+/state",
+                              "solar_assistant/inverter_2/pv_power/state", &level) == "inverter_2/pv_power");
+  CHECK(level == "pv_power");
+  CHECK(TopicTrie::expandName("inverter_1/+", "solar_assistant/inverter_1/+/state",
+                              "solar_assistant/inverter_1/load_power/state", &level) == "inverter_1/load_power");
+  CHECK(level == "load_power");
+  CHECK(TopicTrie::expandName("wr", "wr/#", "wr/3/grid_power", &level) == "wr/3/grid_power");
+  CHECK(level == "grid_power");
+
+  CHECK(DataManager::unitFromName("inverter_2/pv_power", 0) == 1);
+  CHECK(DataManager::unitFromName("battery_12/battery_soc", 0) == 11);
+  CHECK(DataManager::unitFromName("wr/3/grid_power", 0) == 2);
+  // Nummer nur in der Messgröße oder gar nicht: konfigurierte Einheit
+  CHECK(DataManager::unitFromName("pv_power", 3) == 3);
+  CHECK(DataManager::unitFromName("inverter/pv_power_2", 1) == 1);
+}
+
+static void testTwoInverters() {
+  DataManager data;
+  const char *filter = "solar_assistant/+/+/state";
+  receive(data, "+/+", filter, "solar_assistant/inverter_1/pv_power/state", 1200);
+  receive(data, "+/+", filter, "solar_assistant/inverter_2/pv_power/state", 800);
+  receive(data, "+/+", filter, "solar_assistant/inverter_1/load_power/state", 500);
+  receive(data, "+/+", filter, "solar_assistant/inverter_2/load_power/state", 700);
+
+  CHECK(data.getInverters().count == 2);
+  CHECK_NEAR(data.getInverters().pvPower[0], 1200, 0.01);
+  CHECK_NEAR(data.getInverters().pvPower[1], 800, 0.01);
+  CHECK_NEAR(data.getData().pvPower, 2000, 0.01);
+  CHECK_NEAR(data.getData().loadPower, 1200, 0.01);
+
+  // Neuer Wert eines Wechselrichters ändert nur dessen Anteil
+  receive(data, "+/+", filter, "solar_assistant/inverter_2/pv_power/state", 300);
+  CHECK_NEAR(data.getData().pvPower, 1500, 0.01);
+
+  // Vorlage je Wechselrichter ohne Nummer im Platzhalter
+  receive(data, "inverter_1/+", "solar_assistant/inverter_1/+/state",
+          "solar_assistant/inverter_1/pv_power/state", 1000);
+  CHECK_NEAR(data.getData().pvPower, 1300, 0.01);
+}
+
+static void testTwoBatteries() {
+  DataManager data;
+  const float capacities[] = { 100, 300 };
+  data.configureUnits(1, 2, capacities);
+  const char *filter = "bms/+/+";
+  receive(data, "+/+", filter, "bms/battery_1/battery_soc", 40);
+  receive(data, "+/+", filter, "bms/battery_2/battery_soc", 80);
+  receive(data, "+/+", filter, "bms/battery_1/battery_power", -500);
+  receive(data, "+/+", filter, "bms/battery_2/battery_power", 200);
+
+  // Nach Kapazität gewichtet: (40 * 100 + 80 * 300) / 400
+  CHECK_NEAR(data.getData().batterySOC, 70, 0.01);
+  CHECK_NEAR(data.getData().batteryPower, -300, 0.01);
+}
+
+// Über viele Einzelwerte dürfen die Summen nicht von den Einheiten abdriften
+static void testNoDrift() {
+  DataManager data;
+  const float capacities[] = { 100, 200, 280, 360 };
+  data.configureUnits(4, 4, capacities);
+  std::mt19937 rng(7);
+  double worstPower = 0;
+  double worstSoc = 0;
+
+  for (long i = 0; i < 1000000; i++) {
+    uint8_t unit = rng() % 4;
+    data.setMetric(METRIC_PV_POWER, unit, (rng() % 500000) / 100.0f);
+    data.setMetric(METRIC_GRID_POWER, unit, ((long)(rng() % 1000000) - 500000) / 100.0f);
+    data.setMetric(METRIC_BATTERY_SOC, unit, (rng() % 10000) / 100.0f);
+
+    const InverterArray &inverters = data.getInverters();
+    const BatteryArray &batteries = data.getBatteries();
+    double pv = 0;
+    double grid = 0;
+    double socCapacity = 0;
+    double capacity = 0;
+    for (uint8_t k = 0; k < 4; k++) {
+      pv += inverters.pvPower[k];
+      grid += inverters.gridPower[k];
+      socCapacity += batteries.soc[k] * batteries.capacityAh[k];
+      capacity += batteries.capacityAh[k];
+    }
+    worstPower = max(worstPower, max(fabs(pv - data.getData().pvPower), fabs(grid - data.getData().gridPower)));
+    worstSoc = max(worstSoc, fabs(socCapacity / capacity - data.getData().batterySOC));
+  }
+  printf("Größte Abweichung: %.4f W, %.5f %% SOC\n", worstPower, worstSoc);
+  CHECK(worstPower < 0.05);
+  CHECK(worstSoc < 0.0002);
+}
+
+int main() {
+  testNames();
+  testTwoInverters();
+  testTwoBatteries();
+  testNoDrift();
+  return TEST_RESULT();
+}
@@ -0,0 +1,283 @@
+/**
+ * IngestQueueTest.cpp - Spuren, Zusammenfassen und Überlauf der Eingangswarteschlange
+ *
+ * Feste Fälle für Reihenfolge, Verdrängen und die großen Puffer; danach
+ * zufällige push()/pop()-Folgen gegen ein einfaches Modell aus einer Liste
+ * je Spur, damit auch der Ring über viele Umläufe geprüft wird.
+ */
+
+#include "test.h"
+#include "IngestQueue.h"
+#include <deque>
+#include <string>
+#include <random>
+
+static bool push(IngestQueue &queue, uint16_t topic, IngestPriority priority, const std::string &payload,
+                 bool coalesce = true, uint16_t traceId = 0) {
+  return queue.push(topic, priority, coalesce, (const uint8_t *)payload.data(), payload.size(), traceId);
+}
+
+// Nächste Nachricht als "topic:payload", leer wenn die Warteschlange leer ist
+static std::string pop(IngestQueue &queue, uint16_t *traceId = nullptr) {
+  uint16_t topic;
+  const char *payload;
+  size_t length;
+  if (!queue.pop(topic, payload, length, traceId)) {
+    return "";
+  }
+  CHECK(payload[length] == '\0');
+  return std::to_string(topic) + ":" + std::string(payload, length);
+}
+
+static void testLaneOrder() {
+  IngestQueue queue;
+  CHECK(push(queue, 1, INGEST_LOW, "l1"));
+  CHECK(push(queue, 2, INGEST_NORMAL, "n1"));
+  CHECK(push(queue, 3, INGEST_HIGH, "h1"));
+  CHECK(push(queue, 4, INGEST_LOW, "l2"));
+  CHECK(push(queue, 5, INGEST_HIGH, "h2", true, 77));
+  CHECK(push(queue, 6, INGEST_NORMAL, "n2"));
+  CHECK(queue.size() == 6);
+
+  // Höchste Spur zuerst, innerhalb der Spur in Ankunftsreihenfolge
+  CHECK(pop(queue) == "3:h1");
+  uint16_t traceId = 0;
+  CHECK(pop(queue, &traceId) == "5:h2");
+  CHECK(traceId == 77);
+  CHECK(pop(queue) == "2:n1");
+
+  // Eine neue hohe Nachricht überholt die wartenden
+  CHECK(push(queue, 7, INGEST_HIGH, "h3"));
+  CHECK(pop(queue) == "7:h3");
+  CHECK(pop(queue) == "6:n2");
+  CHECK(pop(queue) == "1:l1");
+  CHECK(pop(queue) == "4:l2");
+  CHECK(pop(queue) == "");
+  CHECK(queue.size() == 0);
+}
+
+static void testCoalesce() {
+  IngestQueue queue;
+  CHECK(push(queue, 1, INGEST_NORMAL, "10"));
+  CHECK(push(queue, 2, INGEST_NORMAL, "20"));
+  CHECK(push(queue, 1, INGEST_NORMAL, "11", true, 5));
+
+  // Neuester Wert auf der Position der ersten Nachricht
+  CHECK(queue.size() == 2);
+  uint16_t traceId = 0;
+  CHECK(pop(queue, &traceId) == "1:11");
+  CHECK(traceId == 5);
+  CHECK(pop(queue) == "2:20");
+
+  // Ohne Zusammenfassen belegt jede Nachricht einen Platz
+  CHECK(push(queue, 3, INGEST_NORMAL, "a", false));
+  CHECK(push(queue, 3, INGEST_NORMAL, "b", false));
+  CHECK(queue.size() == 2);
+  CHECK(pop(queue) == "3:a");
+  CHECK(pop(queue) == "3:b");
+
+  // Zwischen kurz und lang wechselnde Werte desselben Topics
+  std::string json(200, 'j');
+  CHECK(push(queue, 4, INGEST_NORMAL, "kurz"));
+  CHECK(push(queue, 4, INGEST_NORMAL, json));
+  CHECK(push(queue, 4, INGEST_NORMAL, "wieder kurz"));
+  CHECK(queue.size() == 1);
+  CHECK(pop(queue) == "4:wieder kurz");
+}
+
+static void testOverflow() {
+  IngestQueue queue;
+  for (int i = 0; i < INGEST_QUEUE_DEPTH / 2; i++) {
+    CHECK(push(queue, 100 + i, INGEST_LOW, "l"));
+  }
+  for (int i = 0; i < INGEST_QUEUE_DEPTH / 2; i++) {
+    CHECK(push(queue, 200 + i, INGEST_NORMAL, "n"));
+  }
+  CHECK(queue.size() == INGEST_QUEUE_DEPTH);
+
+  // Voll: Nachrichten der niedrigsten Spur werden verworfen
+  CHECK(!push(queue, 300, INGEST_LOW, "l"));
+
+  // Höhere Spuren verdrängen die älteste Nachricht der niedrigsten Spur
+  CHECK(push(queue, 2, INGEST_NORMAL, "n"));
+  CHECK(push(queue, 1, INGEST_HIGH, "h"));
+  CHECK(queue.size() == INGEST_QUEUE_DEPTH);
+
+  // Zusammenfassen braucht keinen freien Platz
+  CHECK(push(queue, 200, INGEST_NORMAL, "neu"));
+
+  CHECK(pop(queue) == "1:h");
+  CHECK(pop(queue) == "200:neu");
+  for (int i = 1; i < INGEST_QUEUE_DEPTH / 2; i++) {
+    CHECK(pop(queue) == std::to_string(200 + i) + ":n");
+  }
+  CHECK(pop(queue) == "2:n");
+  for (int i = 2; i < INGEST_QUEUE_DEPTH / 2; i++) {
+    CHECK(pop(queue) == std::to_string(100 + i) + ":l");
+  }
+  CHECK(pop(queue) == "");
+
+  // Nur hohe Nachrichten: die neue wird verworfen
+  for (int i = 0; i < INGEST_QUEUE_DEPTH; i++) {
+    CHECK(push(queue, i, INGEST_HIGH, "h"));
+  }
+  CHECK(!push(queue, 999, INGEST_HIGH, "h"));
+  CHECK(pop(queue) == "0:h");
+}
+
+static void testLargeBuffers() {
+  IngestQueue queue;
+  std::string json[INGEST_LARGE_BUFFERS + 1];
+  for (int i = 0; i <= INGEST_LARGE_BUFFERS; i++) {
+    json[i] = "{\"n\":" + std::to_string(i) + ",\"pad\":\"" + std::string(100 + i, 'x') + "\"}";
+  }
+
+  for (int i = 0; i < INGEST_LARGE_BUFFERS; i++) {
+    CHECK(push(queue, i, INGEST_NORMAL, json[i]));
+  }
+  // Alle großen Puffer belegt: lange Nachrichten werden verworfen, kurze nicht
+  CHECK(!push(queue, 10, INGEST_NORMAL, json[INGEST_LARGE_BUFFERS]));
+  CHECK(push(queue, 11, INGEST_NORMAL, "42"));
+  // Ersetzen eines langen Werts nutzt dessen Puffer weiter
+  CHECK(push(queue, 1, INGEST_NORMAL, json[INGEST_LARGE_BUFFERS]));
+
+  // Ohne freien Puffer wird auch bei voller Warteschlange nichts verdrängt
+  for (int i = 0; i < INGEST_QUEUE_DEPTH - INGEST_LARGE_BUFFERS - 1; i++) {
+    CHECK(push(queue, 100 + i, INGEST_LOW, "l"));
+  }
+  CHECK(queue.size() == INGEST_QUEUE_DEPTH);
+  CHECK(!push(queue, 12, INGEST_HIGH, json[0]));
+  CHECK(queue.size() == INGEST_QUEUE_DEPTH);
+
+  CHECK(pop(queue) == "0:" + json[0]);
+  CHECK(pop(queue) == "1:" + json[INGEST_LARGE_BUFFERS]);
+
+  // Nach pop() ist der Puffer wieder frei
+  CHECK(push(queue, 12, INGEST_HIGH, json[0]));
+  CHECK(pop(queue) == "12:" + json[0]);
+  CHECK(pop(queue) == "2:" + json[2]);
+  CHECK(pop(queue) == "3:" + json[3]);
+  CHECK(pop(queue) == "11:42");
+
+  // Größer als ein Paket: immer verworfen
+  CHECK(!push(queue, 13, INGEST_HIGH, std::string(MQTT_PACKET_SIZE + 1, 'x')));
+  CHECK(push(queue, 13, INGEST_HIGH, std::string(MQTT_PACKET_SIZE, 'x')));
+}
+
+// Modell: eine Liste je Spur, Nachrichten als (Topic, Payload, Zusammenfassen)
+struct ModelEntry {
+  uint16_t topic;
+  std::string payload;
+  bool coalesce;
+};
+
+struct Model {
+  std::deque<ModelEntry> lanes[INGEST_LANES];
+
+  size_t size() const {
+    size_t total = 0;
+    for (const auto &lane : lanes) {
+      total += lane.size();
+    }
+    return total;
+  }
+
+  int largeCount() const {
+    int used = 0;
+    for (const auto &lane : lanes) {
+      for (const auto &entry : lane) {
+        used += entry.payload.size() > INGEST_INLINE_SIZE;
+      }
+    }
+    return used;
+  }
+
+  bool push(uint16_t topic, uint8_t lane, bool coalesce, const std::string &payload) {
+    bool large = payload.size() > INGEST_INLINE_SIZE;
+    if (coalesce) {
+      for (auto &entries : lanes) {
+        for (auto &entry : entries) {
+          if (entry.topic == topic && entry.coalesce) {
+            bool wasLarge = entry.payload.size() > INGEST_INLINE_SIZE;
+            if (payload.size() > MQTT_PACKET_SIZE || (large && !wasLarge && largeCount() >= INGEST_LARGE_BUFFERS)) {
+              return false;
+            }
+            entry.payload = payload;
+            return true;
+          }
+        }
+      }
+    }
+    if (payload.size() > MQTT_PACKET_SIZE || (large && largeCount() >= INGEST_LARGE_BUFFERS)) {
+      return false;
+    }
+    if (size() >= INGEST_QUEUE_DEPTH) {
+      bool displaced = false;
+      for (int victim = INGEST_LANES - 1; victim > lane && !displaced; victim--) {
+        if (!lanes[victim].empty()) {
+          lanes[victim].pop_front();
+          displaced = true;
+        }
+      }
+      if (!displaced) {
+        return false;
+      }
+    }
+    lanes[lane].push_back({topic, payload, coalesce});
+    return true;
+  }
+
+  std::string pop() {
+    for (auto &lane : lanes) {
+      if (!lane.empty()) {
+        ModelEntry entry = lane.front();
+        lane.pop_front();
+        return std::to_string(entry.topic) + ":" + entry.payload;
+      }
+    }
+    return "";
+  }
+};
+
+static void testAgainstModel() {
+  std::mt19937 random(42);
+  IngestQueue queue;
+  Model model;
+  int mismatches = 0;
+  int drops = 0;
+
+  for (int step = 0; step < 200000; step++) {
+    // Mehr push() als pop(), damit die Warteschlange oft voll ist
+    if (random() % 100 < 60) {
+      uint16_t topic = random() % 40;
+      uint8_t lane = random() % INGEST_LANES;
+      bool coalesce = topic % 4 != 0;
+      size_t length = random() % 10 == 0 ? INGEST_INLINE_SIZE + 1 + random() % 900 : random() % (INGEST_INLINE_SIZE + 1);
+      std::string payload = std::to_string(step);
+      payload.resize(std::max(length, payload.size()), '.');
+      bool expected = model.push(topic, lane, coalesce, payload);
+      mismatches += push(queue, topic, (IngestPriority)lane, payload, coalesce) != expected;
+      drops += !expected;
+    } else {
+      mismatches += pop(queue) != model.pop();
+    }
+    mismatches += queue.size() != model.size();
+  }
+
+  printf("Verworfen: %d\n", drops);
+  CHECK(mismatches == 0);
+  CHECK(drops > 1000);
+  while (model.size() > 0) {
+    CHECK(pop(queue) == model.pop());
+  }
+  CHECK(pop(queue) == "");
+}
+
+int main() {
+  testLaneOrder();
+  testCoalesce();
+  testOverflow();
+  testLargeBuffers();
+  testAgainstModel();
+  return TEST_RESULT();
+}
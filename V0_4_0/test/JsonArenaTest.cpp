@@ -0,0 +1,268 @@
+/**
+ * JsonArenaTest.cpp - Zerstückelung des Heaps durch JSON-Payloads
+ *
+ * Läuft N JSON-Nachrichten durch die echte IngestQueue und legt für jede ein
+ * kurzlebiges Dokument an, einmal über jsonArena und einmal direkt auf einem
+ * nachgebildeten Heap. Dazwischen tauschen andere Module langlebige Blöcke
+ * auf demselben Heap aus. Geprüft wird der größte freie Block.
+ *
+ * Nachgebildet sind zwei Dinge, die Zahlen gelten also nur für das Modell:
+ *   - SimHeap: first-fit mit Zusammenlegen und 8 Byte Kopf je Block, nicht
+ *     der TLSF-Heap von ESP-IDF
+ *   - parseDocument(): die Anforderungen von deserializeJson() in
+ *     ArduinoJson 7 (Pool-Liste, Slot-Pools, Zeichenketten, die ab 31 Bytes
+ *     durch Verdoppeln wachsen und danach gekürzt werden); die Bibliothek
+ *     selbst ist in den Host-Tests nur ein Platzhalter
+ */
+
+#include "test.h"
+#include "JsonArena.h"
+#include "IngestQueue.h"
+#include <vector>
+#include <map>
+#include <random>
+#include <string>
+
+static const size_t HEAP_SIZE = 160 * 1024;
+static const size_t NOT_ALLOCATED = SIZE_MAX;
+
+class SimHeap {
+private:
+  struct Block {
+    size_t offset;
+    size_t size;
+    bool used;
+  };
+  std::vector<Block> blocks;
+
+public:
+  SimHeap(size_t size) { blocks.push_back({0, size, false}); }
+
+  size_t allocate(size_t size) {
+    size = ((size + 7) & ~(size_t)7) + 8;
+    for (size_t i = 0; i < blocks.size(); i++) {
+      if (!blocks[i].used && blocks[i].size >= size) {
+        if (blocks[i].size > size) {
+          blocks.insert(blocks.begin() + i + 1, {blocks[i].offset + size, blocks[i].size - size, false});
+        }
+        blocks[i].size = size;
+        blocks[i].used = true;
+        return blocks[i].offset;
+      }
+    }
+    return NOT_ALLOCATED;
+  }
+
+  void release(size_t offset) {
+    for (size_t i = 0; i < blocks.size(); i++) {
+      if (blocks[i].offset != offset) {
+        continue;
+      }
+      blocks[i].used = false;
+      if (i + 1 < blocks.size() && !blocks[i + 1].used) {
+        blocks[i].size += blocks[i + 1].size;
+        blocks.erase(blocks.begin() + i + 1);
+      }
+      if (i > 0 && !blocks[i - 1].used) {
+        blocks[i - 1].size += blocks[i].size;
+        blocks.erase(blocks.begin() + i);
+      }
+      return;
+    }
+    CHECK(!"Block nicht gefunden");
+  }
+
+  size_t largestFree() const {
+    size_t largest = 0;
+    for (const auto &block : blocks) {
+      if (!block.used) {
+        largest = std::max(largest, block.size);
+      }
+    }
+    return largest;
+  }
+};
+
+// Dokumente direkt auf dem nachgebildeten Heap; Zeiger sind nur Kennungen
+class SimHeapAllocator : public ArduinoJson::Allocator {
+private:
+  SimHeap &heap;
+  static uintptr_t base() { return 0x10000000; }
+
+public:
+  SimHeapAllocator(SimHeap &heap) : heap(heap) {}
+
+  void* allocate(size_t size) override {
+    size_t offset = heap.allocate(size);
+    return offset == NOT_ALLOCATED ? nullptr : (void*)(base() + offset);
+  }
+  void deallocate(void *ptr) override {
+    if (ptr) {
+      heap.release((uintptr_t)ptr - base());
+    }
+  }
+  void* reallocate(void *ptr, size_t size) override {
+    // Wie realloc() ohne Platz dahinter: neuer Block, dann alten freigeben
+    void *moved = allocate(size);
+    if (moved) {
+      deallocate(ptr);
+    }
+    return moved;
+  }
+};
+
+// Langlebige Blöcke anderer Module (Strings der Anzeige, Callbacks, ...)
+struct LongLived {
+  SimHeap &heap;
+  std::mt19937 &random;
+  std::vector<size_t> blocks = std::vector<size_t>(64, NOT_ALLOCATED);
+
+  void replaceOne() {
+    size_t &block = blocks[random() % blocks.size()];
+    if (block != NOT_ALLOCATED) {
+      heap.release(block);
+    }
+    block = heap.allocate(8 + random() % 48);
+  }
+};
+
+// Anforderungen von deserializeJson() für payload, danach Freigabe des Dokuments
+static void parseDocument(ArduinoJson::Allocator &allocator, const char *payload, size_t length,
+                          LongLived &others) {
+  std::vector<void*> blocks;
+  size_t poolListSize = 4 * sizeof(void*);
+  void *poolList = allocator.allocate(poolListSize);
+  blocks.push_back(allocator.allocate(1024));
+  size_t slots = 0;
+
+  // Jede Zeichenkette und jede Zahl belegt einen Slot, Zeichenketten zusätzlich Speicher
+  for (size_t i = 0; i < length; i++) {
+    if (payload[i] == '"') {
+      size_t end = i + 1;
+      while (end < length && payload[end] != '"') {
+        end++;
+      }
+      size_t capacity = 31;
+      void *text = allocator.allocate(capacity);
+      while (capacity < end - i) {
+        capacity *= 2;
+        text = allocator.reallocate(text, capacity);
+      }
+      blocks.push_back(allocator.reallocate(text, end - i));
+      i = end;
+    } else if (!isdigit((unsigned char)payload[i]) || (i > 0 && isdigit((unsigned char)payload[i - 1]))) {
+      continue;
+    }
+
+    // Voller Slot-Pool: neuer Pool, die Pool-Liste wächst mit
+    if (++slots % 128 == 0) {
+      blocks.push_back(allocator.allocate(1024));
+      poolListSize += sizeof(void*);
+      poolList = allocator.reallocate(poolList, poolListSize);
+    }
+    // Während des Parsens empfängt bzw. zeichnet der Rest weiter
+    if (slots % 8 == 0) {
+      others.replaceOne();
+    }
+  }
+
+  // shrinkToFit() kürzt den letzten Pool
+  blocks[blocks.size() > 1 ? 1 : 0] = allocator.reallocate(blocks[blocks.size() > 1 ? 1 : 0], 512);
+  for (void *block : blocks) {
+    allocator.deallocate(block);
+  }
+  allocator.deallocate(poolList);
+}
+
+// Tasmota- bzw. Shelly-artige Nachricht mit 200 bis 950 Bytes, passt in ein Paket
+static std::string makePayload(std::mt19937 &random) {
+  std::string payload = "{\"Time\":\"2024-05-01T12:" + std::to_string(random() % 60) + ":00\",\"ENERGY\":{";
+  size_t target = 200 + random() % 700;
+  for (int field = 0; payload.size() < target; field++) {
+    payload += "\"Field" + std::to_string(field) + "\":";
+    if (random() % 3 == 0) {
+      payload += "\"" + std::string(random() % 40, 's') + "\",";
+    } else {
+      payload += std::to_string(random() % 100000) + "." + std::to_string(random() % 10) + ",";
+    }
+  }
+  payload.back() = '}';
+  return payload + "}";
+}
+
+struct RunResult {
+  size_t largestAfterWarmup = 0;
+  size_t smallestLargest = SIZE_MAX;
+};
+
+static RunResult run(bool arena, int messages) {
+  SimHeap heap(HEAP_SIZE);
+  SimHeapAllocator heapAllocator(heap);
+  std::mt19937 random(42);
+  LongLived others{heap, random};
+  IngestQueue queue;
+  RunResult result;
+  int arenaNotEmpty = 0;
+
+  for (int i = 0; i < messages; i++) {
+    std::string payload = makePayload(random);
+    CHECK(queue.push(i % 16, INGEST_NORMAL, false, (const uint8_t *)payload.data(), payload.size()));
+
+    uint16_t topic;
+    const char *data;
+    size_t length;
+    if (!queue.pop(topic, data, length)) {
+      CHECK(!"Nachricht fehlt");
+      continue;
+    }
+    parseDocument(arena ? (ArduinoJson::Allocator &)jsonArena : heapAllocator, data, length, others);
+    arenaNotEmpty += jsonArena.used() != 0;
+
+    size_t largest = heap.largestFree();
+    if (i == messages / 100) {
+      result.largestAfterWarmup = largest;
+    }
+    if (i > messages / 100) {
+      result.smallestLargest = std::min(result.smallestLargest, largest);
+    }
+  }
+  CHECK(arenaNotEmpty == 0);
+  return result;
+}
+
+static void testArenaBlocks() {
+  // Oberster Block wächst an Ort und Stelle, leerer Puffer beginnt von vorn
+  void *first = jsonArena.allocate(40);
+  void *second = jsonArena.allocate(31);
+  CHECK(jsonArena.reallocate(second, 200) == second);
+  void *moved = jsonArena.reallocate(first, 400);
+  CHECK(moved != first);
+  jsonArena.deallocate(second);
+  CHECK(jsonArena.used() > 0);
+  jsonArena.deallocate(moved);
+
+  // Zu groß für den Puffer: Heap
+  uint32_t fallbacks = jsonArena.heapFallbacks();
+  void *large = jsonArena.allocate(JSON_ARENA_SIZE);
+  CHECK(large && jsonArena.heapFallbacks() == fallbacks + 1);
+  jsonArena.deallocate(large);
+  CHECK(jsonArena.used() == 0);
+}
+
+int main(int argc, char **argv) {
+  testArenaBlocks();
+
+  int messages = argc > 1 ? atoi(argv[1]) : 100000;
+  uint32_t fallbacks = jsonArena.heapFallbacks();
+  RunResult heap = run(false, messages);
+  RunResult arena = run(true, messages);
+  printf("%d Nachrichten, größter freier Block nach dem Einlaufen / Minimum:\n", messages);
+  printf("  Heap:  %zu / %zu Bytes\n", heap.largestAfterWarmup, heap.smallestLargest);
+  printf("  Arena: %zu / %zu Bytes\n", arena.largestAfterWarmup, arena.smallestLargest);
+
+  // Auf dem Heap bleiben nur die 64 langlebigen Blöcke (je höchstens 64 Bytes)
+  CHECK(jsonArena.heapFallbacks() == fallbacks);
+  CHECK(arena.smallestLargest >= HEAP_SIZE - 64 * 64 * 2);
+  CHECK(arena.smallestLargest > heap.smallestLargest);
+  return TEST_RESULT();
+}
@@ -0,0 +1,160 @@
+/**
+ * JsonStreamParserTest.cpp - Stückweise Eingabe des Stream-Parsers
+ *
+ * MqttClient reicht große Nachrichten in Stücken beliebiger Länge weiter.
+ * Jedes Dokument wird deshalb an jeder Stelle geteilt und Byte für Byte
+ * eingespeist; Felder und Ergebnis müssen der Eingabe am Stück entsprechen.
+ */
+
+#include "test.h"
+#include "JsonStreamParser.h"
+#include <vector>
+#include <string>
+
+struct ParseResult {
+  std::vector<std::string> fields;   // "pfad=wert" in Meldereihenfolge
+  bool complete = false;
+  bool failed = false;
+
+  bool operator==(const ParseResult &other) const {
+    return fields == other.fields && complete == other.complete && failed == other.failed;
+  }
+};
+
+// Dokument in Stücken der angegebenen Längen einspeisen, Rest am Stück
+static ParseResult parse(const std::string &json, const std::vector<size_t> &chunks) {
+  static JsonStreamParser parser;
+  ParseResult result;
+  parser.begin([&result](const char *path, const char *value) {
+    result.fields.push_back(std::string(path) + "=" + value);
+  });
+
+  size_t offset = 0;
+  for (size_t length : chunks) {
+    length = std::min(length, json.size() - offset);
+    parser.feed((const uint8_t *)json.data() + offset, length);
+    offset += length;
+  }
+  parser.feed((const uint8_t *)json.data() + offset, json.size() - offset);
+
+  result.complete = parser.end();
+  result.failed = parser.failed();
+  return result;
+}
+
+static ParseResult parseWhole(const std::string &json) {
+  return parse(json, {});
+}
+
+// Jede Teilung in zwei Stücke und die Eingabe Byte für Byte
+static void checkSplits(const std::string &json) {
+  ParseResult whole = parseWhole(json);
+  int mismatches = 0;
+  for (size_t split = 0; split <= json.size(); split++) {
+    if (!(parse(json, {split}) == whole)) {
+      mismatches++;
+    }
+  }
+  CHECK(mismatches == 0);
+  CHECK(parse(json, std::vector<size_t>(json.size(), 1)) == whole);
+
+  // Drei Stücke über alle Teilungen der kurzen Dokumente
+  if (json.size() <= 120) {
+    for (size_t first = 0; first <= json.size(); first++) {
+      for (size_t second = 0; first + second <= json.size(); second++) {
+        if (!(parse(json, {first, second}) == whole)) {
+          mismatches++;
+        }
+      }
+    }
+    CHECK(mismatches == 0);
+  }
+}
+
+static bool hasField(const ParseResult &result, const std::string &field) {
+  return std::find(result.fields.begin(), result.fields.end(), field) != result.fields.end();
+}
+
+static void testTasmota() {
+  std::string json =
+    "{\"Time\":\"2024-05-01T12:00:00\",\"ENERGY\":{\"TotalStartTime\":\"2023-01-01T00:00:00\","
+    "\"Total\":1234.567,\"Yesterday\":4.2,\"Today\":1.25,\"Power\":-321,\"ApparentPower\":[340, 12],"
+    "\"Factor\":0.94,\"Voltage\":231,\"Current\":1.39}}";
+  ParseResult result = parseWhole(json);
+  CHECK(result.complete);
+  CHECK(hasField(result, "ENERGY.Power=-321"));
+  CHECK(hasField(result, "ENERGY.Today=1.25"));
+  CHECK(hasField(result, "ENERGY.ApparentPower.1=12"));
+  CHECK(hasField(result, "Time=2024-05-01T12:00:00"));
+  CHECK(result.fields.size() == 11);
+  checkSplits(json);
+}
+
+static void testShelly() {
+  std::string json =
+    "{\"id\":0, \"source\":\"timer\", \"output\":true, \"apower\":812.4, \"voltage\":229.8,\n"
+    " \"aenergy\":{\"total\":5123.45,\"by_minute\":[13.5,14.0,13.9],\"minute_ts\":1714564800},\n"
+    " \"temperature\":{\"tC\":41.2, \"tF\":106.2}, \"name\":null, \"errors\":[], \"flags\":{}}";
+  ParseResult result = parseWhole(json);
+  CHECK(result.complete);
+  CHECK(hasField(result, "output=true"));
+  CHECK(hasField(result, "aenergy.by_minute.2=13.9"));
+  CHECK(hasField(result, "temperature.tC=41.2"));
+  CHECK(hasField(result, "name=null"));
+  checkSplits(json);
+}
+
+static void testStrings() {
+  // Escapes, Unicode und Trennzeichen innerhalb von Zeichenketten
+  std::string json = "{\"a\\\"b\":\"x\\n\\\"y\\\"\",\"u\":\"\\u00e4rger\",\"s\":\"{[,:]}\",\"e\":\"\"}";
+  ParseResult result = parseWhole(json);
+  CHECK(result.complete);
+  CHECK(hasField(result, "a\"b=x\n\"y\""));
+  CHECK(hasField(result, "u=?rger"));
+  CHECK(hasField(result, "s={[,:]}"));
+  CHECK(hasField(result, "e="));
+  checkSplits(json);
+}
+
+static void testLimits() {
+  // Zu lange Werte werden gekürzt, zu lange Pfade und zu tiefe Ebenen übersprungen
+  std::string longValue(100, 'v');
+  std::string longKey(JSON_STREAM_MAX_PATH + 10, 'k');
+  std::string deep = "1";
+  for (int i = 0; i < JSON_STREAM_MAX_DEPTH + 2; i++) {
+    deep = "{\"d\":" + deep + "}";
+  }
+  std::string json = "{\"long\":\"" + longValue + "\",\"" + longKey + "\":1,\"deep\":" + deep + ",\"last\":7}";
+  ParseResult result = parseWhole(json);
+  CHECK(result.complete);
+  CHECK(hasField(result, "long=" + longValue.substr(0, JSON_STREAM_MAX_TOKEN - 1)));
+  CHECK(hasField(result, "last=7"));
+  CHECK(result.fields.size() == 2);
+  checkSplits(json);
+}
+
+static void testScalarsAndErrors() {
+  // Zahl als ganzes Dokument endet erst mit end()
+  ParseResult number = parseWhole("  42.5 ");
+  CHECK(number.complete);
+  CHECK(number.fields.size() == 1 && number.fields[0] == "=42.5");
+  checkSplits("42.5");
+  checkSplits("[1,[2,3],{\"x\":[]}]");
+
+  // Fehler und unvollständige Dokumente unabhängig von der Teilung
+  const char *invalid[] = {"{\"a\":1]", "{\"a\" 1}", "[1,2", "{\"a\":1} x", "{\"a\":\"offen"};
+  for (const char *json : invalid) {
+    ParseResult result = parseWhole(json);
+    CHECK(!result.complete);
+    checkSplits(json);
+  }
+}
+
+int main() {
+  testTasmota();
+  testShelly();
+  testStrings();
+  testLimits();
+  testScalarsAndErrors();
+  return TEST_RESULT();
+}
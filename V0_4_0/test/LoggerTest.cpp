@@ -0,0 +1,235 @@
+/**
+ * LoggerTest.cpp - Inhalt des Ringpuffers, auch bei mehreren Tasks
+ *
+ * Tasks sind auf dem Host Threads. Worker führt Aufrufe in einem eigenen,
+ * dauerhaft laufenden Thread aus, damit sich DEBUG_PRINT-Bruchstücke
+ * mehrerer Tasks gezielt verschränken lassen; der Lasttest lässt danach
+ * mehrere Threads frei gegeneinander schreiben.
+ */
+
+#include "test.h"
+#include "Logger.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Eigene Task, die Aufrufe nacheinander ausführt; run() wartet auf das Ende
+class Worker {
+private:
+  std::mutex mutex;
+  std::condition_variable signal;
+  std::function<void()> job;
+  bool stop = false;
+  std::thread thread;
+
+public:
+  Worker() : thread([this] {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      signal.wait(lock, [this] { return job || stop; });
+      if (!job) {
+        return;
+      }
+      job();
+      job = nullptr;
+      signal.notify_all();
+    }
+  }) {}
+
+  ~Worker() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    signal.notify_all();
+    thread.join();
+  }
+
+  void run(std::function<void()> call) {
+    std::unique_lock<std::mutex> lock(mutex);
+    job = call;
+    signal.notify_all();
+    signal.wait(lock, [this] { return !job; });
+  }
+};
+
+// Einträge ab first als Text, "modul|text" bzw. mit "..." bei Kürzung
+static std::vector<std::string> entries(Logger &log, uint32_t first = 0) {
+  std::vector<std::string> result;
+  Logger::Entry entry;
+  for (uint32_t seq = first; seq < log.sequence(); seq++) {
+    if (log.read(seq, entry)) {
+      std::string text = std::string(Logger::moduleName((LogModule)entry.module)) + "|" +
+                         std::string(entry.text, entry.length);
+      result.push_back(entry.truncated ? text + "..." : text);
+    }
+  }
+  return result;
+}
+
+struct Capture : Print {
+  std::string text;
+  size_t write(uint8_t c) override { text += (char)c; return 1; }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    text.append((const char *)buffer, size);
+    return size;
+  }
+  using Print::write;
+};
+
+static void testRing() {
+  static Logger log;
+  log.setLevel(LOG_LEVEL_DEBUG);
+  log.logf(LOG_LEVEL_INFO, LOG_MOD_MQTT, "verbunden nach %d ms", 12);
+  log.at(LOG_LEVEL_INFO, LOG_MOD_DATA).print("PV ");
+  log.at(LOG_LEVEL_INFO, LOG_MOD_DATA).print(1200);
+  log.at(LOG_LEVEL_INFO, LOG_MOD_DATA).println(" W");
+  // Mehrere Zeilen in einem Aufruf behalten Stufe und Modul
+  log.at(LOG_LEVEL_WARN, LOG_MOD_UI).print("a\r\nb\n");
+  log.logf(LOG_LEVEL_ERROR, LOG_MOD_CONFIG, "%s", std::string(200, 'x').c_str());
+  CHECK((entries(log) == std::vector<std::string>{
+    "mqtt|verbunden nach 12 ms", "data|PV 1200 W", "ui|a", "ui|b",
+    "config|" + std::string(LOG_ENTRY_TEXT - 1, 'x') + "..."}));
+
+  // Gefilterte Stufen landen nicht im Ring
+  log.setLevel(LOG_MOD_UI, LOG_LEVEL_WARN);
+  uint32_t before = log.sequence();
+  log.at(LOG_LEVEL_INFO, LOG_MOD_UI).println("versteckt");
+  log.logf(LOG_LEVEL_DEBUG, LOG_MOD_UI, "auch versteckt");
+  log.at(LOG_LEVEL_WARN, LOG_MOD_UI).println("sichtbar");
+  CHECK((entries(log, before) == std::vector<std::string>{"ui|sichtbar"}));
+  CHECK(log.getFiltered() == 2);
+
+  // Voller Ring: die letzten LOG_ENTRIES bleiben lesbar, ältere gelten als verworfen
+  Capture out;
+  log.drain(out, 100);
+  for (int i = 0; i < LOG_ENTRIES + 36; i++) {
+    log.logf(LOG_LEVEL_INFO, LOG_MOD_MAIN, "%d", i);
+  }
+  std::vector<std::string> ring = entries(log, log.sequence() - LOG_ENTRIES - 1);
+  CHECK(ring.size() == LOG_ENTRIES);
+  CHECK(ring.front() == "main|36" && ring.back() == "main|" + std::to_string(LOG_ENTRIES + 35));
+
+  out.text.clear();
+  CHECK(log.drain(out, 1) == 1);
+  CHECK(out.text.find("[Log] 36 Einträge verworfen") != std::string::npos);
+  CHECK(out.text.find("main   36\r\n") != std::string::npos);
+  CHECK(log.getDropped() == 36);
+}
+
+static void testInterleavedTasks() {
+  static Logger log;
+  Worker first, second;
+
+  // Bruchstücke zweier Tasks abwechselnd: jede Zeile bleibt zusammen
+  first.run([] { log.at(LOG_LEVEL_INFO, LOG_MOD_MQTT).print("Topic "); });
+  second.run([] { log.at(LOG_LEVEL_INFO, LOG_MOD_UI).print("Seite "); });
+  first.run([] { log.at(LOG_LEVEL_INFO, LOG_MOD_MQTT).print("solar/pv"); });
+  second.run([] { log.at(LOG_LEVEL_INFO, LOG_MOD_UI).println(3); });
+  log.logf(LOG_LEVEL_INFO, LOG_MOD_MAIN, "dazwischen");
+  first.run([] { log.at(LOG_LEVEL_INFO, LOG_MOD_MQTT).println(" abonniert"); });
+  CHECK((entries(log) == std::vector<std::string>{"ui|Seite 3", "main|dazwischen", "mqtt|Topic solar/pv abonniert"}));
+
+  // Mehr offene Zeilen als Plätze: die älteste wird gekürzt abgeschlossen
+  Worker workers[LOG_OPEN_LINES + 1];
+  uint32_t before = log.sequence();
+  for (int i = 0; i <= LOG_OPEN_LINES; i++) {
+    workers[i].run([i] { log.at(LOG_LEVEL_INFO, LOG_MOD_DATA).print("Task " + String(i)); });
+  }
+  CHECK((entries(log, before) == std::vector<std::string>{"data|Task 0..."}));
+  for (int i = 1; i <= LOG_OPEN_LINES; i++) {
+    workers[i].run([] { log.at(LOG_LEVEL_INFO, LOG_MOD_DATA).println(" fertig"); });
+  }
+  std::vector<std::string> done = entries(log, before + 1);
+  CHECK(done.size() == LOG_OPEN_LINES);
+  for (int i = 1; i <= LOG_OPEN_LINES && i <= (int)done.size(); i++) {
+    CHECK(done[i - 1] == "data|Task " + std::to_string(i) + " fertig");
+  }
+}
+
+static void testConcurrentTasks() {
+  static Logger log;
+  const int tasks = LOG_OPEN_LINES;
+  const int linesPerTask = 20000;
+  std::vector<std::thread> threads;
+  std::atomic<bool> running(true);
+
+  for (int task = 0; task < tasks; task++) {
+    threads.emplace_back([task] {
+      for (int i = 0; i < linesPerTask; i++) {
+        Print &out = log.at(LOG_LEVEL_INFO, (LogModule)task);
+        // Nach jedem Bruchstück abgeben, auch auf einem einzelnen Kern
+        out.print("T");
+        std::this_thread::yield();
+        out.print(task);
+        std::this_thread::yield();
+        out.print(" #");
+        out.print(i);
+        std::this_thread::yield();
+        out.println(" ende");
+      }
+    });
+  }
+
+  // Ausgabe läuft nebenher wie die Log-Task; jede Zeile muss vollständig
+  // von genau einer Task stammen, in deren Reihenfolge
+  struct Checker : Print {
+    std::string line;
+    int last[LOG_MODULES];
+    int bad = 0;
+    int lines = 0;
+    Checker() { std::fill(last, last + LOG_MODULES, -1); }
+    size_t write(uint8_t c) override {
+      if (c != '\n') {
+        line += (char)c;
+        return 1;
+      }
+      // Meldung über verworfene Einträge, keine Zeile einer Task
+      if (line.compare(0, 6, "[Log] ") == 0) {
+        line.clear();
+        return 1;
+      }
+      int task, number;
+      char end[8] = "";
+      const char *text = line.c_str() + std::min(line.size(), (size_t)22);
+      if (sscanf(text, "T%d #%d %7s", &task, &number, end) != 3 || strcmp(end, "ende") != 0 ||
+          task < 0 || task >= LOG_MODULES || number <= last[task] ||
+          line.compare(15, strlen(Logger::moduleName((LogModule)task)), Logger::moduleName((LogModule)task)) != 0) {
+        bad++;
+      } else {
+        last[task] = number;
+      }
+      lines++;
+      line.clear();
+      return 1;
+    }
+    using Print::write;
+  } checker;
+
+  std::thread drainer([&] {
+    while (running) {
+      log.drain(checker, 8);
+      std::this_thread::yield();
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  running = false;
+  drainer.join();
+  log.drain(checker, LOG_ENTRIES);
+
+  CHECK(log.sequence() == (uint32_t)(tasks * linesPerTask));
+  CHECK(checker.bad == 0);
+  CHECK(checker.lines + log.getDropped() == (uint32_t)(tasks * linesPerTask));
+}
+
+int main() {
+  testRing();
+  testInterleavedTasks();
+  testConcurrentTasks();
+  return TEST_RESULT();
+}
@@ -0,0 +1,63 @@
+/**
+ * MemorySoakTest.cpp - Dauertest "memory soak" auf dem Rechner
+ *
+ * Lädt die Standard-Topics, verbindet sie wie V0_4_0.ino mit dem
+ * DataManager und lässt MemoryMonitor die künstlichen Nachrichten über
+ * MqttManager::handleCallback() einspielen. Nach einem Tag zum Einschwingen
+ * dürfen belegte Blöcke und Bytes über die weiteren Tage nicht wachsen.
+ *
+ * Gezählt wird über operator new/delete (stubs/host.cpp): String ist auf
+ * dem Host ein std::string, die Zahlen entsprechen also nicht genau denen
+ * auf dem ESP32, und die Zerstückelung wird nicht nachgebildet. Die Anzeige
+ * (onDataUpdate) ist nur ein Zähler.
+ */
+
+#include "test.h"
+#include "MemoryMonitor.h"
+#include "MqttManager.h"
+#include "DataManager.h"
+
+static uint32_t messages = 0;
+static uint32_t dataUpdates = 0;
+
+static void runSoak(uint16_t days) {
+  CHECK(memoryMonitor.startSoak(days));
+  while (memoryMonitor.isSoaking()) {
+    // Wie loop(): Dauertest, dann die Eingangswarteschlange abarbeiten
+    memoryMonitor.update();
+    mqttManager.drainIngest();
+    hostAdvance(10);
+  }
+}
+
+int main(int argc, char **argv) {
+  int days = argc > 1 ? atoi(argv[1]) : 30;
+  CHECK(mqttManager.loadDefaultTopics());
+  mqttManager.onTopicUpdate = [](const MqttTopic &topic) {
+    messages++;
+    return dataManager.applyTopic(topic);
+  };
+  mqttManager.onDataUpdate = [] { dataUpdates++; };
+
+  // Erster Tag: Werte, Statistik und Puffer werden zum ersten Mal angelegt
+  runSoak(1);
+  long blocks = hostHeapBlocks;
+  long bytes = hostHeapBytes;
+  unsigned long allocations = hostHeapAllocations;
+  uint32_t firstDay = messages;
+  memoryMonitor.resetStats();
+
+  runSoak(days - 1);
+  uint32_t soakMessages = messages - firstDay;
+  double perMessage = (double)(hostHeapAllocations - allocations) / soakMessages;
+  printf("%d Tage, %lu Nachrichten nach dem ersten Tag\n", days, (unsigned long)soakMessages);
+  printf("Belegte Blöcke %ld -> %ld, Bytes %ld -> %ld, new() je Nachricht %.3f\n",
+         blocks, hostHeapBlocks.load(), bytes, hostHeapBytes.load(), perMessage);
+  memoryMonitor.printStatus(Serial);
+
+  CHECK(soakMessages == firstDay * (uint32_t)(days - 1));
+  CHECK(dataUpdates > 0);
+  CHECK(hostHeapBlocks <= blocks);
+  CHECK(hostHeapBytes <= bytes);
+  return TEST_RESULT();
+}
@@ -0,0 +1,227 @@
+/**
+ * PublishQueueTest.cpp - Zusammenfassen und Bestätigen von Schaltbefehlen
+ *
+ * PublishQueue.cpp wird unverändert übersetzt; die wenigen Funktionen des
+ * MqttManagers, die es aufruft, sind hier durch einen Broker-Ersatz
+ * definiert. update() übernimmt wie in loop() vor publishQueue.update() den
+ * Verbindungszustand und liefert PUBACKs über den Rückruf aus begin().
+ */
+
+#include "test.h"
+#include "PublishQueue.h"
+#include "MqttManager.h"
+#include <vector>
+#include <string>
+
+// Broker-Ersatz, den die Tests steuern
+struct FakeBroker {
+  bool connected = true;
+  bool windowFull = false;             // publish() lehnt ab wie bei vollem In-Flight-Fenster
+  uint16_t nextPacketId = 1;
+  std::vector<std::string> published;  // "topic=payload"
+  std::vector<uint16_t> packetIds;
+  std::vector<uint16_t> acks;          // Beim nächsten update() ausgeliefert
+  MqttTopic echo{"heating_state", "home/heating/state"};
+
+  void ack(uint16_t packetId) { acks.push_back(packetId); }
+  void ackLast() { ack(packetIds.back()); }
+};
+static FakeBroker fakeBroker;
+
+MqttManager mqttManager;
+
+MqttManager::MqttManager() {}
+
+void MqttManager::update() {
+  connected = fakeBroker.connected;
+  for (uint16_t packetId : fakeBroker.acks) {
+    if (mqttClient.onPublishAck) {
+      mqttClient.onPublishAck(packetId);
+    }
+  }
+  fakeBroker.acks.clear();
+}
+
+bool MqttManager::publish(const String &topic, const String &payload, uint8_t qos, bool retain,
+                          uint16_t* packetId) {
+  if (!connected || fakeBroker.windowFull) {
+    return false;
+  }
+  uint16_t id = qos > 0 ? fakeBroker.nextPacketId++ : 0;
+  fakeBroker.published.push_back(std::string(topic.c_str()) + "=" + payload.c_str());
+  fakeBroker.packetIds.push_back(id);
+  if (packetId) {
+    *packetId = id;
+  }
+  return true;
+}
+
+const MqttTopic* MqttManager::findTopic(const char* name) const {
+  return fakeBroker.echo.name == name ? &fakeBroker.echo : nullptr;
+}
+
+// Ein Durchlauf der Hauptschleife
+static void step(unsigned long ms = 10) {
+  hostAdvance(ms);
+  mqttManager.update();
+  publishQueue.update();
+}
+
+static void reset() {
+  publishQueue = PublishQueue();
+  publishQueue.begin();
+  fakeBroker = FakeBroker();
+  step();
+}
+
+static void testCoalesceBeforeSend() {
+  reset();
+  std::vector<CommandState> changes;
+  publishQueue.onStateChange = [&](const String &, CommandState state) { changes.push_back(state); };
+
+  // Mehrfaches Tippen ohne Verbindung: nur der letzte Befehl wird gesendet
+  fakeBroker.connected = false;
+  step();
+  CHECK(publishQueue.enqueue("home/heating/set", "ON", 1));
+  CHECK(publishQueue.enqueue("home/heating/set", "OFF", 1));
+  CHECK(publishQueue.enqueue("home/heating/set", "OFF", 1));
+  step();
+  CHECK(fakeBroker.published.empty());
+  CHECK(publishQueue.getState("home/heating/set") == COMMAND_QUEUED);
+
+  fakeBroker.connected = true;
+  step();
+  CHECK(fakeBroker.published.size() == 1 && fakeBroker.published[0] == "home/heating/set=OFF");
+  CHECK(publishQueue.getState("home/heating/set") == COMMAND_SENT);
+
+  fakeBroker.ackLast();
+  step();
+  String payload;
+  CHECK(publishQueue.getState("home/heating/set", &payload) == COMMAND_CONFIRMED);
+  CHECK(payload == "OFF");
+  // Der doppelte OFF-Befehl löst keinen Zustandswechsel aus
+  CHECK((changes == std::vector<CommandState>{COMMAND_QUEUED, COMMAND_QUEUED, COMMAND_SENT, COMMAND_CONFIRMED}));
+  publishQueue.onStateChange = nullptr;
+}
+
+static void testCoalesceAfterSend() {
+  reset();
+  CHECK(publishQueue.enqueue("home/heating/set", "ON", 1));
+  step();
+  CHECK(fakeBroker.published.size() == 1);
+  uint16_t first = fakeBroker.packetIds.back();
+
+  // Gleicher Befehl während der Bestätigung: nicht erneut senden
+  CHECK(publishQueue.enqueue("home/heating/set", "ON", 1));
+  step();
+  CHECK(fakeBroker.published.size() == 1);
+
+  // Neuer Befehl ersetzt den gesendeten, das verspätete PUBACK zählt nicht
+  CHECK(publishQueue.enqueue("home/heating/set", "OFF", 1));
+  step();
+  CHECK(fakeBroker.published.size() == 2 && fakeBroker.published[1] == "home/heating/set=OFF");
+  fakeBroker.ack(first);
+  step();
+  CHECK(publishQueue.getState("home/heating/set") == COMMAND_SENT);
+
+  fakeBroker.ackLast();
+  step();
+  CHECK(publishQueue.getState("home/heating/set") == COMMAND_CONFIRMED);
+}
+
+static void testAckTimeout() {
+  reset();
+  CHECK(publishQueue.enqueue("home/pool/set", "ON", 1));
+  step();
+  CHECK(publishQueue.getState("home/pool/set") == COMMAND_SENT);
+
+  // Bis zur Zeitgrenze (ab dem Einreihen) bleibt der Befehl offen
+  step(PUBLISH_CONFIRM_TIMEOUT - 20);
+  CHECK(publishQueue.getState("home/pool/set") == COMMAND_SENT);
+  step(20);
+  CHECK(publishQueue.getState("home/pool/set") == COMMAND_FAILED);
+
+  // Ein PUBACK nach der Zeitgrenze ändert nichts mehr
+  fakeBroker.ackLast();
+  step();
+  CHECK(publishQueue.getState("home/pool/set") == COMMAND_FAILED);
+
+  // Volles In-Flight-Fenster: wartet, bis es frei wird
+  CHECK(publishQueue.enqueue("home/pool/set", "OFF", 1));
+  fakeBroker.windowFull = true;
+  step(PUBLISH_CONFIRM_TIMEOUT / 2);
+  CHECK(publishQueue.getState("home/pool/set") == COMMAND_QUEUED);
+  fakeBroker.windowFull = false;
+  step();
+  CHECK(publishQueue.getState("home/pool/set") == COMMAND_SENT);
+  fakeBroker.ackLast();
+  step();
+  CHECK(publishQueue.getState("home/pool/set") == COMMAND_CONFIRMED);
+
+  // Bleibt das Fenster voll, schlägt auch das Einreihen fehl
+  CHECK(publishQueue.enqueue("home/pool/set", "ON", 1));
+  fakeBroker.windowFull = true;
+  step(PUBLISH_CONFIRM_TIMEOUT + 10);
+  CHECK(publishQueue.getState("home/pool/set") == COMMAND_FAILED);
+  CHECK(fakeBroker.published.size() == 2);
+}
+
+static void testQos0AndEcho() {
+  reset();
+  // QoS 0 ohne Echo gilt mit der Übergabe als bestätigt
+  CHECK(publishQueue.enqueue("home/light/set", "ON", 0));
+  step();
+  CHECK(publishQueue.getState("home/light/set") == COMMAND_CONFIRMED);
+
+  // Mit Echo zählt erst ein nach dem Senden empfangener, passender Wert
+  fakeBroker.echo.value = "on";
+  fakeBroker.echo.lastUpdate = millis();
+  step();
+  CHECK(publishQueue.enqueue("home/heating/set", "ON", 1, false, "heating_state"));
+  step();
+  fakeBroker.ackLast();
+  step();
+  CHECK(publishQueue.getState("home/heating/set") == COMMAND_SENT);
+
+  fakeBroker.echo.value = "off";
+  fakeBroker.echo.lastUpdate = millis();
+  step();
+  CHECK(publishQueue.getState("home/heating/set") == COMMAND_SENT);
+
+  fakeBroker.echo.value = "on";
+  fakeBroker.echo.lastUpdate = millis();
+  step();
+  CHECK(publishQueue.getState("home/heating/set") == COMMAND_CONFIRMED);
+}
+
+static void testFullQueue() {
+  reset();
+  fakeBroker.connected = false;
+  step();
+  for (int i = 0; i < PUBLISH_QUEUE_SIZE; i++) {
+    CHECK(publishQueue.enqueue("home/switch/" + String(i), "ON", 1));
+  }
+  // Alle Plätze offen: der nächste Befehl wird abgewiesen
+  CHECK(!publishQueue.enqueue("home/switch/extra", "ON", 1));
+
+  fakeBroker.connected = true;
+  step();
+  CHECK(fakeBroker.published.size() == PUBLISH_QUEUE_SIZE);
+  fakeBroker.ack(fakeBroker.packetIds[3]);
+  step();
+  CHECK(publishQueue.getState("home/switch/3") == COMMAND_CONFIRMED);
+
+  // Der abgeschlossene Befehl macht seinen Platz frei
+  CHECK(publishQueue.enqueue("home/switch/extra", "ON", 1));
+  CHECK(publishQueue.getState("home/switch/3") == COMMAND_IDLE);
+  CHECK(!publishQueue.enqueue("home/switch/other", "ON", 1));
+}
+
+int main() {
+  testCoalesceBeforeSend();
+  testCoalesceAfterSend();
+  testAckTimeout();
+  testQos0AndEcho();
+  testFullQueue();
+  return TEST_RESULT();
+}
@@ -0,0 +1,207 @@
+/**
+ * TouchFilterTest.cpp - Zittern und Ausreißer mit und ohne TouchFilter
+ *
+ * Spielt Spuren von Touch-Abtastungen ab, einmal durch TouchFilter und
+ * einmal durch das Verfahren der Bibliothek XPT2046_Touchscreen (drei
+ * X/Y-Messungen, Mittel des nächstliegenden Paars, ohne Druck je Messung).
+ * Die Spuren sind nachgebildet, nicht an einem Panel aufgezeichnet: aus
+ * festem Startwert erzeugtes Rauschen (Sigma 10 Rohwerte), 5 % Ausreißer,
+ * 1 % Werte 8191 und 5 % Messungen mit schwachem Druck, die zur Mitte hin
+ * verschoben sind. Die Grenzen gelten für dieses Modell.
+ */
+
+#include "test.h"
+#include "TouchFilter.h"
+#include <random>
+#include <vector>
+#include <cmath>
+
+// Eine Abtastung: TOUCH_OVERSAMPLING Messungen am selben wahren Punkt
+struct Reading {
+  int16_t trueX;
+  int16_t trueY;
+  TouchSample samples[TOUCH_OVERSAMPLING];
+};
+
+class Panel {
+private:
+  std::mt19937 random;
+  std::normal_distribution<float> noise{0, 10};
+
+  int16_t clamp(float value) { return (int16_t)std::max(0.0f, std::min(4095.0f, roundf(value))); }
+
+public:
+  Panel(uint32_t seed) : random(seed) {}
+
+  TouchSample measure(int16_t x, int16_t y) {
+    TouchSample sample = {clamp(x + noise(random)), clamp(y + noise(random)), 1200};
+    uint32_t kind = random() % 100;
+    if (kind < 5) {
+      // Ausreißer: 300 bis 800 Rohwerte daneben
+      int sign = random() % 2 ? 1 : -1;
+      sample.x = clamp(sample.x + sign * (300 + random() % 500));
+      sample.y = clamp(sample.y - sign * (300 + random() % 500));
+    } else if (kind < 6) {
+      // Offener Bus
+      (random() % 2 ? sample.x : sample.y) = 8191;
+    } else if (kind < 11) {
+      // Schwacher Druck: Punkt wandert zur Mitte
+      sample.z = 100 + random() % 250;
+      sample.x = clamp(sample.x + (2048 - sample.x) / 8);
+      sample.y = clamp(sample.y + (2048 - sample.y) / 8);
+    }
+    return sample;
+  }
+
+  Reading read(int16_t x, int16_t y) {
+    Reading reading;
+    reading.trueX = x;
+    reading.trueY = y;
+    for (auto &sample : reading.samples) {
+      sample = measure(x, y);
+    }
+    return reading;
+  }
+};
+
+// Verfahren der Bibliothek: Mittel der zwei nächstliegenden von drei Werten
+static int16_t bestTwo(int16_t a, int16_t b, int16_t c) {
+  int ab = abs(a - b);
+  int ac = abs(a - c);
+  int bc = abs(b - c);
+  if (ab <= ac && ab <= bc) {
+    return (a + b) >> 1;
+  }
+  if (ac <= ab && ac <= bc) {
+    return (a + c) >> 1;
+  }
+  return (b + c) >> 1;
+}
+
+static void libraryPoint(const Reading &reading, int16_t &x, int16_t &y) {
+  const TouchSample *s = reading.samples;
+  x = bestTwo(s[0].x, s[1].x, s[2].x);
+  y = bestTwo(s[0].y, s[1].y, s[2].y);
+}
+
+// Abweichungen über eine Spur; abgelehnte Abtastungen behalten den letzten Punkt
+struct Result {
+  double jitter = 0;           // Standardabweichung um den Mittelwert je Ruhelage
+  int maxError = 0;            // Größter Abstand zum wahren Punkt (je Achse)
+  int rejected = 0;
+};
+
+template <typename Filter>
+static Result replay(const std::vector<std::vector<Reading>> &traces, Filter filter) {
+  Result result;
+  double squares = 0;
+  int count = 0;
+  for (const auto &trace : traces) {
+    std::vector<std::pair<int16_t, int16_t>> points;
+    int16_t x = trace[0].trueX;
+    int16_t y = trace[0].trueY;
+    for (const Reading &reading : trace) {
+      if (!filter(reading, x, y)) {
+        result.rejected++;
+      }
+      points.push_back({x, y});
+      result.maxError = std::max(result.maxError, std::max(abs(x - reading.trueX), abs(y - reading.trueY)));
+    }
+    double meanX = 0;
+    double meanY = 0;
+    for (const auto &point : points) {
+      meanX += point.first;
+      meanY += point.second;
+    }
+    meanX /= points.size();
+    meanY /= points.size();
+    for (const auto &point : points) {
+      squares += (point.first - meanX) * (point.first - meanX) + (point.second - meanY) * (point.second - meanY);
+      count++;
+    }
+  }
+  result.jitter = sqrt(squares / count / 2);
+  return result;
+}
+
+static void testCombine() {
+  int16_t x = 0;
+  int16_t y = 0;
+  TouchSample samples[TOUCH_FILTER_MAX_SAMPLES + 4];
+
+  // Gruppe um 1000/2000, zwei Ausreißer und eine schwache Messung fallen weg
+  const TouchSample group[8] = {
+    {1000, 2000, 900}, {1010, 1990, 900}, {990, 2004, 900}, {1004, 1996, 900},
+    {1500, 2600, 900}, {400, 2000, 900}, {1002, 2001, 200}, {1001, 8191, 900}};
+  CHECK(TouchFilter::combine(group, 8, x, y));
+  CHECK(x == 1001 && y == 1998);
+
+  // Weniger als die Hälfte gültig bzw. übereinstimmend: kein Punkt
+  const TouchSample weak[4] = {{1000, 2000, 900}, {1000, 2000, 100}, {1000, 2000, 100}, {1000, 2000, 100}};
+  CHECK(!TouchFilter::combine(weak, 4, x, y));
+  const TouchSample spread[4] = {{100, 100, 900}, {1000, 1000, 900}, {2000, 2000, 900}, {3000, 3000, 900}};
+  CHECK(!TouchFilter::combine(spread, 4, x, y));
+  CHECK(!TouchFilter::combine(spread, 0, x, y));
+
+  // Mehr als TOUCH_FILTER_MAX_SAMPLES: der Rest wird nicht gelesen
+  for (auto &sample : samples) {
+    sample = {3000, 100, 900};
+  }
+  for (int i = TOUCH_FILTER_MAX_SAMPLES; i < TOUCH_FILTER_MAX_SAMPLES + 4; i++) {
+    samples[i] = {0, 0, 900};
+  }
+  CHECK(TouchFilter::combine(samples, TOUCH_FILTER_MAX_SAMPLES + 4, x, y));
+  CHECK(x == 3000 && y == 100);
+}
+
+static void testRestingFinger() {
+  Panel panel(42);
+  std::vector<std::vector<Reading>> traces;
+  const int16_t positions[][2] = {{300, 300}, {3800, 300}, {2048, 2048}, {300, 3800}, {3800, 3800}};
+  for (const auto &position : positions) {
+    std::vector<Reading> trace;
+    for (int i = 0; i < 1000; i++) {
+      trace.push_back(panel.read(position[0], position[1]));
+    }
+    traces.push_back(trace);
+  }
+
+  Result library = replay(traces, [](const Reading &reading, int16_t &x, int16_t &y) {
+    libraryPoint(reading, x, y);
+    return true;
+  });
+  Result filtered = replay(traces, [](const Reading &reading, int16_t &x, int16_t &y) {
+    return TouchFilter::combine(reading.samples, TOUCH_OVERSAMPLING, x, y);
+  });
+  printf("Ruhender Finger, Rohwerte: Bibliothek Zittern %.1f, größter Fehler %d; "
+         "TouchFilter Zittern %.1f, größter Fehler %d, %d von 5000 abgelehnt\n",
+         library.jitter, library.maxError, filtered.jitter, filtered.maxError, filtered.rejected);
+
+  CHECK(filtered.jitter * 4 < library.jitter);
+  CHECK(filtered.jitter < 6);
+  CHECK(filtered.maxError <= TOUCH_FILTER_TOLERANCE);
+  CHECK(library.maxError > 1000);
+  CHECK(filtered.rejected < 50);
+}
+
+static void testDrag() {
+  // Gerade über das Panel, 4 Rohwerte je Abtastung (etwa 30 px/s bei 10 ms)
+  Panel panel(7);
+  std::vector<std::vector<Reading>> traces(1);
+  for (int i = 0; i < 800; i++) {
+    traces[0].push_back(panel.read(400 + i * 4, 3600 - i * 4));
+  }
+  Result filtered = replay(traces, [](const Reading &reading, int16_t &x, int16_t &y) {
+    return TouchFilter::combine(reading.samples, TOUCH_OVERSAMPLING, x, y);
+  });
+  printf("Ziehen: größter Fehler %d Rohwerte, %d von 800 abgelehnt\n", filtered.maxError, filtered.rejected);
+  // Eine abgelehnte Abtastung hängt um einen Schritt nach
+  CHECK(filtered.maxError <= TOUCH_FILTER_TOLERANCE + 4);
+}
+
+int main() {
+  testCombine();
+  testRestingFinger();
+  testDrag();
+  return TEST_RESULT();
+}
@@ -0,0 +1,229 @@
+/**
+ * Arduino.h - Ersatz des Arduino-Kerns für die Host-Tests
+ *
+ * Enthält nur, was die getesteten Module brauchen: String, Print, Serial,
+ * eine vom Test gesteuerte Uhr und die FreeRTOS-Sperren als Mutex. Die
+ * Tests laufen ohne ESP32-Toolchain mit einem normalen C++-Compiler.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <atomic>
+
+#define ARDUINO 10800
+#define HEX 16
+#define DEC 10
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define FALLING 2
+#define RISING 3
+#define CHANGE 4
+#define IRAM_ATTR
+#define PROGMEM
+#define F(x) x
+
+using std::min;
+using std::max;
+typedef uint8_t byte;
+typedef bool boolean;
+
+// Simulierte Zeit: die Tests stellen die Uhr mit hostAdvance() vor
+extern std::atomic<uint64_t> hostMicros;
+inline unsigned long micros() { return (unsigned long)hostMicros.load(); }
+inline unsigned long millis() { return (unsigned long)(hostMicros.load() / 1000); }
+inline void hostAdvance(unsigned long ms) { hostMicros += (uint64_t)ms * 1000; }
+void delay(unsigned long ms);
+inline void delayMicroseconds(unsigned int us) { hostMicros += us; }
+inline void yield() {}
+
+long random(long limit);
+long random(long low, long high);
+void randomSeed(unsigned long seed);
+
+template<class T> T constrain(T a, T low, T high) { return a < low ? low : (a > high ? high : a); }
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+inline bool isDigit(int c) { return c >= '0' && c <= '9'; }
+
+class String {
+public:
+  std::string s;
+
+  String(const char* c = "") : s(c ? c : "") {}
+  String(const std::string& c) : s(c) {}
+  explicit String(char c) : s(1, c) {}
+  String(int v, int base = DEC) : s(formatInteger(v, base)) {}
+  String(unsigned int v, int base = DEC) : s(formatInteger(v, base)) {}
+  String(long v, int base = DEC) : s(formatInteger(v, base)) {}
+  String(unsigned long v, int base = DEC) : s(formatInteger(v, base)) {}
+  String(float v, unsigned char decimals = 2) : s(formatDecimal(v, decimals)) {}
+  String(double v, unsigned char decimals = 2) : s(formatDecimal(v, decimals)) {}
+
+  unsigned int length() const { return s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  bool reserve(unsigned int n) { s.reserve(n); return true; }
+  bool isEmpty() const { return s.empty(); }
+  void clear() { s.clear(); }
+
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  String& operator+=(char o) { s += o; return *this; }
+  String& operator+=(int o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned long o) { s += std::to_string(o); return *this; }
+  bool concat(const char* p, unsigned int n) { s.append(p, n); return true; }
+  bool concat(const String& o) { s += o.s; return true; }
+  bool concat(const char* p) { s += p; return true; }
+  bool concat(char c) { s += c; return true; }
+  friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+  friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.s); }
+
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* o) const { return s == o; }
+  bool operator!=(const String& o) const { return s != o.s; }
+  bool operator!=(const char* o) const { return s != o; }
+  bool operator<(const String& o) const { return s < o.s; }
+  bool equals(const String& o) const { return s == o.s; }
+  bool equalsIgnoreCase(const String& o) const { return strcasecmp(s.c_str(), o.s.c_str()) == 0; }
+
+  char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  char& operator[](unsigned int i) { return s[i]; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+  float toFloat() const { return atof(s.c_str()); }
+  long toInt() const { return atol(s.c_str()); }
+
+  int indexOf(char c, unsigned int from = 0) const { return position(s.find(c, from)); }
+  int indexOf(const String& c, unsigned int from = 0) const { return position(s.find(c.s, from)); }
+  int lastIndexOf(char c) const { return position(s.rfind(c)); }
+  String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    return from < to && from < s.size() ? String(s.substr(from, to - from)) : String();
+  }
+  bool startsWith(const String& p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+  bool endsWith(const String& p) const {
+    return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0;
+  }
+  void remove(unsigned int index) { if (index < s.size()) s.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < s.size()) s.erase(index, count); }
+  void trim() {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    size_t end = s.find_last_not_of(" \t\r\n");
+    s = start == std::string::npos ? "" : s.substr(start, end - start + 1);
+  }
+  void toLowerCase() { for (auto& c : s) c = tolower(c); }
+  void getBytes(unsigned char* buffer, unsigned int size) const {
+    if (size == 0) return;
+    size_t n = std::min((size_t)size - 1, s.size());
+    memcpy(buffer, s.data(), n);
+    buffer[n] = 0;
+  }
+
+private:
+  static int position(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  static std::string formatInteger(long long v, int base) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), base == HEX ? "%llx" : "%lld", v);
+    return buffer;
+  }
+  static std::string formatDecimal(double v, unsigned int decimals) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, v);
+    return buffer;
+  }
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) write(buffer[i]);
+    return size;
+  }
+  size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t write(const char* text, size_t size) { return write((const uint8_t*)text, size); }
+  virtual void flush() {}
+
+  size_t print(const String& v) { return write(v.c_str()); }
+  size_t print(const char* v) { return write(v); }
+  size_t print(char v) { return write((uint8_t)v); }
+  size_t print(int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(long long v, int base = DEC) { return print(String((long)v, base)); }
+  size_t print(unsigned long long v, int base = DEC) { return print(String((unsigned long)v, base)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, (unsigned char)decimals)); }
+  size_t println() { return write("\r\n"); }
+  template<class T> size_t println(const T& v) { return print(v) + println(); }
+  template<class T> size_t println(const T& v, int format) { return print(v, format) + println(); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return write((const uint8_t*)buffer, std::min((size_t)std::max(length, 0), sizeof(buffer) - 1));
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long) {}
+};
+
+// Serial schreibt auf stdout, Eingaben gibt es keine
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+  size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  int availableForWrite() { return 128; }
+  operator bool() const { return true; }
+  using Print::write;
+};
+extern HardwareSerial Serial;
+
+// Heap-Bilanz: operator new/delete zählen belegte Blöcke und Bytes; malloc()
+// (nur JsonArena beim Ausweichen) und die Zerstückelung sind nicht erfasst
+#define HOST_HEAP_SIZE (16 * 1024 * 1024)
+extern std::atomic<long> hostHeapBlocks;
+extern std::atomic<long> hostHeapBytes;
+extern std::atomic<unsigned long> hostHeapAllocations;  // Aufrufe von new seit dem Start
+
+class EspClass {
+private:
+  uint32_t minFree = HOST_HEAP_SIZE;
+
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap() { return minFree; }
+  uint32_t getMaxAllocHeap() { return getFreeHeap(); }
+  uint32_t getHeapSize() { return HOST_HEAP_SIZE; }
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint32_t getCycleCount() { return (uint32_t)(hostMicros.load() * 240); }
+  void restart() { exit(1); }
+};
+extern EspClass ESP;
+
+#include "freertos_stub.h"
+#include "IPAddress.h"
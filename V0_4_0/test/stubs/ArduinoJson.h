@@ -0,0 +1,137 @@
+/**
+ * ArduinoJson.h - Platzhalter für die Host-Tests
+ *
+ * Die Bibliothek selbst ist nicht Teil der Host-Tests: Allocator entspricht
+ * der Schnittstelle von ArduinoJson 7, alle übrigen Klassen übersetzen nur
+ * und liefern leere Werte. Parsen schlägt immer mit InvalidInput fehl.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+namespace ArduinoJson {
+class Allocator {
+public:
+  virtual void* allocate(size_t size) = 0;
+  virtual void deallocate(void* ptr) = 0;
+  virtual void* reallocate(void* ptr, size_t newSize) = 0;
+
+protected:
+  ~Allocator() = default;
+};
+}
+
+class JsonVariant {
+public:
+  JsonVariant operator[](const char*) const { return JsonVariant(); }
+  JsonVariant operator[](const String&) const { return JsonVariant(); }
+  JsonVariant operator[](int) const { return JsonVariant(); }
+  JsonVariant operator[](size_t) const { return JsonVariant(); }
+  template<class T> T as() const { return T(); }
+  template<class T> bool is() const { return false; }
+  template<class T> T to() const { return T(); }
+  template<class T> JsonVariant& operator=(const T&) { return *this; }
+  template<class T> operator T() const { return T(); }
+  template<class T> bool set(const T&) { return false; }
+  template<class T> bool add(const T&) { return false; }
+  template<class T> T add() { return T(); }
+  template<class T> bool operator==(const T&) const { return false; }
+  template<class T> T operator|(const T& fallback) const { return fallback; }
+  const char* operator|(const char* fallback) const { return fallback; }
+  bool isNull() const { return true; }
+  size_t size() const { return 0; }
+  bool containsKey(const char*) const { return false; }
+  void remove(const char*) {}
+  void clear() {}
+};
+
+class JsonVariantConst : public JsonVariant {};
+
+struct JsonStringConst {
+  const char* c_str() const { return ""; }
+};
+
+class JsonPair {
+public:
+  const char* key() const { return ""; }
+  JsonVariant value() const { return JsonVariant(); }
+};
+
+class JsonPairConst {
+public:
+  JsonStringConst key() const { return JsonStringConst(); }
+  JsonVariantConst value() const { return JsonVariantConst(); }
+};
+
+class JsonObject : public JsonVariant {
+public:
+  JsonPair* begin() const { return nullptr; }
+  JsonPair* end() const { return nullptr; }
+};
+
+class JsonObjectConst : public JsonVariant {
+public:
+  JsonPairConst* begin() const { return nullptr; }
+  JsonPairConst* end() const { return nullptr; }
+};
+
+class JsonArray : public JsonVariant {
+public:
+  JsonVariant* begin() const { return nullptr; }
+  JsonVariant* end() const { return nullptr; }
+  explicit operator bool() const { return false; }
+  bool operator!() const { return true; }
+};
+
+class JsonArrayConst : public JsonVariant {
+public:
+  JsonVariantConst* begin() const { return nullptr; }
+  JsonVariantConst* end() const { return nullptr; }
+};
+
+class JsonDocument : public JsonVariant {
+public:
+  JsonDocument() {}
+  explicit JsonDocument(ArduinoJson::Allocator*) {}
+  template<class T> JsonDocument& operator=(const T&) { return *this; }
+  bool overflowed() const { return false; }
+  void shrinkToFit() {}
+};
+
+class DeserializationError {
+public:
+  enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+  DeserializationError(Code code = InvalidInput) : value(code) {}
+  explicit operator bool() const { return value != Ok; }
+  const char* c_str() const { return value == Ok ? "Ok" : "InvalidInput"; }
+  Code code() const { return value; }
+  bool operator==(Code code) const { return value == code; }
+  bool operator!=(Code code) const { return value != code; }
+
+private:
+  Code value;
+};
+
+namespace DeserializationOption {
+class Filter {
+public:
+  explicit Filter(JsonVariantConst) {}
+  explicit Filter(const JsonDocument&) {}
+};
+class NestingLimit {
+public:
+  NestingLimit(uint8_t) {}
+};
+}
+
+template<class... Args> DeserializationError deserializeJson(JsonDocument&, Args&&...) {
+  return DeserializationError::InvalidInput;
+}
+template<class... Args> DeserializationError deserializeMsgPack(JsonDocument&, Args&&...) {
+  return DeserializationError::InvalidInput;
+}
+template<class... Args> size_t serializeJson(const JsonVariant&, Args&&...) { return 0; }
+template<class... Args> size_t serializeMsgPack(const JsonVariant&, Args&&...) { return 0; }
+inline size_t measureJson(const JsonVariant&) { return 0; }
+inline size_t measureMsgPack(const JsonVariant&) { return 0; }
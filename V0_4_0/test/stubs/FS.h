@@ -0,0 +1,62 @@
+/**
+ * FS.h - Dateisystem der Host-Tests
+ *
+ * Pfade werden unter hostFsRoot im Dateisystem des Rechners abgelegt. Für
+ * Stromausfall-Tests begrenzt hostFsBudget die Anzahl der noch möglichen
+ * Schreib-Bytes und Dateioperationen (remove, rename): ist es aufgebraucht,
+ * bricht der laufende Schreibaufruf mitten im Puffer ab und jeder weitere
+ * Zugriff schlägt fehl, bis der Test hostFsPowerOn() aufruft.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+extern std::string hostFsRoot;
+extern long hostFsBudget;          // -1: unbegrenzt
+extern bool hostFsDead;
+void hostFsPowerOn();
+
+namespace fs {
+
+enum SeekMode { SeekSet, SeekCur, SeekEnd };
+
+class File : public Stream {
+public:
+  File(FILE* handle = nullptr, const char* path = "") : handle(handle), filePath(path) {}
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t* buffer, size_t size);
+  size_t size() const;
+  bool seek(uint32_t position, SeekMode mode = SeekSet);
+  File openNextFile() { return File(); }  // Verzeichnisse werden nicht aufgelistet
+  void close();
+  operator bool() const { return handle != nullptr; }
+  const char* name() const { return filePath.c_str(); }
+  const char* path() const { return filePath.c_str(); }
+  using Print::write;
+
+private:
+  FILE* handle;
+  std::string filePath;
+};
+
+class FS {
+public:
+  File open(const String& path, const char* mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+  File open(const char* path, const char* mode = "r", bool create = false);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool exists(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool remove(const char* path);
+  bool rename(const String& from, const String& to);
+};
+
+}
+
+using fs::File;
+using fs::FS;
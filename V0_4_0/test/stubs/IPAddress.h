@@ -0,0 +1,20 @@
+/**
+ * IPAddress.h - IPv4-Adresse in Netzwerk-Byte-Reihenfolge wie lwIP
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  IPAddress();
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
+  String toString() const;
+  operator uint32_t() const;
+  uint8_t operator[](int index) const;
+  bool fromString(const char* address);
+
+private:
+  uint32_t value = 0;
+};
@@ -0,0 +1,15 @@
+/**
+ * SPIFFS.h - SPIFFS der Host-Tests, siehe FS.h
+ */
+
+#pragma once
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+public:
+  bool begin(bool formatOnFail = false) { return true; }
+  size_t totalBytes() { return 1408 * 1024; }
+  size_t usedBytes() { return 0; }
+};
+extern SPIFFSFS SPIFFS;
@@ -0,0 +1,31 @@
+/**
+ * WiFi.h - Nur Deklarationen; hostByName() löst nur IP-Adressen auf
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+#define WL_CONNECTED 3
+#define WL_IDLE_STATUS 0
+#define WL_DISCONNECTED 6
+#define WL_CONNECT_FAILED 4
+#define WL_NO_SSID_AVAIL 1
+#define WIFI_STA 1
+typedef int wl_status_t;
+
+class WiFiClass {
+public:
+  int begin(const char* ssid, const char* password);
+  wl_status_t status();
+  IPAddress localIP();
+  String SSID();
+  int RSSI();
+  bool disconnect(bool off = false);
+  bool mode(int mode);
+  int hostByName(const char* host, IPAddress& address);
+  bool setAutoReconnect(bool enable);
+  bool reconnect();
+};
+extern WiFiClass WiFi;
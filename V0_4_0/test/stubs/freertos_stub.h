@@ -0,0 +1,51 @@
+/**
+ * freertos_stub.h - FreeRTOS-Ersatz für die Host-Tests
+ *
+ * Kritische Abschnitte werden zu einem rekursiven Mutex, Tasks zu Threads.
+ * Als Task-Handle dient eine Kennung je Thread.
+ */
+
+#pragma once
+
+#include <mutex>
+
+typedef void* TaskHandle_t;
+typedef void* QueueHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+struct portMUX_TYPE {
+  std::recursive_mutex mutex;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+inline void portENTER_CRITICAL(portMUX_TYPE* mux) { mux->mutex.lock(); }
+inline void portEXIT_CRITICAL(portMUX_TYPE* mux) { mux->mutex.unlock(); }
+inline void portENTER_CRITICAL_ISR(portMUX_TYPE* mux) { mux->mutex.lock(); }
+inline void portEXIT_CRITICAL_ISR(portMUX_TYPE* mux) { mux->mutex.unlock(); }
+
+#define pdMS_TO_TICKS(x) (x)
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffff
+#define tskIDLE_PRIORITY 0
+#define portYIELD_FROM_ISR(x)
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char* name, uint32_t stack,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle, int core);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+inline TickType_t xTaskGetTickCount() { return millis(); }
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
@@ -0,0 +1,253 @@
+/**
+ * host.cpp - Implementierung des Arduino-Ersatzes für die Host-Tests
+ */
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SPIFFS.h>
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <arpa/inet.h>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <unistd.h>
+#include <malloc.h>
+#include <new>
+
+std::atomic<uint64_t> hostMicros(1000000);
+std::atomic<long> hostHeapBlocks(0);
+std::atomic<long> hostHeapBytes(0);
+std::atomic<unsigned long> hostHeapAllocations(0);
+HardwareSerial Serial;
+EspClass ESP;
+SPIFFSFS SPIFFS;
+WiFiClass WiFi;
+
+void* operator new(size_t size) {
+  void* ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  hostHeapBlocks++;
+  hostHeapBytes += malloc_usable_size(ptr);
+  hostHeapAllocations++;
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  if (ptr) {
+    hostHeapBlocks--;
+    hostHeapBytes -= malloc_usable_size(ptr);
+    free(ptr);
+  }
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  operator delete(ptr);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  long used = hostHeapBytes.load();
+  uint32_t free = used < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - used : 0;
+  minFree = std::min(minFree, free);
+  return free;
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t) {
+  memset(info, 0, sizeof(*info));
+  info->total_free_bytes = ESP.getFreeHeap();
+  info->total_allocated_bytes = hostHeapBytes.load();
+  info->largest_free_block = info->total_free_bytes;
+  info->minimum_free_bytes = ESP.getMinFreeHeap();
+  info->allocated_blocks = hostHeapBlocks.load();
+}
+
+void delay(unsigned long ms) {
+  // Andere Threads (Log-Task) sollen in der Zeit laufen können
+  std::this_thread::sleep_for(std::chrono::microseconds(100));
+  hostAdvance(ms);
+}
+
+static std::mt19937 randomEngine(1);
+
+long random(long limit) {
+  return limit > 0 ? randomEngine() % limit : 0;
+}
+
+long random(long low, long high) {
+  return high > low ? low + random(high - low) : low;
+}
+
+void randomSeed(unsigned long seed) {
+  randomEngine.seed(seed);
+}
+
+IPAddress::IPAddress() {}
+
+IPAddress::IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+  uint8_t bytes[4] = {a, b, c, d};
+  memcpy(&value, bytes, sizeof(value));
+}
+
+bool IPAddress::fromString(const char* address) {
+  return inet_pton(AF_INET, address, &value) == 1;
+}
+
+IPAddress::operator uint32_t() const {
+  return value;
+}
+
+uint8_t IPAddress::operator[](int index) const {
+  return ((const uint8_t*)&value)[index & 3];
+}
+
+String IPAddress::toString() const {
+  char buffer[INET_ADDRSTRLEN];
+  return String(inet_ntop(AF_INET, &value, buffer, sizeof(buffer)));
+}
+
+// Ohne DNS: nur Adressen in Punktschreibweise
+int WiFiClass::hostByName(const char* host, IPAddress& address) {
+  return address.fromString(host) ? 1 : 0;
+}
+
+// Tasks laufen als losgelöste Threads
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char*, uint32_t,
+                                   void* param, UBaseType_t, TaskHandle_t* handle, int) {
+  std::thread thread(task, param);
+  if (handle) {
+    *handle = (TaskHandle_t)(uintptr_t)std::hash<std::thread::id>()(thread.get_id());
+  }
+  thread.detach();
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  static thread_local char marker;
+  return &marker;
+}
+
+// Der Thread endet mit der Rückkehr aus der Task-Funktion
+void vTaskDelete(TaskHandle_t) {}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+// Dateisystem unter hostFsRoot
+std::string hostFsRoot = "/tmp/solarmonitor-fs";
+long hostFsBudget = -1;
+bool hostFsDead = false;
+
+void hostFsPowerOn() {
+  hostFsBudget = -1;
+  hostFsDead = false;
+}
+
+// Eine Dateioperation verbrauchen; false nach dem Stromausfall
+static bool consumeOperation() {
+  if (hostFsDead) {
+    return false;
+  }
+  if (hostFsBudget < 0) {
+    return true;
+  }
+  if (hostFsBudget == 0) {
+    hostFsDead = true;
+    return false;
+  }
+  hostFsBudget--;
+  return true;
+}
+
+static std::string hostPath(const char* path) {
+  return hostFsRoot + path;
+}
+
+namespace fs {
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!handle || hostFsDead) {
+    return 0;
+  }
+  size_t count = size;
+  if (hostFsBudget >= 0 && (long)size > hostFsBudget) {
+    count = hostFsBudget;
+  }
+  fwrite(buffer, 1, count, handle);
+  fflush(handle);
+  if (count < size) {
+    hostFsBudget = 0;
+    hostFsDead = true;
+  } else if (hostFsBudget >= 0) {
+    hostFsBudget -= count;
+  }
+  return count;
+}
+
+int File::available() {
+  return handle ? (int)(size() - ftell(handle)) : 0;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+  int c = handle ? fgetc(handle) : EOF;
+  if (c != EOF) {
+    ungetc(c, handle);
+  }
+  return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  return handle ? fread(buffer, 1, size, handle) : 0;
+}
+
+size_t File::size() const {
+  if (!handle) {
+    return 0;
+  }
+  long position = ftell(handle);
+  fseek(handle, 0, SEEK_END);
+  long size = ftell(handle);
+  fseek(handle, position, SEEK_SET);
+  return size;
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+  static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+  return handle && fseek(handle, position, whence[mode]) == 0;
+}
+
+void File::close() {
+  if (handle) {
+    fclose(handle);
+    handle = nullptr;
+  }
+}
+
+File FS::open(const char* path, const char* mode, bool) {
+  if (hostFsDead) {
+    return File();
+  }
+  std::string binaryMode = std::string(mode) + "b";
+  return File(fopen(hostPath(path).c_str(), binaryMode.c_str()), path);
+}
+
+bool FS::exists(const char* path) {
+  return access(hostPath(path).c_str(), F_OK) == 0;
+}
+
+bool FS::remove(const char* path) {
+  return consumeOperation() && ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const String& from, const String& to) {
+  return consumeOperation() && ::rename(hostPath(from.c_str()).c_str(), hostPath(to.c_str()).c_str()) == 0;
+}
+
+}
@@ -0,0 +1,13 @@
+/**
+ * lwip/sockets.h - Auf dem Host gelten die POSIX-Sockets
+ */
+
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
@@ -0,0 +1,7 @@
+/**
+ * testmain.cpp - Gemeinsame Zustände der Host-Tests
+ */
+
+#include "../test.h"
+
+int testFailures = 0;
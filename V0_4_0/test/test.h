@@ -0,0 +1,23 @@
+/**
+ * test.h - Prüfmakros der Host-Tests
+ *
+ * CHECK zählt Fehler und läuft weiter, damit ein Durchlauf alle Abweichungen
+ * zeigt; TEST_RESULT() beendet main() mit 1, wenn eine Prüfung fehlschlug.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+extern int testFailures;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+      printf("FEHLER %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) CHECK(fabs((double)(a) - (double)(b)) <= (tolerance))
+
+#define TEST_RESULT() (printf("%s: %s\n", __FILE__, testFailures ? "FEHLGESCHLAGEN" : "ok"), testFailures ? 1 : 0)
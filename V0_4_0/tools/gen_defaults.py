@@ -0,0 +1,375 @@
+#!/usr/bin/env python3
+"""
+gen_defaults.py - Erzeugt default_data.h/.cpp aus data/*.json
+
+Die Standardkonfiguration (Einstellungen, Menü, MQTT-Topics) wird als
+constexpr-Tabellen in den Flash übersetzt. Ohne eigene Datei im SPIFFS
+verwendet die Firmware diese Tabellen direkt: kein Schreiben beim ersten
+Start und kein JSON-Parser. Tippfehler in den Daten (falscher Typ, fehlendes
+Feld) fallen beim Übersetzen auf.
+
+Aufruf nach jeder Änderung an data/config.json, data/menu.json oder
+data/mqtt_topics.json (im Verzeichnis V0_4_0 oder mit Pfad):
+
+    python3 tools/gen_defaults.py          # Dateien neu schreiben
+    python3 tools/gen_defaults.py --check  # nur prüfen, ob sie aktuell sind
+"""
+
+import json
+import os
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DATA = os.path.join(ROOT, "data")
+
+# Schlüssel der Topics, die die Firmware auswertet; die übrigen
+# (description, unit, color) sind nur Dokumentation in der JSON-Datei
+TOPIC_KEYS = {"name", "topic", "metric", "inverter", "battery", "qos",
+              "priority", "coalesce", "fields", "description", "unit", "color"}
+FIELD_KEYS = {"name", "path", "metric", "inverter", "battery"}
+PRIORITIES = {"high", "normal", "low"}
+
+
+class GenError(Exception):
+    pass
+
+
+def load(name):
+    path = os.path.join(DATA, name)
+    with open(path, encoding="utf-8") as f:
+        return json.load(f)
+
+
+def c_string(value):
+    if value is None:
+        return "nullptr"
+    out = ['"']
+    for ch in value:
+        if ch in '"\\':
+            out.append("\\" + ch)
+        elif ch == "\n":
+            out.append("\\n")
+        elif ord(ch) < 0x20:
+            out.append("\\x%02x" % ord(ch))
+        else:
+            out.append(ch)
+    out.append('"')
+    return "".join(out)
+
+
+def c_bool(value):
+    return "true" if value else "false"
+
+
+def type_name(key):
+    return "".join(part.capitalize() for part in key.split("_"))
+
+
+def require(condition, message):
+    if not condition:
+        raise GenError(message)
+
+
+# --- Einstellungen (config.json) -------------------------------------------
+
+def settings_type(value, key, where):
+    if isinstance(value, bool):
+        return "bool"
+    if isinstance(value, int):
+        return "int32_t"
+    if isinstance(value, float):
+        return "float"
+    if isinstance(value, str):
+        return "const char*"
+    if isinstance(value, list):
+        require(value and all(isinstance(v, (int, float)) and not isinstance(v, bool) for v in value),
+                "%s: nur nicht-leere Zahlenlisten werden unterstützt" % where)
+        return "float" if any(isinstance(v, float) for v in value) else "int32_t"
+    raise GenError("%s: Typ %s wird nicht unterstützt" % (where, type(value).__name__))
+
+
+def settings_struct(name, obj, indent, where):
+    pad = "  " * indent
+    lines = ["%sstruct %s {" % (pad, name)]
+    for key, value in obj.items():
+        require(key.isidentifier(), "%s.%s: Schlüssel ist kein C++-Bezeichner" % (where, key))
+        if isinstance(value, dict):
+            lines += settings_struct(type_name(key), value, indent + 1, where + "." + key)
+            lines.append("%s  } %s;" % (pad, key))
+        elif isinstance(value, list):
+            lines.append("%s  %s %s[%d];" % (pad, settings_type(value, key, where + "." + key), key, len(value)))
+        else:
+            lines.append("%s  %s %s;" % (pad, settings_type(value, key, where + "." + key), key))
+    return lines
+
+
+def settings_value(value):
+    if isinstance(value, dict):
+        return "{ " + ", ".join(settings_value(v) for v in value.values()) + " }"
+    if isinstance(value, list):
+        return "{ " + ", ".join(settings_value(v) for v in value) + " }"
+    if isinstance(value, bool):
+        return c_bool(value)
+    if isinstance(value, float):
+        return repr(value) + "f"
+    if isinstance(value, int):
+        return str(value)
+    return c_string(value)
+
+
+def settings_initializer(obj, indent):
+    pad = "  " * indent
+    lines = []
+    items = list(obj.items())
+    for i, (key, value) in enumerate(items):
+        comma = "," if i < len(items) - 1 else ""
+        if isinstance(value, dict):
+            lines.append("%s{  // %s" % (pad, key))
+            lines += settings_initializer(value, indent + 1)
+            lines.append("%s}%s" % (pad, comma))
+        else:
+            lines.append("%s%s%s  // %s" % (pad, settings_value(value), comma, key))
+    return lines
+
+
+# --- Menü (menu.json) -------------------------------------------------------
+
+# Ebenen inkl. Tab, wie MENU_MAX_DEPTH in config.h
+MENU_MAX_DEPTH = 4
+
+
+def menu_items(lines, table, title, items, depth):
+    """Schreibt die Tabelle 'table'; Untermenüs stehen davor."""
+    require(isinstance(items, list) and items, "menu.json: '%s' ohne Einträge" % title)
+    require(len(items) <= 255, "menu.json: '%s' hat mehr als 255 Einträge" % title)
+    rows = []
+    for i, item in enumerate(items):
+        name = item.get("name")
+        require(isinstance(name, str) and name, "menu.json: '%s' Eintrag %d ohne 'name'" % (title, i))
+        if "items" in item:
+            # Untermenü: Einträge statt Funktion
+            require(depth < MENU_MAX_DEPTH, "menu.json: '%s' ist tiefer als %d Ebenen" % (name, MENU_MAX_DEPTH))
+            sub = "%s_%d" % (table, i)
+            menu_items(lines, sub, name, item["items"], depth + 1)
+            rows.append("  { %s, nullptr, %s, %s, %d }" % (c_string(name), c_string(item.get("icon")),
+                                                           sub, len(item["items"])))
+        else:
+            require(isinstance(item.get("function"), str) and item["function"],
+                    "menu.json: '%s' Eintrag %d ohne 'function'" % (title, i))
+            rows.append("  { %s, %s, %s, nullptr, 0 }" % (c_string(name), c_string(item["function"]),
+                                                          c_string(item.get("icon"))))
+    lines.append("static constexpr DefaultMenuItem %s[] = {" % table)
+    lines.append(",\n".join(rows))
+    lines.append("};")
+    lines.append("")
+
+
+def menu_tables(menu):
+    tabs = menu.get("tabs")
+    require(isinstance(tabs, list) and tabs, "menu.json: 'tabs' fehlt oder ist leer")
+    lines = []
+    entries = []
+    for t, tab in enumerate(tabs):
+        title = tab.get("title")
+        items = tab.get("items", [])
+        require(isinstance(title, str) and title, "menu.json: Tab %d ohne Titel" % t)
+        menu_items(lines, "MENU_ITEMS_%d" % t, title, items, 2)
+        entries.append("  { %s, MENU_ITEMS_%d, %d }" % (c_string(title), t, len(items)))
+    lines.append("constexpr DefaultMenuTab DEFAULT_MENU[] = {")
+    lines.append(",\n".join(entries))
+    lines.append("};")
+    lines.append("static_assert(sizeof(DEFAULT_MENU) / sizeof(DEFAULT_MENU[0]) == DEFAULT_MENU_TABS, \"DEFAULT_MENU_TABS\");")
+    return lines, len(tabs)
+
+
+# --- MQTT-Topics (mqtt_topics.json) -----------------------------------------
+
+def unit_number(entry, key, where):
+    value = entry.get(key, 1)
+    require(isinstance(value, int) and 1 <= value <= 255, "%s: '%s' muss 1..255 sein" % (where, key))
+    return value
+
+
+def topic_tables(topics_doc):
+    topics = topics_doc.get("topics")
+    require(isinstance(topics, list) and topics, "mqtt_topics.json: 'topics' fehlt oder ist leer")
+    lines = []
+    entries = []
+    for t, topic in enumerate(topics):
+        where = "mqtt_topics.json: Topic %d" % t
+        unknown = set(topic) - TOPIC_KEYS
+        require(not unknown, "%s: unbekannte Schlüssel %s" % (where, ", ".join(sorted(unknown))))
+        for key in ("name", "topic"):
+            require(isinstance(topic.get(key), str) and topic[key], "%s ohne '%s'" % (where, key))
+        priority = topic.get("priority")
+        require(priority is None or priority in PRIORITIES, "%s: Priorität '%s' unbekannt" % (where, priority))
+        qos = topic.get("qos", 0)
+        require(qos in (0, 1), "%s: QoS muss 0 oder 1 sein" % where)
+
+        fields = topic.get("fields", [])
+        fields_name = "nullptr"
+        if fields:
+            fields_name = "TOPIC_FIELDS_%d" % t
+            lines.append("static constexpr DefaultTopicField %s[] = {" % fields_name)
+            for f, field in enumerate(fields):
+                fwhere = "%s Feld %d" % (where, f)
+                unknown = set(field) - FIELD_KEYS
+                require(not unknown, "%s: unbekannte Schlüssel %s" % (fwhere, ", ".join(sorted(unknown))))
+                for key in ("name", "path"):
+                    require(isinstance(field.get(key), str) and field[key], "%s ohne '%s'" % (fwhere, key))
+                comma = "," if f < len(fields) - 1 else ""
+                lines.append("  { %s, %s, %s, %d, %d }%s" % (
+                    c_string(field["name"]), c_string(field["path"]), c_string(field.get("metric")),
+                    unit_number(field, "inverter", fwhere), unit_number(field, "battery", fwhere), comma))
+            lines.append("};")
+            lines.append("")
+
+        entries.append("  { %s, %s, %s, %d, %d, %d, %s, %s, %s, %d }" % (
+            c_string(topic["name"]), c_string(topic["topic"]), c_string(topic.get("metric")),
+            unit_number(topic, "inverter", where), unit_number(topic, "battery", where), qos,
+            c_string(priority), c_bool(topic.get("coalesce", True)), fields_name, len(fields)))
+    lines.append("constexpr DefaultTopic DEFAULT_TOPICS[] = {")
+    lines.append(",\n".join(entries))
+    lines.append("};")
+    lines.append("static_assert(sizeof(DEFAULT_TOPICS) / sizeof(DEFAULT_TOPICS[0]) == DEFAULT_TOPIC_COUNT, \"DEFAULT_TOPIC_COUNT\");")
+    return lines, len(topics)
+
+
+HEADER_TEMPLATE = """/**
+ * default_data.h - Standardkonfiguration als Tabellen im Flash
+ *
+ * Erzeugt von tools/gen_defaults.py aus data/config.json, data/menu.json und
+ * data/mqtt_topics.json - nicht von Hand ändern, sondern die JSON-Dateien
+ * anpassen und das Skript erneut ausführen.
+ *
+ * Ohne eigene Datei im SPIFFS werden diese Tabellen direkt verwendet.
+ */
+
+#ifndef DEFAULT_DATA_H
+#define DEFAULT_DATA_H
+
+#include <stdint.h>
+
+struct DefaultMenuItem {
+  const char* name;
+  const char* function;        // nullptr = Untermenü
+  const char* icon;
+  const DefaultMenuItem* items;
+  uint8_t itemCount;
+};
+
+struct DefaultMenuTab {
+  const char* title;
+  const DefaultMenuItem* items;
+  uint8_t itemCount;
+};
+
+struct DefaultTopicField {
+  const char* name;
+  const char* path;
+  const char* metric;          // nullptr = name
+  uint8_t inverter;            // 1..N
+  uint8_t battery;             // 1..N
+};
+
+struct DefaultTopic {
+  const char* name;
+  const char* topic;
+  const char* metric;          // nullptr = name
+  uint8_t inverter;            // 1..N
+  uint8_t battery;             // 1..N
+  uint8_t qos;
+  const char* priority;        // nullptr = aus der Messgröße
+  bool coalesce;
+  const DefaultTopicField* fields;
+  uint8_t fieldCount;
+};
+
+// data/config.json
+%(settings)s
+
+const uint8_t DEFAULT_MENU_TABS = %(tabs)d;
+const uint8_t DEFAULT_TOPIC_COUNT = %(topics)d;
+
+extern const DefaultSettings DEFAULT_SETTINGS;
+extern const DefaultMenuTab DEFAULT_MENU[DEFAULT_MENU_TABS];
+extern const DefaultTopic DEFAULT_TOPICS[DEFAULT_TOPIC_COUNT];
+
+#endif // DEFAULT_DATA_H
+"""
+
+SOURCE_TEMPLATE = """/**
+ * default_data.cpp - Standardkonfiguration als Tabellen im Flash
+ *
+ * Erzeugt von tools/gen_defaults.py - nicht von Hand ändern.
+ */
+
+#include "default_data.h"
+
+// data/config.json
+constexpr DefaultSettings DEFAULT_SETTINGS = {
+%(settings)s
+};
+
+// data/menu.json
+%(menu)s
+
+// data/mqtt_topics.json
+%(topics)s
+"""
+
+
+def generate():
+    config = load("config.json")
+    menu = load("menu.json")
+    topics = load("mqtt_topics.json")
+
+    require(isinstance(config, dict) and isinstance(config.get("wlan"), dict),
+            "config.json: 'wlan' fehlt")
+    settings = settings_struct("DefaultSettings", config, 0, "config.json")
+    settings.append("};")
+    menu_lines, tab_count = menu_tables(menu)
+    topic_lines, topic_count = topic_tables(topics)
+
+    header = HEADER_TEMPLATE % {
+        "settings": "\n".join(settings),
+        "tabs": tab_count,
+        "topics": topic_count,
+    }
+    source = SOURCE_TEMPLATE % {
+        "settings": "\n".join(settings_initializer(config, 1)),
+        "menu": "\n".join(menu_lines),
+        "topics": "\n".join(topic_lines),
+    }
+    return {"default_data.h": header, "default_data.cpp": source}
+
+
+def main():
+    check = "--check" in sys.argv[1:]
+    try:
+        files = generate()
+    except GenError as error:
+        print("Fehler: %s" % error, file=sys.stderr)
+        return 1
+
+    stale = []
+    for name, content in files.items():
+        path = os.path.join(ROOT, name)
+        data = content.replace("\n", "\r\n").encode("utf-8")
+        old = open(path, "rb").read() if os.path.exists(path) else None
+        if old == data:
+            continue
+        stale.append(name)
+        if not check:
+            with open(path, "wb") as f:
+                f.write(data)
+            print("%s geschrieben" % name)
+
+    if check and stale:
+        print("Nicht aktuell: %s (tools/gen_defaults.py ausführen)" % ", ".join(stale), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())